@@ -0,0 +1,155 @@
+/**
+ * @file
+ * @brief Abstract syntax tree source file.
+ *
+ * The parser pushes every node it completes on a stack. When a node is reduced, its children are
+ * popped from the top of the stack and copied next to each other at the end of the node array,
+ * which is a single bump allocation: a node only stores the index of its first child and their
+ * count, and the whole tree is released at once. Once memory is exhausted, the tree is marked as failed
+ * and stops changing, for the parser to give up at the end of the block.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "ast.h"
+
+/**
+ * Grows a node array so that it can hold at least the given number of nodes. Once memory is exhausted,
+ * the tree is marked as failed and left as it is, every later change being ignored.
+ *
+ * @param ast The syntax tree.
+ * @param nodes The node array.
+ * @param capacity The capacity of the array, updated.
+ * @param needed The number of nodes it must hold.
+ * @return 1 if the array can hold the nodes, 0 if memory is exhausted.
+*/
+static int ast_reserve(Ast* ast, AstNode** nodes, uint32_t* capacity, uint32_t needed) {
+    if (ast->failed)
+        return 0;
+    if (needed <= *capacity)
+        return 1;
+    uint32_t grown = *capacity == 0 ? 256 : *capacity;
+    while (grown < needed)
+        grown *= 2;
+    AstNode* array = realloc(*nodes, grown * sizeof(AstNode));
+    if (array == NULL) {
+        ast->failed = 1;
+        return 0;
+    }
+    *nodes = array;
+    *capacity = grown;
+    return 1;
+}
+
+/**
+ * Initializes an empty syntax tree.
+ *
+ * @param ast The syntax tree.
+*/
+void ast_init(Ast* ast) {
+    memset(ast, 0, sizeof(Ast));
+    ast->root = AST_NONE;
+}
+
+/**
+ * Releases the whole syntax tree.
+ *
+ * @param ast The syntax tree.
+*/
+void ast_free(Ast* ast) {
+    free(ast->nodes);
+    free(ast->stack);
+    ast_init(ast);
+}
+
+/**
+ * Pushes a node on the stack, where it waits for its parent to be reduced.
+ *
+ * @param ast The syntax tree.
+ * @param node The node.
+*/
+void ast_push(Ast* ast, AstNode node) {
+    if (!ast_reserve(ast, &ast->stack, &ast->stack_capacity, ast->depth + 1))
+        return;
+    ast->stack[ast->depth++] = node;
+}
+
+/**
+ * Marks the current top of the stack, before the children of a node are parsed.
+ *
+ * @param ast The syntax tree.
+ * @return The mark to give to ast_reduce().
+*/
+uint32_t ast_mark(const Ast* ast) {
+    return ast->depth;
+}
+
+/**
+ * Moves every node pushed since the mark into the tree as the children of the given node,
+ * then pushes that node.
+ *
+ * @param ast The syntax tree.
+ * @param mark The mark taken before the children were parsed.
+ * @param node The parent node, its first and count fields being filled here.
+*/
+void ast_reduce(Ast* ast, uint32_t mark, AstNode node) {
+    uint32_t count = ast->depth - mark;
+    if (!ast_reserve(ast, &ast->nodes, &ast->capacity, ast->count + count))
+        return;
+    memcpy(ast->nodes + ast->count, ast->stack + mark, count * sizeof(AstNode));
+    node.first = ast->count;
+    node.count = count;
+    ast->count += count;
+    ast->depth = mark;
+    ast_push(ast, node);
+}
+
+/**
+ * Moves the last node left on the stack into the tree as its root.
+ *
+ * @param ast The syntax tree.
+*/
+void ast_finish(Ast* ast) {
+    if (!ast_reserve(ast, &ast->nodes, &ast->capacity, ast->count + 1))
+        return;
+    ast->root = ast->count;
+    ast->nodes[ast->count++] = ast->stack[--ast->depth];
+}
+
+/**
+ * Appends a syntax tree parsed apart, whose nodes are still on its stack, to the end of another:
+ * its finished nodes are copied after the nodes of the tree, and its stack is pushed on the stack.
+ *
+ * @param ast The syntax tree.
+ * @param part The syntax tree parsed apart, left untouched.
+ * @return The index the first node of part has in the tree.
+*/
+uint32_t ast_append(Ast* ast, const Ast* part) {
+    uint32_t base = ast->count;
+    if (!ast_reserve(ast, &ast->nodes, &ast->capacity, base + part->count))
+        return base;
+    for (uint32_t i = 0; i < part->count; i++) {
+        AstNode node = part->nodes[i];
+        node.first += base;
+        ast->nodes[base + i] = node;
+    }
+    ast->count += part->count;
+    for (uint32_t i = 0; i < part->depth; i++) {
+        AstNode node = part->stack[i];
+        node.first += base;
+        ast_push(ast, node);
+    }
+    return base;
+}
+
+/**
+ * Releases the nodes of a subtree that is no longer needed, which must be the last one parsed.
+ *
+ * @param ast The syntax tree.
+ * @param mark The mark taken before the subtree was parsed, the stack being cut back to it.
+ * @param count The number of finished nodes before the subtree was parsed.
+*/
+void ast_truncate(Ast* ast, uint32_t mark, uint32_t count) {
+    ast->depth = mark;
+    ast->count = count;
+}
@@ -0,0 +1,98 @@
+/**
+ * @file
+ * @brief Abstract syntax tree header file.
+*/
+
+#ifndef AST_H_
+#define AST_H_
+
+#include <stdint.h>
+
+#define AST_NONE UINT32_MAX /** Index standing for no node. */
+#define AST_NO_NAME -1 /** Value of a traverse node that doesn't select a graph. */
+
+/**
+ * Enumeration of the different nodes of the syntax tree, with what their value and children hold.
+*/
+typedef enum {
+    AST_PROGRAM,    /** Children: every AST_GRAPH, then the AST_MAIN. */
+    AST_GRAPH,      /** Value: graph name. Children: AST_TYPE, optional AST_SUBGRAPH, AST_DECLARE. */
+    AST_MAIN,       /** Children: AST_TYPE, optional AST_SUBGRAPH, AST_DECLARE, AST_OPERATIONS. */
+    AST_TYPE,       /** Value: 1 for a directed graph, 0 for an undirected one. */
+    AST_SUBGRAPH,   /** Children: AST_INSTANCES. */
+    AST_INSTANCES,  /** Value: template graph name. Children: one AST_ID per instance name. */
+    AST_DECLARE,    /** Value: index of the graph its DeclareSink built, -1 without sink. Edges are not stored. */
+    AST_OPERATIONS, /** Children: instructions (AST_CALL, AST_IF, AST_TRAVERSE). */
+    AST_CALL,       /** Sub: OperationKind. Children: parameters (AST_ID, AST_COLOR, AST_CALL). */
+    AST_IF,         /** Children: AST_CONDITION, then the instructions of its block. */
+    AST_CONDITION,  /** Sub: comparison TokenType, 0 if none. Children: one or two AST_NUM or AST_CALL. */
+    AST_TRAVERSE,   /** Sub: SearchKind. Value: graph name or AST_NO_NAME. Children: AST_LAMBDA. */
+    AST_LAMBDA,     /** Children: three AST_ID parameters (start, end, edge), then the body instructions. */
+    AST_ID,         /** Value: name. */
+    AST_NUM,        /** Value: number. */
+    AST_COLOR       /** Value: ColorKind. */
+} AstKind;
+
+/**
+ * Defined type based on a struct holding one node of the syntax tree.
+ * Nodes refer to each other by index and the children of a node are stored next to each other.
+*/
+typedef struct {
+    uint8_t kind;    /** AstKind of the node. */
+    uint8_t sub;     /** Operation, search method or comparison, depending on the kind. */
+    uint16_t flags;  /** Kind specific bits, none are used yet. */
+    int32_t value;   /** Name id, number or color, depending on the kind. */
+    uint32_t first;  /** Index of the first child. */
+    uint32_t count;  /** Number of children. */
+    uint32_t line;   /** Line of the first token of the node. */
+    uint32_t column; /** Column of the first token of the node. */
+} AstNode;
+
+/**
+ * Defined type based on a struct holding a whole syntax tree in one bump allocated array,
+ * and the stack of nodes whose parent is still being parsed.
+*/
+typedef struct {
+    AstNode* nodes;          /** Finished nodes, children being moved here when their parent is reduced. */
+    uint32_t count;          /** Number of finished nodes. */
+    uint32_t capacity;       /** Capacity of nodes. */
+    AstNode* stack;          /** Nodes waiting for their parent. */
+    uint32_t depth;          /** Number of nodes on the stack. */
+    uint32_t stack_capacity; /** Capacity of stack. */
+    uint32_t root;           /** Index of the AST_PROGRAM node, AST_NONE until the tree is finished. */
+    int failed;              /** 1 once memory is exhausted, the tree being incomplete. */
+} Ast;
+
+void ast_init(Ast* ast);
+void ast_free(Ast* ast);
+void ast_push(Ast* ast, AstNode node);
+uint32_t ast_mark(const Ast* ast);
+void ast_reduce(Ast* ast, uint32_t mark, AstNode node);
+void ast_finish(Ast* ast);
+uint32_t ast_append(Ast* ast, const Ast* part);
+void ast_truncate(Ast* ast, uint32_t mark, uint32_t count);
+
+/**
+ * Returns the node at the given index.
+ *
+ * @param ast The syntax tree.
+ * @param index The index of the node.
+ * @return The node.
+*/
+static inline const AstNode* ast_node(const Ast* ast, uint32_t index) {
+    return &ast->nodes[index];
+}
+
+/**
+ * Returns the i-th child of a node.
+ *
+ * @param ast The syntax tree.
+ * @param node The parent node.
+ * @param i The position of the child.
+ * @return The child node.
+*/
+static inline const AstNode* ast_child(const Ast* ast, const AstNode* node, uint32_t i) {
+    return &ast->nodes[node->first + i];
+}
+
+#endif
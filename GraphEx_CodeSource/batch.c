@@ -0,0 +1,268 @@
+/**
+ * @file
+ * @brief Batch compilation source file.
+ *
+ * Compiles many files in one process: each worker of a thread pool compiles the files of its own
+ * queue, each one in its own GxContext whose diagnostics go to a memory stream, and steals half of
+ * the files left to another worker once its queue is empty.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "batch.h"
+#include "graphex.h"
+
+/**
+ * Marks a batch as exhausted when it can't grow anymore.
+ *
+ * @param batch The batch.
+ * @return 0.
+*/
+static int batch_out_of_memory(Batch* batch) {
+    __atomic_store_n(&batch->exhausted, 1, __ATOMIC_RELAXED);
+    return 0;
+}
+
+/**
+ * Initializes a batch without any file.
+ *
+ * @param batch The batch.
+*/
+void batch_init(Batch* batch) {
+    memset(batch, 0, sizeof(Batch));
+}
+
+/**
+ * Releases a batch.
+ *
+ * @param batch The batch.
+*/
+void batch_free(Batch* batch) {
+    for (uint32_t i = 0; batch->messages != NULL && i < batch->count; i++)
+        free(batch->messages[i]);
+    for (uint32_t i = 0; i < batch->list_count; i++)
+        free(batch->lists[i]);
+    free(batch->paths);
+    free(batch->lists);
+    free(batch->messages);
+    free(batch->lengths);
+    free(batch->valid);
+    free(batch->queues);
+    memset(batch, 0, sizeof(Batch));
+}
+
+/**
+ * Adds a file to a batch.
+ *
+ * @param batch The batch.
+ * @param path The path of the file, kept until the batch is freed.
+ * @return 0 if memory is exhausted, the batch being exhausted, 1 if not.
+*/
+int batch_add(Batch* batch, const char* path) {
+    if (batch->count == batch->capacity) {
+        uint32_t capacity = batch->capacity == 0 ? 64 : batch->capacity * 2;
+        const char** paths = realloc(batch->paths, capacity * sizeof(const char*));
+        if (paths == NULL)
+            return batch_out_of_memory(batch);
+        batch->paths = paths;
+        batch->capacity = capacity;
+    }
+    batch->paths[batch->count++] = path;
+    return 1;
+}
+
+/**
+ * Adds every file of a list file to a batch, one path per line. Blank lines are skipped.
+ *
+ * @param batch The batch.
+ * @param path The path of the list file.
+ * @return 0 if the list file can't be read or if memory is exhausted, the batch being exhausted, 1 if not.
+*/
+int batch_add_list(Batch* batch, const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL)
+        return 0;
+    size_t size = 0, capacity = 4096;
+    char* text = malloc(capacity);
+    size_t read;
+    while (text != NULL && (read = fread(text + size, 1, capacity - size - 1, file)) > 0) {
+        size += read;
+        if (size + 1 == capacity) {
+            capacity *= 2;
+            char* grown = realloc(text, capacity);
+            if (grown == NULL)
+                free(text);
+            text = grown;
+        }
+    }
+    fclose(file);
+    char** lists = text == NULL ? NULL : realloc(batch->lists, (batch->list_count + 1) * sizeof(char*));
+    if (lists == NULL) {
+        free(text);
+        return batch_out_of_memory(batch);
+    }
+    text[size] = '\0';
+    batch->lists = lists;
+    batch->lists[batch->list_count++] = text;
+
+    for (char* line = text; line < text + size;) { // Each line is cut at its end, \r\n included
+        char* end = line + strcspn(line, "\r\n");
+        char* next = *end == '\0' ? end : end + 1;
+        *end = '\0';
+        if (end > line && !batch_add(batch, line))
+            return 0;
+        line = next;
+    }
+    return 1;
+}
+
+/**
+ * Compiles one file of a batch, keeping its diagnostics.
+ *
+ * @param batch The batch.
+ * @param i The index of the file.
+*/
+static void compile_file(Batch* batch, uint32_t i) {
+    char* text = NULL;
+    size_t length = 0;
+    FILE* messages = open_memstream(&text, &length);
+    if (messages == NULL) { // The file counts as failed, the summary telling why
+        batch_out_of_memory(batch);
+        return;
+    }
+    GxContext context;
+    gx_init(&context);
+    context.messages = messages;
+    context.threads = 1; // The workers of the batch already keep every processor busy
+    int valid = 0;
+    if (!gx_open(&context, batch->paths[i]))
+        fprintf(messages, "Error: failed to find target source file at path \"%s\"\n", batch->paths[i]);
+    else
+        valid = gx_compile(&context);
+    gx_free(&context);
+    fclose(messages);
+    batch->messages[i] = text;
+    batch->lengths[i] = length;
+    batch->valid[i] = (uint8_t) valid;
+}
+
+/**
+ * Takes the first file of the queue of a worker.
+ *
+ * @param queue The queue.
+ * @return The index of the file, BATCH_NO_FILE if the queue is empty.
+*/
+static uint32_t take_file(BatchQueue* queue) {
+    uint64_t range = __atomic_load_n(&queue->range, __ATOMIC_RELAXED);
+    while ((uint32_t) (range >> 32) < (uint32_t) range) {
+        if (__atomic_compare_exchange_n(&queue->range, &range, range + (1ull << 32), 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            return (uint32_t) (range >> 32);
+    }
+    return BATCH_NO_FILE;
+}
+
+/**
+ * Moves the last half of the files left to another worker into the empty queue of a worker.
+ *
+ * @param batch The batch.
+ * @param worker The index of the worker.
+ * @return 0 if every other queue is empty, 1 if files were stolen.
+*/
+static int steal_files(Batch* batch, uint32_t worker) {
+    uint32_t workers = batch->pool->count;
+    for (uint32_t k = 1; k < workers; k++) {
+        BatchQueue* victim = &batch->queues[(worker + k) % workers];
+        uint64_t range = __atomic_load_n(&victim->range, __ATOMIC_RELAXED);
+        while (1) {
+            uint32_t first = (uint32_t) (range >> 32), end = (uint32_t) range;
+            if (first >= end)
+                break;
+            uint32_t half = end - (end - first) / 2; // The victim keeps the first file if only one is left
+            if (half == end)
+                break;
+            if (__atomic_compare_exchange_n(&victim->range, &range, ((uint64_t) first << 32) | half, 1,
+                __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                __atomic_store_n(&batch->queues[worker].range, ((uint64_t) half << 32) | end, __ATOMIC_RELAXED);
+                __atomic_fetch_add(&batch->steals, 1, __ATOMIC_RELAXED);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * Batch task compiling the files of the worker, then the files it steals, until every queue is empty.
+*/
+static void task_compile(void* data, uint32_t worker) {
+    Batch* batch = data;
+    BatchQueue* queue = &batch->queues[worker];
+    while (1) {
+        uint32_t file = take_file(queue);
+        if (file != BATCH_NO_FILE)
+            compile_file(batch, file);
+        else if (!steal_files(batch, worker))
+            return;
+    }
+}
+
+/**
+ * Compiles every file of a batch, then prints the diagnostics of each file in input order and a summary.
+ *
+ * @param batch The batch.
+ * @param threads The number of workers, 0 for one per processor.
+ * @param stats 1 to print the work done by the workers.
+ * @param out The stream receiving the diagnostics, the summary and the statistics.
+ * @return The number of files that failed to compile, every file if memory is exhausted before any is compiled.
+*/
+uint32_t batch_run(Batch* batch, uint32_t threads, int stats, FILE* out) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    uint32_t n = batch->count;
+    batch->messages = calloc((size_t) n + 1, sizeof(char*));
+    batch->lengths = calloc((size_t) n + 1, sizeof(size_t));
+    batch->valid = calloc((size_t) n + 1, sizeof(uint8_t));
+    if (batch->messages == NULL || batch->lengths == NULL || batch->valid == NULL) {
+        fprintf(out, "Error: out of memory while compiling a batch\n");
+        return n;
+    }
+
+    ThreadPool pool;
+    pool_init(&pool, threads);
+    batch->pool = &pool;
+    batch->queues = calloc(pool.count, sizeof(BatchQueue));
+    if (batch->queues == NULL) {
+        pool_free(&pool);
+        batch->pool = NULL;
+        fprintf(out, "Error: out of memory while compiling a batch\n");
+        return n;
+    }
+    for (uint32_t w = 0; w < pool.count; w++) { // Contiguous ranges of the same size
+        uint64_t first = (uint64_t) n * w / pool.count, last = (uint64_t) n * (w + 1) / pool.count;
+        batch->queues[w].range = (first << 32) | last;
+    }
+    pool_run(&pool, task_compile, batch);
+    uint32_t workers = pool.count;
+    pool_free(&pool);
+    batch->pool = NULL;
+
+    uint32_t failed = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        failed += !batch->valid[i];
+        if (batch->lengths[i] == 0)
+            continue;
+        fprintf(out, "%s:\n", batch->paths[i]);
+        fwrite(batch->messages[i], 1, batch->lengths[i], out);
+    }
+    if (batch->exhausted)
+        fprintf(out, "Error: out of memory while compiling a batch\n");
+    fprintf(out, "%u file%s compiled, %u failed\n", n, n == 1 ? "" : "s", failed);
+    if (stats) {
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        double time = (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) / 1e6;
+        fprintf(out, "[stats] batch: %u workers, %llu steals, %.3f ms\n", workers, (unsigned long long) batch->steals, time);
+    }
+    return failed;
+}
@@ -0,0 +1,52 @@
+/**
+ * @file
+ * @brief Batch compilation header file.
+*/
+
+#ifndef BATCH_H_
+#define BATCH_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stddef.h>
+#include "pool.h"
+
+#define BATCH_NO_FILE UINT32_MAX /** File taken from an empty queue. */
+
+/**
+ * Defined type based on a struct holding the files a worker has yet to compile, a range of indices
+ * packed in one word so that the owner taking from the front and a thief taking from the back
+ * both move it with a single compare-and-swap. It fills a cache line so that queues don't share one.
+*/
+typedef struct {
+    uint64_t range;          /** First file in the high 32 bits, one past the last file in the low 32 bits. */
+    uint8_t padding[56];     /** Keeps the next queue on another cache line. */
+} BatchQueue;
+
+/**
+ * Defined type based on a struct holding the files of a batch and what compiling each one gave.
+ * The files are split among the workers of a pool, a worker whose queue is empty stealing half of
+ * the queue of another. The diagnostics of each file are kept apart, then printed in input order.
+*/
+typedef struct {
+    const char** paths;      /** Path of each file, in input order. */
+    uint32_t count;          /** Number of files. */
+    uint32_t capacity;       /** Capacity of paths. */
+    char** lists;            /** Contents of the list files, holding the paths they give. */
+    uint32_t list_count;     /** Number of list files. */
+    char** messages;         /** Diagnostics printed while compiling each file. */
+    size_t* lengths;         /** Length of the diagnostics of each file. */
+    uint8_t* valid;          /** 1 for each file that compiled. */
+    ThreadPool* pool;        /** Workers compiling the files. */
+    BatchQueue* queues;      /** Files left to each worker. */
+    uint64_t steals;         /** Ranges stolen by workers with an empty queue. */
+    int exhausted;           /** 1 once memory was exhausted, some files being left out or failed. */
+} Batch;
+
+void batch_init(Batch* batch);
+void batch_free(Batch* batch);
+int batch_add(Batch* batch, const char* path);
+int batch_add_list(Batch* batch, const char* path);
+uint32_t batch_run(Batch* batch, uint32_t threads, int stats, FILE* out);
+
+#endif
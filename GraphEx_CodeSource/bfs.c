@@ -0,0 +1,397 @@
+/**
+ * @file
+ * @brief Parallel breadth-first search source file.
+ *
+ * Direction-optimizing search (Beamer et al.): top-down steps scan the edges of the frontier,
+ * bottom-up steps scan the incoming edges of the unreached nodes and stop at the first one
+ * leaving the frontier, which is far cheaper once the frontier holds most of the graph.
+ * Workers share the frontier by contiguous ranges and only synchronize between steps.
+ * The edges are walked through the view and its instances, so a search only allocates arrays
+ * indexed by node, whatever the number of instances of a template.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "bfs.h"
+
+/**
+ * Allocates memory for a search array.
+ *
+ * @param count The number of elements.
+ * @param size The size of an element.
+ * @return The allocated array, NULL if memory is exhausted.
+*/
+static void* bfs_alloc(size_t count, size_t size) {
+    return malloc(count * size + 1);
+}
+
+/**
+ * Releases the node arrays of a search.
+ *
+ * @param bfs The search.
+*/
+static void bfs_release(Bfs* bfs) {
+    free(bfs->visited);
+    free(bfs->in_frontier);
+    free(bfs->keys);
+    free(bfs->ranks);
+    free(bfs->pending);
+    free(bfs->frontier);
+    free(bfs->previous);
+    free(bfs->parents);
+    free(bfs->parent_weights);
+    free(bfs->entries);
+    bfs->visited = NULL;
+    bfs->in_frontier = NULL;
+    bfs->keys = NULL;
+    bfs->ranks = NULL;
+    bfs->pending = NULL;
+    bfs->frontier = NULL;
+    bfs->previous = NULL;
+    bfs->parents = NULL;
+    bfs->parent_weights = NULL;
+    bfs->entries = NULL;
+    bfs->capacity = 0;
+}
+
+/**
+ * Initializes a search without any graph. The search is failed if memory is exhausted.
+ *
+ * @param bfs The search.
+ * @param pool The workers of the steps.
+ * @param ordered 1 to get each level in the order of a sequential search, 0 for any order.
+*/
+void bfs_init(Bfs* bfs, ThreadPool* pool, int ordered) {
+    memset(bfs, 0, sizeof(Bfs));
+    bfs->pool = pool;
+    bfs->ordered = ordered;
+    bfs->buffers = calloc(pool->count, sizeof(BfsBuffer));
+    if (bfs->buffers == NULL)
+        bfs->failed = 1;
+}
+
+/**
+ * Releases a search.
+ *
+ * @param bfs The search.
+*/
+void bfs_free(Bfs* bfs) {
+    bfs_release(bfs);
+    for (uint32_t w = 0; w < bfs->pool->count && bfs->buffers != NULL; w++)
+        free(bfs->buffers[w].nodes);
+    free(bfs->buffers);
+    memset(bfs, 0, sizeof(Bfs));
+}
+
+/**
+ * Starts searching a graph, with no node reached yet.
+ *
+ * @param bfs The search.
+ * @param view The graph, whose graphs must have their incoming edges built by graph_reverse().
+ * @return 0 if memory is exhausted, the search being failed, 1 if not.
+*/
+int bfs_begin(Bfs* bfs, const GraphView* view) {
+    if (bfs->failed)
+        return 0;
+    bfs->view = view;
+    uint32_t n = view->node_count;
+    size_t words = ((size_t) n + 63) / 64;
+    if (n > bfs->capacity || bfs->capacity == 0) {
+        bfs_release(bfs);
+        bfs->visited = bfs_alloc(words, sizeof(uint64_t));
+        bfs->in_frontier = calloc(words + 1, sizeof(uint64_t));
+        bfs->keys = bfs_alloc(n, sizeof(uint64_t));
+        bfs->ranks = bfs_alloc(n, sizeof(uint32_t));
+        bfs->pending = bfs_alloc(n, sizeof(uint32_t));
+        bfs->frontier = bfs_alloc(n, sizeof(uint32_t));
+        bfs->previous = bfs_alloc(n, sizeof(uint32_t));
+        bfs->parents = bfs_alloc(n, sizeof(uint32_t));
+        bfs->parent_weights = bfs_alloc(n, sizeof(int64_t));
+        bfs->entries = bfs_alloc(n, sizeof(BfsEntry));
+        if (bfs->visited == NULL || bfs->in_frontier == NULL || bfs->keys == NULL || bfs->ranks == NULL
+            || bfs->pending == NULL || bfs->frontier == NULL || bfs->previous == NULL || bfs->parents == NULL
+            || bfs->parent_weights == NULL || bfs->entries == NULL) {
+            bfs_release(bfs);
+            bfs->failed = 1;
+            return 0;
+        }
+        bfs->capacity = n;
+    }
+    memset(bfs->visited, 0, words * sizeof(uint64_t));
+    memset(bfs->keys, 0xFF, n * sizeof(uint64_t));
+    bfs->unvisited_edges = view->edge_count;
+    bfs->frontier_count = 0;
+    bfs->bottom_up = 0;
+    bfs->levels = 0;
+    bfs->bottom_up_levels = 0;
+    bfs->reached = 0;
+    return 1;
+}
+
+/**
+ * Makes an unreached node the only node of the frontier.
+ *
+ * @param bfs The search.
+ * @param root The node id.
+*/
+void bfs_root(Bfs* bfs, uint32_t root) {
+    bfs->visited[root >> 6] |= 1ull << (root & 63);
+    bfs->keys[root] = 0;
+    bfs->frontier[0] = root;
+    bfs->frontier_count = 1;
+    bfs->frontier_edges = view_degree(bfs->view, root);
+    bfs->unvisited_edges -= bfs->frontier_edges;
+    bfs->bottom_up = 0;
+    bfs->reached++;
+}
+
+/**
+ * Gives the range of a list that a worker handles.
+ *
+ * @param bfs The search.
+ * @param worker The index of the worker.
+ * @param count The length of the list.
+ * @param begin Receives the first index of the range.
+ * @param end Receives the index after the range.
+*/
+static void worker_range(const Bfs* bfs, uint32_t worker, uint32_t count, uint32_t* begin, uint32_t* end) {
+    uint32_t workers = bfs->pool->count;
+    *begin = (uint32_t) ((uint64_t) count * worker / workers);
+    *end = (uint32_t) ((uint64_t) count * (worker + 1) / workers);
+}
+
+/**
+ * Appends a node to the buffer of a worker, unless the buffer can't grow, which fails the search.
+ *
+ * @param bfs The search.
+ * @param buffer The buffer of the worker.
+ * @param node The node id.
+*/
+static void buffer_push(Bfs* bfs, BfsBuffer* buffer, uint32_t node) {
+    if (buffer->count == buffer->capacity) {
+        uint32_t capacity = buffer->capacity == 0 ? 64 : buffer->capacity * 2;
+        uint32_t* nodes = realloc(buffer->nodes, (size_t) capacity * sizeof(uint32_t));
+        if (nodes == NULL) {
+            __atomic_store_n(&bfs->failed, 1, __ATOMIC_RELAXED);
+            return;
+        }
+        buffer->nodes = nodes;
+        buffer->capacity = capacity;
+    }
+    buffer->nodes[buffer->count++] = node;
+    buffer->edges += view_degree(bfs->view, node);
+}
+
+/**
+ * Step task indexing the frontier, and marking it in the frontier bitset for a bottom-up step.
+*/
+static void task_rank(void* data, uint32_t worker) {
+    Bfs* bfs = data;
+    uint32_t begin, end;
+    worker_range(bfs, worker, bfs->frontier_count, &begin, &end);
+    for (uint32_t i = begin; i < end; i++) {
+        uint32_t node = bfs->frontier[i];
+        bfs->ranks[node] = i;
+        if (bfs->bottom_up) {
+            __atomic_fetch_or(&bfs->in_frontier[node >> 6], 1ull << (node & 63), __ATOMIC_RELAXED);
+            bfs->pending[i] = 0;
+        }
+    }
+    bfs->buffers[worker].count = 0;
+    bfs->buffers[worker].edges = 0;
+}
+
+/**
+ * Top-down step task: the frontier nodes of the worker claim their unreached neighbors,
+ * the smallest key winning when the levels are ordered.
+*/
+static void task_top_down(void* data, uint32_t worker) {
+    Bfs* bfs = data;
+    BfsBuffer* buffer = &bfs->buffers[worker];
+    uint32_t begin, end;
+    worker_range(bfs, worker, bfs->frontier_count, &begin, &end);
+    EdgeCursor cursor;
+    ViewEdge edge;
+    for (uint32_t i = begin; i < end; i++) {
+        view_edges(bfs->view, bfs->frontier[i], &cursor);
+        for (uint64_t position = 0; view_next_edge(&cursor, &edge); position++) {
+            uint32_t next = edge.target;
+            if (bfs_visited(bfs, next))
+                continue;
+            uint64_t key = (uint64_t) i << 32 | position;
+            uint64_t old = __atomic_load_n(&bfs->keys[next], __ATOMIC_RELAXED);
+            while (key < old && (bfs->ordered || old == BFS_NO_KEY)) {
+                if (__atomic_compare_exchange_n(&bfs->keys[next], &old, key, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                    if (old == BFS_NO_KEY)
+                        buffer_push(bfs, buffer, next);
+                    break;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Bottom-up step task: the unreached nodes of the worker look for an incoming edge from the frontier,
+ * all of them when the levels are ordered, the first one otherwise. A node keeps the frontier node
+ * of smallest index, the position of the edge among its outgoing edges being resolved by task_resolve().
+*/
+static void task_bottom_up(void* data, uint32_t worker) {
+    Bfs* bfs = data;
+    BfsBuffer* buffer = &bfs->buffers[worker];
+    uint32_t begin, end;
+    worker_range(bfs, worker, bfs->view->node_count, &begin, &end);
+    EdgeCursor cursor;
+    ViewEdge edge;
+    for (uint32_t node = begin; node < end; node++) {
+        if (bfs_visited(bfs, node))
+            continue;
+        uint32_t best = BFS_NO_POSITION;
+        view_edges_in(bfs->view, node, &cursor);
+        while (view_next_edge(&cursor, &edge)) {
+            uint32_t source = edge.target;
+            if (!((bfs->in_frontier[source >> 6] >> (source & 63)) & 1))
+                continue;
+            if (bfs->ranks[source] < best)
+                best = bfs->ranks[source];
+            if (!bfs->ordered)
+                break;
+        }
+        if (best != BFS_NO_POSITION) {
+            bfs->keys[node] = (uint64_t) best << 32 | BFS_NO_POSITION;
+            __atomic_fetch_add(&bfs->pending[best], 1, __ATOMIC_RELAXED);
+            buffer_push(bfs, buffer, node);
+        }
+    }
+}
+
+/**
+ * Step task resolving the edges of a bottom-up step: each frontier node of the worker that reached
+ * nodes walks its outgoing edges until it met all of them, the first edge to a node being its smallest.
+*/
+static void task_resolve(void* data, uint32_t worker) {
+    Bfs* bfs = data;
+    uint32_t begin, end;
+    worker_range(bfs, worker, bfs->frontier_count, &begin, &end);
+    EdgeCursor cursor;
+    ViewEdge edge;
+    for (uint32_t i = begin; i < end; i++) {
+        uint32_t pending = bfs->pending[i];
+        if (pending == 0)
+            continue;
+        uint64_t unresolved = (uint64_t) i << 32 | BFS_NO_POSITION;
+        view_edges(bfs->view, bfs->frontier[i], &cursor);
+        for (uint64_t position = 0; pending > 0 && view_next_edge(&cursor, &edge); position++) {
+            if (bfs->keys[edge.target] == unresolved) {
+                bfs->keys[edge.target] = (uint64_t) i << 32 | position;
+                pending--;
+            }
+        }
+    }
+}
+
+/**
+ * Step task resolving the parent of each node of the new level from its key, marking the level
+ * reached and clearing the frontier bitset.
+*/
+static void task_finish(void* data, uint32_t worker) {
+    Bfs* bfs = data;
+    uint32_t begin, end;
+    worker_range(bfs, worker, bfs->frontier_count, &begin, &end);
+    for (uint32_t i = begin; i < end; i++) {
+        uint32_t node = bfs->frontier[i];
+        uint64_t key = bfs->keys[node];
+        uint32_t parent = bfs->previous[key >> 32];
+        ViewEdge edge;
+        view_edge_at(bfs->view, parent, key & 0xFFFFFFFFu, &edge);
+        bfs->parents[i] = parent;
+        bfs->parent_weights[i] = edge.weight;
+        __atomic_fetch_or(&bfs->visited[node >> 6], 1ull << (node & 63), __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * Step task clearing the frontier bitset after a bottom-up step.
+*/
+static void task_clear(void* data, uint32_t worker) {
+    Bfs* bfs = data;
+    uint32_t begin, end;
+    worker_range(bfs, worker, bfs->frontier_count, &begin, &end);
+    for (uint32_t i = begin; i < end; i++)
+        __atomic_store_n(&bfs->in_frontier[bfs->previous[i] >> 6], 0, __ATOMIC_RELAXED);
+}
+
+/**
+ * Compares two level entries by key, for qsort().
+ *
+ * @param a The first BfsEntry.
+ * @param b The second BfsEntry.
+ * @return A negative number, zero, or a positive number, as a is before, with, or after b.
+*/
+static int compare_entries(const void* a, const void* b) {
+    uint64_t key_a = ((const BfsEntry*) a)->key;
+    uint64_t key_b = ((const BfsEntry*) b)->key;
+    return (key_a > key_b) - (key_a < key_b);
+}
+
+/**
+ * Reaches the next level. The nodes of the level are then in frontier, and the edge each one
+ * was reached by goes from the node at the same index in parents, with its weight in parent_weights.
+ *
+ * @param bfs The search.
+ * @return The number of nodes of the level, 0 once every node reachable from the roots is reached
+ * or when memory is exhausted, the search being failed.
+*/
+uint32_t bfs_step(Bfs* bfs) {
+    if (bfs->frontier_count == 0)
+        return 0;
+    // A bottom-up step scans every node, so it also needs a frontier large enough to pay for it
+    int large = bfs->frontier_count >= bfs->view->node_count / BFS_BETA;
+    if (!bfs->bottom_up && large && bfs->frontier_edges > bfs->unvisited_edges / BFS_ALPHA)
+        bfs->bottom_up = 1;
+    else if (bfs->bottom_up && !large)
+        bfs->bottom_up = 0;
+
+    pool_run(bfs->pool, task_rank, bfs);
+    pool_run(bfs->pool, bfs->bottom_up ? task_bottom_up : task_top_down, bfs);
+    if (bfs->failed) // A buffer lost some of the level
+        return 0;
+    if (bfs->bottom_up)
+        pool_run(bfs->pool, task_resolve, bfs);
+
+    // The buffers of the workers make the new level, the old one being kept to resolve the parents
+    uint32_t* level = bfs->previous;
+    bfs->previous = bfs->frontier;
+    bfs->frontier = level;
+    uint32_t previous_count = bfs->frontier_count;
+    uint32_t count = 0;
+    uint64_t edges = 0;
+    for (uint32_t w = 0; w < bfs->pool->count; w++) {
+        memcpy(level + count, bfs->buffers[w].nodes, bfs->buffers[w].count * sizeof(uint32_t));
+        count += bfs->buffers[w].count;
+        edges += bfs->buffers[w].edges;
+    }
+    if (bfs->bottom_up) {
+        bfs->frontier_count = previous_count;
+        pool_run(bfs->pool, task_clear, bfs);
+    }
+    if (bfs->ordered && count > 1) {
+        for (uint32_t i = 0; i < count; i++) {
+            bfs->entries[i].key = bfs->keys[level[i]];
+            bfs->entries[i].node = level[i];
+        }
+        qsort(bfs->entries, count, sizeof(BfsEntry), compare_entries);
+        for (uint32_t i = 0; i < count; i++)
+            level[i] = bfs->entries[i].node;
+    }
+    bfs->frontier_count = count;
+    pool_run(bfs->pool, task_finish, bfs);
+    bfs->frontier_edges = edges;
+    bfs->unvisited_edges -= edges;
+    bfs->reached += count;
+    if (count > 0) {
+        bfs->levels++;
+        bfs->bottom_up_levels += bfs->bottom_up;
+    }
+    return count;
+}
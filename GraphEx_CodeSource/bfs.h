@@ -0,0 +1,87 @@
+/**
+ * @file
+ * @brief Parallel breadth-first search header file.
+*/
+
+#ifndef BFS_H_
+#define BFS_H_
+
+#include <stdint.h>
+#include "pool.h"
+#include "view.h"
+
+#define BFS_ALPHA 15 /** A step goes bottom-up once the frontier has more than 1 / alpha of the unvisited edges. */
+#define BFS_BETA 18 /** A step goes back top-down once the frontier has less than 1 / beta of the nodes. */
+#define BFS_NO_KEY UINT64_MAX /** Key of a node that was not reached. */
+#define BFS_NO_POSITION 0xFFFFFFFFu /** Edge position of a key found bottom-up, until the edge is resolved. */
+
+/**
+ * Defined type based on a struct holding the nodes a worker reached during a step.
+*/
+typedef struct {
+    uint32_t* nodes;  /** Reached nodes. */
+    uint32_t count;   /** Number of reached nodes. */
+    uint32_t capacity;/** Capacity of nodes. */
+    uint64_t edges;   /** Sum of the outgoing edges of the reached nodes. */
+} BfsBuffer;
+
+/**
+ * Defined type based on a struct holding a node of a level with the edge it was reached by, for sorting levels.
+*/
+typedef struct {
+    uint64_t key;  /** Key of the node. */
+    uint32_t node; /** The node id. */
+} BfsEntry;
+
+/**
+ * Defined type based on a struct holding a level-synchronous breadth-first search run by a thread pool.
+ * Each step reaches the next level either top-down, the frontier claiming its unvisited neighbors,
+ * or bottom-up, the unvisited nodes looking for a neighbor in the frontier, whichever scans fewer edges.
+ * A node reached from the edge at position p of the frontier node at index i gets the key i << 32 | p:
+ * keeping the smallest key and sorting a level by key gives the order of a sequential search.
+ * The edges are walked through the view, so the instances of a template are never copied.
+*/
+typedef struct {
+    ThreadPool* pool;          /** Workers of the steps. */
+    int ordered;               /** 1 if each level comes in the order of a sequential search, 0 for any order. */
+    const GraphView* view;     /** Graph being searched, whose incoming edges are built. */
+    uint32_t capacity;         /** Number of nodes the arrays below can hold. */
+    uint64_t* visited;         /** Bitset of the nodes reached by an earlier step. */
+    uint64_t* in_frontier;     /** Bitset of the frontier during bottom-up steps. */
+    uint64_t* keys;            /** Key of each reached node, BFS_NO_KEY for the others. */
+    uint32_t* ranks;           /** Index of each frontier node in the frontier. */
+    uint32_t* pending;         /** Nodes reached bottom-up from each frontier node, by index, whose edge is not resolved yet. */
+    uint32_t* frontier;        /** Nodes of the current level. */
+    uint32_t frontier_count;   /** Number of nodes of the current level. */
+    uint32_t* previous;        /** Nodes of the level before. */
+    uint32_t* parents;         /** Node each node of the current level was reached from, by index in the level. */
+    int64_t* parent_weights;   /** Weight of the edge each node of the current level was reached by. */
+    BfsEntry* entries;         /** Level being sorted. */
+    BfsBuffer* buffers;        /** Nodes reached by each worker. */
+    uint64_t frontier_edges;   /** Sum of the outgoing edges of the frontier. */
+    uint64_t unvisited_edges;  /** Sum of the outgoing edges of the unreached nodes. */
+    int bottom_up;             /** 1 if the last step was bottom-up. */
+    uint32_t levels;           /** Steps run since bfs_begin(). */
+    uint32_t bottom_up_levels; /** Bottom-up steps run since bfs_begin(). */
+    uint32_t reached;          /** Nodes reached since bfs_begin(). */
+    int failed;                /** 1 once memory was exhausted, the search giving no level from then on. */
+} Bfs;
+
+void bfs_init(Bfs* bfs, ThreadPool* pool, int ordered);
+void bfs_free(Bfs* bfs);
+int bfs_begin(Bfs* bfs, const GraphView* view);
+void bfs_root(Bfs* bfs, uint32_t root);
+uint32_t bfs_step(Bfs* bfs);
+
+/**
+ * Tells if a node was reached since bfs_begin().
+ *
+ * @param bfs The search.
+ * @param node The node id.
+ * @return 1 if the node was reached, 0 if not.
+*/
+static inline int bfs_visited(const Bfs* bfs, uint32_t node) {
+    return (bfs->visited[node >> 6] >> (node & 63)) & 1;
+}
+
+#endif
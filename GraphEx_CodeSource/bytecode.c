@@ -0,0 +1,331 @@
+/**
+ * @file
+ * @brief Operations bytecode source file.
+ *
+ * Lowers the %operations block of the main graph, with the body of each traverse lambda, to a flat
+ * array of register instructions. Each expression gets registers above the ones of the enclosing
+ * lambdas, which are given back once its instruction is compiled.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bytecode.h"
+
+/**
+ * Defined type based on a struct holding a lambda parameter in scope and its register.
+*/
+typedef struct {
+    int32_t name;           /** Interned name of the parameter. */
+    uint32_t reg;           /** Register holding its value for the current edge. */
+    const GraphView* view;  /** View whose node ids the parameter holds, NULL for the weight. */
+} ScopedName;
+
+/**
+ * Defined type based on a struct holding the state of a compilation.
+*/
+typedef struct {
+    Bytecode* bytecode;     /** The bytecode being written. */
+    const Program* program; /** The linked program. */
+    const uint8_t* runnable;/** 1 for each operation that runs, indexed by OperationKind. */
+    const GraphView* view;  /** View whose nodes the names stand for, the traversed one inside a lambda. */
+    ScopedName* names;      /** Parameters of the enclosing lambdas, innermost last. */
+    uint32_t name_count;    /** Number of names. */
+    uint32_t name_capacity; /** Capacity of names. */
+    uint32_t top;           /** First free register. */
+    int failed;             /** 1 once a name stands for a node of another graph than the one it is used on. */
+    int exhausted;          /** 1 once memory is exhausted, the instructions being written to spare from then on. */
+    Instruction spare;      /** Instruction written and patched in place of the code once memory is exhausted. */
+} Compiler;
+
+/**
+ * Gives the index of an AST node.
+ *
+ * @param compiler The compilation.
+ * @param node The node.
+ * @return Its index in the syntax tree.
+*/
+static uint32_t ast_index(const Compiler* compiler, const AstNode* node) {
+    return (uint32_t) (node - compiler->program->ast.nodes);
+}
+
+/**
+ * Appends an instruction.
+ *
+ * @param compiler The compilation.
+ * @param op The opcode.
+ * @param sub The operation, comparison or search method.
+ * @param a The first register.
+ * @param b The second register or view index.
+ * @param value The constant or jump target.
+ * @param ast The AST node of the instruction.
+ * @return The position of the instruction, to patch its jump target.
+*/
+static uint32_t emit(Compiler* compiler, Opcode op, uint8_t sub, uint32_t a, uint32_t b, int32_t value, const AstNode* ast) {
+    Bytecode* bytecode = compiler->bytecode;
+    if (bytecode->count == bytecode->capacity && !compiler->exhausted) {
+        uint32_t capacity = bytecode->capacity == 0 ? 64 : bytecode->capacity * 2;
+        Instruction* code = realloc(bytecode->code, capacity * sizeof(Instruction));
+        if (code == NULL)
+            compiler->exhausted = 1;
+        else {
+            bytecode->code = code;
+            bytecode->capacity = capacity;
+        }
+    }
+    if (compiler->exhausted)
+        return bytecode->count;
+    Instruction* instruction = &bytecode->code[bytecode->count];
+    instruction->op = (uint8_t) op;
+    instruction->sub = sub;
+    instruction->flags = 0;
+    instruction->a = a;
+    instruction->b = b;
+    instruction->value = value;
+    instruction->ast = ast_index(compiler, ast);
+    return bytecode->count++;
+}
+
+/**
+ * Gives an instruction written by emit(), to patch it.
+ *
+ * @param compiler The compilation.
+ * @param position The position given by emit().
+ * @return The instruction, or the spare one once memory is exhausted.
+*/
+static Instruction* instruction_at(Compiler* compiler, uint32_t position) {
+    return compiler->exhausted ? &compiler->spare : &compiler->bytecode->code[position];
+}
+
+/**
+ * Takes consecutive free registers, given back by resetting top.
+ *
+ * @param compiler The compilation.
+ * @param count The number of registers.
+ * @return The first register.
+*/
+static uint32_t reserve(Compiler* compiler, uint32_t count) {
+    uint32_t first = compiler->top;
+    compiler->top += count;
+    if (compiler->top > compiler->bytecode->register_count)
+        compiler->bytecode->register_count = compiler->top;
+    return first;
+}
+
+/**
+ * Puts a lambda parameter in scope.
+ *
+ * @param compiler The compilation.
+ * @param name The interned name of the parameter.
+ * @param reg Its register.
+ * @param view The view whose node ids it holds, NULL for a number.
+*/
+static void scope_push(Compiler* compiler, int32_t name, uint32_t reg, const GraphView* view) {
+    if (compiler->name_count == compiler->name_capacity) {
+        uint32_t capacity = compiler->name_capacity == 0 ? 8 : compiler->name_capacity * 2;
+        ScopedName* names = realloc(compiler->names, capacity * sizeof(ScopedName));
+        if (names == NULL) {
+            compiler->exhausted = 1;
+            return;
+        }
+        compiler->names = names;
+        compiler->name_capacity = capacity;
+    }
+    compiler->names[compiler->name_count].name = name;
+    compiler->names[compiler->name_count].reg = reg;
+    compiler->names[compiler->name_count].view = view;
+    compiler->name_count++;
+}
+
+static void compile_call(Compiler* compiler, const AstNode* call, uint32_t dest, uint16_t flags);
+
+/**
+ * Compiles a node named by a parameter: a lambda parameter, which hides the nodes of the same name,
+ * one of the nodes of the graph or the name of an instance standing for its entry node.
+ * The node of an enclosing lambda that traverses another graph is rejected: its id means nothing here.
+ *
+ * @param compiler The compilation.
+ * @param call The AST_CALL node.
+ * @param param The AST_ID node.
+ * @param dest The register receiving the node.
+*/
+static void compile_node(Compiler* compiler, const AstNode* call, const AstNode* param, uint32_t dest) {
+    for (uint32_t i = compiler->name_count; i-- > 0;) {
+        if (compiler->names[i].name == param->value) {
+            const GraphView* view = compiler->names[i].view;
+            if (view != NULL && view != compiler->view) {
+                fprintf(compiler->program->messages, "Semantic Error: %s is a node of another graph than the traversed one at line %u\n",
+                    intern_text(compiler->program->names, (uint32_t) param->value), param->line);
+                compiler->failed = 1;
+            }
+            emit(compiler, BC_MOVE, 0, dest, compiler->names[i].reg, 0, param);
+            return;
+        }
+    }
+    const GraphView* view = compiler->view;
+    uint32_t node = view_find(view, (uint32_t) param->value);
+    if (node == GRAPH_NO_NODE) {
+        uint32_t instance = name_map_get(&view->instance_names, (uint32_t) param->value);
+        if (instance != GRAPH_NO_NODE && view->instances[instance].shape->node_count > 0)
+            node = view->instances[instance].offset;
+    }
+    if (node == GRAPH_NO_NODE)
+        emit(compiler, BC_UNKNOWN, call->sub, 0, 0, 0, param);
+    else
+        emit(compiler, BC_NODE, 0, dest, 0, (int32_t) node, param);
+}
+
+/**
+ * Compiles a call: its parameters go in consecutive registers, then the call writes its value.
+ * The parameters of an operation that doesn't run anything yet are not evaluated.
+ *
+ * @param compiler The compilation.
+ * @param call The AST_CALL node.
+ * @param dest The register receiving the value of the call.
+ * @param flags BC_PRINT for an instruction, 0 for a parameter.
+*/
+static void compile_call(Compiler* compiler, const AstNode* call, uint32_t dest, uint16_t flags) {
+    const Ast* ast = &compiler->program->ast;
+    uint32_t count = compiler->runnable[call->sub] ? call->count : 0;
+    uint32_t args = reserve(compiler, count);
+    for (uint32_t i = 0; i < count; i++) {
+        const AstNode* param = ast_child(ast, call, i);
+        if (param->kind == AST_ID)
+            compile_node(compiler, call, param, args + i);
+        else if (param->kind == AST_CALL)
+            compile_call(compiler, param, args + i, 0);
+        else if (param->kind == AST_COLOR)
+            emit(compiler, BC_COLOR, 0, args + i, 0, param->value, param);
+        else
+            emit(compiler, BC_NUMBER, 0, args + i, 0, param->value, param);
+    }
+    uint32_t position = emit(compiler, BC_CALL, call->sub, dest, args, 0, call);
+    instruction_at(compiler, position)->flags = flags;
+}
+
+/**
+ * Compiles one side of a condition.
+ *
+ * @param compiler The compilation.
+ * @param operand The AST_NUM or AST_CALL node.
+ * @return The register receiving its value.
+*/
+static uint32_t compile_operand(Compiler* compiler, const AstNode* operand) {
+    uint32_t reg = reserve(compiler, 1);
+    if (operand->kind == AST_NUM)
+        emit(compiler, BC_NUMBER, 0, reg, 0, operand->value, operand);
+    else
+        compile_call(compiler, operand, reg, 0);
+    return reg;
+}
+
+static void compile_instructions(Compiler* compiler, const AstNode* parent, uint32_t first);
+
+/**
+ * Compiles a traverse: the instruction running the search, followed by the body of its lambda.
+ * The names of the body stand for the nodes of the traversed graph.
+ *
+ * @param compiler The compilation.
+ * @param traverse The AST_TRAVERSE node.
+*/
+static void compile_traverse(Compiler* compiler, const AstNode* traverse) {
+    const Program* program = compiler->program;
+    const AstNode* lambda = ast_child(&program->ast, traverse, 0);
+    uint32_t view = program->graph_count - 1;
+    if (traverse->value != AST_NO_NAME) {
+        view = name_map_get(&program->blocks, (uint32_t) traverse->value);
+        if (view == GRAPH_NO_NODE) {
+            emit(compiler, BC_UNKNOWN, 0, 0, 0, 0, traverse);
+            return;
+        }
+    }
+
+    uint32_t params = reserve(compiler, 3);
+    uint32_t position = emit(compiler, BC_TRAVERSE, traverse->sub, params, view, 0, traverse);
+    uint32_t name_count = compiler->name_count;
+    const GraphView* outer = compiler->view;
+    compiler->view = &program->views[view];
+    for (uint32_t i = 0; i < 3; i++) // The source and target are nodes of the traversed view, the weight a number
+        scope_push(compiler, ast_child(&program->ast, lambda, i)->value, params + i, i < 2 ? compiler->view : NULL);
+    compile_instructions(compiler, lambda, 3);
+    emit(compiler, BC_RETURN, 0, 0, 0, 0, lambda);
+    compiler->view = outer;
+    compiler->name_count = name_count;
+    instruction_at(compiler, position)->value = (int32_t) compiler->bytecode->count;
+}
+
+/**
+ * Compiles the instructions that are children of a node.
+ *
+ * @param compiler The compilation.
+ * @param parent The AST_OPERATIONS, AST_IF or AST_LAMBDA node.
+ * @param first The position of the first instruction among the children.
+*/
+static void compile_instructions(Compiler* compiler, const AstNode* parent, uint32_t first) {
+    const Ast* ast = &compiler->program->ast;
+    for (uint32_t i = first; i < parent->count; i++) {
+        const AstNode* instruction = ast_child(ast, parent, i);
+        uint32_t top = compiler->top;
+        if (instruction->kind == AST_CALL)
+            compile_call(compiler, instruction, reserve(compiler, 1), BC_PRINT);
+        else if (instruction->kind == AST_IF) {
+            const AstNode* condition = ast_child(ast, instruction, 0);
+            uint32_t left = compile_operand(compiler, ast_child(ast, condition, 0));
+            uint32_t jump;
+            if (condition->count == 1)
+                jump = emit(compiler, BC_TEST, 0, left, 0, 0, condition);
+            else {
+                uint32_t right = compile_operand(compiler, ast_child(ast, condition, 1));
+                jump = emit(compiler, BC_COMPARE, condition->sub, left, right, 0, condition);
+            }
+            compiler->top = top;
+            compile_instructions(compiler, instruction, 1);
+            instruction_at(compiler, jump)->value = (int32_t) compiler->bytecode->count;
+        }
+        else if (instruction->kind == AST_TRAVERSE)
+            compile_traverse(compiler, instruction);
+        compiler->top = top;
+    }
+}
+
+/**
+ * Compiles the %operations block of the main graph of a linked program.
+ *
+ * @param bytecode Receives the bytecode.
+ * @param program The program.
+ * @param runnable 1 for each operation that runs, 0 for the reserved ones, indexed by OperationKind.
+ * @return 0 if a name stands for a node of another graph than the one it is used on or if memory is
+ * exhausted, the error being printed to the messages of the program, 1 if not.
+*/
+int bytecode_compile(Bytecode* bytecode, const Program* program, const uint8_t* runnable) {
+    const Ast* ast = &program->ast;
+    const AstNode* root = ast_node(ast, ast->root);
+    const AstNode* main_block = ast_child(ast, root, root->count - 1);
+    const AstNode* operations = ast_child(ast, main_block, main_block->count - 1);
+
+    memset(bytecode, 0, sizeof(Bytecode));
+    Compiler compiler = {0};
+    compiler.bytecode = bytecode;
+    compiler.program = program;
+    compiler.runnable = runnable;
+    compiler.view = &program->views[program->graph_count - 1];
+    compile_instructions(&compiler, operations, 0);
+    emit(&compiler, BC_RETURN, 0, 0, 0, 0, operations);
+    free(compiler.names);
+    if (compiler.exhausted) {
+        fprintf(program->messages, "Error: out of memory while compiling the operations\n");
+        bytecode_free(bytecode);
+        return 0;
+    }
+    return !compiler.failed;
+}
+
+/**
+ * Releases a bytecode.
+ *
+ * @param bytecode The bytecode.
+*/
+void bytecode_free(Bytecode* bytecode) {
+    free(bytecode->code);
+    memset(bytecode, 0, sizeof(Bytecode));
+}
@@ -0,0 +1,85 @@
+/**
+ * @file
+ * @brief Operations bytecode header file.
+*/
+
+#ifndef BYTECODE_H_
+#define BYTECODE_H_
+
+#include <stdint.h>
+#include "program.h"
+
+#define BC_PRINT 1 /** Flag of a call whose result is printed, an instruction rather than a parameter. */
+
+/**
+ * List of the instructions of the bytecode, expanded by each user of BYTECODE_OPCODES(X):
+ * into the Opcode enumeration here, into the dispatch table of the executor.
+ *
+ * BC_NUMBER    a: destination register. value: the number.
+ * BC_NODE      a: destination register. value: the node id, resolved when compiling.
+ * BC_COLOR     a: destination register. value: the ColorKind.
+ * BC_MOVE      a: destination register. b: source register, the parameter of a lambda.
+ * BC_CALL      sub: OperationKind. flags: BC_PRINT if the result is printed. a: destination register.
+ *              b: first argument register, the arguments being in consecutive registers. ast: the AST_CALL node.
+ * BC_TEST      a: tested register. value: instruction to jump to when the register has no non-zero value.
+ * BC_COMPARE   sub: comparison TokenType. a, b: compared registers. value: instruction to jump to when
+ *              the comparison doesn't hold.
+ * BC_TRAVERSE  sub: SearchKind. a: first of the three registers of the lambda parameters. b: index of the
+ *              view traversed. value: instruction following the body. ast: the AST_TRAVERSE node.
+ *              The body starts at the next instruction and ends with a BC_RETURN.
+ * BC_UNKNOWN   sub: OperationKind of the call naming it. ast: the AST_ID of a node or the AST_TRAVERSE of a
+ *              graph that doesn't exist, reported as a runtime error when reached.
+ * BC_RETURN    ends the %operations block or the body of a lambda.
+*/
+#define BYTECODE_OPCODES(X) \
+    X(BC_NUMBER) \
+    X(BC_NODE) \
+    X(BC_COLOR) \
+    X(BC_MOVE) \
+    X(BC_CALL) \
+    X(BC_TEST) \
+    X(BC_COMPARE) \
+    X(BC_TRAVERSE) \
+    X(BC_UNKNOWN) \
+    X(BC_RETURN)
+
+/**
+ * Enumeration of the instructions of the bytecode.
+*/
+typedef enum {
+#define OPCODE(name) name,
+    BYTECODE_OPCODES(OPCODE)
+#undef OPCODE
+    OPCODE_COUNT
+} Opcode;
+
+/**
+ * Defined type based on a struct holding one instruction. Operands are registers of a flat
+ * register file, see BYTECODE_OPCODES for what each instruction reads and writes.
+*/
+typedef struct {
+    uint8_t op;     /** Opcode of the instruction. */
+    uint8_t sub;    /** Operation, comparison or search method, depending on the opcode. */
+    uint16_t flags; /** Opcode specific bits. */
+    uint32_t a;     /** First register. */
+    uint32_t b;     /** Second register, or view index. */
+    int32_t value;  /** Constant or jump target. */
+    uint32_t ast;   /** Index of the AST node the instruction comes from, for its line and its errors. */
+} Instruction;
+
+/**
+ * Defined type based on a struct holding the %operations block of the main graph lowered to bytecode.
+ * Names are resolved when compiling: the parameters of the lambdas get fixed registers and the nodes
+ * of the graphs become constants, so a lambda body runs without any lookup or allocation per edge.
+*/
+typedef struct {
+    Instruction* code;       /** Instructions, the block starting at 0. */
+    uint32_t count;          /** Number of instructions. */
+    uint32_t capacity;       /** Capacity of code. */
+    uint32_t register_count; /** Number of registers the code uses. */
+} Bytecode;
+
+int bytecode_compile(Bytecode* bytecode, const Program* program, const uint8_t* runnable);
+void bytecode_free(Bytecode* bytecode);
+
+#endif
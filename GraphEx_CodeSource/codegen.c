@@ -0,0 +1,1062 @@
+/**
+ * @file
+ * @brief C code generator source file.
+ *
+ * Writes a standalone C translation unit running the %operations block of a linked program. The graphs
+ * it works on are flattened into static CSR arrays, both directions included, with the printed name of
+ * each node. Each instruction of its bytecode becomes C code calling the search library directly, and
+ * each traverse lambda is inlined in the loop of its search, so the generated program neither parses
+ * nor interprets anything when it runs.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "codegen.h"
+#include "executor.h"
+
+#define KEYWORD(word, type, value)
+#define TAG(word, type)
+
+/**
+ * Constant string array holding the name of each operation, indexed by OperationKind.
+*/
+static const char* operation_names[OPERATION_COUNT] = {
+#define OPERATION(word, kind) #word,
+#define COLOR(word, kind)
+#include "keywords.def"
+#undef OPERATION
+#undef COLOR
+};
+
+/**
+ * Constant string array holding the name of each color, indexed by ColorKind.
+*/
+static const char* color_names[COLOR_COUNT] = {
+#define OPERATION(word, kind)
+#define COLOR(word, kind) "#" #word,
+#include "keywords.def"
+#undef OPERATION
+#undef COLOR
+};
+
+#undef KEYWORD
+#undef TAG
+
+/**
+ * Start of every generated unit: the values of the registers and the helpers running the operations,
+ * which print the same results as the handlers of the executor.
+*/
+static const char* codegen_prelude =
+    "#include <stdio.h>\n"
+    "#include <stdlib.h>\n"
+    "#include \"paths.h\"\n"
+    "#include \"bfs.h\"\n"
+    "#include \"dfs.h\"\n"
+    "#include \"spanning.h\"\n"
+    "\n"
+    "typedef enum { VALUE_NONE, VALUE_NUMBER, VALUE_NODE, VALUE_COLOR } ValueKind;\n"
+    "\n"
+    "typedef struct {\n"
+    "    ValueKind kind;\n"
+    "    int64_t number;\n"
+    "} Value;\n"
+    "\n"
+    "enum { SEARCH_DIJKSTRA, SEARCH_BIDIRECTIONAL, SEARCH_LANDMARKS, SEARCH_BELLMAN };\n"
+    "\n"
+    "static PathEngine paths;\n"
+    "\n"
+    "static inline int out_of_memory(const char* doing) {\n"
+    "    printf(\"Error: out of memory while %s\\n\", doing);\n"
+    "    return 0;\n"
+    "}\n"
+    "\n"
+    "static inline int node_param(const char* operation, const Value* args, uint32_t i, uint32_t line, const GraphView* view,\n"
+    "        uint32_t* node) {\n"
+    "    if (args[i].kind == VALUE_NODE && (uint64_t) args[i].number < view->node_count) {\n"
+    "        *node = (uint32_t) args[i].number;\n"
+    "        return 1;\n"
+    "    }\n"
+    "    printf(\"Runtime Error: parameter %u of %s must be a node at line %u\\n\", i + 1, operation, line);\n"
+    "    return 0;\n"
+    "}\n"
+    "\n"
+    "static inline int run_search(int method, const char* operation, uint32_t line, const GraphView* view,\n"
+    "        const char* const* names, uint32_t source, uint32_t target, int64_t* cost) {\n"
+    "    int valid = 1;\n"
+    "    if (method == SEARCH_BELLMAN) {\n"
+    "        if (!paths_bellman(&paths, view, source) && !paths.failed) {\n"
+    "            printf(\"Runtime Error: %s found a negative cycle \", operation);\n"
+    "            for (uint32_t i = 0; i < paths.cycle_length; i++)\n"
+    "                printf(\"%s%s\", i > 0 ? \" -> \" : \"\", names[paths.path[i]]);\n"
+    "            printf(\" (cost %lld) declared at line %u, reached at line %u\\n\", (long long) paths.cycle_cost,\n"
+    "                paths.cycle_line, line);\n"
+    "            return 0;\n"
+    "        }\n"
+    "    }\n"
+    "    else if (target == GRAPH_NO_NODE)\n"
+    "        valid = paths_dijkstra(&paths, view, source, target);\n"
+    "    else if (method == SEARCH_LANDMARKS)\n"
+    "        valid = paths_landmarks(&paths, view, target)\n"
+    "            && paths_astar(&paths, view, source, target, paths_landmark_bound, &paths.landmarks);\n"
+    "    else\n"
+    "        valid = paths_bidirectional(&paths, view, source, target);\n"
+    "    if (paths.failed)\n"
+    "        return out_of_memory(\"searching a graph\");\n"
+    "    if (!valid) {\n"
+    "        printf(\"Runtime Error: %s needs non-negative weights at line %u, bellman allows negative ones\\n\", operation, line);\n"
+    "        return 0;\n"
+    "    }\n"
+    "    *cost = target == GRAPH_NO_NODE ? PATH_INFINITY : paths_cost(&paths, target);\n"
+    "    return 1;\n"
+    "}\n"
+    "\n"
+    "static inline int run_distances(int method, const char* operation, const char* text, uint32_t line, const GraphView* view,\n"
+    "        const char* const* names, uint32_t source, int print, Value* result) {\n"
+    "    int64_t cost;\n"
+    "    if (!run_search(method, operation, line, view, names, source, GRAPH_NO_NODE, &cost))\n"
+    "        return 0;\n"
+    "    result->kind = VALUE_NUMBER;\n"
+    "    result->number = (int64_t) paths.settled_count;\n"
+    "    if (print) {\n"
+    "        printf(\"%s:\\n\", text);\n"
+    "        for (uint32_t node = 0; node < view->node_count; node++) {\n"
+    "            int64_t distance = paths_distance(&paths, node);\n"
+    "            if (distance != PATH_INFINITY)\n"
+    "                printf(\"    %s %lld\\n\", names[node], (long long) distance);\n"
+    "        }\n"
+    "    }\n"
+    "    return 1;\n"
+    "}\n"
+    "\n"
+    "static inline int run_path(int method, const char* operation, const char* text, uint32_t line, const GraphView* view,\n"
+    "        const char* const* names, uint32_t source, uint32_t target, int print, Value* result) {\n"
+    "    int64_t cost;\n"
+    "    if (!run_search(method, operation, line, view, names, source, target, &cost))\n"
+    "        return 0;\n"
+    "    result->kind = cost == PATH_INFINITY ? VALUE_NONE : VALUE_NUMBER;\n"
+    "    result->number = cost;\n"
+    "    if (print) {\n"
+    "        if (cost == PATH_INFINITY) {\n"
+    "            printf(\"%s: no path\\n\", text);\n"
+    "            return 1;\n"
+    "        }\n"
+    "        uint32_t length = paths_rebuild(&paths, target);\n"
+    "        if (paths.failed)\n"
+    "            return out_of_memory(\"rebuilding a path\");\n"
+    "        printf(\"%s: \", text);\n"
+    "        for (uint32_t i = 0; i < length; i++)\n"
+    "            printf(\"%s%s\", i > 0 ? \" -> \" : \"\", names[paths.path[i]]);\n"
+    "        printf(\" (cost %lld)\\n\", (long long) cost);\n"
+    "    }\n"
+    "    return 1;\n"
+    "}\n"
+    "\n"
+    "static inline int run_cost(int method, const char* operation, const char* text, uint32_t line, const GraphView* view,\n"
+    "        const char* const* names, uint32_t source, uint32_t target, int print, Value* result) {\n"
+    "    int64_t cost;\n"
+    "    if (!run_search(method, operation, line, view, names, source, target, &cost))\n"
+    "        return 0;\n"
+    "    result->kind = cost == PATH_INFINITY ? VALUE_NONE : VALUE_NUMBER;\n"
+    "    result->number = cost;\n"
+    "    if (print) {\n"
+    "        if (cost == PATH_INFINITY)\n"
+    "            printf(\"%s: no path\\n\", text);\n"
+    "        else\n"
+    "            printf(\"%s: %lld\\n\", text, (long long) cost);\n"
+    "    }\n"
+    "    return 1;\n"
+    "}\n"
+    "\n"
+    "static inline int run_spanning(int prim, const char* text, const GraphView* view, const char* const* names,\n"
+    "        Spanning* spanning, int print, Value* result) {\n"
+    "    if (!(prim ? spanning_prim(spanning, view) : spanning_kruskal(spanning, view)))\n"
+    "        return out_of_memory(\"building a spanning tree\");\n"
+    "    result->kind = VALUE_NUMBER;\n"
+    "    result->number = spanning->cost;\n"
+    "    if (print) {\n"
+    "        printf(\"%s: %u edge%s (cost %lld)\\n\", text, spanning->edge_count, spanning->edge_count == 1 ? \"\" : \"s\",\n"
+    "            (long long) spanning->cost);\n"
+    "        for (uint32_t i = 0; i < spanning->edge_count; i++) {\n"
+    "            uint64_t edge = spanning->edges[i];\n"
+    "            printf(\"    %s -> %s %lld\\n\", names[flat_source(&spanning->flat, edge)], names[spanning->flat.targets[edge]],\n"
+    "                (long long) spanning->flat.weights[edge]);\n"
+    "        }\n"
+    "    }\n"
+    "    return 1;\n"
+    "}\n";
+
+/**
+ * Helpers of the generated units coloring a graph, written after the names of the palette colors.
+*/
+static const char* codegen_coloring =
+    "#include \"coloring.h\"\n"
+    "\n"
+    "#define PALETTE_SIZE (sizeof(color_names) / sizeof(color_names[0]))\n"
+    "\n"
+    "static inline void print_color(const Coloring* coloring, uint32_t color) {\n"
+    "    if (coloring->color_count <= PALETTE_SIZE)\n"
+    "        printf(\"%s\", color_names[color]);\n"
+    "    else\n"
+    "        printf(\"color %u\", color);\n"
+    "}\n"
+    "\n"
+    "static inline int keep_colors(const Coloring* coloring, GraphView* view) {\n"
+    "    if (coloring->color_count > PALETTE_SIZE)\n"
+    "        return 1;\n"
+    "    for (uint32_t node = 0; node < view->node_count; node++) {\n"
+    "        if (!view_set_color(view, node, (int) coloring->colors[node]))\n"
+    "            return out_of_memory(\"coloring a graph\");\n"
+    "    }\n"
+    "    return 1;\n"
+    "}\n"
+    "\n"
+    "static inline int run_colorergraph(const Value* args, uint32_t count, const char* text, uint32_t line, GraphView* view,\n"
+    "        const char* const* names, Coloring* coloring, int print, Value* result) {\n"
+    "    if (count == 1 && args[0].kind != VALUE_NUMBER) {\n"
+    "        printf(\"Runtime Error: parameter 1 of colorergraph must be a number at line %u\\n\", line);\n"
+    "        return 0;\n"
+    "    }\n"
+    "    if (!(count == 1 && args[0].number != 0 ? coloring_speculative(coloring, view) : coloring_dsatur(coloring, view)))\n"
+    "        return out_of_memory(\"coloring a graph\");\n"
+    "    if (!keep_colors(coloring, view))\n"
+    "        return 0;\n"
+    "    result->kind = VALUE_NUMBER;\n"
+    "    result->number = coloring->color_count;\n"
+    "    if (print) {\n"
+    "        printf(\"%s: %u color%s\\n\", text, coloring->color_count, coloring->color_count == 1 ? \"\" : \"s\");\n"
+    "        for (uint32_t node = 0; node < view->node_count; node++) {\n"
+    "            printf(\"    %s \", names[node]);\n"
+    "            print_color(coloring, coloring->colors[node]);\n"
+    "            printf(\"\\n\");\n"
+    "        }\n"
+    "    }\n"
+    "    return 1;\n"
+    "}\n"
+    "\n"
+    "static inline int run_colorier(const Value* args, uint32_t count, const char* text, uint32_t line, GraphView* view,\n"
+    "        Coloring* coloring, uint32_t node, int print, Value* result) {\n"
+    "    if (count == 2 && args[1].kind != VALUE_COLOR) {\n"
+    "        printf(\"Runtime Error: parameter 2 of colorier must be a color at line %u\\n\", line);\n"
+    "        return 0;\n"
+    "    }\n"
+    "    result->kind = VALUE_COLOR;\n"
+    "    if (count == 2) {\n"
+    "        result->number = args[1].number;\n"
+    "        if (!view_set_color(view, node, (int) args[1].number))\n"
+    "            return out_of_memory(\"coloring a graph\");\n"
+    "        if (coloring->view == view) {\n"
+    "            coloring->colors[node] = (uint32_t) args[1].number;\n"
+    "            if (coloring->colors[node] >= coloring->color_count)\n"
+    "                coloring->color_count = coloring->colors[node] + 1;\n"
+    "            coloring->edited = 1;\n"
+    "        }\n"
+    "    }\n"
+    "    else if (view_color(view, node) != VIEW_NO_COLOR)\n"
+    "        result->number = view_color(view, node);\n"
+    "    else {\n"
+    "        if (coloring->view != view) {\n"
+    "            if (!coloring_dsatur(coloring, view))\n"
+    "                return out_of_memory(\"coloring a graph\");\n"
+    "            if (!keep_colors(coloring, view))\n"
+    "                return 0;\n"
+    "        }\n"
+    "        result->kind = coloring->color_count <= PALETTE_SIZE ? VALUE_COLOR : VALUE_NUMBER;\n"
+    "        result->number = coloring->colors[node];\n"
+    "    }\n"
+    "    if (print) {\n"
+    "        if (result->kind == VALUE_COLOR)\n"
+    "            printf(\"%s: %s\\n\", text, color_names[result->number]);\n"
+    "        else\n"
+    "            printf(\"%s: color %u\\n\", text, (uint32_t) result->number);\n"
+    "    }\n"
+    "    return 1;\n"
+    "}\n"
+    "\n"
+    "static inline int run_chromatic(const char* text, const GraphView* view, Coloring* coloring, uint32_t budget, int print,\n"
+    "        Value* result) {\n"
+    "    if (!coloring_chromatic(coloring, view, budget))\n"
+    "        return out_of_memory(\"coloring a graph\");\n"
+    "    result->kind = VALUE_NUMBER;\n"
+    "    result->number = coloring->chromatic;\n"
+    "    if (print) {\n"
+    "        if (coloring->lower == coloring->chromatic)\n"
+    "            printf(\"%s: %u\\n\", text, coloring->chromatic);\n"
+    "        else\n"
+    "            printf(\"%s: at most %u, at least %u (%s)\\n\", text, coloring->chromatic, coloring->lower, coloring->expired\n"
+    "                ? \"time budget exceeded\" : \"component too large to search\");\n"
+    "    }\n"
+    "    return 1;\n"
+    "}\n";
+
+/**
+ * Helpers of the generated units sending a flow on a graph with capacities.
+*/
+static const char* codegen_flow =
+    "#include \"flow.h\"\n"
+    "\n"
+    "static inline int run_flow(const Value* args, uint32_t count, const char* text, uint32_t line, uint32_t amount_line,\n"
+    "        const GraphView* view, const char* const* names, FlowEngine* flow, uint32_t source, uint32_t target, int scaling,\n"
+    "        int print, Value* result) {\n"
+    "    if (count == 3 && (args[2].kind != VALUE_NUMBER || args[2].number < 0)) {\n"
+    "        printf(\"Runtime Error: parameter 3 of mincost must be a non-negative number at line %u\\n\", amount_line);\n"
+    "        return 0;\n"
+    "    }\n"
+    "    int64_t amount = count == 3 ? args[2].number : FLOW_INFINITE;\n"
+    "    int solved = flow_solve(flow, view, source, target, amount, scaling);\n"
+    "    if (flow->failed)\n"
+    "        return out_of_memory(\"searching a flow\");\n"
+    "    if (!solved) {\n"
+    "        printf(\"Runtime Error: mincost found a negative cycle of edges that can carry flow at line %u\\n\", line);\n"
+    "        return 0;\n"
+    "    }\n"
+    "    result->kind = flow->unbounded ? VALUE_NONE : VALUE_NUMBER;\n"
+    "    result->number = flow->cost;\n"
+    "    if (!print)\n"
+    "        return 1;\n"
+    "    if (flow->unbounded)\n"
+    "        printf(\"%s: unbounded flow\\n\", text);\n"
+    "    else if (amount != FLOW_INFINITE && flow->flow < amount)\n"
+    "        printf(\"%s: only %lld unit%s can flow, at cost %lld\\n\", text, (long long) flow->flow, flow->flow == 1 ? \"\" : \"s\",\n"
+    "            (long long) flow->cost);\n"
+    "    else\n"
+    "        printf(\"%s: flow %lld at cost %lld\\n\", text, (long long) flow->flow, (long long) flow->cost);\n"
+    "    const FlatGraph* flat = &flow->flat;\n"
+    "    for (uint32_t u = 0; u < flat->node_count && !flow->unbounded; u++) {\n"
+    "        for (uint64_t e = flat->first[u]; e < flat->first[u + 1]; e++) {\n"
+    "            if (flow_edge(flow, e) > 0)\n"
+    "                printf(\"    %s -> %s %lld\\n\", names[u], names[flat->targets[e]], (long long) flow_edge(flow, e));\n"
+    "        }\n"
+    "    }\n"
+    "    return 1;\n"
+    "}\n";
+
+/**
+ * Defined type based on a struct holding the edges of a view in one direction, in the order its cursors give them.
+*/
+typedef struct {
+    uint32_t* offsets;  /** First edge of each node, node_count + 1 entries. */
+    uint32_t* targets;  /** Target of each edge, or source of an incoming edge. */
+    int32_t* weights;   /** Weight of each edge. */
+    uint32_t* lines;    /** %declare line of each edge. */
+    int32_t* capacities;/** Capacity of each edge, GRAPH_NO_CAPACITY without one. */
+    uint32_t count;     /** Number of edges. */
+    uint32_t capacity;  /** Capacity of targets, weights, lines and capacities. */
+} EdgeList;
+
+/**
+ * Defined type based on a struct holding the state of a generation.
+*/
+typedef struct {
+    FILE* file;              /** The generated unit. */
+    const Program* program;  /** The linked program. */
+    const Bytecode* code;    /** Its %operations block lowered to bytecode. */
+    const uint8_t* runnable; /** 1 for each operation that runs, indexed by OperationKind. */
+    const ExecOptions* options; /** Options of the runs, baked into the unit. */
+    int coloring;            /** 1 if the unit colors a graph. */
+    int flow;                /** 1 if the unit sends a flow. */
+    uint8_t* capacitated;    /** 1 for each written view declaring capacities, by index of its arrays. */
+    uint8_t* landings;       /** 1 for each instruction a jump lands on. */
+    uint8_t* stopped;        /** 1 for each traverse whose loop a stop() leaves. */
+    uint32_t* baked;         /** Index of the arrays of each view of the program, UINT32_MAX for the views not used. */
+    uint32_t baked_count;    /** Number of views whose arrays are written. */
+    int failing;             /** 1 once the code can fail. */
+} Codegen;
+
+/**
+ * Reports that the generation can't grow anymore.
+ *
+ * @param program The program, whose messages receive the error.
+ * @return 0.
+*/
+static int codegen_out_of_memory(const Program* program) {
+    fprintf(program->messages, "Error: out of memory while generating C code\n");
+    return 0;
+}
+
+/**
+ * Allocates an array that is freed by the caller.
+ *
+ * @param count The number of elements.
+ * @param size The size of an element.
+ * @return The array, NULL if memory is exhausted.
+*/
+static void* codegen_alloc(size_t count, size_t size) {
+    return calloc(count == 0 ? 1 : count, size);
+}
+
+/**
+ * Collects the edges of a view in one direction.
+ *
+ * @param view The view.
+ * @param reverse 1 for the incoming edges, 0 for the outgoing ones.
+ * @param list Receives the edges, freed by free_edges() even when memory is exhausted.
+ * @return 0 if memory is exhausted, 1 if not.
+*/
+static int collect_edges(const GraphView* view, int reverse, EdgeList* list) {
+    memset(list, 0, sizeof(EdgeList));
+    list->capacity = (uint32_t) view->edge_count;
+    list->offsets = codegen_alloc((size_t) view->node_count + 1, sizeof(uint32_t));
+    list->targets = codegen_alloc(list->capacity, sizeof(uint32_t));
+    list->weights = codegen_alloc(list->capacity, sizeof(int32_t));
+    list->lines = codegen_alloc(list->capacity, sizeof(uint32_t));
+    list->capacities = codegen_alloc(list->capacity, sizeof(int32_t));
+    if (list->offsets == NULL || list->targets == NULL || list->weights == NULL || list->lines == NULL
+        || list->capacities == NULL)
+        return 0;
+    for (uint32_t node = 0; node < view->node_count; node++) {
+        EdgeCursor cursor;
+        ViewEdge edge;
+        if (reverse)
+            view_edges_in(view, node, &cursor);
+        else
+            view_edges(view, node, &cursor);
+        while (view_next_edge(&cursor, &edge)) {
+            if (list->count == list->capacity) { // Each array is kept by the list as soon as it grew
+                uint32_t capacity = list->capacity == 0 ? 64 : list->capacity * 2;
+                uint32_t* targets = realloc(list->targets, capacity * sizeof(uint32_t));
+                if (targets == NULL)
+                    return 0;
+                list->targets = targets;
+                int32_t* weights = realloc(list->weights, capacity * sizeof(int32_t));
+                if (weights == NULL)
+                    return 0;
+                list->weights = weights;
+                uint32_t* lines = realloc(list->lines, capacity * sizeof(uint32_t));
+                if (lines == NULL)
+                    return 0;
+                list->lines = lines;
+                int32_t* capacities = realloc(list->capacities, capacity * sizeof(int32_t));
+                if (capacities == NULL)
+                    return 0;
+                list->capacities = capacities;
+                list->capacity = capacity;
+            }
+            list->targets[list->count] = edge.target;
+            list->weights[list->count] = edge.weight;
+            list->lines[list->count] = edge.line;
+            list->capacities[list->count] = edge.capacity;
+            list->count++;
+        }
+        list->offsets[node + 1] = list->count;
+    }
+    return 1;
+}
+
+/**
+ * Releases the edges of a view.
+ *
+ * @param list The edges.
+*/
+static void free_edges(EdgeList* list) {
+    free(list->offsets);
+    free(list->targets);
+    free(list->weights);
+    free(list->lines);
+    free(list->capacities);
+}
+
+/**
+ * Writes a static array of unsigned numbers.
+ *
+ * @param codegen The generation.
+ * @param name The name of the array.
+ * @param view The index of the view the array belongs to.
+ * @param values The numbers.
+ * @param count The number of numbers.
+*/
+static void write_unsigned(Codegen* codegen, const char* name, uint32_t view, const uint32_t* values, uint32_t count) {
+    fprintf(codegen->file, "static const uint32_t %s%u[] = {", name, view);
+    for (uint32_t i = 0; i < count; i++)
+        fprintf(codegen->file, "%s%u,", i % CODEGEN_PER_LINE == 0 ? "\n    " : " ", values[i]);
+    fprintf(codegen->file, count == 0 ? "0};\n" : "\n};\n");
+}
+
+/**
+ * Writes a static array of signed numbers.
+ *
+ * @param codegen The generation.
+ * @param name The name of the array.
+ * @param view The index of the view the array belongs to.
+ * @param values The numbers.
+ * @param count The number of numbers.
+*/
+static void write_signed(Codegen* codegen, const char* name, uint32_t view, const int32_t* values, uint32_t count) {
+    fprintf(codegen->file, "static const int32_t %s%u[] = {", name, view);
+    for (uint32_t i = 0; i < count; i++)
+        fprintf(codegen->file, "%s%d,", i % CODEGEN_PER_LINE == 0 ? "\n    " : " ", values[i]);
+    fprintf(codegen->file, count == 0 ? "0};\n" : "\n};\n");
+}
+
+/**
+ * Writes a node as it is printed, prefixed by the instances holding it, such as m1.node2.
+ *
+ * @param codegen The generation.
+ * @param view The view of the node.
+ * @param node The node id.
+*/
+static void write_node(Codegen* codegen, const GraphView* view, uint32_t node) {
+    const Instance* instance;
+    while ((instance = view_instance_of(view, node)) != NULL) {
+        fprintf(codegen->file, "%s.", intern_text(codegen->program->names, (uint32_t) instance->name));
+        node -= instance->offset;
+        view = instance->shape;
+    }
+    fprintf(codegen->file, "%s", intern_text(codegen->program->names, view->graph->names[node]));
+}
+
+/**
+ * Writes the arrays of a view: its edges in both directions, with their capacities if it declares some,
+ * and the names of its nodes.
+ *
+ * @param codegen The generation.
+ * @param view The view.
+ * @param index The index of its arrays.
+ * @return 0 if memory is exhausted, 1 if not.
+*/
+static int write_view(Codegen* codegen, const GraphView* view, uint32_t index) {
+    EdgeList list;
+    for (int reverse = 0; reverse < 2; reverse++) {
+        if (!collect_edges(view, reverse, &list)) {
+            free_edges(&list);
+            return 0;
+        }
+        write_unsigned(codegen, reverse ? "reverse_offsets" : "offsets", index, list.offsets, view->node_count + 1);
+        write_unsigned(codegen, reverse ? "reverse_targets" : "targets", index, list.targets, list.count);
+        write_signed(codegen, reverse ? "reverse_weights" : "weights", index, list.weights, list.count);
+        write_unsigned(codegen, reverse ? "reverse_lines" : "lines", index, list.lines, list.count);
+        if (view->capacitated)
+            write_signed(codegen, reverse ? "reverse_capacities" : "capacities", index, list.capacities, list.count);
+        free_edges(&list);
+    }
+    fprintf(codegen->file, "static const char* const names%u[] = {", index);
+    for (uint32_t node = 0; node < view->node_count; node++) {
+        fprintf(codegen->file, "%s\"", node % CODEGEN_PER_LINE == 0 ? "\n    " : " ");
+        write_node(codegen, view, node);
+        fprintf(codegen->file, "\",");
+    }
+    fprintf(codegen->file, view->node_count == 0 ? "0};\n\n" : "\n};\n\n");
+    return 1;
+}
+
+/**
+ * Writes a call as it is written in the source, with its parameters.
+ *
+ * @param codegen The generation.
+ * @param call The AST_CALL node.
+*/
+static void write_call(Codegen* codegen, const AstNode* call) {
+    const Ast* ast = &codegen->program->ast;
+    fprintf(codegen->file, "%s(", operation_names[call->sub]);
+    for (uint32_t i = 0; i < call->count; i++) {
+        const AstNode* param = ast_child(ast, call, i);
+        if (i > 0)
+            fprintf(codegen->file, ", ");
+        if (param->kind == AST_CALL)
+            write_call(codegen, param);
+        else if (param->kind == AST_COLOR)
+            fprintf(codegen->file, "%s", color_names[param->value]);
+        else if (param->kind == AST_NUM)
+            fprintf(codegen->file, "%d", param->value);
+        else
+            fprintf(codegen->file, "%s", intern_text(codegen->program->names, (uint32_t) param->value));
+    }
+    fprintf(codegen->file, ")");
+}
+
+/**
+ * Tells whether the generated code can run an operation.
+ *
+ * @param kind The OperationKind.
+ * @return 1 if it can, 0 if only the executor runs it.
+*/
+static int supported(uint8_t kind) {
+    return kind == OP_DIJKSTRA || kind == OP_GETCHEMIN || kind == OP_MINCOST || kind == OP_DIJKSTRAGENERALISE
+        || kind == OP_BELLMAN || kind == OP_STOP || kind == OP_KRUSKAL || kind == OP_PRIME || kind == OP_COLORERGRAPH
+        || kind == OP_COLORIER || kind == OP_NOMBRECHROMATIQUE;
+}
+
+/**
+ * Writes the indentation of a line.
+ *
+ * @param codegen The generation.
+ * @param depth The nesting depth of the line.
+*/
+static void indent(Codegen* codegen, uint32_t depth) {
+    for (uint32_t i = 0; i < depth; i++)
+        fputs("    ", codegen->file);
+}
+
+/**
+ * Writes the code of a BC_CALL instruction.
+ *
+ * @param codegen The generation.
+ * @param instruction The instruction.
+ * @param view The index of the arrays of the view the call works on.
+ * @param traverse The innermost traverse, UINT32_MAX at the top of the block.
+ * @param depth The nesting depth of the code.
+*/
+static void write_call_code(Codegen* codegen, const Instruction* instruction, uint32_t view, uint32_t traverse, uint32_t depth) {
+    FILE* file = codegen->file;
+    const AstNode* call = ast_node(&codegen->program->ast, instruction->ast);
+    const char* name = operation_names[call->sub];
+    indent(codegen, depth);
+    fprintf(file, "r[%u].kind = VALUE_NONE;\n", instruction->a);
+    if (!codegen->runnable[call->sub])
+        return;
+
+    uint32_t expected = call->sub == OP_MINCOST && call->count == 3 ? 3 : 2; // mincost(source, target, amount) sends a flow
+    if (call->sub == OP_STOP || call->sub == OP_KRUSKAL || call->sub == OP_PRIME || call->sub == OP_NOMBRECHROMATIQUE)
+        expected = 0;
+    else if (call->sub == OP_COLORERGRAPH) // colorergraph(1) runs the speculative coloring
+        expected = call->count == 0 ? 0 : 1;
+    else if (call->sub == OP_DIJKSTRA || ((call->sub == OP_BELLMAN || call->sub == OP_COLORIER) && call->count != 2))
+        expected = 1;
+    if (call->count != expected) {
+        indent(codegen, depth);
+        fprintf(file, "printf(\"Runtime Error: %s expects %u parameter%s but got %u at line %u\\n\");\n", name,
+            expected, expected == 1 ? "" : "s", call->count, call->line);
+        indent(codegen, depth);
+        fprintf(file, "goto fail;\n");
+        codegen->failing = 1;
+        return;
+    }
+    if (call->sub == OP_STOP) {
+        indent(codegen, depth);
+        if (traverse == UINT32_MAX)
+            fprintf(file, "goto done;\n");
+        else {
+            fprintf(file, "goto S%u;\n", traverse);
+            codegen->stopped[traverse] = 1;
+        }
+        return;
+    }
+
+    const Ast* ast = &codegen->program->ast;
+    int print = instruction->flags & BC_PRINT ? 1 : 0;
+    if (call->sub == OP_KRUSKAL || call->sub == OP_PRIME) {
+        indent(codegen, depth);
+        fprintf(file, "if (!run_spanning(%d, \"", call->sub == OP_PRIME);
+        write_call(codegen, call);
+        fprintf(file, "\", &views[%u], names%u, &spanning, %d, &r[%u]))\n", view, view, print, instruction->a);
+        indent(codegen, depth + 1);
+        fprintf(file, "goto fail;\n");
+        codegen->failing = 1;
+        return;
+    }
+    if (call->sub == OP_NOMBRECHROMATIQUE) {
+        indent(codegen, depth);
+        fprintf(file, "if (!run_chromatic(\"");
+        write_call(codegen, call);
+        fprintf(file, "\", &views[%u], &coloring, %u, %d, &r[%u]))\n", view, codegen->options->color_budget, print, instruction->a);
+        indent(codegen, depth + 1);
+        fprintf(file, "goto fail;\n");
+        codegen->failing = 1;
+        return;
+    }
+    if (call->sub == OP_COLORERGRAPH) {
+        indent(codegen, depth);
+        fprintf(file, "if (!run_colorergraph(&r[%u], %u, \"", instruction->b, call->count);
+        write_call(codegen, call);
+        fprintf(file, "\", %u, &views[%u], names%u, &coloring, %d, &r[%u]))\n", call->count == 0 ? 0 : ast_child(ast, call, 0)->line,
+            view, view, print, instruction->a);
+        indent(codegen, depth + 1);
+        fprintf(file, "goto fail;\n");
+        codegen->failing = 1;
+        return;
+    }
+    if (call->sub == OP_COLORIER) {
+        indent(codegen, depth);
+        fprintf(file, "if (!node_param(\"%s\", &r[%u], 0, %u, &views[%u], &source)\n", name, instruction->b,
+            ast_child(ast, call, 0)->line, view);
+        indent(codegen, depth);
+        fprintf(file, "    || !run_colorier(&r[%u], %u, \"", instruction->b, call->count);
+        write_call(codegen, call);
+        fprintf(file, "\", %u, &views[%u], &coloring, source, %d, &r[%u]))\n", call->count == 2 ? ast_child(ast, call, 1)->line : 0,
+            view, print, instruction->a);
+        indent(codegen, depth + 1);
+        fprintf(file, "goto fail;\n");
+        codegen->failing = 1;
+        return;
+    }
+
+    const char* method = call->sub == OP_BELLMAN ? "SEARCH_BELLMAN" : call->sub == OP_DIJKSTRAGENERALISE ? "SEARCH_LANDMARKS"
+        : expected == 1 ? "SEARCH_DIJKSTRA" : "SEARCH_BIDIRECTIONAL";
+    const char* runner = expected == 1 ? "run_distances" : call->sub == OP_MINCOST ? "run_cost" : "run_path";
+    for (uint32_t i = 0; i < expected && i < 2; i++) {
+        indent(codegen, depth);
+        fprintf(file, "%snode_param(\"%s\", &r[%u], %u, %u, &views[%u], &%s)\n", i == 0 ? "if (!" : "    || !", name,
+            instruction->b, i, ast_child(ast, call, i)->line, view, i == 0 ? "source" : "target");
+    }
+    if (call->sub == OP_MINCOST && (expected == 3 || codegen->capacitated[view])) {
+        indent(codegen, depth);
+        fprintf(file, "    || !run_flow(&r[%u], %u, \"", instruction->b, call->count);
+        write_call(codegen, call);
+        fprintf(file, "\", %u, %u, &views[%u], names%u, &flow, source, target, %d, %d, &r[%u]))\n", call->line,
+            expected == 3 ? ast_child(ast, call, 2)->line : 0, view, view, codegen->options->flow_scaling, print, instruction->a);
+        indent(codegen, depth + 1);
+        fprintf(file, "goto fail;\n");
+        codegen->failing = 1;
+        return;
+    }
+    indent(codegen, depth);
+    fprintf(file, "    || !%s(%s, \"%s\", \"", runner, method, name);
+    write_call(codegen, call);
+    fprintf(file, "\", %u, &views[%u], names%u, source, %s%d, &r[%u]))\n", call->line, view, view,
+        expected == 1 ? "" : "target, ", print, instruction->a);
+    indent(codegen, depth + 1);
+    fprintf(file, "goto fail;\n");
+    codegen->failing = 1;
+}
+
+static void write_code(Codegen* codegen, uint32_t first, uint32_t end, uint32_t view, uint32_t traverse, uint32_t depth);
+
+/**
+ * Writes a traverse: the loop of its search, with the body of its lambda inlined for each edge.
+ *
+ * @param codegen The generation.
+ * @param pc The position of the BC_TRAVERSE instruction.
+ * @param depth The nesting depth of the code.
+*/
+static void write_traverse(Codegen* codegen, uint32_t pc, uint32_t depth) {
+    FILE* file = codegen->file;
+    const Instruction* instruction = &codegen->code->code[pc];
+    uint32_t view = codegen->baked[instruction->b];
+    uint32_t a = instruction->a;
+    int bfs = instruction->sub == SEARCH_BFS;
+    const char* engine = bfs ? "bfs" : "dfs";
+    indent(codegen, depth);
+    fprintf(file, "r[%u].kind = VALUE_NODE;\n", a);
+    indent(codegen, depth);
+    fprintf(file, "r[%u].kind = VALUE_NODE;\n", a + 1);
+    indent(codegen, depth);
+    fprintf(file, "r[%u].kind = VALUE_NUMBER;\n", a + 2);
+    indent(codegen, depth);
+    fprintf(file, "%s_begin(&%s%u, &views[%u]);\n", engine, engine, pc, view);
+    indent(codegen, depth);
+    fprintf(file, "for (uint32_t root%u = 0; root%u < views[%u].node_count && !%s%u.failed; root%u++) {\n", pc, pc, view,
+        engine, pc, pc);
+    indent(codegen, depth + 1);
+    fprintf(file, "if (%s_visited(&%s%u, root%u))\n", engine, engine, pc, pc);
+    indent(codegen, depth + 2);
+    fprintf(file, "continue;\n");
+    indent(codegen, depth + 1);
+    fprintf(file, "%s_root(&%s%u, root%u);\n", engine, engine, pc, pc);
+    uint32_t body = depth + 2;
+    if (bfs) {
+        indent(codegen, depth + 1);
+        fprintf(file, "uint32_t count%u;\n", pc);
+        indent(codegen, depth + 1);
+        fprintf(file, "while ((count%u = bfs_step(&bfs%u)) > 0) {\n", pc, pc);
+        indent(codegen, depth + 2);
+        fprintf(file, "for (uint32_t i%u = 0; i%u < count%u; i%u++) {\n", pc, pc, pc, pc);
+        body = depth + 3;
+        indent(codegen, body);
+        fprintf(file, "r[%u].number = bfs%u.parents[i%u];\n", a, pc, pc);
+        indent(codegen, body);
+        fprintf(file, "r[%u].number = bfs%u.frontier[i%u];\n", a + 1, pc, pc);
+        indent(codegen, body);
+        fprintf(file, "r[%u].number = bfs%u.parent_weights[i%u];\n", a + 2, pc, pc);
+    }
+    else {
+        indent(codegen, depth + 1);
+        fprintf(file, "uint32_t source%u, target%u;\n", pc, pc);
+        indent(codegen, depth + 1);
+        fprintf(file, "int64_t weight%u;\n", pc);
+        indent(codegen, depth + 1);
+        fprintf(file, "while (dfs_next(&dfs%u, &source%u, &target%u, &weight%u)) {\n", pc, pc, pc, pc);
+        indent(codegen, body);
+        fprintf(file, "r[%u].number = source%u;\n", a, pc);
+        indent(codegen, body);
+        fprintf(file, "r[%u].number = target%u;\n", a + 1, pc);
+        indent(codegen, body);
+        fprintf(file, "r[%u].number = weight%u;\n", a + 2, pc);
+    }
+    write_code(codegen, pc + 1, (uint32_t) instruction->value, view, pc, body);
+    for (uint32_t level = body; level-- > depth;) {
+        indent(codegen, level);
+        fprintf(file, "}\n");
+    }
+    indent(codegen, depth);
+    fprintf(file, "if (%s%u.failed && !out_of_memory(\"traversing a graph\"))\n", engine, pc);
+    indent(codegen, depth + 1);
+    fprintf(file, "goto fail;\n");
+    codegen->failing = 1;
+    if (codegen->stopped[pc])
+        fprintf(file, "S%u: ;\n", pc);
+}
+
+/**
+ * Writes the code of a range of instructions.
+ *
+ * @param codegen The generation.
+ * @param first The position of the first instruction.
+ * @param end The position following the last instruction.
+ * @param view The index of the arrays of the view the instructions work on.
+ * @param traverse The innermost traverse, UINT32_MAX at the top of the block.
+ * @param depth The nesting depth of the code.
+*/
+static void write_code(Codegen* codegen, uint32_t first, uint32_t end, uint32_t view, uint32_t traverse, uint32_t depth) {
+    static const char* comparisons[] = {
+        [EQ_TOKEN] = "==", [NEQ_TOKEN] = "!=", [GT_TOKEN] = ">", [LT_TOKEN] = "<", [LEQ_TOKEN] = "<=", [BEQ_TOKEN] = ">="
+    };
+    FILE* file = codegen->file;
+    const Ast* ast = &codegen->program->ast;
+    uint32_t pc = first;
+    while (pc < end) {
+        const Instruction* instruction = &codegen->code->code[pc];
+        if (codegen->landings[pc])
+            fprintf(file, "L%u: ;\n", pc);
+        switch (instruction->op) {
+            case BC_NUMBER:
+            case BC_NODE:
+            case BC_COLOR:
+                indent(codegen, depth);
+                fprintf(file, "r[%u].kind = %s;\n", instruction->a, instruction->op == BC_NUMBER ? "VALUE_NUMBER"
+                    : instruction->op == BC_NODE ? "VALUE_NODE" : "VALUE_COLOR");
+                indent(codegen, depth);
+                fprintf(file, "r[%u].number = %d;\n", instruction->a, instruction->value);
+                break;
+            case BC_MOVE:
+                indent(codegen, depth);
+                fprintf(file, "r[%u] = r[%u];\n", instruction->a, instruction->b);
+                break;
+            case BC_CALL:
+                write_call_code(codegen, instruction, view, traverse, depth);
+                break;
+            case BC_TEST:
+                indent(codegen, depth);
+                fprintf(file, "if (r[%u].kind != VALUE_NODE && (r[%u].kind != VALUE_NUMBER || r[%u].number == 0))\n",
+                    instruction->a, instruction->a, instruction->a);
+                indent(codegen, depth + 1);
+                fprintf(file, "goto L%d;\n", instruction->value);
+                break;
+            case BC_COMPARE:
+                indent(codegen, depth);
+                fprintf(file, "if (r[%u].kind == VALUE_NONE || r[%u].kind == VALUE_NONE || !(r[%u].number %s r[%u].number))\n",
+                    instruction->a, instruction->b, instruction->a, comparisons[instruction->sub], instruction->b);
+                indent(codegen, depth + 1);
+                fprintf(file, "goto L%d;\n", instruction->value);
+                break;
+            case BC_TRAVERSE:
+                write_traverse(codegen, pc, depth);
+                pc = (uint32_t) instruction->value;
+                continue;
+            case BC_UNKNOWN: {
+                const AstNode* node = ast_node(ast, instruction->ast);
+                indent(codegen, depth);
+                if (node->kind == AST_TRAVERSE)
+                    fprintf(file, "printf(\"Runtime Error: unknown graph %s in traverse at line %u\\n\");\n",
+                        intern_text(codegen->program->names, (uint32_t) node->value), node->line);
+                else
+                    fprintf(file, "printf(\"Runtime Error: unknown node %s in %s at line %u\\n\");\n",
+                        intern_text(codegen->program->names, (uint32_t) node->value), operation_names[instruction->sub], node->line);
+                indent(codegen, depth);
+                fprintf(file, "goto fail;\n");
+                codegen->failing = 1;
+                break;
+            }
+            default: // BC_RETURN ends the block or the body of a lambda
+                break;
+        }
+        pc++;
+    }
+}
+
+/**
+ * Writes the main function: the graphs and searches are set up, the block runs, then everything is released.
+ *
+ * @param codegen The generation.
+*/
+static void write_main(Codegen* codegen) {
+    FILE* file = codegen->file;
+    const Bytecode* code = codegen->code;
+    int pooled = 0;
+    int spanning = 0;
+    fprintf(file, "static Graph graphs[%u];\nstatic GraphView views[%u];\nstatic Value r[%u];\n", codegen->baked_count,
+        codegen->baked_count, code->register_count == 0 ? 1 : code->register_count);
+    for (uint32_t pc = 0; pc < code->count; pc++) {
+        const Instruction* instruction = &code->code[pc];
+        if (instruction->op == BC_CALL && codegen->runnable[instruction->sub])
+            spanning |= instruction->sub == OP_KRUSKAL || instruction->sub == OP_PRIME;
+        if (instruction->op != BC_TRAVERSE)
+            continue;
+        pooled |= instruction->sub == SEARCH_BFS;
+        fprintf(file, instruction->sub == SEARCH_BFS ? "static Bfs bfs%u;\n" : "static Dfs dfs%u;\n", pc);
+    }
+    pooled |= spanning || codegen->coloring; // Kruskal and the speculative coloring run on the pool
+    if (pooled)
+        fprintf(file, "static ThreadPool pool;\n");
+    if (spanning)
+        fprintf(file, "static Spanning spanning;\n");
+    if (codegen->coloring)
+        fprintf(file, "static Coloring coloring;\n");
+    if (codegen->flow)
+        fprintf(file, "static FlowEngine flow;\n");
+
+    fprintf(file, "\nint main(void) {\n    int valid = 1;\n    uint32_t source = 0, target = 0;\n");
+    fprintf(file, "    (void) source;\n    (void) target;\n    setvbuf(stdout, NULL, _IOFBF, 1 << 20);\n    paths_init(&paths);\n");
+    for (uint32_t i = 0; i < codegen->program->graph_count; i++) {
+        uint32_t k = codegen->baked[i];
+        if (k == UINT32_MAX)
+            continue;
+        const GraphView* view = &codegen->program->views[i];
+        fprintf(file, "    graphs[%u] = (Graph) {.name = -1, .directed = 1, .node_count = %u, .edge_count = %llu,\n", k,
+            view->node_count, (unsigned long long) view->edge_count);
+        fprintf(file, "        .min_weight = %d, .max_weight = %d, .offsets = (uint32_t*) offsets%u, .targets = (uint32_t*) targets%u,\n",
+            view->min_weight, view->max_weight, k, k);
+        fprintf(file, "        .weights = (int32_t*) weights%u, .lines = (uint32_t*) lines%u, .reverse_offsets = (uint32_t*) reverse_offsets%u,\n",
+            k, k, k);
+        fprintf(file, "        .reverse_targets = (uint32_t*) reverse_targets%u, .reverse_weights = (int32_t*) reverse_weights%u,\n", k, k);
+        if (view->capacitated)
+            fprintf(file, "        .reverse_lines = (uint32_t*) reverse_lines%u, .capacities = (int32_t*) capacities%u,\n"
+                "        .reverse_capacities = (int32_t*) reverse_capacities%u};\n", k, k, k);
+        else
+            fprintf(file, "        .reverse_lines = (uint32_t*) reverse_lines%u};\n", k);
+        fprintf(file, "    view_init(&views[%u], &graphs[%u]);\n    view_finish(&views[%u]);\n", k, k, k);
+        fprintf(file, "    (void) names%u;\n", k);
+    }
+    if (pooled)
+        fprintf(file, "    pool_init(&pool, 0);\n");
+    if (spanning)
+        fprintf(file, "    spanning_init(&spanning, &pool);\n");
+    if (codegen->coloring)
+        fprintf(file, "    coloring_init(&coloring, &pool);\n");
+    if (codegen->flow)
+        fprintf(file, "    flow_init(&flow);\n");
+    for (uint32_t pc = 0; pc < code->count; pc++) {
+        if (code->code[pc].op == BC_TRAVERSE)
+            fprintf(file, code->code[pc].sub == SEARCH_BFS ? "    bfs_init(&bfs%u, &pool, 1);\n" : "    dfs_init(&dfs%u);\n", pc);
+    }
+    fprintf(file, "\n");
+
+    write_code(codegen, 0, code->count, codegen->baked[codegen->program->graph_count - 1], UINT32_MAX, 1);
+
+    fprintf(file, "    goto done;\n");
+    if (codegen->failing)
+        fprintf(file, "fail:\n    valid = 0;\n");
+    fprintf(file, "done:\n");
+    for (uint32_t pc = 0; pc < code->count; pc++) {
+        if (code->code[pc].op == BC_TRAVERSE)
+            fprintf(file, code->code[pc].sub == SEARCH_BFS ? "    bfs_free(&bfs%u);\n" : "    dfs_free(&dfs%u);\n", pc);
+    }
+    if (spanning)
+        fprintf(file, "    spanning_free(&spanning);\n");
+    if (codegen->coloring)
+        fprintf(file, "    coloring_free(&coloring);\n");
+    if (codegen->flow)
+        fprintf(file, "    flow_free(&flow);\n");
+    if (pooled)
+        fprintf(file, "    pool_free(&pool);\n");
+    for (uint32_t k = 0; k < codegen->baked_count; k++)
+        fprintf(file, "    view_free(&views[%u]);\n", k);
+    fprintf(file, "    paths_free(&paths);\n    fflush(stdout);\n    return valid ? EXIT_SUCCESS : EXIT_FAILURE;\n}\n");
+}
+
+/**
+ * Writes a standalone C translation unit running the %operations block of a linked program.
+ * It is built with the library sources listed by CODEGEN_LIBRARY.
+ *
+ * @param program The program.
+ * @param options The options of the runs, whose color budget and flow method are baked into the unit.
+ * @param path The path of the unit.
+ * @return 0 if the program can't be generated or the file can't be written, 1 if not.
+*/
+int codegen_write(Program* program, const ExecOptions* options, const char* path) {
+    uint8_t runnable[OPERATION_COUNT];
+    Bytecode code;
+    exec_runnable(runnable);
+    int valid = bytecode_compile(&code, program, runnable);
+
+    Codegen codegen = {0};
+    codegen.program = program;
+    codegen.code = &code;
+    codegen.runnable = runnable;
+    codegen.options = options;
+    codegen.landings = codegen_alloc(code.count + 1, sizeof(uint8_t));
+    codegen.stopped = codegen_alloc(code.count, sizeof(uint8_t));
+    codegen.baked = codegen_alloc(program->graph_count, sizeof(uint32_t));
+    if (valid && (codegen.landings == NULL || codegen.stopped == NULL || codegen.baked == NULL))
+        valid = codegen_out_of_memory(program);
+    if (valid) {
+        memset(codegen.baked, 0xFF, program->graph_count * sizeof(uint32_t));
+        codegen.baked[program->graph_count - 1] = 0;
+        codegen.baked_count = 1;
+    }
+
+    int mincost = 0; // 1 if a mincost call runs, which sends a flow on a graph with capacities
+    for (uint32_t pc = 0; pc < code.count && valid; pc++) {
+        const Instruction* instruction = &code.code[pc];
+        if (instruction->op == BC_TEST || instruction->op == BC_COMPARE)
+            codegen.landings[instruction->value] = 1;
+        else if (instruction->op == BC_TRAVERSE && codegen.baked[instruction->b] == UINT32_MAX)
+            codegen.baked[instruction->b] = codegen.baked_count++;
+        else if (instruction->op == BC_CALL && runnable[instruction->sub] && !supported(instruction->sub)) {
+            printf("Error: %s at line %u can't be compiled to C yet\n", operation_names[instruction->sub],
+                ast_node(&program->ast, instruction->ast)->line);
+            valid = 0;
+        }
+        else if (instruction->op == BC_CALL && runnable[instruction->sub]) {
+            codegen.coloring |= instruction->sub == OP_COLORERGRAPH || instruction->sub == OP_COLORIER
+                || instruction->sub == OP_NOMBRECHROMATIQUE;
+            mincost |= instruction->sub == OP_MINCOST;
+            codegen.flow |= instruction->sub == OP_MINCOST && ast_node(&program->ast, instruction->ast)->count == 3;
+        }
+    }
+    codegen.capacitated = codegen_alloc(codegen.baked_count, sizeof(uint8_t));
+    if (valid && codegen.capacitated == NULL)
+        valid = codegen_out_of_memory(program);
+    for (uint32_t i = 0; i < program->graph_count && valid; i++) {
+        if (codegen.baked[i] != UINT32_MAX && program->views[i].edge_count > UINT32_MAX) {
+            printf("Error: the graph at index %u has too many edges to be compiled to C\n", i);
+            valid = 0;
+        }
+        else if (codegen.baked[i] != UINT32_MAX && program->views[i].capacitated) {
+            codegen.capacitated[codegen.baked[i]] = 1;
+            codegen.flow |= mincost;
+        }
+    }
+    if (valid && !program_reverse(program)) // The incoming edges are written next to the outgoing ones
+        valid = codegen_out_of_memory(program);
+    if (valid) {
+        codegen.file = fopen(path, "w");
+        if (codegen.file == NULL) {
+            printf("Error: failed to open C output file at path \"%s\"\n", path);
+            valid = 0;
+        }
+    }
+    if (valid) {
+        fprintf(codegen.file, "/*\n * Generated by gx --emit-c. Build it with the GraphEx sources:\n"
+            " *     gcc -O2 -pthread -I<source directory> <this file> " CODEGEN_LIBRARY "\n*/\n\n");
+        fputs(codegen_prelude, codegen.file);
+        fprintf(codegen.file, "\n");
+        if (codegen.coloring) {
+            fprintf(codegen.file, "static const char* const color_names[] = {");
+            for (int color = 0; color < COLOR_COUNT; color++)
+                fprintf(codegen.file, "%s\"%s\"", color == 0 ? "" : ", ", color_names[color]);
+            fprintf(codegen.file, "};\n\n");
+            fputs(codegen_coloring, codegen.file);
+            fprintf(codegen.file, "\n");
+        }
+        if (codegen.flow) {
+            fputs(codegen_flow, codegen.file);
+            fprintf(codegen.file, "\n");
+        }
+        for (uint32_t i = 0; i < program->graph_count && valid; i++) {
+            if (codegen.baked[i] != UINT32_MAX && !write_view(&codegen, &program->views[i], codegen.baked[i]))
+                valid = codegen_out_of_memory(program);
+        }
+        if (valid)
+            write_main(&codegen);
+        if (fclose(codegen.file) != 0 && valid) {
+            printf("Error: failed to write C output file at path \"%s\"\n", path);
+            valid = 0;
+        }
+    }
+    free(codegen.landings);
+    free(codegen.stopped);
+    free(codegen.baked);
+    free(codegen.capacitated);
+    bytecode_free(&code);
+    return valid;
+}
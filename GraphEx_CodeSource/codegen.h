@@ -0,0 +1,17 @@
+/**
+ * @file
+ * @brief C code generator header file.
+*/
+
+#ifndef CODEGEN_H_
+#define CODEGEN_H_
+
+#include "program.h"
+#include "executor.h"
+
+#define CODEGEN_LIBRARY "graph.c view.c heap.c flat.c paths.c pool.c bfs.c dfs.c spanning.c coloring.c flow.c" /** Sources a generated unit is built with. */
+#define CODEGEN_PER_LINE 16 /** Numbers written on each line of a generated array. */
+
+int codegen_write(Program* program, const ExecOptions* options, const char* path);
+
+#endif
@@ -0,0 +1,734 @@
+/**
+ * @file
+ * @brief Graph coloring source file.
+ *
+ * DSATUR colors the node whose neighbors already use the most colors, with the first color none of them
+ * uses. The exact search tries the colors of the same node in turn, below the fewest colors found so
+ * far, starting from a greedy clique whose nodes need distinct colors anyway. The speculative coloring
+ * runs its rounds on a thread pool, for the graphs too large for DSATUR.
+ *
+ * Every coloring works on a flat copy of the graph with its incoming edges, not through its view: the
+ * saturation updates and the exact search scan the neighbors of a node in both directions over and
+ * over, where the view would follow the instances and its reverse overlay on every scan. The copy
+ * holds the expanded edges of the instances, on top of the colors kept per node anyway.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "coloring.h"
+
+/**
+ * Allocates a zeroed array.
+ *
+ * @param count The number of elements.
+ * @param size The size of an element.
+ * @return The array, NULL if memory is exhausted.
+*/
+static void* coloring_alloc(size_t count, size_t size) {
+    return calloc(count + 1, size);
+}
+
+/**
+ * Initializes a coloring without any graph.
+ *
+ * @param coloring The coloring.
+ * @param pool The workers of the speculative coloring, which may be started later.
+*/
+void coloring_init(Coloring* coloring, ThreadPool* pool) {
+    memset(coloring, 0, sizeof(Coloring));
+    coloring->pool = pool;
+    flat_init(&coloring->flat);
+    heap_init(&coloring->heap);
+}
+
+/**
+ * Releases a coloring.
+ *
+ * @param coloring The coloring.
+*/
+void coloring_free(Coloring* coloring) {
+    free(coloring->colors);
+    free(coloring->saturation);
+    free(coloring->saturated);
+    free(coloring->members);
+    free(coloring->local);
+    free(coloring->degrees);
+    free(coloring->worklist);
+    if (coloring->buffers != NULL) {
+        for (uint32_t w = 0; w < coloring->pool->count; w++) {
+            free(coloring->buffers[w].nodes);
+            free(coloring->buffers[w].marks);
+        }
+        free(coloring->buffers);
+    }
+    heap_free(&coloring->heap);
+    flat_free(&coloring->flat);
+    memset(coloring, 0, sizeof(Coloring));
+}
+
+/**
+ * Releases a coloring when memory is exhausted, keeping its workers for the next one.
+ *
+ * @param coloring The coloring.
+ * @return 0.
+*/
+static int coloring_out_of_memory(Coloring* coloring) {
+    ThreadPool* pool = coloring->pool;
+    coloring_free(coloring);
+    coloring->pool = pool;
+    return 0;
+}
+
+/**
+ * Makes room for the nodes of a graph.
+ *
+ * @param coloring The coloring.
+ * @param n The number of nodes.
+ * @return 0 if memory is exhausted, 1 if not.
+*/
+static int reserve_nodes(Coloring* coloring, uint32_t n) {
+    if (n <= coloring->capacity && coloring->colors != NULL)
+        return 1;
+    free(coloring->colors);
+    free(coloring->saturated);
+    free(coloring->members);
+    free(coloring->local);
+    free(coloring->degrees);
+    free(coloring->worklist);
+    coloring->colors = coloring_alloc(n, sizeof(uint32_t));
+    coloring->saturated = coloring_alloc(n, sizeof(uint32_t));
+    coloring->members = coloring_alloc(n, sizeof(uint32_t));
+    coloring->local = coloring_alloc(n, sizeof(uint32_t));
+    coloring->degrees = coloring_alloc(n, sizeof(uint32_t));
+    coloring->worklist = coloring_alloc(n, sizeof(uint32_t));
+    coloring->capacity = n;
+    return coloring->colors != NULL && coloring->saturated != NULL && coloring->members != NULL
+        && coloring->local != NULL && coloring->degrees != NULL && coloring->worklist != NULL;
+}
+
+/**
+ * Doubles the words of the saturation bitset of each node, once a color doesn't fit in them.
+ *
+ * @param coloring The coloring.
+ * @return 0 if memory is exhausted, 1 if not.
+*/
+static int grow_saturation(Coloring* coloring) {
+    uint32_t n = coloring->flat.node_count;
+    uint32_t stride = coloring->stride * 2;
+    uint64_t* saturation = coloring_alloc((size_t) n * stride, sizeof(uint64_t));
+    if (saturation == NULL)
+        return 0;
+    for (uint32_t v = 0; v < n; v++)
+        memcpy(&saturation[(size_t) v * stride], &coloring->saturation[(size_t) v * coloring->stride],
+            coloring->stride * sizeof(uint64_t));
+    free(coloring->saturation);
+    coloring->saturation = saturation;
+    coloring->stride = stride;
+    return 1;
+}
+
+/**
+ * Gives the DSATUR priority of a node: its saturation degree, then its degree, the largest first.
+ *
+ * @param saturated The saturation degree of the node.
+ * @param degree The number of edges of the node.
+ * @return The key of the node in the heap.
+*/
+static inline int64_t dsatur_key(uint32_t saturated, uint64_t degree) {
+    if (degree > UINT32_MAX)
+        degree = UINT32_MAX;
+    return -(int64_t) (((uint64_t) saturated << 32) | degree);
+}
+
+/**
+ * Gives the number of edges of a node, in both directions.
+ *
+ * @param flat The flattened graph, its incoming edges built.
+ * @param node The node id.
+ * @return The degree.
+*/
+static inline uint64_t node_degree(const FlatGraph* flat, uint32_t node) {
+    return flat_degree(flat, node) + flat->in_first[node + 1] - flat->in_first[node];
+}
+
+/**
+ * Tells a neighbor of a node colored with a color that one of its neighbors uses it.
+ *
+ * @param coloring The coloring.
+ * @param node The neighbor.
+ * @param color The color.
+*/
+static inline void saturate(Coloring* coloring, uint32_t node, uint32_t color) {
+    if (coloring->colors[node] != COLORING_NO_COLOR)
+        return;
+    uint64_t* set = &coloring->saturation[(size_t) node * coloring->stride];
+    uint64_t bit = (uint64_t) 1 << (color & 63);
+    if (set[color >> 6] & bit)
+        return;
+    set[color >> 6] |= bit;
+    coloring->saturated[node]++;
+    heap_update(&coloring->heap, node, dsatur_key(coloring->saturated[node], node_degree(&coloring->flat, node)));
+}
+
+/**
+ * Colors a graph with DSATUR, unless it is the graph colored last.
+ *
+ * @param coloring The coloring.
+ * @param view The graph.
+ * @return 0 if memory is exhausted, the coloring being released, 1 if not.
+*/
+int coloring_dsatur(Coloring* coloring, const GraphView* view) {
+    if (coloring->view == view && !coloring->speculative && !coloring->edited)
+        return 1;
+    FlatGraph* flat = &coloring->flat;
+    if (!flat_build(flat, view) || !flat_incoming(flat) || !reserve_nodes(coloring, flat->node_count))
+        return coloring_out_of_memory(coloring);
+    uint32_t n = flat->node_count;
+    free(coloring->saturation);
+    coloring->stride = 1;
+    coloring->saturation = coloring_alloc(n, sizeof(uint64_t));
+    heap_clear(&coloring->heap);
+    if (coloring->saturation == NULL || !heap_reserve(&coloring->heap, n))
+        return coloring_out_of_memory(coloring);
+    for (uint32_t v = 0; v < n; v++) {
+        coloring->colors[v] = COLORING_NO_COLOR;
+        coloring->saturated[v] = 0;
+        heap_update(&coloring->heap, v, dsatur_key(0, node_degree(flat, v)));
+    }
+
+    coloring->color_count = 0;
+    HeapEntry entry;
+    while (heap_pop(&coloring->heap, &entry)) {
+        uint32_t u = entry.node;
+        const uint64_t* set = &coloring->saturation[(size_t) u * coloring->stride];
+        uint32_t color = coloring->stride * 64;
+        for (uint32_t w = 0; w < coloring->stride; w++) {
+            if (~set[w] != 0) {
+                color = w * 64 + (uint32_t) __builtin_ctzll(~set[w]);
+                break;
+            }
+        }
+        coloring->colors[u] = color;
+        if (color >= coloring->color_count)
+            coloring->color_count = color + 1;
+        if (color + 1 >= coloring->stride * 64 && !grow_saturation(coloring)) // The neighbors may need the next color too
+            return coloring_out_of_memory(coloring);
+        for (uint64_t e = flat->first[u]; e < flat->first[u + 1]; e++)
+            saturate(coloring, flat->targets[e], color);
+        for (uint64_t i = flat->in_first[u]; i < flat->in_first[u + 1]; i++)
+            saturate(coloring, flat->sources[i], color);
+    }
+    coloring->view = view;
+    coloring->speculative = 0;
+    coloring->edited = 0;
+    return 1;
+}
+
+/**
+ * Gives the range of the worklist that a worker handles.
+ *
+ * @param coloring The coloring.
+ * @param worker The index of the worker.
+ * @param begin Receives the first index of the range.
+ * @param end Receives the index after the range.
+*/
+static void worker_range(const Coloring* coloring, uint32_t worker, uint32_t* begin, uint32_t* end) {
+    uint32_t workers = coloring->pool->count;
+    *begin = coloring->work_count / workers * worker + (worker == 0 ? 0 : coloring->work_count % workers);
+    *end = *begin + coloring->work_count / workers + (worker == 0 ? coloring->work_count % workers : 0);
+}
+
+/**
+ * Marks a color as used by a neighbor of the node a worker colors.
+ *
+ * @param buffer The state of the worker.
+ * @param color The color, COLORING_NO_COLOR for a neighbor not colored yet.
+*/
+static inline void mark_color(ColoringBuffer* buffer, uint32_t color) {
+    if (color < buffer->mark_capacity)
+        buffer->marks[color] = buffer->stamp;
+}
+
+/**
+ * Speculative round task giving each node of the worker the first color its neighbors don't use,
+ * as far as the worker can see them.
+*/
+static void task_color(void* data, uint32_t worker) {
+    Coloring* coloring = data;
+    const FlatGraph* flat = &coloring->flat;
+    ColoringBuffer* buffer = &coloring->buffers[worker];
+    uint32_t begin, end;
+    worker_range(coloring, worker, &begin, &end);
+    for (uint32_t i = begin; i < end; i++) {
+        uint32_t v = coloring->worklist[i];
+        uint64_t degree = node_degree(flat, v);
+        if (degree + 1 > buffer->mark_capacity) { // A node never needs more colors than neighbors plus one
+            free(buffer->marks);
+            buffer->mark_capacity = (uint32_t) (degree + 1 < UINT32_MAX / 2 ? (degree + 1) * 2 : UINT32_MAX);
+            buffer->marks = coloring_alloc(buffer->mark_capacity, sizeof(uint32_t));
+            buffer->stamp = 0;
+            if (buffer->marks == NULL) {
+                buffer->mark_capacity = 0;
+                __atomic_store_n(&coloring->exhausted, 1, __ATOMIC_RELAXED);
+                return;
+            }
+        }
+        if (++buffer->stamp == 0) {
+            memset(buffer->marks, 0, buffer->mark_capacity * sizeof(uint32_t));
+            buffer->stamp = 1;
+        }
+        for (uint64_t e = flat->first[v]; e < flat->first[v + 1]; e++)
+            mark_color(buffer, __atomic_load_n(&coloring->colors[flat->targets[e]], __ATOMIC_RELAXED));
+        for (uint64_t j = flat->in_first[v]; j < flat->in_first[v + 1]; j++)
+            mark_color(buffer, __atomic_load_n(&coloring->colors[flat->sources[j]], __ATOMIC_RELAXED));
+        uint32_t color = 0;
+        while (buffer->marks[color] == buffer->stamp)
+            color++;
+        __atomic_store_n(&coloring->colors[v], color, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * Tells if a neighbor of a node got its color, the larger node of the pair being colored again.
+ *
+ * @param coloring The coloring.
+ * @param node The node.
+ * @param neighbor The neighbor.
+ * @return 1 if the node must be colored again, 0 if not.
+*/
+static inline int in_conflict(const Coloring* coloring, uint32_t node, uint32_t neighbor) {
+    return neighbor < node && coloring->colors[neighbor] == coloring->colors[node];
+}
+
+/**
+ * Speculative round task finding the nodes of the worker that got the color of a neighbor.
+*/
+static void task_conflicts(void* data, uint32_t worker) {
+    Coloring* coloring = data;
+    const FlatGraph* flat = &coloring->flat;
+    ColoringBuffer* buffer = &coloring->buffers[worker];
+    uint32_t begin, end;
+    worker_range(coloring, worker, &begin, &end);
+    buffer->count = 0;
+    for (uint32_t i = begin; i < end; i++) {
+        uint32_t v = coloring->worklist[i];
+        int conflict = 0;
+        for (uint64_t e = flat->first[v]; e < flat->first[v + 1] && !conflict; e++)
+            conflict = in_conflict(coloring, v, flat->targets[e]);
+        for (uint64_t j = flat->in_first[v]; j < flat->in_first[v + 1] && !conflict; j++)
+            conflict = in_conflict(coloring, v, flat->sources[j]);
+        if (!conflict)
+            continue;
+        if (buffer->count == buffer->capacity) {
+            uint32_t capacity = buffer->capacity == 0 ? 1024 : buffer->capacity * 2;
+            uint32_t* nodes = realloc(buffer->nodes, capacity * sizeof(uint32_t));
+            if (nodes == NULL) {
+                __atomic_store_n(&coloring->exhausted, 1, __ATOMIC_RELAXED);
+                return;
+            }
+            buffer->nodes = nodes;
+            buffer->capacity = capacity;
+        }
+        buffer->nodes[buffer->count++] = v;
+    }
+}
+
+/**
+ * Colors a graph with rounds of speculative coloring run by the thread pool. The colors are the
+ * first free ones, so they can be more than those of DSATUR. Each round rescans the neighbors of the
+ * nodes left to color, so the workers share the flat copy of DSATUR rather than the view.
+ *
+ * @param coloring The coloring.
+ * @param view The graph.
+ * @return 0 if memory is exhausted, the coloring being released, 1 if not.
+*/
+int coloring_speculative(Coloring* coloring, const GraphView* view) {
+    FlatGraph* flat = &coloring->flat;
+    if (!flat_build(flat, view) || !flat_incoming(flat) || !reserve_nodes(coloring, flat->node_count))
+        return coloring_out_of_memory(coloring);
+    uint32_t n = flat->node_count;
+    uint32_t workers = coloring->pool->count;
+    if (coloring->buffers == NULL)
+        coloring->buffers = coloring_alloc(workers, sizeof(ColoringBuffer));
+    if (coloring->buffers == NULL)
+        return coloring_out_of_memory(coloring);
+    for (uint32_t v = 0; v < n; v++) {
+        coloring->colors[v] = COLORING_NO_COLOR;
+        coloring->worklist[v] = v;
+    }
+    coloring->work_count = n;
+    coloring->rounds = 0;
+    coloring->conflicts = 0;
+
+    while (coloring->work_count > 0) {
+        pool_run(coloring->pool, task_color, coloring);
+        pool_run(coloring->pool, task_conflicts, coloring);
+        if (coloring->exhausted)
+            return coloring_out_of_memory(coloring);
+        uint32_t count = 0;
+        for (uint32_t w = 0; w < workers; w++) {
+            memcpy(&coloring->worklist[count], coloring->buffers[w].nodes, coloring->buffers[w].count * sizeof(uint32_t));
+            count += coloring->buffers[w].count;
+        }
+        coloring->work_count = count;
+        coloring->conflicts += count;
+        coloring->rounds++;
+    }
+
+    coloring->color_count = 0;
+    for (uint32_t v = 0; v < n; v++) {
+        if (coloring->colors[v] >= coloring->color_count)
+            coloring->color_count = coloring->colors[v] + 1;
+    }
+    coloring->view = view;
+    coloring->speculative = 1;
+    coloring->edited = 0;
+    return 1;
+}
+
+/**
+ * Tells if two bitsets over the component share a node. Every word is read, which lets the
+ * compiler run the loop on vector registers.
+ *
+ * @param coloring The coloring.
+ * @param a The first bitset.
+ * @param b The second bitset.
+ * @return 1 if they intersect, 0 if not.
+*/
+static inline int intersects(const Coloring* coloring, const uint64_t* a, const uint64_t* b) {
+    uint64_t common = 0;
+    for (uint32_t w = 0; w < coloring->words; w++)
+        common |= a[w] & b[w];
+    return common != 0;
+}
+
+/**
+ * Gives the row of a node in the adjacency bitsets of the component.
+ *
+ * @param coloring The coloring.
+ * @param node The local id of the node.
+ * @return Its neighbors.
+*/
+static inline uint64_t* neighbors(const Coloring* coloring, uint32_t node) {
+    return &coloring->adjacency[(size_t) node * coloring->words];
+}
+
+/**
+ * Gives the bitset of the nodes of a color in the current branch.
+ *
+ * @param coloring The coloring.
+ * @param color The color.
+ * @return The nodes of the color.
+*/
+static inline uint64_t* color_class(const Coloring* coloring, uint32_t color) {
+    return &coloring->classes[(size_t) color * coloring->words];
+}
+
+/**
+ * Colors a node of the component in the current branch, or uncolors it.
+ *
+ * @param coloring The coloring.
+ * @param node The local id of the node.
+ * @param color The color.
+ * @param set 1 to color the node, 0 to uncolor it.
+*/
+static inline void assign(Coloring* coloring, uint32_t node, uint32_t color, int set) {
+    uint64_t bit = (uint64_t) 1 << (node & 63);
+    if (set) {
+        color_class(coloring, color)[node >> 6] |= bit;
+        coloring->uncolored[node >> 6] &= ~bit;
+    }
+    else {
+        color_class(coloring, color)[node >> 6] &= ~bit;
+        coloring->uncolored[node >> 6] |= bit;
+    }
+}
+
+/**
+ * Explores the colorings of the component extending the current branch with fewer colors than the best one.
+ * The node colored next is the most saturated one, which prunes the branches that would need a new color early.
+ *
+ * @param coloring The coloring.
+ * @param remaining The number of nodes without a color.
+ * @param used The number of colors of the branch.
+*/
+static void branch(Coloring* coloring, uint32_t remaining, uint32_t used) {
+    if (used >= coloring->best)
+        return;
+    if (remaining == 0) {
+        coloring->best = used;
+        return;
+    }
+    if (++coloring->branches % COLORING_CHECK_PERIOD == 0 && coloring->deadline != 0 && clock() >= coloring->deadline)
+        coloring->expired = 1;
+    if (coloring->expired)
+        return;
+
+    uint32_t pick = 0, pick_saturation = 0, pick_degree = 0;
+    int found = 0;
+    for (uint32_t w = 0; w < coloring->words; w++) {
+        for (uint64_t bits = coloring->uncolored[w]; bits != 0; bits &= bits - 1) {
+            uint32_t v = w * 64 + (uint32_t) __builtin_ctzll(bits);
+            uint32_t saturation = 0;
+            for (uint32_t color = 0; color < used; color++)
+                saturation += intersects(coloring, neighbors(coloring, v), color_class(coloring, color));
+            if (saturation == used && used + 1 >= coloring->best) // The node needs a color too many
+                return;
+            if (!found || saturation > pick_saturation || (saturation == pick_saturation && coloring->degrees[v] > pick_degree)) {
+                pick = v;
+                pick_saturation = saturation;
+                pick_degree = coloring->degrees[v];
+                found = 1;
+            }
+        }
+    }
+
+    for (uint32_t color = 0; color < used; color++) {
+        if (intersects(coloring, neighbors(coloring, pick), color_class(coloring, color)))
+            continue;
+        assign(coloring, pick, color, 1);
+        branch(coloring, remaining - 1, used);
+        assign(coloring, pick, color, 0);
+        if (coloring->best == coloring->bound || coloring->expired)
+            return;
+    }
+    if (used + 1 < coloring->best) {
+        assign(coloring, pick, used, 1);
+        branch(coloring, remaining - 1, used + 1);
+        assign(coloring, pick, used, 0);
+    }
+}
+
+/**
+ * Releases the bitsets of the exact search of a component.
+ *
+ * @param coloring The coloring.
+*/
+static void release_search(Coloring* coloring) {
+    free(coloring->adjacency);
+    free(coloring->candidates);
+    free(coloring->classes);
+    free(coloring->uncolored);
+    coloring->adjacency = NULL;
+    coloring->candidates = NULL;
+    coloring->classes = NULL;
+    coloring->uncolored = NULL;
+}
+
+/**
+ * Searches the chromatic number of the component held by members, between the size of a greedy clique
+ * and the colors of the coloring of the graph.
+ *
+ * @param coloring The coloring.
+ * @param upper The number of colors the coloring gives the component.
+ * @return 0 if memory is exhausted, 1 if not.
+*/
+static int search_component(Coloring* coloring, uint32_t upper) {
+    const FlatGraph* flat = &coloring->flat;
+    uint32_t s = coloring->size;
+    uint32_t words = (s + 63) / 64;
+    coloring->words = words;
+    coloring->adjacency = coloring_alloc((size_t) s * words, sizeof(uint64_t));
+    coloring->candidates = coloring_alloc(words, sizeof(uint64_t));
+    uint32_t* clique = coloring_alloc(s, sizeof(uint32_t));
+    if (coloring->adjacency == NULL || coloring->candidates == NULL || clique == NULL) {
+        free(clique);
+        release_search(coloring);
+        return 0;
+    }
+    for (uint32_t i = 0; i < s; i++) {
+        uint32_t v = coloring->members[i];
+        for (uint64_t e = flat->first[v]; e < flat->first[v + 1]; e++) {
+            uint32_t j = coloring->local[flat->targets[e]];
+            if (j != i) { // Each edge is seen from both ends, and stored in both rows
+                neighbors(coloring, i)[j >> 6] |= (uint64_t) 1 << (j & 63);
+                neighbors(coloring, j)[i >> 6] |= (uint64_t) 1 << (i & 63);
+            }
+        }
+    }
+    for (uint32_t i = 0; i < s; i++) {
+        uint32_t degree = 0;
+        for (uint32_t w = 0; w < words; w++)
+            degree += (uint32_t) __builtin_popcountll(neighbors(coloring, i)[w]);
+        coloring->degrees[i] = degree;
+        coloring->candidates[i >> 6] |= (uint64_t) 1 << (i & 63);
+    }
+
+    // Greedy clique: the candidate with the most neighbors among the candidates joins it each time
+    uint32_t clique_size = 0;
+    for (;;) {
+        uint32_t pick = 0, pick_count = 0;
+        int found = 0;
+        for (uint32_t w = 0; w < words; w++) {
+            for (uint64_t bits = coloring->candidates[w]; bits != 0; bits &= bits - 1) {
+                uint32_t v = w * 64 + (uint32_t) __builtin_ctzll(bits);
+                uint32_t count = 0;
+                for (uint32_t x = 0; x < words; x++)
+                    count += (uint32_t) __builtin_popcountll(neighbors(coloring, v)[x] & coloring->candidates[x]);
+                if (!found || count > pick_count) {
+                    pick = v;
+                    pick_count = count;
+                    found = 1;
+                }
+            }
+        }
+        if (!found)
+            break;
+        clique[clique_size++] = pick;
+        for (uint32_t w = 0; w < words; w++)
+            coloring->candidates[w] &= neighbors(coloring, pick)[w];
+    }
+
+    coloring->bound = clique_size;
+    coloring->best = upper;
+    if (clique_size < upper) {
+        coloring->searched++;
+        coloring->classes = coloring_alloc((size_t) upper * words, sizeof(uint64_t));
+        coloring->uncolored = coloring_alloc(words, sizeof(uint64_t));
+        if (coloring->classes == NULL || coloring->uncolored == NULL) {
+            free(clique);
+            release_search(coloring);
+            return 0;
+        }
+        for (uint32_t i = 0; i < s; i++)
+            coloring->uncolored[i >> 6] |= (uint64_t) 1 << (i & 63);
+        for (uint32_t i = 0; i < clique_size; i++)
+            assign(coloring, clique[i], i, 1);
+        branch(coloring, s - clique_size, clique_size);
+    }
+    free(clique);
+    release_search(coloring);
+    return 1;
+}
+
+/**
+ * Finds a greedy clique of the component held by members when it is too large for the adjacency
+ * bitsets, counting the neighbors of each candidate through its edges instead. Each node joining the
+ * clique keeps only its neighbors as candidates.
+ *
+ * @param coloring The coloring.
+ * @return The size of the clique, a lower bound of the colors of the component.
+*/
+static uint32_t sparse_clique(Coloring* coloring) {
+    const FlatGraph* flat = &coloring->flat;
+    uint32_t* candidates = coloring->worklist;
+    uint32_t* stamps = coloring->degrees; // Candidates of the current round hold its stamp
+    uint32_t count = coloring->size, stamp = 1, size = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        candidates[i] = i;
+        stamps[i] = stamp;
+    }
+    while (count > 0 && !coloring->expired) {
+        uint32_t pick = 0, pick_count = 0;
+        for (uint32_t c = 0; c < count; c++) {
+            uint32_t v = coloring->members[candidates[c]], adjacent = 0;
+            for (uint64_t e = flat->first[v]; e < flat->first[v + 1]; e++)
+                adjacent += stamps[coloring->local[flat->targets[e]]] == stamp;
+            for (uint64_t j = flat->in_first[v]; j < flat->in_first[v + 1]; j++)
+                adjacent += stamps[coloring->local[flat->sources[j]]] == stamp;
+            if (c == 0 || adjacent > pick_count) {
+                pick = candidates[c];
+                pick_count = adjacent;
+            }
+        }
+        size++;
+        stamps[pick] = 0;
+        uint32_t v = coloring->members[pick], next = 0;
+        for (uint64_t e = flat->first[v]; e < flat->first[v + 1]; e++) {
+            uint32_t j = coloring->local[flat->targets[e]];
+            if (stamps[j] == stamp) {
+                stamps[j] = stamp + 1;
+                candidates[next++] = j;
+            }
+        }
+        for (uint64_t e = flat->in_first[v]; e < flat->in_first[v + 1]; e++) {
+            uint32_t j = coloring->local[flat->sources[e]];
+            if (stamps[j] == stamp) {
+                stamps[j] = stamp + 1;
+                candidates[next++] = j;
+            }
+        }
+        count = next;
+        stamp++;
+        if (coloring->deadline != 0 && clock() >= coloring->deadline)
+            coloring->expired = 1;
+    }
+    return size;
+}
+
+/**
+ * Searches the chromatic number of a graph, the largest one of its connected components. The graph keeps
+ * its coloring, DSATUR coloring it when it has none or when it was changed by hand. A component colored
+ * with at most two colors, or with as many colors as a clique it holds, needs no search.
+ * The others are searched exactly until the time budget runs out, the best coloring found so far then
+ * giving an upper bound. A component above COLORING_EXACT_LIMIT nodes only gets a greedy clique as its
+ * lower bound, its adjacency bitsets being too large.
+ *
+ * @param coloring The coloring.
+ * @param view The graph.
+ * @param budget The milliseconds the search may run for, 0 for no limit.
+ * @return 0 if memory is exhausted, the coloring being released, 1 if not.
+*/
+int coloring_chromatic(Coloring* coloring, const GraphView* view, uint32_t budget) {
+    if ((coloring->view != view || coloring->edited) && !coloring_dsatur(coloring, view))
+        return 0;
+    const FlatGraph* flat = &coloring->flat;
+    uint32_t n = flat->node_count;
+    coloring->deadline = budget == 0 ? 0 : clock() + (clock_t) ((uint64_t) budget * CLOCKS_PER_SEC / 1000);
+    coloring->expired = 0;
+    coloring->chromatic = 0;
+    coloring->lower = 0;
+    coloring->branches = 0;
+    coloring->searched = 0;
+    for (uint32_t v = 0; v < n; v++)
+        coloring->local[v] = GRAPH_NO_NODE;
+
+    for (uint32_t root = 0; root < n; root++) {
+        if (coloring->local[root] != GRAPH_NO_NODE)
+            continue;
+        uint32_t s = 0, upper = 0, lower = 1;
+        coloring->local[root] = s;
+        coloring->members[s++] = root;
+        for (uint32_t i = 0; i < s; i++) { // Breadth-first, the members being the queue
+            uint32_t u = coloring->members[i];
+            if (coloring->colors[u] + 1 > upper)
+                upper = coloring->colors[u] + 1;
+            for (uint64_t e = flat->first[u]; e < flat->first[u + 1]; e++) {
+                uint32_t v = flat->targets[e];
+                if (v != u)
+                    lower = 2;
+                if (coloring->local[v] == GRAPH_NO_NODE) {
+                    coloring->local[v] = s;
+                    coloring->members[s++] = v;
+                }
+            }
+            for (uint64_t j = flat->in_first[u]; j < flat->in_first[u + 1]; j++) {
+                uint32_t v = flat->sources[j];
+                if (coloring->local[v] == GRAPH_NO_NODE) {
+                    coloring->local[v] = s;
+                    coloring->members[s++] = v;
+                }
+            }
+        }
+        uint32_t best = upper;
+        if (upper > lower && upper > coloring->lower && !coloring->expired) {
+            coloring->size = s;
+            if (s <= COLORING_EXACT_LIMIT) {
+                if (!search_component(coloring, upper))
+                    return coloring_out_of_memory(coloring);
+                best = coloring->best;
+                lower = coloring->expired ? coloring->bound : best;
+            }
+            else {
+                uint32_t clique = sparse_clique(coloring);
+                if (clique > lower)
+                    lower = clique;
+            }
+        }
+        if (best > coloring->chromatic)
+            coloring->chromatic = best;
+        if (lower > coloring->lower)
+            coloring->lower = lower;
+    }
+    return 1;
+}
@@ -0,0 +1,88 @@
+/**
+ * @file
+ * @brief Graph coloring header file.
+*/
+
+#ifndef COLORING_H_
+#define COLORING_H_
+
+#include <stdint.h>
+#include <time.h>
+#include "heap.h"
+#include "pool.h"
+#include "flat.h"
+
+#define COLORING_NO_COLOR UINT32_MAX /** Color of a node that is not colored yet. */
+#define COLORING_EXACT_LIMIT 4096 /** Largest component whose chromatic number is searched exactly, its adjacency taking n² bits. */
+#define COLORING_CHECK_PERIOD 1024 /** Branches of the exact search between two looks at the clock. */
+#define COLORING_DEFAULT_BUDGET 10000 /** Default milliseconds the exact search may run for. */
+
+/**
+ * Defined type based on a struct holding the nodes a worker of the speculative coloring found in conflict,
+ * and the marks of the colors of the neighbors of the node it colors.
+*/
+typedef struct {
+    uint32_t* nodes;         /** Nodes to color again in the next round. */
+    uint32_t count;          /** Number of nodes. */
+    uint32_t capacity;       /** Capacity of nodes. */
+    uint32_t* marks;         /** Stamp of the node whose neighbors use each color. */
+    uint32_t mark_capacity;  /** Number of colors marks can hold. */
+    uint32_t stamp;          /** Stamp of the node being colored. */
+} ColoringBuffer;
+
+/**
+ * Defined type based on a struct holding a coloring of a graph and the state of the searches giving it.
+ * The direction of the edges is ignored and loops don't constrain anything. The coloring is computed
+ * by DSATUR, each node tracking the colors of its neighbors in a bitset. The chromatic number is
+ * searched by a branch-and-bound over each connected component, whose nodes, adjacency and color
+ * classes are bitsets intersected a word at a time.
+ * The speculative coloring gives the first free color to every node at once, split among workers that
+ * may read the colors of neighbors being colored. The larger node of each pair of neighbors that got
+ * the same color is colored again in the next round, until no conflict is left.
+*/
+typedef struct {
+    ThreadPool* pool;        /** Workers of the speculative coloring. */
+    FlatGraph flat;          /** Outgoing and incoming edges of the graph. */
+    const GraphView* view;   /** Graph of the coloring, NULL until one is computed. */
+    int speculative;         /** 1 if the colors were given by the speculative coloring, 0 by DSATUR. */
+    int edited;              /** 1 once a color was changed by hand, the coloring being possibly improper. */
+    uint32_t capacity;       /** Number of nodes the node arrays can hold. */
+    uint32_t* colors;        /** Color given to each node by DSATUR. */
+    uint32_t color_count;    /** Number of colors used by DSATUR. */
+    uint64_t* saturation;    /** Bitset of the colors of the neighbors of each node, stride words each. */
+    uint32_t stride;         /** Number of words of the bitset of each node. */
+    uint32_t* saturated;     /** Number of colors in the bitset of each node, its saturation degree. */
+    IndexedHeap heap;        /** Nodes not colored yet, the most saturated first. */
+    uint32_t* worklist;      /** Nodes colored by the current round of the speculative coloring, or the candidates of the sparse clique. */
+    uint32_t work_count;     /** Number of nodes of the round. */
+    ColoringBuffer* buffers; /** State of each worker of the speculative coloring. */
+    uint32_t rounds;         /** Rounds of the last speculative coloring. */
+    uint64_t conflicts;      /** Nodes colored again by the last speculative coloring. */
+    uint32_t* members;       /** Nodes of the component being searched, by local id. */
+    uint32_t* local;         /** Local id of each node in its component. */
+    uint32_t* degrees;       /** Number of neighbors of each node of the component, or the round it is a candidate of the sparse clique. */
+    uint64_t* adjacency;     /** Bitset of the neighbors of each node of the component, words each. */
+    uint64_t* classes;       /** Bitset of the nodes of each color in the current branch, words each. */
+    uint64_t* uncolored;     /** Bitset of the nodes without a color in the current branch. */
+    uint64_t* candidates;    /** Bitset of the nodes that can still extend the clique. */
+    uint32_t words;          /** Number of words of a bitset over the component. */
+    uint32_t size;           /** Number of nodes of the component. */
+    uint32_t best;           /** Fewest colors of the component found so far. */
+    uint32_t bound;          /** Size of the clique of the component, a lower bound of best. */
+    clock_t deadline;        /** Clock when the search gives up, 0 for never. */
+    int expired;             /** 1 once the deadline is reached. */
+    uint32_t chromatic;      /** Chromatic number, or the best upper bound found if not exact. */
+    uint32_t lower;          /** Lower bound of the chromatic number: a clique, or a component colored optimally. */
+    int exact;               /** 1 if chromatic is proven to be the chromatic number, lower being equal. */
+    uint64_t branches;       /** Branches of the last exact search. */
+    uint32_t searched;       /** Components of the last exact search that needed a branch-and-bound. */
+    int exhausted;           /** 1 once a worker of the speculative coloring ran out of memory. */
+} Coloring;
+
+void coloring_init(Coloring* coloring, ThreadPool* pool);
+void coloring_free(Coloring* coloring);
+int coloring_dsatur(Coloring* coloring, const GraphView* view);
+int coloring_speculative(Coloring* coloring, const GraphView* view);
+int coloring_chromatic(Coloring* coloring, const GraphView* view, uint32_t budget);
+
+#endif
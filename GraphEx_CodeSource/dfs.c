@@ -0,0 +1,125 @@
+/**
+ * @file
+ * @brief Depth-first search source file.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "dfs.h"
+
+/**
+ * Initializes a search without any graph.
+ *
+ * @param dfs The search.
+*/
+void dfs_init(Dfs* dfs) {
+    memset(dfs, 0, sizeof(Dfs));
+}
+
+/**
+ * Releases a search.
+ *
+ * @param dfs The search.
+*/
+void dfs_free(Dfs* dfs) {
+    free(dfs->visited);
+    free(dfs->stack);
+    dfs_init(dfs);
+}
+
+/**
+ * Starts searching a graph, with no node reached yet.
+ *
+ * @param dfs The search.
+ * @param view The graph.
+ * @return 0 if memory is exhausted, the search being failed, 1 if not.
+*/
+int dfs_begin(Dfs* dfs, const GraphView* view) {
+    if (dfs->failed)
+        return 0;
+    dfs->view = view;
+    uint32_t n = view->node_count;
+    size_t words = ((size_t) n + 63) / 64;
+    if (n > dfs->capacity || dfs->visited == NULL) {
+        free(dfs->visited);
+        dfs->visited = malloc(words * sizeof(uint64_t) + 1);
+        dfs->capacity = n;
+        if (dfs->visited == NULL) {
+            dfs->capacity = 0;
+            dfs->failed = 1;
+            return 0;
+        }
+    }
+    memset(dfs->visited, 0, words * sizeof(uint64_t));
+    dfs->depth = 0;
+    dfs->max_depth = 0;
+    dfs->reached = 0;
+    return 1;
+}
+
+/**
+ * Pushes a node on the path of the search, marking it reached. When the stack can't grow, the
+ * search is failed and its path emptied, which ends it.
+ *
+ * @param dfs The search.
+ * @param node The node id.
+*/
+static void dfs_push(Dfs* dfs, uint32_t node) {
+    if (dfs->depth == dfs->stack_capacity) {
+        uint32_t capacity = dfs->stack_capacity == 0 ? 256 : dfs->stack_capacity * 2;
+        DfsFrame* stack = realloc(dfs->stack, capacity * sizeof(DfsFrame));
+        if (stack == NULL) {
+            dfs->failed = 1;
+            dfs->depth = 0;
+            return;
+        }
+        dfs->stack = stack;
+        dfs->stack_capacity = capacity;
+    }
+    dfs->visited[node >> 6] |= 1ull << (node & 63);
+    dfs->stack[dfs->depth].node = node;
+    view_edges(dfs->view, node, &dfs->stack[dfs->depth].edges);
+    dfs->depth++;
+    if (dfs->depth > dfs->max_depth)
+        dfs->max_depth = dfs->depth;
+    dfs->reached++;
+}
+
+/**
+ * Starts the search again from an unreached node.
+ *
+ * @param dfs The search.
+ * @param root The node id.
+*/
+void dfs_root(Dfs* dfs, uint32_t root) {
+    dfs->depth = 0;
+    dfs_push(dfs, root);
+}
+
+/**
+ * Follows the search to the next unreached node, backtracking as needed.
+ *
+ * @param dfs The search.
+ * @param source Receives the node the edge leaves.
+ * @param target Receives the newly reached node.
+ * @param weight Receives the weight of the edge.
+ * @return 1 if a node was reached, 0 once every node reachable from the root is reached or when memory is exhausted.
+*/
+int dfs_next(Dfs* dfs, uint32_t* source, uint32_t* target, int64_t* weight) {
+    ViewEdge edge;
+    while (dfs->depth > 0) {
+        DfsFrame* top = &dfs->stack[dfs->depth - 1];
+        if (!view_next_edge(&top->edges, &edge)) {
+            dfs->depth--;
+            continue;
+        }
+        if (dfs_visited(dfs, edge.target))
+            continue;
+        *source = top->node;
+        *target = edge.target;
+        *weight = edge.weight;
+        dfs_push(dfs, edge.target);
+        return !dfs->failed;
+    }
+    return 0;
+}
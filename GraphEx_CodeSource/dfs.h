@@ -0,0 +1,55 @@
+/**
+ * @file
+ * @brief Depth-first search header file.
+*/
+
+#ifndef DFS_H_
+#define DFS_H_
+
+#include <stdint.h>
+#include "view.h"
+
+/**
+ * Defined type based on a struct holding a node on the path of a depth-first search.
+*/
+typedef struct {
+    uint32_t node;     /** The node id. */
+    EdgeCursor edges;  /** Walk of the outgoing edges of the node left to follow. */
+} DfsFrame;
+
+/**
+ * Defined type based on a struct holding a depth-first search. The path from the root is an
+ * explicit stack of frames on the heap, so the depth of a search is only bounded by the number
+ * of nodes, however long the chains of the graph are. The search gives its edges one at a time,
+ * walking them through the view so that the instances of a template are never copied.
+*/
+typedef struct {
+    const GraphView* view;   /** Graph being searched. */
+    uint64_t* visited;       /** Bitset of the reached nodes. */
+    uint32_t capacity;       /** Number of nodes visited can hold. */
+    DfsFrame* stack;         /** Path from the root to the current node. */
+    uint32_t depth;          /** Number of frames on the stack. */
+    uint32_t stack_capacity; /** Capacity of stack. */
+    uint32_t max_depth;      /** Deepest stack since dfs_begin(). */
+    uint32_t reached;        /** Nodes reached since dfs_begin(). */
+    int failed;              /** 1 once memory was exhausted, the search giving no edge from then on. */
+} Dfs;
+
+void dfs_init(Dfs* dfs);
+void dfs_free(Dfs* dfs);
+int dfs_begin(Dfs* dfs, const GraphView* view);
+void dfs_root(Dfs* dfs, uint32_t root);
+int dfs_next(Dfs* dfs, uint32_t* source, uint32_t* target, int64_t* weight);
+
+/**
+ * Tells if a node was reached since dfs_begin().
+ *
+ * @param dfs The search.
+ * @param node The node id.
+ * @return 1 if the node was reached, 0 if not.
+*/
+static inline int dfs_visited(const Dfs* dfs, uint32_t node) {
+    return (dfs->visited[node >> 6] >> (node & 63)) & 1;
+}
+
+#endif
@@ -0,0 +1,1097 @@
+/**
+ * @file
+ * @brief Operations executor source file.
+ *
+ * Runs the %operations block of the main graph once the program is linked and lowered to bytecode.
+ * Each operation has a handler in operation_handlers, called with the values of its parameters in
+ * registers: a handler called as an instruction prints its result, a handler called as a parameter
+ * only gives its value.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "executor.h"
+
+#define KEYWORD(word, type, value)
+#define TAG(word, type)
+
+/**
+ * Constant string array holding the name of each operation, indexed by OperationKind.
+*/
+static const char* operation_names[OPERATION_COUNT] = {
+#define OPERATION(word, kind) #word,
+#define COLOR(word, kind)
+#include "keywords.def"
+#undef OPERATION
+#undef COLOR
+};
+
+/**
+ * Constant string array holding the name of each color, indexed by ColorKind.
+*/
+static const char* color_names[COLOR_COUNT] = {
+#define OPERATION(word, kind)
+#define COLOR(word, kind) "#" #word,
+#include "keywords.def"
+#undef OPERATION
+#undef COLOR
+};
+
+#undef KEYWORD
+#undef TAG
+
+/**
+ * Function pointer type of an operation handler.
+ *
+ * @param executor The executor.
+ * @param call The AST_CALL node.
+ * @param args The values of its parameters.
+ * @param print 1 if the call is an instruction whose result must be printed, 0 if it is a parameter.
+ * @param result Receives the value of the call.
+ * @return 0 if a runtime error is found, 1 if not.
+*/
+typedef int (*OperationHandler)(Executor* executor, const AstNode* call, const Value* args, int print, Value* result);
+
+int exec_code(Executor* executor, uint32_t pc);
+
+/**
+ * Writes a node of the graph the operations work on, prefixed by the instances holding it, such as m1.node2.
+ *
+ * @param executor The executor.
+ * @param file The stream written.
+ * @param node The node id.
+*/
+void write_node(Executor* executor, FILE* file, uint32_t node) {
+    const GraphView* view = executor->graph;
+    const Instance* instance;
+    while ((instance = view_instance_of(view, node)) != NULL) {
+        fprintf(file, "%s.", intern_text(executor->program->names, (uint32_t) instance->name));
+        node -= instance->offset;
+        view = instance->shape;
+    }
+    fprintf(file, "%s", intern_text(executor->program->names, view->graph->names[node]));
+}
+
+/**
+ * Prints a node of the graph the operations work on.
+ *
+ * @param executor The executor.
+ * @param node The node id.
+*/
+void print_node(Executor* executor, uint32_t node) {
+    write_node(executor, stdout, node);
+}
+
+/**
+ * Prints an operation call as it is written, with its parameters.
+ *
+ * @param executor The executor.
+ * @param call The AST_CALL node.
+*/
+void print_call(Executor* executor, const AstNode* call) {
+    const Ast* ast = &executor->program->ast;
+    printf("%s(", operation_names[call->sub]);
+    for (uint32_t i = 0; i < call->count; i++) {
+        const AstNode* param = ast_child(ast, call, i);
+        if (i > 0)
+            printf(", ");
+        if (param->kind == AST_CALL)
+            print_call(executor, param);
+        else if (param->kind == AST_COLOR)
+            printf("%s", color_names[param->value]);
+        else if (param->kind == AST_NUM)
+            printf("%d", param->value);
+        else
+            printf("%s", intern_text(executor->program->names, (uint32_t) param->value));
+    }
+    printf(")");
+}
+
+/**
+ * Checks the number of parameters of a call.
+ *
+ * @param executor The executor.
+ * @param call The AST_CALL node.
+ * @param count The number of parameters the operation expects.
+ * @return 0 if the call has another number of parameters, 1 if not.
+*/
+int expect_params(Executor* executor, const AstNode* call, uint32_t count) {
+    if (call->count == count)
+        return 1;
+    fprintf(executor->program->messages, "Runtime Error: %s expects %u parameter%s but got %u at line %u\n",
+        operation_names[call->sub], count, count == 1 ? "" : "s", call->count, call->line);
+    return 0;
+}
+
+/**
+ * Reads a parameter that must be a node: the name of a node, resolved when compiling,
+ * a lambda parameter holding one or a call giving one.
+ *
+ * @param executor The executor.
+ * @param call The AST_CALL node.
+ * @param args The values of its parameters.
+ * @param i The position of the parameter.
+ * @param node Receives the node id.
+ * @return 0 if the parameter is not a node of the graph the operation works on, 1 if it is.
+*/
+int node_param(Executor* executor, const AstNode* call, const Value* args, uint32_t i, uint32_t* node) {
+    if (args[i].kind == VALUE_NODE && (uint64_t) args[i].number < executor->graph->node_count) {
+        *node = (uint32_t) args[i].number;
+        return 1;
+    }
+    fprintf(executor->program->messages, "Runtime Error: parameter %u of %s must be a node at line %u\n", i + 1,
+        operation_names[call->sub], ast_child(&executor->program->ast, call, i)->line);
+    return 0;
+}
+
+/**
+ * Reports that memory is exhausted, which ends the run.
+ *
+ * @param executor The executor.
+ * @param doing What the operation was doing, such as "searching a graph".
+ * @return 0.
+*/
+static int exec_out_of_memory(Executor* executor, const char* doing) {
+    fprintf(executor->program->messages, "Error: out of memory while %s\n", doing);
+    return 0;
+}
+
+/**
+ * Builds the incoming edges of the graphs the first time a search needs them.
+ *
+ * @param executor The executor.
+ * @return 0 if memory is exhausted, 1 if not.
+*/
+int need_reverse(Executor* executor) {
+    if (!executor->reversed && !program_reverse(executor->program))
+        return exec_out_of_memory(executor, "reversing the graphs");
+    executor->reversed = 1;
+    return 1;
+}
+
+/**
+ * Starts the thread pool the first time an operation needs it.
+ *
+ * @param executor The executor.
+*/
+void need_pool(Executor* executor) {
+    if (!executor->pooled)
+        pool_init(&executor->pool, executor->options->threads);
+    executor->pooled = 1;
+}
+
+/**
+ * Gives the breadth-first search of a traversal at the current depth, creating it the first time a
+ * traversal runs that deep. The depth is bounded by the nesting of the lambdas, so the array grows
+ * by one search at a time; each search is allocated on its own and doesn't move when it grows.
+ *
+ * @param executor The executor, whose pool is started.
+ * @return The search, NULL if memory is exhausted.
+*/
+static Bfs* depth_bfs(Executor* executor) {
+    if (executor->bfs_busy == executor->bfs_depths) {
+        Bfs** searches = realloc(executor->bfs, ((size_t) executor->bfs_depths + 1) * sizeof(Bfs*));
+        if (searches == NULL)
+            return NULL;
+        executor->bfs = searches;
+        if ((searches[executor->bfs_depths] = malloc(sizeof(Bfs))) == NULL)
+            return NULL;
+        bfs_init(searches[executor->bfs_depths++], &executor->pool, !executor->options->unordered);
+    }
+    return executor->bfs[executor->bfs_busy];
+}
+
+/**
+ * Gives the depth-first search of a traversal at the current depth, creating it the first time a
+ * traversal runs that deep.
+ *
+ * @param executor The executor.
+ * @return The search, NULL if memory is exhausted.
+*/
+static Dfs* depth_dfs(Executor* executor) {
+    if (executor->dfs_busy == executor->dfs_depths) {
+        Dfs** searches = realloc(executor->dfs, ((size_t) executor->dfs_depths + 1) * sizeof(Dfs*));
+        if (searches == NULL)
+            return NULL;
+        executor->dfs = searches;
+        if ((searches[executor->dfs_depths] = malloc(sizeof(Dfs))) == NULL)
+            return NULL;
+        dfs_init(searches[executor->dfs_depths++]);
+    }
+    return executor->dfs[executor->dfs_busy];
+}
+
+/**
+ * Prints the negative cycle found by a Bellman-Ford search, with the line where it is declared.
+ *
+ * @param executor The executor.
+ * @param call The AST_CALL node.
+*/
+void report_cycle(Executor* executor, const AstNode* call) {
+    const PathEngine* paths = &executor->paths;
+    FILE* messages = executor->program->messages;
+    fprintf(messages, "Runtime Error: %s found a negative cycle ", operation_names[call->sub]);
+    for (uint32_t i = 0; i < paths->cycle_length; i++) {
+        if (i > 0)
+            fprintf(messages, " -> ");
+        write_node(executor, messages, paths->path[i]);
+    }
+    fprintf(messages, " (cost %lld) declared at line %u, reached at line %u\n", (long long) paths->cycle_cost, paths->cycle_line,
+        call->line);
+}
+
+/**
+ * Runs a shortest path search and reports a graph with negative weights, or with a negative cycle for bellman.
+ *
+ * @param executor The executor.
+ * @param call The AST_CALL node.
+ * @param source The source node id.
+ * @param target The target node id, GRAPH_NO_NODE to reach every node.
+ * @return 0 if the search can't give the shortest paths, 1 if it does.
+*/
+int run_search(Executor* executor, const AstNode* call, uint32_t source, uint32_t target) {
+    PathEngine* paths = &executor->paths;
+    int valid = 1;
+    const char* method;
+    uint64_t settled;
+    executor->from_hierarchy = 0;
+    if (target != GRAPH_NO_NODE && executor->hierarchical && executor->graph == executor->main && call->sub != OP_DIJKSTRAGENERALISE) {
+        executor->cost = hierarchy_query(&executor->hierarchy, source, target);
+        executor->from_hierarchy = 1;
+        method = "contraction hierarchy";
+    }
+    else if (call->sub == OP_BELLMAN) {
+        valid = paths_bellman(paths, executor->graph, source);
+        if (paths->failed)
+            return exec_out_of_memory(executor, "searching a graph");
+        if (!valid) {
+            report_cycle(executor, call);
+            return 0;
+        }
+        method = "bellman-ford";
+    }
+    else if (target == GRAPH_NO_NODE) {
+        valid = paths_dijkstra(paths, executor->graph, source, target);
+        method = "dijkstra";
+    }
+    else if (call->sub == OP_DIJKSTRAGENERALISE) { // Goal directed by the landmark bounds
+        if (!need_reverse(executor))
+            return 0;
+        valid = paths_landmarks(paths, executor->graph, target)
+            && paths_astar(paths, executor->graph, source, target, paths_landmark_bound, &paths->landmarks);
+        method = "A* with landmarks";
+    }
+    else {
+        if (!need_reverse(executor))
+            return 0;
+        valid = paths_bidirectional(paths, executor->graph, source, target);
+        method = "bidirectional dijkstra";
+    }
+    if (paths->failed)
+        return exec_out_of_memory(executor, "searching a graph");
+    if (!valid) {
+        fprintf(executor->program->messages, "Runtime Error: %s needs non-negative weights at line %u, bellman allows negative ones\n",
+            operation_names[call->sub], call->line);
+        return 0;
+    }
+    if (executor->from_hierarchy)
+        settled = executor->hierarchy.settled_count;
+    else {
+        settled = paths->settled_count;
+        executor->cost = target == GRAPH_NO_NODE ? PATH_INFINITY : paths_cost(paths, target);
+    }
+    if (executor->stats) {
+        printf("[stats] ");
+        print_call(executor, call);
+        printf(": %s, %llu nodes settled\n", method, (unsigned long long) settled);
+    }
+    return 1;
+}
+
+/**
+ * dijkstra(source): distances of every node reachable from the source.
+ * Prints each reached node with its distance, gives the number of reached nodes.
+*/
+int op_dijkstra(Executor* executor, const AstNode* call, const Value* args, int print, Value* result) {
+    uint32_t source;
+    if (!expect_params(executor, call, 1) || !node_param(executor, call, args, 0, &source))
+        return 0;
+    if (!run_search(executor, call, source, GRAPH_NO_NODE))
+        return 0;
+    result->kind = VALUE_NUMBER;
+    result->number = (int64_t) executor->paths.settled_count;
+    if (print) {
+        print_call(executor, call);
+        printf(":\n");
+        for (uint32_t node = 0; node < executor->graph->node_count; node++) {
+            int64_t distance = paths_distance(&executor->paths, node);
+            if (distance == PATH_INFINITY)
+                continue;
+            printf("    ");
+            print_node(executor, node);
+            printf(" %lld\n", (long long) distance);
+        }
+    }
+    return 1;
+}
+
+/**
+ * getchemin(source, target): shortest path between two nodes, searched from both ends.
+ * dijkstrageneralise(source, target): the same path, searched by A* with landmark lower bounds.
+ * Prints the nodes of the path and its cost, gives the cost or no value if there is no path.
+*/
+int op_getchemin(Executor* executor, const AstNode* call, const Value* args, int print, Value* result) {
+    uint32_t source, target;
+    if (!expect_params(executor, call, 2) || !node_param(executor, call, args, 0, &source)
+        || !node_param(executor, call, args, 1, &target))
+        return 0;
+    if (!run_search(executor, call, source, target))
+        return 0;
+    int64_t cost = executor->cost;
+    result->kind = cost == PATH_INFINITY ? VALUE_NONE : VALUE_NUMBER;
+    result->number = cost;
+    if (print) {
+        uint32_t length = 0;
+        const uint32_t* path = NULL;
+        if (cost != PATH_INFINITY && executor->from_hierarchy) {
+            length = hierarchy_path(&executor->hierarchy, source, target);
+            path = executor->hierarchy.path;
+        }
+        else if (cost != PATH_INFINITY) {
+            length = paths_rebuild(&executor->paths, target);
+            path = executor->paths.path;
+        }
+        if (executor->hierarchy.failed || executor->paths.failed)
+            return exec_out_of_memory(executor, "rebuilding a path");
+        print_call(executor, call);
+        if (cost == PATH_INFINITY) {
+            printf(": no path\n");
+            return 1;
+        }
+        printf(": ");
+        for (uint32_t i = 0; i < length; i++) {
+            if (i > 0)
+                printf(" -> ");
+            print_node(executor, path[i]);
+        }
+        printf(" (cost %lld)\n", (long long) cost);
+    }
+    return 1;
+}
+
+/**
+ * mincost(source, target, amount): minimum cost flow of amount units between two nodes, the edges
+ * carrying at most their capacity. Prints the flow of each edge carrying some, gives the cost,
+ * or no value if the flow is unbounded.
+ *
+ * @param executor The executor.
+ * @param call The AST_CALL node.
+ * @param source The node sending the flow.
+ * @param target The node receiving it.
+ * @param amount The units of flow, FLOW_INFINITE for a maximum flow.
+ * @param print 1 if the flow must be printed.
+ * @param result Receives the cost.
+ * @return 0 if a runtime error is found, 1 if not.
+*/
+int run_flow(Executor* executor, const AstNode* call, uint32_t source, uint32_t target, int64_t amount, int print, Value* result) {
+    FlowEngine* flow = &executor->flow;
+    int solved = flow_solve(flow, executor->graph, source, target, amount, executor->options->flow_scaling);
+    if (flow->failed)
+        return exec_out_of_memory(executor, "searching a flow");
+    if (!solved) {
+        fprintf(executor->program->messages, "Runtime Error: %s found a negative cycle of edges that can carry flow at line %u\n",
+            operation_names[call->sub], call->line);
+        return 0;
+    }
+    result->kind = flow->unbounded ? VALUE_NONE : VALUE_NUMBER;
+    result->number = flow->cost;
+    if (print) {
+        print_call(executor, call);
+        if (flow->unbounded)
+            printf(": unbounded flow\n");
+        else if (amount != FLOW_INFINITE && flow->flow < amount)
+            printf(": only %lld unit%s can flow, at cost %lld\n", (long long) flow->flow, flow->flow == 1 ? "" : "s",
+                (long long) flow->cost);
+        else
+            printf(": flow %lld at cost %lld\n", (long long) flow->flow, (long long) flow->cost);
+        const FlatGraph* flat = &flow->flat;
+        for (uint32_t u = 0; u < flat->node_count && !flow->unbounded; u++) {
+            for (uint64_t e = flat->first[u]; e < flat->first[u + 1]; e++) {
+                if (flow_edge(flow, e) <= 0)
+                    continue;
+                printf("    ");
+                print_node(executor, u);
+                printf(" -> ");
+                print_node(executor, flat->targets[e]);
+                printf(" %lld\n", (long long) flow_edge(flow, e));
+            }
+        }
+    }
+    if (executor->stats) {
+        printf("[stats] ");
+        print_call(executor, call);
+        printf(": %s, %u phase%s, %llu augmentation%s, %llu nodes settled\n",
+            flow->scaling ? "capacity scaling" : "successive shortest paths", flow->phases, flow->phases == 1 ? "" : "s",
+            (unsigned long long) flow->augmentations, flow->augmentations == 1 ? "" : "s",
+            (unsigned long long) flow->settled_total);
+    }
+    return 1;
+}
+
+/**
+ * mincost(source, target): cost of the shortest path between two nodes, or of the minimum cost maximum
+ * flow between them if the graph has capacities.
+ * mincost(source, target, amount): cost of the minimum cost flow of amount units between two nodes.
+ * Prints and gives the cost, or no value if there is no path.
+*/
+int op_mincost(Executor* executor, const AstNode* call, const Value* args, int print, Value* result) {
+    uint32_t source, target;
+    if ((call->count != 3 && !expect_params(executor, call, 2)) || !node_param(executor, call, args, 0, &source)
+        || !node_param(executor, call, args, 1, &target))
+        return 0;
+    if (call->count == 3) {
+        if (args[2].kind != VALUE_NUMBER || args[2].number < 0) {
+            fprintf(executor->program->messages, "Runtime Error: parameter 3 of %s must be a non-negative number at line %u\n",
+                operation_names[call->sub], ast_child(&executor->program->ast, call, 2)->line);
+            return 0;
+        }
+        return run_flow(executor, call, source, target, args[2].number, print, result);
+    }
+    if (executor->graph->capacitated)
+        return run_flow(executor, call, source, target, FLOW_INFINITE, print, result);
+    if (!run_search(executor, call, source, target))
+        return 0;
+    int64_t cost = executor->cost;
+    result->kind = cost == PATH_INFINITY ? VALUE_NONE : VALUE_NUMBER;
+    result->number = cost;
+    if (print) {
+        print_call(executor, call);
+        if (cost == PATH_INFINITY)
+            printf(": no path\n");
+        else
+            printf(": %lld\n", (long long) cost);
+    }
+    return 1;
+}
+
+/**
+ * bellman(source): distances of every node reachable from the source, with negative weights allowed.
+ * bellman(source, target): shortest path between two nodes, with negative weights allowed.
+ * Prints and gives the same results as dijkstra and getchemin, or reports a negative cycle.
+*/
+int op_bellman(Executor* executor, const AstNode* call, const Value* args, int print, Value* result) {
+    if (call->count == 2)
+        return op_getchemin(executor, call, args, print, result);
+    return op_dijkstra(executor, call, args, print, result);
+}
+
+/**
+ * stop(): ends the innermost traverse running the call. It is only an operation in a lambda body.
+*/
+int op_stop(Executor* executor, const AstNode* call, const Value* args, int print, Value* result) {
+    (void) args;
+    (void) print;
+    (void) result;
+    if (!expect_params(executor, call, 0))
+        return 0;
+    executor->stopping = 1;
+    return 1;
+}
+
+/**
+ * kruskal(): minimum spanning forest of the graph, the edges being taken by increasing weight.
+ * prime(): the same forest, grown by Prim from the first node of each component.
+ * Prints the edges of the forest and its cost, gives the cost.
+*/
+int op_kruskal(Executor* executor, const AstNode* call, const Value* args, int print, Value* result) {
+    (void) args;
+    if (!expect_params(executor, call, 0))
+        return 0;
+    Spanning* spanning = &executor->spanning;
+    int built;
+    if (call->sub == OP_KRUSKAL) {
+        need_pool(executor);
+        built = spanning_kruskal(spanning, executor->graph);
+    }
+    else
+        built = spanning_prim(spanning, executor->graph);
+    if (!built)
+        return exec_out_of_memory(executor, "building a spanning tree");
+    result->kind = VALUE_NUMBER;
+    result->number = spanning->cost;
+    if (print) {
+        print_call(executor, call);
+        printf(": %u edge%s (cost %lld)\n", spanning->edge_count, spanning->edge_count == 1 ? "" : "s",
+            (long long) spanning->cost);
+        for (uint32_t i = 0; i < spanning->edge_count; i++) {
+            uint64_t edge = spanning->edges[i];
+            printf("    ");
+            print_node(executor, flat_source(&spanning->flat, edge));
+            printf(" -> ");
+            print_node(executor, spanning->flat.targets[edge]);
+            printf(" %lld\n", (long long) spanning->flat.weights[edge]);
+        }
+    }
+    if (executor->stats) {
+        printf("[stats] ");
+        print_call(executor, call);
+        if (call->sub == OP_KRUSKAL)
+            printf(": %llu candidates sorted in %u radix passes by %u threads, %llu examined\n",
+                (unsigned long long) spanning->candidate_count, spanning->passes, executor->pool.count,
+                (unsigned long long) spanning->examined);
+        else
+            printf(": %llu edges examined\n", (unsigned long long) spanning->examined);
+    }
+    return 1;
+}
+
+/**
+ * Prints a color of a coloring: its palette name when the palette has enough colors, its index otherwise.
+ *
+ * @param coloring The coloring.
+ * @param color The color.
+*/
+void print_color(const Coloring* coloring, uint32_t color) {
+    if (coloring->color_count <= COLOR_COUNT)
+        printf("%s", color_names[color]);
+    else
+        printf("color %u", color);
+}
+
+/**
+ * Gives the colors of the coloring of the graph to its nodes, when the palette has enough colors.
+ *
+ * @param executor The executor.
+ * @return 0 if memory is exhausted, 1 if not.
+*/
+int keep_colors(Executor* executor) {
+    const Coloring* coloring = &executor->coloring;
+    if (coloring->color_count > COLOR_COUNT)
+        return 1;
+    for (uint32_t node = 0; node < executor->graph->node_count; node++) {
+        if (!view_set_color(executor->graph, node, (int) coloring->colors[node]))
+            return exec_out_of_memory(executor, "coloring a graph");
+    }
+    return 1;
+}
+
+/**
+ * Gives the milliseconds elapsed since a moment.
+ *
+ * @param start The moment, read from the monotonic clock.
+ * @return The wall-clock time elapsed.
+*/
+double elapsed_ms(const struct timespec* start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double) (now.tv_sec - start->tv_sec) * 1000.0 + (double) (now.tv_nsec - start->tv_nsec) / 1e6;
+}
+
+/**
+ * colorergraph(): colors the graph with DSATUR, neighbors getting distinct colors. The nodes keep palette colors.
+ * colorergraph(1): colors it with the speculative coloring run by the thread pool, usually with a few more colors.
+ * Prints the color of each node, gives the number of colors.
+*/
+int op_colorergraph(Executor* executor, const AstNode* call, const Value* args, int print, Value* result) {
+    if (call->count > 1 && !expect_params(executor, call, 1))
+        return 0;
+    if (call->count == 1 && args[0].kind != VALUE_NUMBER) {
+        fprintf(executor->program->messages, "Runtime Error: parameter 1 of %s must be a number at line %u\n",
+            operation_names[call->sub], ast_child(&executor->program->ast, call, 0)->line);
+        return 0;
+    }
+    Coloring* coloring = &executor->coloring;
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int colored;
+    if (call->count == 1 && args[0].number != 0) {
+        need_pool(executor);
+        colored = coloring_speculative(coloring, executor->graph);
+    }
+    else
+        colored = coloring_dsatur(coloring, executor->graph);
+    if (!colored)
+        return exec_out_of_memory(executor, "coloring a graph");
+    double time = elapsed_ms(&start);
+    if (!keep_colors(executor))
+        return 0;
+    result->kind = VALUE_NUMBER;
+    result->number = coloring->color_count;
+    if (print) {
+        print_call(executor, call);
+        printf(": %u color%s\n", coloring->color_count, coloring->color_count == 1 ? "" : "s");
+        for (uint32_t node = 0; node < executor->graph->node_count; node++) {
+            printf("    ");
+            print_node(executor, node);
+            printf(" ");
+            print_color(coloring, coloring->colors[node]);
+            printf("\n");
+        }
+    }
+    if (executor->stats) {
+        printf("[stats] ");
+        print_call(executor, call);
+        if (coloring->speculative)
+            printf(": speculative, %u colors over %u nodes in %u rounds (%llu colored again), %u threads, %.3f ms\n",
+                coloring->color_count, executor->graph->node_count, coloring->rounds,
+                (unsigned long long) coloring->conflicts, executor->pool.count, time);
+        else
+            printf(": dsatur, %u colors over %u nodes, %.3f ms\n", coloring->color_count, executor->graph->node_count, time);
+    }
+    return 1;
+}
+
+/**
+ * colorier(node): color of a node, DSATUR coloring the graph if the node has none.
+ * colorier(node, color): gives a palette color to a node.
+ * Prints and gives the color, a palette color when the palette has enough colors, its index otherwise.
+*/
+int op_colorier(Executor* executor, const AstNode* call, const Value* args, int print, Value* result) {
+    uint32_t node;
+    if ((call->count != 2 && !expect_params(executor, call, 1)) || !node_param(executor, call, args, 0, &node))
+        return 0;
+    if (call->count == 2 && args[1].kind != VALUE_COLOR) {
+        fprintf(executor->program->messages, "Runtime Error: parameter 2 of %s must be a color at line %u\n",
+            operation_names[call->sub], ast_child(&executor->program->ast, call, 1)->line);
+        return 0;
+    }
+    Coloring* coloring = &executor->coloring;
+    result->kind = VALUE_COLOR;
+    if (call->count == 2) {
+        result->number = args[1].number;
+        if (!view_set_color(executor->graph, node, (int) args[1].number))
+            return exec_out_of_memory(executor, "coloring a graph");
+        if (coloring->view == executor->graph) {
+            coloring->colors[node] = (uint32_t) args[1].number;
+            if (coloring->colors[node] >= coloring->color_count)
+                coloring->color_count = coloring->colors[node] + 1;
+            coloring->edited = 1;
+        }
+    }
+    else if (view_color(executor->graph, node) != VIEW_NO_COLOR)
+        result->number = view_color(executor->graph, node);
+    else {
+        if (coloring->view != executor->graph) {
+            if (!coloring_dsatur(coloring, executor->graph))
+                return exec_out_of_memory(executor, "coloring a graph");
+            if (!keep_colors(executor))
+                return 0;
+        }
+        result->kind = coloring->color_count <= COLOR_COUNT ? VALUE_COLOR : VALUE_NUMBER;
+        result->number = coloring->colors[node];
+    }
+    if (print) {
+        print_call(executor, call);
+        if (result->kind == VALUE_COLOR)
+            printf(": %s\n", color_names[result->number]);
+        else
+            printf(": color %u\n", (uint32_t) result->number);
+    }
+    return 1;
+}
+
+/**
+ * nombrechromatique(): chromatic number of the graph, the fewest colors its nodes can have with neighbors
+ * colored differently, starting from the coloring of the graph unless colorier changed it. Prints and gives it,
+ * or the best upper bound found once the time budget is exceeded.
+*/
+int op_nombrechromatique(Executor* executor, const AstNode* call, const Value* args, int print, Value* result) {
+    (void) args;
+    if (!expect_params(executor, call, 0))
+        return 0;
+    Coloring* coloring = &executor->coloring;
+    if (!coloring_chromatic(coloring, executor->graph, executor->options->color_budget))
+        return exec_out_of_memory(executor, "coloring a graph");
+    result->kind = VALUE_NUMBER;
+    result->number = coloring->chromatic;
+    if (print) {
+        print_call(executor, call);
+        if (coloring->lower == coloring->chromatic)
+            printf(": %u\n", coloring->chromatic);
+        else
+            printf(": at most %u, at least %u (%s)\n", coloring->chromatic, coloring->lower, coloring->expired
+                ? "time budget exceeded" : "component too large to search");
+    }
+    if (executor->stats) {
+        printf("[stats] ");
+        print_call(executor, call);
+        printf(": %s gave %u colors, %u components searched in %llu branches\n",
+            coloring->speculative ? "speculative coloring" : "dsatur", coloring->color_count,
+            coloring->searched, (unsigned long long) coloring->branches);
+    }
+    return 1;
+}
+
+/**
+ * Constant OperationHandler array holding the handler of each operation, indexed by OperationKind.
+ * Operations without a handler are reserved words that don't run anything yet.
+*/
+static const OperationHandler operation_handlers[OPERATION_COUNT] = {
+    [OP_NOMBRECHROMATIQUE] = op_nombrechromatique,
+    [OP_COLORIER] = op_colorier,
+    [OP_COLORERGRAPH] = op_colorergraph,
+    [OP_DIJKSTRA] = op_dijkstra,
+    [OP_GETCHEMIN] = op_getchemin,
+    [OP_MINCOST] = op_mincost,
+    [OP_DIJKSTRAGENERALISE] = op_getchemin,
+    [OP_BELLMAN] = op_bellman,
+    [OP_KRUSKAL] = op_kruskal,
+    [OP_PRIME] = op_kruskal,
+    [OP_STOP] = op_stop,
+};
+
+/**
+ * Runs the body of a traverse lambda for one edge, its parameters being written in their registers.
+ *
+ * @param executor The executor.
+ * @param traverse The BC_TRAVERSE instruction.
+ * @param source The node the edge leaves.
+ * @param target The node the edge reaches.
+ * @param weight The weight of the edge.
+ * @return 0 if a runtime error is found, 1 if not.
+*/
+static inline int visit_edge(Executor* executor, const Instruction* traverse, uint32_t source, uint32_t target, int64_t weight) {
+    Value* params = &executor->registers[traverse->a];
+    params[0].number = source;
+    params[1].number = target;
+    params[2].number = weight;
+    return exec_code(executor, (uint32_t) (traverse - executor->code.code) + 1);
+}
+
+/**
+ * Runs a breadth-first traversal, level by level.
+ *
+ * @param executor The executor.
+ * @param traverse The BC_TRAVERSE instruction.
+ * @return 0 if a runtime error is found, 1 if not.
+*/
+int traverse_bfs(Executor* executor, const Instruction* traverse) {
+    const GraphView* view = executor->graph;
+    need_pool(executor);
+    if (!need_reverse(executor)) // Bottom-up steps walk the incoming edges
+        return 0;
+    Bfs* bfs = depth_bfs(executor); // The outer traversals keep the searches of their own depths
+    if (bfs == NULL)
+        return exec_out_of_memory(executor, "nesting traversals");
+    executor->bfs_busy++;
+
+    int valid = bfs_begin(bfs, view);
+    for (uint32_t root = 0; root < view->node_count && valid && !bfs->failed && !executor->stopping; root++) {
+        if (bfs_visited(bfs, root))
+            continue;
+        bfs_root(bfs, root);
+        uint32_t count;
+        while (valid && !executor->stopping && (count = bfs_step(bfs)) > 0) {
+            for (uint32_t i = 0; i < count && valid && !executor->stopping; i++)
+                valid = visit_edge(executor, traverse, bfs->parents[i], bfs->frontier[i], bfs->parent_weights[i]);
+        }
+    }
+    if (bfs->failed) {
+        executor->bfs_busy--;
+        return exec_out_of_memory(executor, "traversing a graph");
+    }
+    if (executor->stats) {
+        printf("[stats] traverse at line %u: breadth-first, %u nodes reached in %u levels (%u bottom-up), %u threads%s\n",
+            ast_node(&executor->program->ast, traverse->ast)->line, bfs->reached, bfs->levels, bfs->bottom_up_levels, executor->pool.count,
+            executor->stopping ? ", stopped" : "");
+    }
+
+    executor->bfs_busy--;
+    return valid;
+}
+
+/**
+ * Runs a depth-first traversal, giving the edges in the order they are followed.
+ *
+ * @param executor The executor.
+ * @param traverse The BC_TRAVERSE instruction.
+ * @return 0 if a runtime error is found, 1 if not.
+*/
+int traverse_dfs(Executor* executor, const Instruction* traverse) {
+    const GraphView* view = executor->graph;
+    Dfs* dfs = depth_dfs(executor); // The outer traversals keep the searches of their own depths
+    if (dfs == NULL)
+        return exec_out_of_memory(executor, "nesting traversals");
+    executor->dfs_busy++;
+
+    int valid = dfs_begin(dfs, view);
+    for (uint32_t root = 0; root < view->node_count && valid && !dfs->failed && !executor->stopping; root++) {
+        if (dfs_visited(dfs, root))
+            continue;
+        dfs_root(dfs, root);
+        uint32_t source, target;
+        int64_t weight;
+        while (valid && !executor->stopping && dfs_next(dfs, &source, &target, &weight))
+            valid = visit_edge(executor, traverse, source, target, weight);
+    }
+    if (dfs->failed) {
+        executor->dfs_busy--;
+        return exec_out_of_memory(executor, "traversing a graph");
+    }
+    if (executor->stats) {
+        printf("[stats] traverse at line %u: depth-first, %u nodes reached, %u deep%s\n",
+            ast_node(&executor->program->ast, traverse->ast)->line, dfs->reached, dfs->max_depth, executor->stopping ? ", stopped" : "");
+    }
+
+    executor->dfs_busy--;
+    return valid;
+}
+
+/**
+ * Runs a traverse: its lambda is called for each edge of a search of the graph, the nodes being
+ * searched from the first one and then from each node that is still unreached, in declaration order.
+ * A breadth-first traversal gives the edges level by level, each level in the order of a sequential
+ * search unless the run allows any order. A stop() in the lambda ends the traversal.
+ *
+ * @param executor The executor.
+ * @param traverse The BC_TRAVERSE instruction.
+ * @return 0 if a runtime error is found, 1 if not.
+*/
+int exec_traverse(Executor* executor, const Instruction* traverse) {
+    Value* params = &executor->registers[traverse->a];
+    params[0].kind = VALUE_NODE;
+    params[1].kind = VALUE_NODE;
+    params[2].kind = VALUE_NUMBER;
+
+    GraphView* graph = executor->graph;
+    executor->graph = &executor->program->views[traverse->b];
+    int valid = traverse->sub == SEARCH_BFS ? traverse_bfs(executor, traverse) : traverse_dfs(executor, traverse);
+    executor->graph = graph;
+    executor->stopping = 0; // The stop only ends the innermost traversal
+    return valid;
+}
+
+/**
+ * Compares two values. A comparison never holds when one of them has no value.
+ *
+ * @param comparison The comparison TokenType.
+ * @param left The left value.
+ * @param right The right value.
+ * @return 1 if the comparison holds, 0 if not.
+*/
+static inline int compare(uint8_t comparison, const Value* left, const Value* right) {
+    if (left->kind == VALUE_NONE || right->kind == VALUE_NONE)
+        return 0;
+    switch (comparison) {
+        case EQ_TOKEN: return left->number == right->number;
+        case NEQ_TOKEN: return left->number != right->number;
+        case GT_TOKEN: return left->number > right->number;
+        case LT_TOKEN: return left->number < right->number;
+        case LEQ_TOKEN: return left->number <= right->number;
+        case BEQ_TOKEN: return left->number >= right->number;
+        default: return 0;
+    }
+}
+
+/**
+ * Reports the node or graph of a BC_UNKNOWN instruction.
+ *
+ * @param executor The executor.
+ * @param instruction The instruction.
+*/
+void report_unknown(Executor* executor, const Instruction* instruction) {
+    const AstNode* node = ast_node(&executor->program->ast, instruction->ast);
+    const char* name = intern_text(executor->program->names, (uint32_t) node->value);
+    if (node->kind == AST_TRAVERSE)
+        fprintf(executor->program->messages, "Runtime Error: unknown graph %s in traverse at line %u\n", name, node->line);
+    else
+        fprintf(executor->program->messages, "Runtime Error: unknown node %s in %s at line %u\n", name,
+            operation_names[instruction->sub], node->line);
+}
+
+/*
+ * The instructions are dispatched by jumping from one to the next through a table of label addresses
+ * when the compiler allows it, by a switch otherwise.
+*/
+#ifdef __GNUC__
+#define DISPATCH() do { instruction = &code[pc]; goto *dispatch[instruction->op]; } while (0)
+#define TARGET(name) do_##name:
+#else
+#define DISPATCH() goto next
+#define TARGET(name) case name:
+#endif
+
+/**
+ * Runs the bytecode from an instruction until its BC_RETURN: the %operations block, or the body
+ * of a lambda for one edge. A stop() returns at once, leaving the traversal to end.
+ *
+ * @param executor The executor.
+ * @param pc The position of the first instruction.
+ * @return 0 if a runtime error is found, 1 if not.
+*/
+int exec_code(Executor* executor, uint32_t pc) {
+    const Instruction* code = executor->code.code;
+    const Ast* ast = &executor->program->ast;
+    Value* registers = executor->registers;
+    const Instruction* instruction;
+#ifdef __GNUC__
+    static void* const dispatch[OPCODE_COUNT] = {
+#define OPCODE(name) &&do_##name,
+        BYTECODE_OPCODES(OPCODE)
+#undef OPCODE
+    };
+    DISPATCH();
+#else
+next:
+    instruction = &code[pc];
+    switch (instruction->op) {
+#endif
+    TARGET(BC_NUMBER)
+        registers[instruction->a].kind = VALUE_NUMBER;
+        registers[instruction->a].number = instruction->value;
+        pc++;
+        DISPATCH();
+    TARGET(BC_NODE)
+        registers[instruction->a].kind = VALUE_NODE;
+        registers[instruction->a].number = instruction->value;
+        pc++;
+        DISPATCH();
+    TARGET(BC_COLOR)
+        registers[instruction->a].kind = VALUE_COLOR;
+        registers[instruction->a].number = instruction->value;
+        pc++;
+        DISPATCH();
+    TARGET(BC_MOVE)
+        registers[instruction->a] = registers[instruction->b];
+        pc++;
+        DISPATCH();
+    TARGET(BC_CALL) {
+        Value* result = &registers[instruction->a];
+        result->kind = VALUE_NONE;
+        result->number = 0;
+        OperationHandler handler = operation_handlers[instruction->sub];
+        if (handler != NULL && !handler(executor, ast_node(ast, instruction->ast), &registers[instruction->b],
+                instruction->flags & BC_PRINT, result))
+            return 0;
+        if (executor->stopping)
+            return 1;
+        pc++;
+        DISPATCH();
+    }
+    TARGET(BC_TEST) {
+        const Value* value = &registers[instruction->a];
+        int holds = value->kind == VALUE_NODE || (value->kind == VALUE_NUMBER && value->number != 0);
+        pc = holds ? pc + 1 : (uint32_t) instruction->value;
+        DISPATCH();
+    }
+    TARGET(BC_COMPARE)
+        pc = compare(instruction->sub, &registers[instruction->a], &registers[instruction->b]) ? pc + 1
+            : (uint32_t) instruction->value;
+        DISPATCH();
+    TARGET(BC_TRAVERSE)
+        if (!exec_traverse(executor, instruction))
+            return 0;
+        pc = (uint32_t) instruction->value;
+        DISPATCH();
+    TARGET(BC_UNKNOWN)
+        report_unknown(executor, instruction);
+        return 0;
+    TARGET(BC_RETURN)
+        return 1;
+#ifndef __GNUC__
+    }
+    return 1;
+#endif
+}
+
+#undef DISPATCH
+#undef TARGET
+
+/**
+ * Loads the contraction hierarchy of the main graph, or builds and saves it when its file is missing
+ * or was built for another graph. Graphs with negative weights keep the plain searches.
+ *
+ * @param executor The executor.
+ * @param path The path of the hierarchy file.
+*/
+void prepare_hierarchy(Executor* executor, const char* path) {
+    Hierarchy* hierarchy = &executor->hierarchy;
+    if (hierarchy_load(hierarchy, path, executor->graph)) {
+        executor->hierarchical = 1;
+        if (executor->stats)
+            printf("[stats] contraction hierarchy loaded from \"%s\": %llu shortcuts\n", path,
+                (unsigned long long) hierarchy->shortcut_count);
+        return;
+    }
+    if (!hierarchy_build(hierarchy, executor->graph)) { // The searches run without it
+        if (executor->stats)
+            printf("[stats] no contraction hierarchy: %s\n", hierarchy->failed ? "out of memory" : "the graph has negative weights");
+        return;
+    }
+    executor->hierarchical = 1;
+    int saved = hierarchy_save(hierarchy, path);
+    if (!saved)
+        printf("Warning: failed to save the contraction hierarchy at path \"%s\"\n", path);
+    if (executor->stats)
+        printf("[stats] contraction hierarchy built%s: %llu shortcuts\n", saved ? " and saved" : "",
+            (unsigned long long) hierarchy->shortcut_count);
+}
+
+/**
+ * Tells which operations run something, the others being reserved words whose calls do nothing.
+ *
+ * @param runnable Receives 1 for each operation that has a handler, 0 for the others, indexed by OperationKind.
+*/
+void exec_runnable(uint8_t* runnable) {
+    for (uint32_t i = 0; i < OPERATION_COUNT; i++)
+        runnable[i] = operation_handlers[i] != NULL;
+}
+
+/**
+ * Runs the %operations block of the main graph of a linked program.
+ *
+ * @param program The program.
+ * @param options The options of the run.
+ * @return 0 if a semantic error is found in the operations or a runtime error, 1 if not.
+*/
+int exec_program(Program* program, const ExecOptions* options) {
+    Executor executor = {0};
+    executor.program = program;
+    executor.main = &program->views[program->graph_count - 1];
+    executor.graph = executor.main;
+    executor.options = options;
+    executor.stats = options->stats;
+    int valid = 1;
+    if (options->code != NULL) // The operations of an image were lowered when it was saved
+        executor.code = *options->code;
+    else {
+        uint8_t runnable[OPERATION_COUNT];
+        exec_runnable(runnable);
+        valid = bytecode_compile(&executor.code, program, runnable);
+    }
+    paths_init(&executor.paths);
+    spanning_init(&executor.spanning, &executor.pool);
+    coloring_init(&executor.coloring, &executor.pool);
+    flow_init(&executor.flow);
+    if (valid && options->hierarchy_path != NULL)
+        prepare_hierarchy(&executor, options->hierarchy_path);
+    executor.registers = calloc(executor.code.register_count + 1, sizeof(Value));
+    if (valid && executor.registers == NULL)
+        valid = exec_out_of_memory(&executor, "compiling the operations");
+    if (valid)
+        valid = exec_code(&executor, 0);
+    if (executor.hierarchical)
+        hierarchy_free(&executor.hierarchy);
+    spanning_free(&executor.spanning);
+    coloring_free(&executor.coloring); // Before the pool, whose size gives its number of buffers
+    flow_free(&executor.flow);
+    for (uint32_t depth = 0; depth < executor.bfs_depths; depth++) { // Before the pool they run on
+        bfs_free(executor.bfs[depth]);
+        free(executor.bfs[depth]);
+    }
+    free(executor.bfs);
+    if (executor.pooled)
+        pool_free(&executor.pool);
+    for (uint32_t depth = 0; depth < executor.dfs_depths; depth++) {
+        dfs_free(executor.dfs[depth]);
+        free(executor.dfs[depth]);
+    }
+    free(executor.dfs);
+    free(executor.registers);
+    if (options->code == NULL)
+        bytecode_free(&executor.code);
+    paths_free(&executor.paths);
+    return valid;
+}
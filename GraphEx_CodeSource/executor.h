@@ -0,0 +1,86 @@
+/**
+ * @file
+ * @brief Operations executor header file.
+*/
+
+#ifndef EXECUTOR_H_
+#define EXECUTOR_H_
+
+#include <stdint.h>
+#include "program.h"
+#include "paths.h"
+#include "hierarchy.h"
+#include "pool.h"
+#include "bfs.h"
+#include "dfs.h"
+#include "spanning.h"
+#include "coloring.h"
+#include "flow.h"
+#include "bytecode.h"
+
+/**
+ * Enumeration of the kinds of values an operation call can give.
+*/
+typedef enum {
+    VALUE_NONE,   /** No value, such as the cost of a path that doesn't exist. */
+    VALUE_NUMBER, /** An integer. */
+    VALUE_NODE,   /** A node of the main graph. */
+    VALUE_COLOR   /** A palette color. */
+} ValueKind;
+
+/**
+ * Defined type based on a struct holding the value of an operation call.
+*/
+typedef struct {
+    ValueKind kind; /** Kind of the value. */
+    int64_t number; /** The integer, the node id of a VALUE_NODE or the ColorKind of a VALUE_COLOR. */
+} Value;
+
+/**
+ * Defined type based on a struct holding the options of a run.
+*/
+typedef struct {
+    int stats;                  /** 1 to print the work done by each operation. */
+    const char* hierarchy_path; /** Path of the contraction hierarchy file of the main graph, NULL not to use one. */
+    uint32_t threads;           /** Number of threads of the traversals, 0 for one per processor. */
+    int unordered;              /** 1 to let the levels of a breadth-first traversal come in any order. */
+    uint32_t color_budget;      /** Milliseconds nombrechromatique may search for, 0 for no limit. */
+    int flow_scaling;           /** 1 to send the flows of mincost by capacity scaling instead of successive shortest paths. */
+    const Bytecode* code;       /** Operations already lowered by a loaded image, NULL to lower them from the syntax tree. */
+} ExecOptions;
+
+/**
+ * Defined type based on a struct holding the state shared by every operation of a program.
+*/
+typedef struct {
+    Program* program;  /** The linked program. */
+    GraphView* graph;  /** View of the graph the operations work on, the main block unless traversing another one. */
+    PathEngine paths;  /** Shortest path searches, reused from one call to the next. */
+    int reversed;      /** 1 once the incoming edges of the graphs are built. */
+    int stats;         /** 1 if the work done by each operation is printed. */
+    Hierarchy hierarchy; /** Contraction hierarchy of the main graph, used when hierarchical is 1. */
+    int hierarchical;  /** 1 if path queries are answered by the contraction hierarchy. */
+    int from_hierarchy;/** 1 if the last search was answered by the contraction hierarchy. */
+    int64_t cost;      /** Cost found by the last search between two nodes. */
+    const ExecOptions* options; /** Options of the run. */
+    GraphView* main;   /** View of the main block, graph being another view inside a traverse of another block. */
+    ThreadPool pool;   /** Workers of the traversals and of kruskal, started by the first one needing them. */
+    int pooled;        /** 1 once pool is started. */
+    Bfs** bfs;         /** Breadth-first search of each depth of nested traversals, reused from one traversal to the next. */
+    uint32_t bfs_depths; /** Number of searches in bfs. */
+    uint32_t bfs_busy; /** Number of breadth-first traversals running inside each other, the depth of the next one. */
+    Dfs** dfs;         /** Depth-first search of each depth of nested traversals, reused from one traversal to the next. */
+    uint32_t dfs_depths; /** Number of searches in dfs. */
+    uint32_t dfs_busy; /** Number of depth-first traversals running inside each other, the depth of the next one. */
+    int stopping;      /** 1 once stop() is called, until the traversal it ends returns. */
+    Spanning spanning; /** Minimum spanning forest of the last kruskal or prime call. */
+    Coloring coloring; /** DSATUR coloring of the last colored graph. */
+    FlowEngine flow;   /** Minimum cost flow of the last mincost call on a graph with capacities. */
+    Bytecode code;     /** The %operations block lowered to bytecode. */
+    Value* registers;  /** Registers of the bytecode, the lambda parameters included. */
+} Executor;
+
+void exec_runnable(uint8_t* runnable);
+int exec_program(Program* program, const ExecOptions* options);
+
+#endif
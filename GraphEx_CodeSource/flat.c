@@ -0,0 +1,157 @@
+/**
+ * @file
+ * @brief Flattened graph source file.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "flat.h"
+
+/**
+ * Allocates memory for a flattened array.
+ *
+ * @param count The number of elements.
+ * @param size The size of an element.
+ * @return The allocated array, NULL if memory is exhausted.
+*/
+static void* flat_alloc(size_t count, size_t size) {
+    return malloc(count * size + 1);
+}
+
+/**
+ * Initializes a flattened graph without any graph.
+ *
+ * @param flat The flattened graph.
+*/
+void flat_init(FlatGraph* flat) {
+    memset(flat, 0, sizeof(FlatGraph));
+}
+
+/**
+ * Releases a flattened graph.
+ *
+ * @param flat The flattened graph.
+*/
+void flat_free(FlatGraph* flat) {
+    free(flat->first);
+    free(flat->targets);
+    free(flat->weights);
+    free(flat->lines);
+    free(flat->capacities);
+    free(flat->in_first);
+    free(flat->sources);
+    free(flat->positions);
+    flat_init(flat);
+}
+
+/**
+ * Flattens the outgoing edges of a graph, unless they are the edges flattened last.
+ *
+ * @param flat The flattened graph.
+ * @param view The graph.
+ * @return 0 if memory is exhausted, the flattened graph being left empty, 1 if not.
+*/
+int flat_build(FlatGraph* flat, const GraphView* view) {
+    if (flat->view == view)
+        return 1;
+    flat_free(flat);
+    uint32_t n = view->node_count;
+    uint64_t m = 0;
+    EdgeCursor cursor;
+    ViewEdge edge;
+    for (uint32_t v = 0; v < n; v++) {
+        view_edges(view, v, &cursor);
+        while (view_next_edge(&cursor, &edge))
+            m++;
+    }
+    flat->node_count = n;
+    flat->edge_count = m;
+    flat->first = flat_alloc((size_t) n + 1, sizeof(uint64_t));
+    flat->targets = flat_alloc(m, sizeof(uint32_t));
+    flat->weights = flat_alloc(m, sizeof(int64_t));
+    flat->lines = flat_alloc(m, sizeof(uint32_t));
+    if (view->capacitated)
+        flat->capacities = flat_alloc(m, sizeof(int32_t));
+    if (flat->first == NULL || flat->targets == NULL || flat->weights == NULL || flat->lines == NULL
+        || (view->capacitated && flat->capacities == NULL)) {
+        flat_free(flat);
+        return 0;
+    }
+    uint64_t e = 0;
+    for (uint32_t v = 0; v < n; v++) {
+        flat->first[v] = e;
+        view_edges(view, v, &cursor);
+        while (view_next_edge(&cursor, &edge)) {
+            flat->targets[e] = edge.target;
+            flat->weights[e] = edge.weight;
+            flat->lines[e] = edge.line;
+            if (flat->capacities != NULL)
+                flat->capacities[e] = edge.capacity;
+            e++;
+        }
+    }
+    flat->first[n] = e;
+    flat->view = view;
+    return 1;
+}
+
+/**
+ * Builds the incoming edges of a flattened graph if they are not built yet. They are sorted by
+ * target, each one remembering where it is among the outgoing edges of its source.
+ *
+ * @param flat The flattened graph.
+ * @return 0 if memory is exhausted, the incoming edges being left unbuilt, 1 if not.
+*/
+int flat_incoming(FlatGraph* flat) {
+    if (flat->in_first != NULL)
+        return 1;
+    uint32_t n = flat->node_count;
+    uint64_t m = flat->edge_count;
+    uint64_t* in_first = calloc((size_t) n + 1, sizeof(uint64_t));
+    uint32_t* sources = flat_alloc(m, sizeof(uint32_t));
+    uint32_t* positions = flat_alloc(m, sizeof(uint32_t));
+    uint64_t* next = flat_alloc((size_t) n + 1, sizeof(uint64_t));
+    if (in_first == NULL || sources == NULL || positions == NULL || next == NULL) {
+        free(in_first);
+        free(sources);
+        free(positions);
+        free(next);
+        return 0;
+    }
+    flat->in_first = in_first;
+    flat->sources = sources;
+    flat->positions = positions;
+    for (uint64_t e = 0; e < m; e++)
+        flat->in_first[flat->targets[e] + 1]++;
+    for (uint32_t v = 0; v < n; v++)
+        flat->in_first[v + 1] += flat->in_first[v];
+    memcpy(next, flat->in_first, ((size_t) n + 1) * sizeof(uint64_t));
+    for (uint32_t u = 0; u < n; u++) {
+        for (uint64_t out = flat->first[u]; out < flat->first[u + 1]; out++) {
+            uint64_t slot = next[flat->targets[out]]++;
+            flat->sources[slot] = u;
+            flat->positions[slot] = (uint32_t) (out - flat->first[u]);
+        }
+    }
+    free(next);
+    return 1;
+}
+
+/**
+ * Finds the node an outgoing edge leaves, by binary search over the first edge of each node.
+ *
+ * @param flat The flattened graph.
+ * @param edge The position of the edge among the outgoing edges.
+ * @return The source node id.
+*/
+uint32_t flat_source(const FlatGraph* flat, uint64_t edge) {
+    uint32_t low = 0, high = flat->node_count - 1;
+    while (low < high) { // The last node whose first edge is at or before the edge
+        uint32_t middle = low + (high - low + 1) / 2;
+        if (flat->first[middle] <= edge)
+            low = middle;
+        else
+            high = middle - 1;
+    }
+    return low;
+}
@@ -0,0 +1,48 @@
+/**
+ * @file
+ * @brief Flattened graph header file.
+*/
+
+#ifndef FLAT_H_
+#define FLAT_H_
+
+#include <stdint.h>
+#include "view.h"
+
+/**
+ * Defined type based on a struct holding the edges of a view copied into plain CSR arrays, for the
+ * searches that scan every edge many times: the degree of a node is known at once and its edges
+ * are contiguous, instead of being followed through the instances and overlay of the view.
+*/
+typedef struct {
+    const GraphView* view;  /** Graph of the edges, NULL until they are flattened. */
+    uint32_t node_count;    /** Number of nodes. */
+    uint64_t edge_count;    /** Number of edges. */
+    uint64_t* first;        /** First outgoing edge of each node, node_count + 1 entries. */
+    uint32_t* targets;      /** Target of each outgoing edge. */
+    int64_t* weights;       /** Weight of each outgoing edge. */
+    int32_t* capacities;    /** Capacity of each outgoing edge, NULL if the graph declares none. */
+    uint32_t* lines;        /** Line where each outgoing edge was declared. */
+    uint64_t* in_first;     /** First incoming edge of each node, NULL until flat_incoming() is called. */
+    uint32_t* sources;      /** Source of each incoming edge. */
+    uint32_t* positions;    /** Position of each incoming edge among the outgoing edges of its source. */
+} FlatGraph;
+
+void flat_init(FlatGraph* flat);
+void flat_free(FlatGraph* flat);
+int flat_build(FlatGraph* flat, const GraphView* view);
+int flat_incoming(FlatGraph* flat);
+uint32_t flat_source(const FlatGraph* flat, uint64_t edge);
+
+/**
+ * Returns the number of outgoing edges of a node.
+ *
+ * @param flat The flattened graph.
+ * @param node The node id.
+ * @return The degree.
+*/
+static inline uint64_t flat_degree(const FlatGraph* flat, uint32_t node) {
+    return flat->first[node + 1] - flat->first[node];
+}
+
+#endif
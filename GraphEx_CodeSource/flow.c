@@ -0,0 +1,448 @@
+/**
+ * @file
+ * @brief Minimum cost flow source file.
+ *
+ * Successive shortest paths push the flow from the source along the cheapest path of the residual
+ * graph until the target gets all of it or can't be reached anymore. Capacity scaling first sends
+ * the flow by large units: each phase only uses the arcs that can carry its unit, and lets any node
+ * with that much excess send it to the nearest node short of as much, halving the unit until it is 1.
+ *
+ * The residual graph is built from a flat copy of the graph rather than walked through its view: each
+ * edge needs two residual arcs with their own capacity and cost, so the memory is O(edges) of the
+ * expanded graph whatever the source of the arcs, and the copy numbers the edges the arcs come from.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "flow.h"
+
+/**
+ * Allocates an array.
+ *
+ * @param count The number of elements.
+ * @param size The size of an element.
+ * @return The array, NULL if memory is exhausted.
+*/
+static void* flow_alloc(size_t count, size_t size) {
+    return malloc(count * size + 1);
+}
+
+/**
+ * Initializes a flow engine without any graph.
+ *
+ * @param engine The flow engine.
+*/
+void flow_init(FlowEngine* engine) {
+    memset(engine, 0, sizeof(FlowEngine));
+    flat_init(&engine->flat);
+    heap_init(&engine->heap);
+}
+
+/**
+ * Releases the node arrays of a flow engine.
+ *
+ * @param engine The flow engine.
+*/
+static void free_nodes(FlowEngine* engine) {
+    free(engine->arc_first);
+    free(engine->potentials);
+    free(engine->distances);
+    free(engine->reaching);
+    free(engine->stamps);
+    free(engine->excess);
+    free(engine->settled);
+    free(engine->queue);
+    free(engine->lengths);
+    free(engine->queued);
+}
+
+/**
+ * Releases the arc arrays of a flow engine.
+ *
+ * @param engine The flow engine.
+*/
+static void free_arcs(FlowEngine* engine) {
+    free(engine->arcs);
+    free(engine->heads);
+    free(engine->residuals);
+    free(engine->costs);
+}
+
+/**
+ * Releases a flow engine.
+ *
+ * @param engine The flow engine.
+*/
+void flow_free(FlowEngine* engine) {
+    free_nodes(engine);
+    free_arcs(engine);
+    heap_free(&engine->heap);
+    flat_free(&engine->flat);
+    memset(engine, 0, sizeof(FlowEngine));
+}
+
+/**
+ * Builds the residual graph of a graph, every edge carrying no flow yet.
+ *
+ * @param engine The flow engine.
+ * @param view The graph.
+ * @param source The node sending the flow.
+ * @param target The node receiving it.
+ * @return 0 if memory is exhausted, the engine being released and failed, 1 if not.
+*/
+static int flow_begin(FlowEngine* engine, const GraphView* view, uint32_t source, uint32_t target) {
+    FlatGraph* flat = &engine->flat;
+    if (!flat_build(flat, view) || !flat_incoming(flat)) {
+        flow_free(engine);
+        engine->failed = 1;
+        return 0;
+    }
+    uint32_t n = flat->node_count;
+    uint64_t m = flat->edge_count;
+    if (n > engine->capacity || engine->arc_first == NULL) {
+        free_nodes(engine);
+        engine->arc_first = flow_alloc((size_t) n + 1, sizeof(uint64_t));
+        engine->potentials = flow_alloc(n, sizeof(int64_t));
+        engine->distances = flow_alloc(n, sizeof(int64_t));
+        engine->reaching = flow_alloc(n, sizeof(uint64_t));
+        engine->stamps = calloc((size_t) n + 1, sizeof(uint32_t));
+        engine->excess = flow_alloc(n, sizeof(int64_t));
+        engine->settled = flow_alloc(n, sizeof(uint32_t));
+        engine->queue = flow_alloc(n, sizeof(uint32_t));
+        engine->lengths = flow_alloc(n, sizeof(uint32_t));
+        engine->queued = flow_alloc(n, sizeof(uint8_t));
+        engine->stamp = 0;
+        engine->capacity = n;
+    }
+    if (2 * m + 2 > engine->arc_capacity || engine->arcs == NULL) {
+        free_arcs(engine);
+        engine->arcs = flow_alloc(2 * m + 2, sizeof(uint64_t));
+        engine->heads = flow_alloc(2 * m + 2, sizeof(uint32_t));
+        engine->residuals = flow_alloc(2 * m + 2, sizeof(int64_t));
+        engine->costs = flow_alloc(2 * m + 2, sizeof(int64_t));
+        engine->arc_capacity = 2 * m + 2;
+    }
+    heap_clear(&engine->heap);
+    if (engine->arc_first == NULL || engine->potentials == NULL || engine->distances == NULL || engine->reaching == NULL
+        || engine->stamps == NULL || engine->excess == NULL || engine->settled == NULL || engine->queue == NULL
+        || engine->lengths == NULL || engine->queued == NULL || engine->arcs == NULL || engine->heads == NULL
+        || engine->residuals == NULL || engine->costs == NULL || !heap_reserve(&engine->heap, n)) {
+        flow_free(engine);
+        engine->failed = 1;
+        return 0;
+    }
+
+    // The arcs leaving a node: its outgoing edges, its incoming edges going back, then the artificial arc
+    uint64_t a = 0;
+    for (uint32_t u = 0; u < n; u++) {
+        engine->arc_first[u] = a;
+        for (uint64_t e = flat->first[u]; e < flat->first[u + 1]; e++) {
+            int32_t capacity = flat->capacities == NULL ? GRAPH_NO_CAPACITY : flat->capacities[e];
+            engine->heads[2 * e] = flat->targets[e];
+            engine->heads[2 * e + 1] = u;
+            engine->residuals[2 * e] = capacity == GRAPH_NO_CAPACITY ? FLOW_INFINITE : capacity;
+            engine->residuals[2 * e + 1] = 0;
+            engine->costs[2 * e] = flat->weights[e];
+            engine->costs[2 * e + 1] = -flat->weights[e];
+            engine->arcs[a++] = 2 * e;
+        }
+        for (uint64_t i = flat->in_first[u]; i < flat->in_first[u + 1]; i++)
+            engine->arcs[a++] = 2 * (flat->first[flat->sources[i]] + flat->positions[i]) + 1;
+        if (u == source)
+            engine->arcs[a++] = 2 * m;
+        if (u == target)
+            engine->arcs[a++] = 2 * m + 1;
+    }
+    engine->arc_first[n] = a;
+    engine->heads[2 * m] = target;
+    engine->heads[2 * m + 1] = source;
+    engine->residuals[2 * m] = 0;
+    engine->residuals[2 * m + 1] = 0;
+    engine->costs[2 * m] = 0;
+    engine->costs[2 * m + 1] = 0;
+    for (uint32_t v = 0; v < n; v++) {
+        engine->potentials[v] = 0;
+        engine->excess[v] = 0;
+    }
+    engine->unbounded = 0;
+    engine->flow = 0;
+    engine->cost = 0;
+    engine->augmentations = 0;
+    engine->phases = 0;
+    engine->settled_total = 0;
+    return 1;
+}
+
+/**
+ * Gives the potentials their first values with Bellman-Ford, run from every node at once over the
+ * arcs that can carry flow. The potential of a node is then the cost of the cheapest path ending there.
+ *
+ * @param engine The flow engine.
+ * @return 0 if the arcs that can carry flow make a negative cycle, 1 if not.
+*/
+static int initial_potentials(FlowEngine* engine) {
+    uint32_t n = engine->flat.node_count;
+    uint32_t head = 0, count = n;
+    for (uint32_t v = 0; v < n; v++) {
+        engine->queue[v] = v;
+        engine->queued[v] = 1;
+        engine->lengths[v] = 0;
+    }
+    while (count > 0) {
+        uint32_t u = engine->queue[head];
+        head = head + 1 == n ? 0 : head + 1;
+        count--;
+        engine->queued[u] = 0;
+        for (uint64_t i = engine->arc_first[u]; i < engine->arc_first[u + 1]; i++) {
+            uint64_t a = engine->arcs[i];
+            uint32_t v = engine->heads[a];
+            if (engine->residuals[a] <= 0 || engine->potentials[u] + engine->costs[a] >= engine->potentials[v])
+                continue;
+            engine->potentials[v] = engine->potentials[u] + engine->costs[a];
+            engine->lengths[v] = engine->lengths[u] + 1;
+            if (engine->lengths[v] >= n) // A path of n arcs goes through a node twice
+                return 0;
+            if (!engine->queued[v]) {
+                engine->queue[(head + count) % n] = v;
+                engine->queued[v] = 1;
+                count++;
+            }
+        }
+    }
+    return 1;
+}
+
+/**
+ * Searches the cheapest path of the residual graph from a node, with Dijkstra on the reduced costs,
+ * over the arcs that can carry a number of units. Once found, the potentials of the settled nodes
+ * take their distances, which keeps the reduced costs non-negative after the flow is pushed.
+ *
+ * @param engine The flow engine.
+ * @param source The node the path starts from.
+ * @param unit The units of flow each arc of the path must be able to carry.
+ * @param target The node the path ends at, FLOW_NO_NODE for the first node short of unit units.
+ * @return The node the path ends at, FLOW_NO_NODE if there is no such path.
+*/
+static uint32_t search(FlowEngine* engine, uint32_t source, int64_t unit, uint32_t target) {
+    if (++engine->stamp == 0) { // The stamps wrapped around
+        memset(engine->stamps, 0, engine->flat.node_count * sizeof(uint32_t));
+        engine->stamp = 1;
+    }
+    uint32_t stamp = engine->stamp;
+    heap_clear(&engine->heap);
+    engine->settled_count = 0;
+    engine->stamps[source] = stamp;
+    engine->distances[source] = 0;
+    engine->reaching[source] = FLOW_NO_ARC;
+    heap_update(&engine->heap, source, 0);
+    uint32_t found = FLOW_NO_NODE;
+    HeapEntry entry;
+    while (heap_pop(&engine->heap, &entry)) {
+        uint32_t u = entry.node;
+        engine->settled[engine->settled_count++] = u;
+        if (u == target || (target == FLOW_NO_NODE && engine->excess[u] <= -unit)) {
+            found = u;
+            break;
+        }
+        int64_t base = entry.key + engine->potentials[u];
+        for (uint64_t i = engine->arc_first[u]; i < engine->arc_first[u + 1]; i++) {
+            uint64_t a = engine->arcs[i];
+            if (engine->residuals[a] < unit)
+                continue;
+            uint32_t v = engine->heads[a];
+            int64_t distance = base + engine->costs[a] - engine->potentials[v];
+            if (engine->stamps[v] == stamp && distance >= engine->distances[v])
+                continue;
+            engine->stamps[v] = stamp;
+            engine->distances[v] = distance;
+            engine->reaching[v] = a;
+            heap_update(&engine->heap, v, distance);
+        }
+    }
+    engine->settled_total += engine->settled_count;
+    if (found == FLOW_NO_NODE)
+        return FLOW_NO_NODE;
+    int64_t reached = engine->distances[found];
+    for (uint32_t i = 0; i < engine->settled_count; i++) {
+        uint32_t v = engine->settled[i];
+        engine->potentials[v] += engine->distances[v] - reached;
+    }
+    return found;
+}
+
+/**
+ * Pushes flow along an arc.
+ *
+ * @param engine The flow engine.
+ * @param arc The arc.
+ * @param units The units of flow.
+*/
+static inline void push(FlowEngine* engine, uint64_t arc, int64_t units) {
+    engine->residuals[arc] -= units;
+    engine->residuals[arc ^ 1] += units;
+    engine->cost += units * engine->costs[arc];
+    engine->excess[engine->heads[arc ^ 1]] -= units;
+    engine->excess[engine->heads[arc]] += units;
+}
+
+/**
+ * Pushes as much flow as possible along the path the last search found.
+ *
+ * @param engine The flow engine.
+ * @param source The node the path starts from.
+ * @param sink The node the path ends at.
+ * @param limit The most units to push.
+ * @return 0 if the path only has arcs without a capacity and no limit, nothing being pushed, 1 if not.
+*/
+static int augment(FlowEngine* engine, uint32_t source, uint32_t sink, int64_t limit) {
+    int64_t units = limit;
+    for (uint32_t v = sink; v != source; v = engine->heads[engine->reaching[v] ^ 1]) {
+        int64_t residual = engine->residuals[engine->reaching[v]];
+        if (residual < units)
+            units = residual;
+    }
+    if (units >= FLOW_INFINITE / 2)
+        return 0;
+    for (uint32_t v = sink; v != source; v = engine->heads[engine->reaching[v] ^ 1])
+        push(engine, engine->reaching[v], units);
+    engine->augmentations++;
+    return 1;
+}
+
+/**
+ * Sends the flow by successive shortest paths from the source to the target.
+ *
+ * @param engine The flow engine.
+ * @param source The node sending the flow.
+ * @param target The node receiving it.
+*/
+static void successive_paths(FlowEngine* engine, uint32_t source, uint32_t target) {
+    engine->phases++;
+    while (engine->excess[source] > 0) {
+        if (search(engine, source, 1, target) == FLOW_NO_NODE)
+            break;
+        int64_t limit = engine->excess[source] < -engine->excess[target] ? engine->excess[source] : -engine->excess[target];
+        if (!augment(engine, source, target, limit)) {
+            engine->unbounded = 1;
+            break;
+        }
+    }
+}
+
+/**
+ * Sums the capacities of the arcs of a node that carry flow away from it, or towards it.
+ *
+ * @param engine The flow engine.
+ * @param node The node.
+ * @param incoming 1 for the arcs entering the node, 0 for the arcs leaving it.
+ * @return The sum, FLOW_INFINITE if an arc has no capacity.
+*/
+static int64_t node_capacity(const FlowEngine* engine, uint32_t node, int incoming) {
+    int64_t total = 0;
+    for (uint64_t i = engine->arc_first[node]; i < engine->arc_first[node + 1]; i++) {
+        uint64_t a = engine->arcs[i];
+        if (a >= 2 * engine->flat.edge_count || (a & 1) != (uint64_t) incoming)
+            continue;
+        int64_t residual = engine->residuals[a & ~(uint64_t) 1];
+        if (residual >= FLOW_INFINITE / 2)
+            return FLOW_INFINITE;
+        total += residual;
+    }
+    return total;
+}
+
+/**
+ * Sends the flow by capacity scaling. The artificial arc from the source to the target takes all of
+ * it at a cost above any path, so that the flow is always feasible and what it carries at the end is
+ * what the graph couldn't.
+ *
+ * @param engine The flow engine.
+ * @param source The node sending the flow.
+ * @param target The node receiving it.
+ * @param amount The units of flow, FLOW_INFINITE for as many as possible.
+ * @return 0 if the flow or its cost may not fit in 64 bits, successive shortest paths being needed, 1 if not.
+*/
+static int capacity_scaling(FlowEngine* engine, uint32_t source, uint32_t target, int64_t amount) {
+    uint32_t n = engine->flat.node_count;
+    uint64_t m = engine->flat.edge_count;
+    if (amount == FLOW_INFINITE) { // The flow can't exceed what leaves the source or enters the target
+        int64_t leaving = node_capacity(engine, source, 0);
+        int64_t entering = node_capacity(engine, target, 1);
+        amount = leaving < entering ? leaving : entering;
+        if (amount == FLOW_INFINITE)
+            return 0;
+    }
+    int64_t penalty = 1, bound;
+    for (uint64_t e = 0; e < m; e++) {
+        if (__builtin_add_overflow(penalty, engine->costs[2 * e] < 0 ? -engine->costs[2 * e] : engine->costs[2 * e], &penalty))
+            return 0;
+    }
+    if (__builtin_mul_overflow(penalty, amount, &bound) || bound > FLOW_INFINITE)
+        return 0;
+    engine->residuals[2 * m] = amount;
+    engine->costs[2 * m] = penalty;
+    engine->costs[2 * m + 1] = -penalty;
+    engine->excess[source] = amount;
+    engine->excess[target] = -amount;
+    engine->scaling = 1;
+
+    int64_t unit = 1;
+    while (unit <= amount / 2)
+        unit *= 2;
+    for (; unit >= 1; unit /= 2) {
+        engine->phases++;
+        for (uint32_t u = 0; u < n; u++) { // Arcs that can carry a unit but have a negative reduced cost are saturated
+            for (uint64_t i = engine->arc_first[u]; i < engine->arc_first[u + 1]; i++) {
+                uint64_t a = engine->arcs[i];
+                int64_t residual = engine->residuals[a];
+                if (residual >= unit && residual < FLOW_INFINITE / 2
+                    && engine->costs[a] + engine->potentials[u] - engine->potentials[engine->heads[a]] < 0)
+                    push(engine, a, residual);
+            }
+        }
+        for (uint32_t k = 0; k < n; k++) {
+            while (engine->excess[k] >= unit) {
+                uint32_t sink = search(engine, k, unit, FLOW_NO_NODE);
+                if (sink == FLOW_NO_NODE) // Left to a smaller unit
+                    break;
+                augment(engine, k, sink, engine->excess[k] < -engine->excess[sink] ? engine->excess[k] : -engine->excess[sink]);
+            }
+        }
+    }
+    int64_t unsent = engine->residuals[2 * m + 1];
+    engine->cost -= unsent * penalty;
+    engine->flow = amount - unsent;
+    return 1;
+}
+
+/**
+ * Searches the cheapest flow of a number of units from a node to another, or of as many units as possible.
+ *
+ * @param engine The flow engine.
+ * @param view The graph.
+ * @param source The node sending the flow.
+ * @param target The node receiving it.
+ * @param amount The units of flow, FLOW_INFINITE for a maximum flow.
+ * @param scaling 1 to send the flow by capacity scaling, 0 by successive shortest paths.
+ * @return 0 if the edges that can carry flow make a negative cycle, 1 if not or when memory is exhausted,
+ * the engine being failed.
+*/
+int flow_solve(FlowEngine* engine, const GraphView* view, uint32_t source, uint32_t target, int64_t amount, int scaling) {
+    if (!flow_begin(engine, view, source, target))
+        return 1;
+    engine->scaling = 0;
+    if (view->min_weight < 0 && !initial_potentials(engine))
+        return 0;
+    if (source == target) { // The flow stays where it is
+        engine->flow = amount;
+        engine->unbounded = amount == FLOW_INFINITE;
+        return 1;
+    }
+    if (!scaling || !capacity_scaling(engine, source, target, amount)) {
+        engine->excess[source] = amount;
+        engine->excess[target] = -amount;
+        successive_paths(engine, source, target);
+        engine->flow = amount - engine->excess[source];
+    }
+    return 1;
+}
@@ -0,0 +1,71 @@
+/**
+ * @file
+ * @brief Minimum cost flow header file.
+*/
+
+#ifndef FLOW_H_
+#define FLOW_H_
+
+#include <stdint.h>
+#include "heap.h"
+#include "flat.h"
+
+#define FLOW_INFINITE (INT64_MAX / 4) /** Residual capacity of an edge declared without a capacity, and amount of a maximum flow. */
+#define FLOW_NO_NODE UINT32_MAX /** Node a search looks for when any node short of flow ends it. */
+#define FLOW_NO_ARC UINT64_MAX /** Arc reaching the node a search starts from. */
+
+/**
+ * Defined type based on a struct holding a minimum cost flow between two nodes and the residual graph
+ * it is searched in. Edge e of the flattened graph gives arc 2e, whose residual capacity is what the
+ * edge can still carry, and arc 2e + 1 going back, whose residual capacity is the flow of the edge.
+ * Arcs 2m and 2m + 1 join the source to the target at a cost above any path, for capacity scaling.
+ * The flow is pushed along shortest paths of the residual graph, searched by Dijkstra on costs made
+ * non-negative by node potentials, which Bellman-Ford gives first when some cost is negative.
+*/
+typedef struct {
+    FlatGraph flat;          /** Outgoing and incoming edges of the graph. */
+    uint32_t capacity;       /** Number of nodes the node arrays can hold. */
+    uint64_t arc_capacity;   /** Number of arcs the arc arrays can hold. */
+    uint64_t* arc_first;     /** First arc of each node in arcs, node_count + 1 entries. */
+    uint64_t* arcs;          /** Arcs leaving each node. */
+    uint32_t* heads;         /** Node each arc enters, the node it leaves being the head of its pair. */
+    int64_t* residuals;      /** Flow each arc can still carry. */
+    int64_t* costs;          /** Cost of a unit of flow along each arc. */
+    int64_t* potentials;     /** Potential of each node, keeping the reduced cost of every residual arc non-negative. */
+    int64_t* distances;      /** Reduced distance of each node reached by the last search. */
+    uint64_t* reaching;      /** Arc reaching each node reached by the last search. */
+    uint32_t* stamps;        /** Search that last reached each node. */
+    uint32_t stamp;          /** Number of the current search. */
+    int64_t* excess;         /** Flow each node has yet to send, negative for a node still expecting some. */
+    uint32_t* settled;       /** Nodes settled by the last search. */
+    uint32_t settled_count;  /** Number of settled nodes. */
+    IndexedHeap heap;        /** Queue of the searches. */
+    uint32_t* queue;         /** Ring of the nodes Bellman-Ford relaxes next. */
+    uint32_t* lengths;       /** Arcs of the path Bellman-Ford found to each node, n meaning a negative cycle. */
+    uint8_t* queued;         /** 1 for each node in queue. */
+    int scaling;             /** 1 if the last flow was found by capacity scaling, 0 by successive shortest paths. */
+    int unbounded;           /** 1 if the last flow could grow without limit along edges without a capacity. */
+    int64_t flow;            /** Units of flow sent from the source to the target. */
+    int64_t cost;            /** Cost of the flow. */
+    uint64_t augmentations;  /** Paths the flow was pushed along. */
+    uint32_t phases;         /** Scaling phases of the last flow, 1 for successive shortest paths. */
+    uint64_t settled_total;  /** Nodes settled by every search of the last flow. */
+    int failed;              /** 1 once memory was exhausted, the engine holding no flow. */
+} FlowEngine;
+
+void flow_init(FlowEngine* engine);
+void flow_free(FlowEngine* engine);
+int flow_solve(FlowEngine* engine, const GraphView* view, uint32_t source, uint32_t target, int64_t amount, int scaling);
+
+/**
+ * Returns the flow an edge carries.
+ *
+ * @param engine The flow engine.
+ * @param edge The position of the edge among the flattened outgoing edges.
+ * @return The flow.
+*/
+static inline int64_t flow_edge(const FlowEngine* engine, uint64_t edge) {
+    return engine->residuals[2 * edge + 1];
+}
+
+#endif
@@ -0,0 +1,119 @@
+/**
+ * @file
+ * @brief Keyword table generator source file.
+ *
+ * Built and run by the Makefile before the compiler itself: reads the reserved words of keywords.def,
+ * searches a seed for which the scanner's FNV-1a hash has no collision, and prints keywords.h,
+ * a static table indexed by that hash. The scanner then recognizes any keyword, tag or color
+ * with one hash and one comparison.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#define MAX_SEED_TRIES 1000000 /** Seeds tried for a table size before doubling it. */
+
+/**
+ * Defined type based on a struct holding one entry of keywords.def.
+*/
+typedef struct {
+    const char* word;
+    const char* type;
+    const char* value;
+} Entry;
+
+/**
+ * Constant Entry array holding every reserved word, in keywords.def order.
+*/
+static const Entry entries[] = {
+#define KEYWORD(word, type, value) { #word, #type, #value },
+#define TAG(word, type) { "%" #word, #type, "0" },
+#define OPERATION(word, kind) { #word, "OPERATION_TOKEN", #kind },
+#define COLOR(word, kind) { "#" #word, "COLOR_TOKEN", #kind },
+#define CONTEXTUAL(word, kind)
+#include "keywords.def"
+#undef KEYWORD
+#undef TAG
+#undef OPERATION
+#undef COLOR
+};
+
+#define ENTRY_COUNT ((int) (sizeof(entries) / sizeof(entries[0])))
+
+/**
+ * Hashes a lowercase word exactly like findKeyword() in scanner.c.
+ *
+ * @param word The word to hash.
+ * @param seed The FNV-1a offset basis.
+ * @return The hash of the word.
+*/
+static uint32_t keyword_hash(const char* word, uint32_t seed) {
+    uint32_t hash = seed;
+    for (; *word != '\0'; word++) {
+        hash ^= (unsigned char) *word;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * Checks if the seed spreads every word to a different slot.
+ *
+ * @param seed The seed to try.
+ * @param slots The number of slots, a power of two.
+ * @param table Receives the entry index + 1 of each slot.
+ * @return 1 if no two words share a slot, 0 if not.
+*/
+static int try_seed(uint32_t seed, int slots, int* table) {
+    memset(table, 0, slots * sizeof(int));
+    for (int i = 0; i < ENTRY_COUNT; i++) {
+        uint32_t slot = keyword_hash(entries[i].word, seed) & (slots - 1);
+        if (table[slot] != 0)
+            return 0;
+        table[slot] = i + 1;
+    }
+    return 1;
+}
+
+int main() {
+    int slots = 1;
+    while (slots < ENTRY_COUNT)
+        slots *= 2;
+
+    int max_length = 0;
+    for (int i = 0; i < ENTRY_COUNT; i++) {
+        if ((int) strlen(entries[i].word) > max_length)
+            max_length = (int) strlen(entries[i].word);
+    }
+
+    for (;; slots *= 2) {
+        int* table = malloc(slots * sizeof(int));
+        if (table == NULL)
+            return EXIT_FAILURE;
+        for (uint32_t seed = 2166136261u; seed < 2166136261u + MAX_SEED_TRIES; seed++) {
+            if (!try_seed(seed, slots, table))
+                continue;
+
+            printf("/* Generated by gen_keywords from keywords.def, do not edit. */\n\n");
+            printf("#ifndef KEYWORDS_H_\n#define KEYWORDS_H_\n\n");
+            printf("#define KEYWORD_SEED %uu\n", seed);
+            printf("#define KEYWORD_SLOTS %d\n", slots);
+            printf("#define KEYWORD_MAX_LENGTH %d\n\n", max_length);
+            printf("typedef struct {\n    const char* word;\n    int length;\n    int type;\n    int value;\n} Keyword;\n\n");
+            printf("static const Keyword keyword_table[KEYWORD_SLOTS] = {\n");
+            for (int slot = 0; slot < slots; slot++) {
+                if (table[slot] == 0)
+                    continue;
+                const Entry* entry = &entries[table[slot] - 1];
+                printf("    [%d] = { \"%s\", %d, %s, %s },\n", slot, entry->word, (int) strlen(entry->word),
+                    entry->type, entry->value);
+            }
+            printf("};\n\n#endif\n");
+            free(table);
+            return EXIT_SUCCESS;
+        }
+        free(table);
+    }
+}
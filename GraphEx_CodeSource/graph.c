@@ -0,0 +1,427 @@
+/**
+ * @file
+ * @brief Graph storage source file.
+ *
+ * Edges are streamed into a GraphBuilder straight from the parser, in flat arrays, and turned
+ * into a compressed sparse row graph by a counting sort once the %declare block is complete.
+ * Loading a declaration is one linear pass, and its memory is known from its edge count.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "graph.h"
+
+#define NAME_MAP_INITIAL_SLOTS 64 /** Initial number of slots of a NameMap, must be a power of two. */
+
+#define GRAPH_OUT_OF_MEMORY "out of memory while building a graph" /** Error of a builder once memory is exhausted. */
+
+/**
+ * Allocates memory for a graph array.
+ *
+ * @param count The number of elements.
+ * @param size The size of an element.
+ * @return The allocated array, NULL if memory is exhausted.
+*/
+static void* graph_alloc(size_t count, size_t size) {
+    return malloc(count == 0 ? 1 : count * size);
+}
+
+/**
+ * Grows every edge array of a builder to the given capacity, each one staying valid if memory is exhausted.
+ *
+ * @param builder The builder.
+ * @param capacity The new capacity.
+ * @return 1 if the arrays were grown, 0 if memory is exhausted.
+*/
+static int builder_grow(GraphBuilder* builder, uint32_t capacity) {
+    uint32_t* sources = realloc(builder->sources, capacity * sizeof(uint32_t));
+    if (sources != NULL) builder->sources = sources;
+    uint32_t* targets = realloc(builder->targets, capacity * sizeof(uint32_t));
+    if (targets != NULL) builder->targets = targets;
+    int32_t* weights = realloc(builder->weights, capacity * sizeof(int32_t));
+    if (weights != NULL) builder->weights = weights;
+    uint32_t* lines = realloc(builder->lines, capacity * sizeof(uint32_t));
+    if (lines != NULL) builder->lines = lines;
+    int32_t* capacities = builder->capacities == NULL ? NULL : realloc(builder->capacities, capacity * sizeof(int32_t));
+    if (capacities != NULL) builder->capacities = capacities;
+    if (sources == NULL || targets == NULL || weights == NULL || lines == NULL || (builder->capacities != NULL && capacities == NULL))
+        return 0;
+    builder->capacity = capacity;
+    return 1;
+}
+
+/**
+ * Returns the first slot of a name in a map.
+ *
+ * @param name The interned name.
+ * @param mask The slot mask of the map.
+ * @return The slot where the search for the name starts.
+*/
+static uint32_t name_map_slot(uint32_t name, uint32_t mask) {
+    return (name * 2654435761u) & mask;
+}
+
+/**
+ * Initializes an empty name map.
+ *
+ * @param map The map, left without slots if memory is exhausted.
+ * @return 1 if the map was initialized, 0 if memory is exhausted.
+*/
+int name_map_init(NameMap* map) {
+    map->keys = calloc(NAME_MAP_INITIAL_SLOTS, sizeof(uint32_t));
+    map->values = graph_alloc(NAME_MAP_INITIAL_SLOTS, sizeof(uint32_t));
+    map->count = 0;
+    map->mask = NAME_MAP_INITIAL_SLOTS - 1;
+    if (map->keys == NULL || map->values == NULL) {
+        name_map_free(map);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * Releases the slots of a name map.
+ *
+ * @param map The map.
+*/
+void name_map_free(NameMap* map) {
+    free(map->keys);
+    free(map->values);
+    memset(map, 0, sizeof(NameMap));
+}
+
+/**
+ * Looks a name up in a map.
+ *
+ * @param map The map.
+ * @param name The interned name.
+ * @return The value of the name, GRAPH_NO_NODE if it is not in the map.
+*/
+uint32_t name_map_get(const NameMap* map, uint32_t name) {
+    if (map->keys == NULL)
+        return GRAPH_NO_NODE;
+    uint32_t slot = name_map_slot(name, map->mask);
+    while (map->keys[slot] != 0) {
+        if (map->keys[slot] == name + 1)
+            return map->values[slot];
+        slot = (slot + 1) & map->mask;
+    }
+    return GRAPH_NO_NODE;
+}
+
+/**
+ * Adds a name that is not in the map yet, doubling the slots when the map gets half full.
+ *
+ * @param map The map, left as it was if memory is exhausted.
+ * @param name The interned name.
+ * @param value The value of the name.
+ * @return 1 if the name was added, 0 if memory is exhausted.
+*/
+int name_map_put(NameMap* map, uint32_t name, uint32_t value) {
+    if (map->keys == NULL)
+        return 0;
+    if ((map->count + 1) * 2 > map->mask + 1) {
+        NameMap grown;
+        uint32_t slot_count = (map->mask + 1) * 2;
+        grown.keys = calloc(slot_count, sizeof(uint32_t));
+        grown.values = graph_alloc(slot_count, sizeof(uint32_t));
+        if (grown.keys == NULL || grown.values == NULL) {
+            free(grown.keys);
+            free(grown.values);
+            return 0;
+        }
+        grown.count = 0;
+        grown.mask = slot_count - 1;
+        for (uint32_t slot = 0; slot <= map->mask; slot++) {
+            if (map->keys[slot] != 0)
+                name_map_put(&grown, map->keys[slot] - 1, map->values[slot]);
+        }
+        name_map_free(map);
+        *map = grown;
+    }
+    uint32_t slot = name_map_slot(name, map->mask);
+    while (map->keys[slot] != 0)
+        slot = (slot + 1) & map->mask;
+    map->keys[slot] = name + 1;
+    map->values[slot] = value;
+    map->count++;
+    return 1;
+}
+
+/**
+ * Starts building the graph of a %declare block.
+ *
+ * @param builder The builder, whose error is set if memory is exhausted.
+ * @param name The interned name of the graph block, -1 for the main block.
+ * @param directed 1 for a directed graph, 0 for an undirected one.
+*/
+void builder_init(GraphBuilder* builder, int32_t name, int directed) {
+    memset(builder, 0, sizeof(GraphBuilder));
+    builder->graph = calloc(1, sizeof(Graph));
+    if (builder->graph == NULL) {
+        builder->error = GRAPH_OUT_OF_MEMORY;
+        return;
+    }
+    builder->graph->name = name;
+    builder->graph->directed = directed;
+    if (!name_map_init(&builder->graph->nodes))
+        builder->error = GRAPH_OUT_OF_MEMORY;
+}
+
+/**
+ * Returns the node id of a name, adding the node if it was never met.
+ * Node ids are given in order of first appearance.
+ *
+ * @param builder The builder, whose error is set if memory is exhausted.
+ * @param name The interned name of the node.
+ * @return The node id, 0 once the builder has an error.
+*/
+uint32_t builder_node(GraphBuilder* builder, uint32_t name) {
+    if (builder->error != NULL)
+        return 0;
+    Graph* graph = builder->graph;
+    uint32_t node = name_map_get(&graph->nodes, name);
+    if (node != GRAPH_NO_NODE)
+        return node;
+    if (graph->node_count == builder->name_capacity) {
+        uint32_t capacity = builder->name_capacity == 0 ? 64 : builder->name_capacity * 2;
+        uint32_t* names = realloc(graph->names, capacity * sizeof(uint32_t));
+        if (names == NULL) {
+            builder->error = GRAPH_OUT_OF_MEMORY;
+            return 0;
+        }
+        graph->names = names;
+        builder->name_capacity = capacity;
+    }
+    node = graph->node_count;
+    if (!name_map_put(&graph->nodes, name, node)) {
+        builder->error = GRAPH_OUT_OF_MEMORY;
+        return 0;
+    }
+    graph->names[node] = name;
+    graph->node_count++;
+    return node;
+}
+
+/**
+ * Appends a declared edge.
+ *
+ * @param builder The builder, whose error is set if memory is exhausted.
+ * @param source The source node id.
+ * @param target The target node id.
+ * @param weight The weight of the edge.
+ * @param capacity The capacity of the edge, GRAPH_NO_CAPACITY without one.
+ * @param line The %declare line of the edge.
+*/
+void builder_edge(GraphBuilder* builder, uint32_t source, uint32_t target, int32_t weight, int32_t capacity, uint32_t line) {
+    if (builder->error != NULL)
+        return;
+    if (builder->edge_count == builder->capacity && !builder_grow(builder, builder->capacity == 0 ? 1024 : builder->capacity * 2)) {
+        builder->error = GRAPH_OUT_OF_MEMORY;
+        return;
+    }
+    if (capacity != GRAPH_NO_CAPACITY && builder->capacities == NULL) { // The edges before had none
+        builder->capacities = graph_alloc(builder->capacity, sizeof(int32_t));
+        if (builder->capacities == NULL) {
+            builder->error = GRAPH_OUT_OF_MEMORY;
+            return;
+        }
+        for (uint32_t j = 0; j < builder->edge_count; j++)
+            builder->capacities[j] = GRAPH_NO_CAPACITY;
+    }
+    uint32_t i = builder->edge_count++;
+    builder->sources[i] = source;
+    builder->targets[i] = target;
+    builder->weights[i] = weight;
+    builder->lines[i] = line;
+    if (builder->capacities != NULL)
+        builder->capacities[i] = capacity;
+}
+
+/**
+ * Turns the declared edges into the compressed sparse row graph, with a counting sort on the source
+ * node that keeps the declaration order of the edges of each node. An undirected graph also gets
+ * the reverse of each edge, except for self loops.
+ *
+ * @param builder The builder, whose edge arrays are released once the graph is finished.
+ * @return The finished graph, owned by the caller, NULL if the builder has an error, the builder keeping the graph.
+*/
+Graph* builder_finish(GraphBuilder* builder) {
+    if (builder->error != NULL)
+        return NULL;
+    Graph* graph = builder->graph;
+    uint32_t n = graph->node_count;
+    uint64_t m = builder->edge_count;
+    if (!graph->directed) {
+        for (uint32_t i = 0; i < builder->edge_count; i++)
+            m += builder->sources[i] != builder->targets[i];
+    }
+    if (m > UINT32_MAX - 1) {
+        builder->error = "too many edges in a single graph";
+        return NULL;
+    }
+
+    graph->edge_count = (uint32_t) m;
+    for (uint32_t i = 0; i < builder->edge_count; i++) {
+        if (i == 0 || builder->weights[i] < graph->min_weight)
+            graph->min_weight = builder->weights[i];
+        if (i == 0 || builder->weights[i] > graph->max_weight)
+            graph->max_weight = builder->weights[i];
+    }
+    graph->offsets = calloc((size_t) n + 1, sizeof(uint32_t));
+    graph->targets = graph_alloc(m, sizeof(uint32_t));
+    graph->weights = graph_alloc(m, sizeof(int32_t));
+    graph->lines = graph_alloc(m, sizeof(uint32_t));
+    if (builder->capacities != NULL)
+        graph->capacities = graph_alloc(m, sizeof(int32_t));
+    uint32_t* cursor = graph_alloc(n, sizeof(uint32_t));
+    if (graph->offsets == NULL || graph->targets == NULL || graph->weights == NULL || graph->lines == NULL
+        || (builder->capacities != NULL && graph->capacities == NULL) || cursor == NULL) {
+        free(cursor);
+        builder->error = GRAPH_OUT_OF_MEMORY; // The arrays are released with the graph by builder_free()
+        return NULL;
+    }
+
+    // Count the edges of each node, then turn the counts into offsets
+    for (uint32_t i = 0; i < builder->edge_count; i++) {
+        graph->offsets[builder->sources[i] + 1]++;
+        if (!graph->directed && builder->sources[i] != builder->targets[i])
+            graph->offsets[builder->targets[i] + 1]++;
+    }
+    for (uint32_t v = 0; v < n; v++)
+        graph->offsets[v + 1] += graph->offsets[v];
+
+    // Place each edge, using a copy of the offsets as insertion cursors
+    memcpy(cursor, graph->offsets, n * sizeof(uint32_t));
+    for (uint32_t i = 0; i < builder->edge_count; i++) {
+        uint32_t source = builder->sources[i];
+        uint32_t target = builder->targets[i];
+        uint32_t e = cursor[source]++;
+        graph->targets[e] = target;
+        graph->weights[e] = builder->weights[i];
+        graph->lines[e] = builder->lines[i];
+        if (graph->capacities != NULL)
+            graph->capacities[e] = builder->capacities[i];
+        if (!graph->directed && source != target) {
+            e = cursor[target]++;
+            graph->targets[e] = source;
+            graph->weights[e] = builder->weights[i];
+            graph->lines[e] = builder->lines[i];
+            if (graph->capacities != NULL)
+                graph->capacities[e] = builder->capacities[i];
+        }
+    }
+    free(cursor);
+
+    free(builder->sources);
+    free(builder->targets);
+    free(builder->weights);
+    free(builder->lines);
+    free(builder->capacities);
+    memset(builder, 0, sizeof(GraphBuilder));
+    return graph;
+}
+
+/**
+ * Releases a builder and its unfinished graph, when a %declare block is abandoned.
+ *
+ * @param builder The builder.
+*/
+void builder_free(GraphBuilder* builder) {
+    free(builder->sources);
+    free(builder->targets);
+    free(builder->weights);
+    free(builder->lines);
+    free(builder->capacities);
+    graph_free(builder->graph);
+    memset(builder, 0, sizeof(GraphBuilder));
+}
+
+/**
+ * Returns the node id of a name in a graph.
+ *
+ * @param graph The graph.
+ * @param name The interned name of the node.
+ * @return The node id, GRAPH_NO_NODE if the graph has no such node.
+*/
+uint32_t graph_node(const Graph* graph, uint32_t name) {
+    return name_map_get(&graph->nodes, name);
+}
+
+/**
+ * Builds the incoming edges of every node of a directed graph, in compressed sparse row form,
+ * for the searches running backward from a target. An undirected graph already stores each
+ * edge in both directions and is left alone, as is a graph that was already reversed.
+ *
+ * @param graph The graph, left without incoming edges if memory is exhausted.
+ * @return 1 if the incoming edges are built, 0 if memory is exhausted.
+*/
+int graph_reverse(Graph* graph) {
+    if (!graph->directed || graph->reverse_offsets != NULL)
+        return 1;
+    uint32_t n = graph->node_count;
+    uint32_t m = graph->edge_count;
+    uint32_t* offsets = calloc((size_t) n + 1, sizeof(uint32_t));
+    graph->reverse_targets = graph_alloc(m, sizeof(uint32_t));
+    graph->reverse_weights = graph_alloc(m, sizeof(int32_t));
+    graph->reverse_lines = graph_alloc(m, sizeof(uint32_t));
+    if (graph->capacities != NULL)
+        graph->reverse_capacities = graph_alloc(m, sizeof(int32_t));
+    uint32_t* cursor = graph_alloc(n, sizeof(uint32_t));
+    if (offsets == NULL || graph->reverse_targets == NULL || graph->reverse_weights == NULL || graph->reverse_lines == NULL
+        || (graph->capacities != NULL && graph->reverse_capacities == NULL) || cursor == NULL) {
+        free(offsets);
+        free(cursor);
+        free(graph->reverse_targets);
+        free(graph->reverse_weights);
+        free(graph->reverse_lines);
+        free(graph->reverse_capacities);
+        graph->reverse_targets = NULL;
+        graph->reverse_weights = NULL;
+        graph->reverse_lines = NULL;
+        graph->reverse_capacities = NULL;
+        return 0;
+    }
+    graph->reverse_offsets = offsets;
+
+    for (uint32_t e = 0; e < m; e++)
+        graph->reverse_offsets[graph->targets[e] + 1]++;
+    for (uint32_t v = 0; v < n; v++)
+        graph->reverse_offsets[v + 1] += graph->reverse_offsets[v];
+    memcpy(cursor, graph->reverse_offsets, n * sizeof(uint32_t));
+    for (uint32_t v = 0; v < n; v++) {
+        for (uint32_t e = graph->offsets[v]; e < graph->offsets[v + 1]; e++) {
+            uint32_t r = cursor[graph->targets[e]]++;
+            graph->reverse_targets[r] = v;
+            graph->reverse_weights[r] = graph->weights[e];
+            graph->reverse_lines[r] = graph->lines[e];
+            if (graph->capacities != NULL)
+                graph->reverse_capacities[r] = graph->capacities[e];
+        }
+    }
+    free(cursor);
+    return 1;
+}
+
+/**
+ * Releases a graph.
+ *
+ * @param graph The graph.
+*/
+void graph_free(Graph* graph) {
+    if (graph == NULL)
+        return;
+    free(graph->offsets);
+    free(graph->targets);
+    free(graph->weights);
+    free(graph->lines);
+    free(graph->capacities);
+    free(graph->names);
+    free(graph->reverse_offsets);
+    free(graph->reverse_targets);
+    free(graph->reverse_weights);
+    free(graph->reverse_lines);
+    free(graph->reverse_capacities);
+    name_map_free(&graph->nodes);
+    free(graph);
+}
@@ -0,0 +1,83 @@
+/**
+ * @file
+ * @brief Graph storage header file.
+*/
+
+#ifndef GRAPH_H_
+#define GRAPH_H_
+
+#include <stdint.h>
+
+#define GRAPH_NO_NODE UINT32_MAX /** Node id standing for no node. */
+#define GRAPH_DEFAULT_WEIGHT 1 /** Weight of an edge declared without one. */
+#define GRAPH_NO_CAPACITY (-1) /** Capacity of an edge declared without one, which lets any flow through. */
+
+/**
+ * Defined type based on a struct mapping interned names to node ids, with open addressing.
+*/
+typedef struct {
+    uint32_t* keys;   /** Interned name + 1 of each slot, 0 for an empty slot. */
+    uint32_t* values; /** Node id of each slot. */
+    uint32_t count;   /** Number of names in the map. */
+    uint32_t mask;    /** Number of slots minus one, the slot count being a power of two. */
+} NameMap;
+
+/**
+ * Defined type based on a struct holding a graph in compressed sparse row form.
+ * The edges leaving node v are targets[offsets[v]] to targets[offsets[v + 1] - 1].
+ * An undirected graph stores each edge in both directions.
+*/
+typedef struct {
+    int32_t name;        /** Interned name of the graph block, -1 for the main block. */
+    int directed;        /** 1 for a directed graph, 0 for an undirected one. */
+    uint32_t node_count; /** Number of nodes. */
+    uint32_t edge_count; /** Number of stored edges. */
+    int32_t min_weight;  /** Smallest edge weight, 0 without edges. */
+    int32_t max_weight;  /** Largest edge weight, 0 without edges. */
+    uint32_t* offsets;   /** First edge of each node, node_count + 1 entries. */
+    uint32_t* targets;   /** Target node of each edge. */
+    int32_t* weights;    /** Weight of each edge. */
+    int32_t* capacities; /** Capacity of each edge, NULL if the block declares none. */
+    uint32_t* lines;     /** %declare line of each edge. */
+    uint32_t* names;     /** Interned name of each node. */
+    NameMap nodes;       /** Node id of each interned name. */
+    uint32_t* reverse_offsets; /** First incoming edge of each node, NULL until graph_reverse() for a directed graph. */
+    uint32_t* reverse_targets; /** Source node of each incoming edge. */
+    int32_t* reverse_weights;  /** Weight of each incoming edge. */
+    int32_t* reverse_capacities; /** Capacity of each incoming edge, NULL if the block declares none. */
+    uint32_t* reverse_lines;   /** %declare line of each incoming edge. */
+} Graph;
+
+/**
+ * Defined type based on a struct collecting the nodes and edges of a %declare block
+ * in flat growable arrays, until they are turned into a Graph.
+*/
+typedef struct {
+    Graph* graph;        /** Graph being built, which already owns the node names. */
+    uint32_t* sources;   /** Source node of each declared edge. */
+    uint32_t* targets;   /** Target node of each declared edge. */
+    int32_t* weights;    /** Weight of each declared edge. */
+    int32_t* capacities; /** Capacity of each declared edge, NULL until one is declared. */
+    uint32_t* lines;     /** %declare line of each declared edge. */
+    uint32_t edge_count; /** Number of declared edges. */
+    uint32_t capacity;   /** Capacity of the edge arrays. */
+    uint32_t name_capacity; /** Capacity of graph->names. */
+    const char* error;   /** Why the graph can't be built, NULL while it can. Nothing is added once set. */
+} GraphBuilder;
+
+int name_map_init(NameMap* map);
+void name_map_free(NameMap* map);
+uint32_t name_map_get(const NameMap* map, uint32_t name);
+int name_map_put(NameMap* map, uint32_t name, uint32_t value);
+
+void builder_init(GraphBuilder* builder, int32_t name, int directed);
+uint32_t builder_node(GraphBuilder* builder, uint32_t name);
+void builder_edge(GraphBuilder* builder, uint32_t source, uint32_t target, int32_t weight, int32_t capacity, uint32_t line);
+Graph* builder_finish(GraphBuilder* builder);
+void builder_free(GraphBuilder* builder);
+
+uint32_t graph_node(const Graph* graph, uint32_t name);
+int graph_reverse(Graph* graph);
+void graph_free(Graph* graph);
+
+#endif
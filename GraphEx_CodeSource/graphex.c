@@ -0,0 +1,316 @@
+/**
+ * @file
+ * @brief Embeddable compiler source file.
+ *
+ * Compiles a source into a linked program: the source is scanned in one pass, its tokens are parsed
+ * while the %declare blocks are streamed into graphs, then the program is linked. The program can
+ * then be run by exec_program() or compiled to C by codegen_write().
+ *
+ * A large source is first split between its top-level blocks, and its parts are scanned then parsed
+ * on a pool of workers. Each part interns its names in a table of its own: the tables are merged in
+ * source order between the two steps, so that every name gets the id a single pass would give it,
+ * and the graphs and syntax trees of the parts are appended in source order before linking. Any
+ * error sends the source back to the single pass, which prints it exactly as it always did.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "graphex.h"
+
+/**
+ * Defined type based on a struct holding a part of a source compiled apart.
+*/
+typedef struct {
+    SourcePart range;    /** Where the part lies in the source. */
+    Source source;       /** The source, read from the start to the end of the part. */
+    InternTable names;   /** Names met in the part, by id of the part. */
+    uint32_t* ids;       /** Id in the context of each name of the part. */
+    TokenBuffer tokens;  /** Tokens of the part. */
+    Program program;     /** Blocks of the part, appended to the program of the context. */
+    int valid;           /** 1 while the part is scanned and parsed without error. */
+} GxPart;
+
+/**
+ * Defined type based on a struct holding the parts of a source shared by the workers compiling them.
+*/
+typedef struct {
+    GxContext* context;  /** The context of the source. */
+    GxPart* parts;       /** The parts, in source order. */
+    uint32_t count;      /** Number of parts. */
+    uint32_t next;       /** Next part to be taken by a worker. */
+    FILE* discarded;     /** Where the errors of the parts go, the single pass printing them again. */
+} GxSplit;
+
+/**
+ * Initializes a context without any source.
+ *
+ * @param context The context.
+*/
+void gx_init(GxContext* context) {
+    memset(context, 0, sizeof(GxContext));
+    intern_init(&context->names);
+    program_init(&context->program, &context->names);
+    context->messages = stdout;
+}
+
+/**
+ * Releases a context, closing its source.
+ *
+ * @param context The context.
+*/
+void gx_free(GxContext* context) {
+    if (context->image) // Arrays of an image belong to the source, closed last
+        image_free(&context->program, &context->names, &context->code);
+    else {
+        program_free(&context->program);
+        intern_free(&context->names);
+    }
+    free_tokens(&context->tokens);
+    if (context->path != NULL)
+        source_close(&context->source);
+    memset(context, 0, sizeof(GxContext));
+}
+
+/**
+ * Opens the source of a context, mapping the whole file in memory when possible.
+ *
+ * @param context The context, without a source yet.
+ * @param path The path of the source.
+ * @return 0 if the file can't be read, 1 if not.
+*/
+int gx_open(GxContext* context, const char* path) {
+    if (!source_open(&context->source, path))
+        return 0;
+    context->path = path;
+    return 1;
+}
+
+/**
+ * Split task scanning the parts taken by the worker, each with a scanner starting where the part does.
+*/
+static void task_scan(void* data, uint32_t worker) {
+    GxSplit* split = data;
+    (void) worker;
+    uint32_t i;
+    while ((i = __atomic_fetch_add(&split->next, 1, __ATOMIC_RELAXED)) < split->count) {
+        GxPart* part = &split->parts[i];
+        part->source = split->context->source;
+        part->source.cursor = part->source.data + part->range.start;
+        part->source.end = part->source.data + part->range.end;
+        Scanner scanner;
+        scanner_init(&scanner, &part->source, &part->names);
+        scanner.row = (int) part->range.line;
+        scanner.column = (int) part->range.column;
+        scanner.messages = split->discarded;
+        part->valid = scan_all(&scanner, &part->tokens);
+    }
+}
+
+/**
+ * Split task parsing the parts taken by the worker, once their names are given the ids of the context.
+*/
+static void task_parse(void* data, uint32_t worker) {
+    GxSplit* split = data;
+    (void) worker;
+    uint32_t i;
+    while ((i = __atomic_fetch_add(&split->next, 1, __ATOMIC_RELAXED)) < split->count) {
+        GxPart* part = &split->parts[i];
+        TokenBuffer* tokens = &part->tokens;
+        for (uint32_t t = 0; t < tokens->count; t++) {
+            if (tokens->types[t] == ID_TOKEN)
+                tokens->values[t] = (int32_t) part->ids[tokens->values[t]];
+        }
+        part->program.messages = split->discarded;
+        DeclareSink sink = program_sink(&part->program);
+        part->valid = parse_part(&split->context->source, tokens, &part->program.ast, &sink, split->discarded);
+    }
+}
+
+/**
+ * Checks that every part of a split source was scanned or parsed, and that no block follows the main block.
+ *
+ * @param split The split source.
+ * @param parsed 1 once the parts are parsed, 0 once they are scanned.
+ * @return 1 if the parts can be joined, 0 if the source must be compiled in one pass.
+*/
+static int parts_valid(const GxSplit* split, int parsed) {
+    int ended = 0;
+    for (uint32_t i = 0; i < split->count; i++) {
+        const GxPart* part = &split->parts[i];
+        if (!part->valid)
+            return 0;
+        for (uint32_t j = 0; parsed && j < part->program.ast.depth; j++) {
+            if (ended)
+                return 0;
+            ended = part->program.ast.stack[j].kind == AST_MAIN;
+        }
+    }
+    return 1;
+}
+
+/**
+ * Scans and parses the parts of a source on a pool of workers, then joins them into the program of its context.
+ *
+ * @param context The context, whose names and program are still empty.
+ * @param ranges The parts of the source.
+ * @param count The number of parts.
+ * @param workers The number of workers.
+ * @return 1 if the program was joined, 0 if the context is left empty and the source must be compiled in one pass.
+*/
+static int compile_parts(GxContext* context, const SourcePart* ranges, uint32_t count, uint32_t workers) {
+    char* text = NULL;
+    size_t length = 0;
+    GxSplit split = { context, calloc(count, sizeof(GxPart)), count, 0, open_memstream(&text, &length) };
+    if (split.parts == NULL || split.discarded == NULL) {
+        free(split.parts);
+        if (split.discarded != NULL)
+            fclose(split.discarded);
+        free(text);
+        return 0;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        split.parts[i].range = ranges[i];
+        intern_init(&split.parts[i].names);
+        program_init(&split.parts[i].program, &context->names);
+    }
+
+    ThreadPool pool;
+    pool_init(&pool, workers < count ? workers : count);
+    pool_run(&pool, task_scan, &split);
+    int valid = parts_valid(&split, 0);
+    for (uint32_t i = 0; valid && i < count; i++) { // In source order, names get the ids of a single pass
+        GxPart* part = &split.parts[i];
+        part->ids = malloc((part->names.count + 1) * sizeof(uint32_t));
+        if (part->ids == NULL)
+            valid = 0;
+        else
+            intern_merge(&context->names, &part->names, part->ids);
+        valid &= !context->names.failed;
+    }
+    if (valid) {
+        split.next = 0;
+        pool_run(&pool, task_parse, &split);
+        valid = parts_valid(&split, 1);
+    }
+    pool_free(&pool);
+
+    for (uint32_t i = 0; valid && i < count; i++)
+        valid = program_append(&context->program, &split.parts[i].program);
+    if (valid) {
+        parse_join(&context->program.ast, split.parts[0].tokens.lines[0], split.parts[0].tokens.columns[0]);
+        valid = !context->program.ast.failed;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        GxPart* part = &split.parts[i];
+        program_free(&part->program);
+        free_tokens(&part->tokens);
+        free(part->ids);
+        intern_free(&part->names);
+    }
+    free(split.parts);
+    fclose(split.discarded);
+    free(text);
+    if (!valid) { // The names of the parts merged so far are dropped
+        intern_free(&context->names);
+        intern_init(&context->names);
+        program_free(&context->program);
+        program_init(&context->program, &context->names);
+    }
+    return valid;
+}
+
+/**
+ * Compiles the source of a context into a linked program. Errors are printed as they are found.
+ * A large source is compiled in parts by the workers of the context unless its tokens are traced or dumped.
+ * A compiled graph image is loaded in place instead, with its operations already lowered.
+ *
+ * @param context The context, whose source is opened.
+ * @return 0 if the source has a lexical, syntax or link error or is an image of another version or corrupted,
+ * or if memory is exhausted, 1 if not.
+*/
+int gx_compile(GxContext* context) {
+    context->parts = 1;
+    if (image_detect(&context->source)) { // Nothing to scan nor parse, the program is read in place
+        uint8_t runnable[OPERATION_COUNT];
+        exec_runnable(runnable);
+        program_free(&context->program);
+        intern_free(&context->names);
+        context->image = 1;
+        context->parts = 0;
+        int loaded = image_load(&context->program, &context->names, &context->code, &context->source, runnable,
+            context->verify);
+        if (loaded == IMAGE_OUT_OF_MEMORY) {
+            fprintf(context->messages, "Error: out of memory while loading the graph image \"%s\"\n", context->path);
+            return 0;
+        }
+        if (!loaded) {
+            fprintf(context->messages, "Error: \"%s\" is corrupted or is not a graph image of this version of the compiler\n", context->path);
+            return 0;
+        }
+        context->program.messages = context->messages;
+        return 1;
+    }
+    uint32_t workers = context->threads == 0 ? pool_default_size() : context->threads;
+    if (workers > 1 && context->trace == NULL && context->dump == NULL && context->source.length >= SPLIT_MIN_LENGTH) {
+        SourcePart* ranges;
+        uint32_t count = split_source(&context->source, workers * SPLIT_PARTS_PER_WORKER, &ranges);
+        int joined = count > 1 && compile_parts(context, ranges, count, workers);
+        free(ranges);
+        if (joined) {
+            context->parts = count;
+            context->program.messages = context->messages;
+            return program_link(&context->program);
+        }
+    }
+
+    Scanner* scanner = &context->scanner;
+    scanner_init(scanner, &context->source, &context->names);
+    scanner->trace = context->trace;
+    scanner->dump = context->dump;
+    scanner->messages = context->messages;
+    if (!scan_all(scanner, &context->tokens)) {
+        if (!scanner->failed)
+            fprintf(context->messages, "Error: out of memory while scanning \"%s\"\n", context->path);
+        return 0;
+    }
+    context->program.messages = context->messages;
+    DeclareSink sink = program_sink(&context->program); // %declare blocks are streamed into CSR graphs
+    return parse_tokens(&context->source, &context->tokens, &context->program.ast, &sink, context->messages)
+        && program_link(&context->program);
+}
+
+/**
+ * Block consumer of gx_check(), counting the blocks. The names of a block are dropped with it,
+ * nothing being kept from one block to the next, unless the tokens are dumped with their ids.
+*/
+static int check_block(void* data, const Ast* ast, const AstNode* block) {
+    GxContext* context = data;
+    (void) ast;
+    (void) block;
+    context->blocks++;
+    if (context->dump == NULL) {
+        intern_free(&context->names);
+        intern_init(&context->names);
+    }
+    return 1;
+}
+
+/**
+ * Checks the syntax of the source of a context one top-level block at a time, without building its graphs,
+ * so that a source of any number of blocks is checked in memory bounded by its largest block.
+ * Errors are printed as they are found, in source order.
+ *
+ * @param context The context, whose source is opened.
+ * @return 0 if the source has a lexical or syntax error, 1 if not.
+*/
+int gx_check(GxContext* context) {
+    Scanner* scanner = &context->scanner;
+    scanner_init(scanner, &context->source, &context->names);
+    scanner->trace = context->trace;
+    scanner->dump = context->dump;
+    scanner->messages = context->messages;
+    context->blocks = 0;
+    BlockSink consumer = { context, check_block };
+    return parse_stream(scanner, &context->tokens, &context->program.ast, NULL, &consumer, context->messages);
+}
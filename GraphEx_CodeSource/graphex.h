@@ -0,0 +1,49 @@
+/**
+ * @file
+ * @brief Embeddable compiler header file.
+*/
+
+#ifndef GRAPHEX_H_
+#define GRAPHEX_H_
+
+#include <stdio.h>
+#include "source.h"
+#include "intern.h"
+#include "scanner.h"
+#include "parser.h"
+#include "program.h"
+#include "executor.h"
+#include "codegen.h"
+#include "batch.h"
+#include "split.h"
+#include "image.h"
+
+/**
+ * Defined type based on a struct holding everything the compilation of one source needs. Nothing is
+ * shared between two contexts, so that a process can compile many sources at once, one per thread.
+*/
+typedef struct {
+    const char* path;    /** Path of the source, NULL until it is opened. */
+    Source source;       /** The source text. */
+    InternTable names;   /** Names of the identifiers met in the source. */
+    Scanner scanner;     /** Scan of the source. */
+    TokenBuffer tokens;  /** Tokens of the source, empty when its parts were compiled apart. */
+    Program program;     /** Program of the source, linked once gx_compile() succeeds. */
+    FILE* trace;         /** Where each token is traced as "text | TYPE", NULL when tracing is off. */
+    FILE* dump;          /** Where the token stream is dumped as tab separated values, NULL when off. */
+    FILE* messages;      /** Where lexical, syntax, semantic and runtime errors are printed, stdout unless changed. */
+    uint32_t threads;    /** Workers scanning and parsing the blocks of a large source at once, 0 for one per processor. */
+    uint32_t parts;      /** Parts the source was compiled in by gx_compile(), 1 when it was compiled in one pass. */
+    uint64_t blocks;     /** Top-level blocks checked by gx_check(). */
+    int image;           /** 1 if the source is a compiled graph image, read in place by gx_compile(). */
+    int verify;          /** 1 to check every array of a compiled graph image as it is loaded, not only its tables. */
+    Bytecode code;       /** Operations lowered when the image was saved, empty for a GraphEx text. */
+} GxContext;
+
+void gx_init(GxContext* context);
+void gx_free(GxContext* context);
+int gx_open(GxContext* context, const char* path);
+int gx_compile(GxContext* context);
+int gx_check(GxContext* context);
+
+#endif
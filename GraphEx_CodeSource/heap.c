@@ -0,0 +1,299 @@
+/**
+ * @file
+ * @brief Priority queues source file.
+ *
+ * The indexed 4-ary heap is shallower than a binary heap and keeps the children of a node in one
+ * cache line, which makes decrease-key cheap. The radix heap only works with monotone keys, but
+ * moves each entry at most once per bit of its key and never compares entries that are far apart.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "heap.h"
+
+/**
+ * Initializes an empty indexed heap.
+ *
+ * @param heap The heap.
+*/
+void heap_init(IndexedHeap* heap) {
+    memset(heap, 0, sizeof(IndexedHeap));
+}
+
+/**
+ * Releases an indexed heap.
+ *
+ * @param heap The heap.
+*/
+void heap_free(IndexedHeap* heap) {
+    free(heap->entries);
+    free(heap->positions);
+    heap_init(heap);
+}
+
+/**
+ * Makes an indexed heap able to hold the nodes of a graph. Memory is kept from one search to the next.
+ *
+ * @param heap The heap, which must be empty.
+ * @param node_count The number of nodes of the graph.
+ * @return 0 if memory is exhausted, the heap holding no node, 1 if not.
+*/
+int heap_reserve(IndexedHeap* heap, uint32_t node_count) {
+    if (node_count <= heap->capacity)
+        return 1;
+    heap_free(heap);
+    heap->entries = malloc(node_count * sizeof(HeapEntry));
+    heap->positions = malloc(node_count * sizeof(uint32_t));
+    if (heap->entries == NULL || heap->positions == NULL) {
+        heap_free(heap);
+        return 0;
+    }
+    memset(heap->positions, 0xFF, node_count * sizeof(uint32_t));
+    heap->capacity = node_count;
+    return 1;
+}
+
+/**
+ * Removes every queued node, in time proportional to their number.
+ *
+ * @param heap The heap.
+*/
+void heap_clear(IndexedHeap* heap) {
+    for (uint32_t i = 0; i < heap->size; i++)
+        heap->positions[heap->entries[i].node] = HEAP_ABSENT;
+    heap->size = 0;
+}
+
+/**
+ * Moves an entry towards the root until its parent has a smaller key.
+ *
+ * @param heap The heap.
+ * @param i The position of the entry.
+*/
+static void sift_up(IndexedHeap* heap, uint32_t i) {
+    HeapEntry entry = heap->entries[i];
+    while (i > 0) {
+        uint32_t parent = (i - 1) / HEAP_ARITY;
+        if (heap->entries[parent].key <= entry.key)
+            break;
+        heap->entries[i] = heap->entries[parent];
+        heap->positions[heap->entries[i].node] = i;
+        i = parent;
+    }
+    heap->entries[i] = entry;
+    heap->positions[entry.node] = i;
+}
+
+/**
+ * Moves an entry towards the leaves until its children have larger keys.
+ *
+ * @param heap The heap.
+ * @param i The position of the entry.
+*/
+static void sift_down(IndexedHeap* heap, uint32_t i) {
+    HeapEntry entry = heap->entries[i];
+    for (;;) {
+        uint32_t first = i * HEAP_ARITY + 1;
+        if (first >= heap->size)
+            break;
+        uint32_t last = first + HEAP_ARITY < heap->size ? first + HEAP_ARITY : heap->size;
+        uint32_t smallest = first;
+        for (uint32_t child = first + 1; child < last; child++) {
+            if (heap->entries[child].key < heap->entries[smallest].key)
+                smallest = child;
+        }
+        if (heap->entries[smallest].key >= entry.key)
+            break;
+        heap->entries[i] = heap->entries[smallest];
+        heap->positions[heap->entries[i].node] = i;
+        i = smallest;
+    }
+    heap->entries[i] = entry;
+    heap->positions[entry.node] = i;
+}
+
+/**
+ * Queues a node, or decreases its key if it is already queued with a larger one.
+ *
+ * @param heap The heap.
+ * @param node The node, below the reserved node count.
+ * @param key The key of the node.
+ * @return 1 if the node was queued or its key decreased, 0 if it was already queued with a smaller key.
+*/
+int heap_update(IndexedHeap* heap, uint32_t node, int64_t key) {
+    uint32_t i = heap->positions[node];
+    if (i == HEAP_ABSENT) {
+        i = heap->size++;
+        heap->entries[i].node = node;
+    }
+    else if (heap->entries[i].key <= key)
+        return 0;
+    heap->entries[i].key = key;
+    sift_up(heap, i);
+    return 1;
+}
+
+/**
+ * Gives the node with the smallest key, without removing it.
+ *
+ * @param heap The heap.
+ * @param entry Receives the node and its key.
+ * @return 0 if the heap is empty, 1 if not.
+*/
+int heap_top(const IndexedHeap* heap, HeapEntry* entry) {
+    if (heap->size == 0)
+        return 0;
+    *entry = heap->entries[0];
+    return 1;
+}
+
+/**
+ * Removes the node with the smallest key.
+ *
+ * @param heap The heap.
+ * @param entry Receives the node and its key.
+ * @return 0 if the heap is empty, 1 if not.
+*/
+int heap_pop(IndexedHeap* heap, HeapEntry* entry) {
+    if (heap->size == 0)
+        return 0;
+    *entry = heap->entries[0];
+    heap->positions[entry->node] = HEAP_ABSENT;
+    if (--heap->size > 0) {
+        heap->entries[0] = heap->entries[heap->size];
+        sift_down(heap, 0);
+    }
+    return 1;
+}
+
+/**
+ * Initializes an empty radix heap.
+ *
+ * @param heap The heap.
+*/
+void radix_init(RadixHeap* heap) {
+    memset(heap, 0, sizeof(RadixHeap));
+}
+
+/**
+ * Releases a radix heap.
+ *
+ * @param heap The heap.
+*/
+void radix_free(RadixHeap* heap) {
+    for (int i = 0; i < RADIX_BUCKETS; i++)
+        free(heap->buckets[i].entries);
+    radix_init(heap);
+}
+
+/**
+ * Removes every entry, keeping the memory of the buckets for the next search.
+ *
+ * @param heap The heap.
+*/
+void radix_clear(RadixHeap* heap) {
+    for (int i = 0; i < RADIX_BUCKETS; i++)
+        heap->buckets[i].size = 0;
+    heap->last = 0;
+    heap->size = 0;
+}
+
+/**
+ * Returns the bucket of a key.
+ *
+ * @param heap The heap.
+ * @param key The key, not below the last popped one.
+ * @return The bit length of the difference between the key and the last popped one.
+*/
+static int radix_bucket(const RadixHeap* heap, int64_t key) {
+    uint64_t difference = (uint64_t) key ^ (uint64_t) heap->last;
+    return difference == 0 ? 0 : 64 - __builtin_clzll(difference);
+}
+
+/**
+ * Appends an entry to a bucket.
+ *
+ * @param bucket The bucket.
+ * @param entry The entry.
+ * @return 0 if the bucket can't grow, 1 if not.
+*/
+static int bucket_push(RadixBucket* bucket, HeapEntry entry) {
+    if (bucket->size == bucket->capacity) {
+        uint32_t capacity = bucket->capacity == 0 ? 64 : bucket->capacity * 2;
+        HeapEntry* entries = realloc(bucket->entries, capacity * sizeof(HeapEntry));
+        if (entries == NULL)
+            return 0;
+        bucket->entries = entries;
+        bucket->capacity = capacity;
+    }
+    bucket->entries[bucket->size++] = entry;
+    return 1;
+}
+
+/**
+ * Queues a node. Nothing is queued anymore once a bucket couldn't grow.
+ *
+ * @param heap The heap.
+ * @param node The node.
+ * @param key The key of the node, not below the last popped one.
+*/
+void radix_push(RadixHeap* heap, uint32_t node, int64_t key) {
+    HeapEntry entry = { key, node };
+    if (heap->failed || !bucket_push(&heap->buckets[radix_bucket(heap, key)], entry)) {
+        heap->failed = 1;
+        return;
+    }
+    heap->size++;
+}
+
+/**
+ * Gives an entry with the smallest key, without removing it. When the first bucket is empty, the
+ * smallest key of the first non-empty bucket becomes the last popped key, and that bucket is spread
+ * over smaller ones.
+ *
+ * @param heap The heap.
+ * @param entry Receives the node and its key.
+ * @return 0 if the heap is empty or a bucket couldn't grow, 1 if not.
+*/
+int radix_top(RadixHeap* heap, HeapEntry* entry) {
+    if (heap->size == 0 || heap->failed)
+        return 0;
+    if (heap->buckets[0].size == 0) {
+        int i = 1;
+        while (heap->buckets[i].size == 0)
+            i++;
+        RadixBucket* bucket = &heap->buckets[i];
+        int64_t smallest = bucket->entries[0].key;
+        for (uint32_t j = 1; j < bucket->size; j++) {
+            if (bucket->entries[j].key < smallest)
+                smallest = bucket->entries[j].key;
+        }
+        heap->last = smallest;
+        uint32_t size = bucket->size;
+        bucket->size = 0;
+        for (uint32_t j = 0; j < size; j++) { // Every entry goes to a smaller bucket
+            if (!bucket_push(&heap->buckets[radix_bucket(heap, bucket->entries[j].key)], bucket->entries[j])) {
+                heap->failed = 1;
+                return 0;
+            }
+        }
+    }
+    RadixBucket* first = &heap->buckets[0];
+    *entry = first->entries[first->size - 1];
+    return 1;
+}
+
+/**
+ * Removes an entry with the smallest key.
+ *
+ * @param heap The heap.
+ * @param entry Receives the node and its key.
+ * @return 0 if the heap is empty, 1 if not.
+*/
+int radix_pop(RadixHeap* heap, HeapEntry* entry) {
+    if (!radix_top(heap, entry))
+        return 0;
+    heap->buckets[0].size--;
+    heap->size--;
+    return 1;
+}
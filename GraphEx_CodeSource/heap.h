@@ -0,0 +1,71 @@
+/**
+ * @file
+ * @brief Priority queues header file.
+*/
+
+#ifndef HEAP_H_
+#define HEAP_H_
+
+#include <stdint.h>
+
+#define HEAP_ARITY 4 /** Number of children of a node of an IndexedHeap. */
+#define HEAP_ABSENT UINT32_MAX /** Position of a graph node that is not in an IndexedHeap. */
+#define RADIX_BUCKETS 65 /** Buckets of a RadixHeap, one per bit length of a 64-bit key difference. */
+
+/**
+ * Defined type based on a struct holding one entry of a priority queue.
+*/
+typedef struct {
+    int64_t key;   /** Priority of the entry, the smallest coming first. */
+    uint32_t node; /** Graph node of the entry. */
+} HeapEntry;
+
+/**
+ * Defined type based on a struct holding a 4-ary min-heap of graph nodes, indexed by node
+ * so that the key of a queued node can be decreased in place.
+*/
+typedef struct {
+    HeapEntry* entries;  /** Heap ordered entries. */
+    uint32_t size;       /** Number of queued nodes. */
+    uint32_t* positions; /** Position of each graph node in entries, HEAP_ABSENT if not queued. */
+    uint32_t capacity;   /** Number of graph nodes the heap can hold. */
+} IndexedHeap;
+
+/**
+ * Defined type based on a struct holding a growable array of entries.
+*/
+typedef struct {
+    HeapEntry* entries; /** Entries of the bucket, in no particular order. */
+    uint32_t size;      /** Number of entries. */
+    uint32_t capacity;  /** Capacity of entries. */
+} RadixBucket;
+
+/**
+ * Defined type based on a struct holding a monotone radix heap of non-negative keys: a key never
+ * goes below the last popped one, which is the case of the distances settled by Dijkstra.
+ * Bucket i holds the keys whose highest bit differing from the last popped key is bit i - 1.
+ * Queued nodes can't be updated: a node is pushed again instead, and the caller skips stale entries.
+*/
+typedef struct {
+    RadixBucket buckets[RADIX_BUCKETS]; /** Buckets of the heap. */
+    int64_t last;                       /** Last popped key. */
+    uint64_t size;                      /** Number of entries in every bucket. */
+    int failed;                         /** 1 once a bucket couldn't grow, the heap looking empty from then on. */
+} RadixHeap;
+
+void heap_init(IndexedHeap* heap);
+void heap_free(IndexedHeap* heap);
+int heap_reserve(IndexedHeap* heap, uint32_t node_count);
+void heap_clear(IndexedHeap* heap);
+int heap_update(IndexedHeap* heap, uint32_t node, int64_t key);
+int heap_top(const IndexedHeap* heap, HeapEntry* entry);
+int heap_pop(IndexedHeap* heap, HeapEntry* entry);
+
+void radix_init(RadixHeap* heap);
+void radix_free(RadixHeap* heap);
+void radix_clear(RadixHeap* heap);
+void radix_push(RadixHeap* heap, uint32_t node, int64_t key);
+int radix_top(RadixHeap* heap, HeapEntry* entry);
+int radix_pop(RadixHeap* heap, HeapEntry* entry);
+
+#endif
@@ -0,0 +1,639 @@
+/**
+ * @file
+ * @brief Contraction hierarchy source file.
+ *
+ * Preprocessing contracts the nodes by increasing importance, the importance of a node being the
+ * number of shortcuts its contraction needs minus the edges it removes, plus its contracted
+ * neighbors. A shortcut u -> w is only added when a bounded witness search finds no path from u to w
+ * as short as u -> v -> w without the contracted node v. Queries run Dijkstra upward from both ends
+ * and shortcuts are unpacked through their middle node to print the path.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hierarchy.h"
+
+/**
+ * Defined type based on a struct holding the edges of a node while nodes are being contracted.
+*/
+typedef struct {
+    HierarchyEdge* edges; /** Edges of the node. */
+    uint32_t count;       /** Number of edges. */
+    uint32_t capacity;    /** Capacity of edges. */
+} EdgeList;
+
+/**
+ * Defined type based on a struct holding the graph being contracted.
+*/
+typedef struct {
+    uint32_t node_count;  /** Number of nodes. */
+    EdgeList* out;        /** Outgoing edges of each node. */
+    EdgeList* in;         /** Incoming edges of each node, targeting their source. */
+    uint8_t* contracted;  /** 1 for each contracted node. */
+    uint32_t* neighbors;  /** Number of contracted neighbors of each node. */
+    int64_t* distances;   /** Witness search distances. */
+    uint32_t* stamps;     /** Witness search in which each node was reached. */
+    uint32_t stamp;       /** Stamp of the current witness search. */
+    IndexedHeap heap;     /** Witness search queue. */
+    EdgeList up;          /** Upward edges, grouped by node in contraction order. */
+    EdgeList down;        /** Downward edges, grouped by node in contraction order. */
+    int failed;           /** 1 once a list couldn't grow, the hierarchy missing edges. */
+} Contraction;
+
+/**
+ * Allocates memory for a hierarchy array.
+ *
+ * @param count The number of elements.
+ * @param size The size of an element.
+ * @return The allocated array, NULL if memory is exhausted.
+*/
+static void* hierarchy_alloc(size_t count, size_t size) {
+    return malloc(count == 0 ? 1 : count * size);
+}
+
+/**
+ * Appends an edge to a list.
+ *
+ * @param list The list.
+ * @param target The other node of the edge.
+ * @param weight The weight of the edge.
+ * @param middle The middle node of a shortcut, HIERARCHY_NO_MIDDLE for a declared edge.
+ * @return 0 if the list can't grow, 1 if not.
+*/
+static int list_push(EdgeList* list, uint32_t target, int64_t weight, uint32_t middle) {
+    if (list->count == list->capacity) {
+        uint32_t capacity = list->capacity == 0 ? 4 : list->capacity * 2;
+        HierarchyEdge* edges = realloc(list->edges, capacity * sizeof(HierarchyEdge));
+        if (edges == NULL)
+            return 0;
+        list->edges = edges;
+        list->capacity = capacity;
+    }
+    HierarchyEdge* edge = &list->edges[list->count++];
+    edge->weight = weight;
+    edge->target = target;
+    edge->middle = middle;
+    return 1;
+}
+
+/**
+ * Adds an edge to a list, or lowers the weight of the edge it already has towards the same node.
+ *
+ * @param list The list.
+ * @param target The other node of the edge.
+ * @param weight The weight of the edge.
+ * @param middle The middle node of a shortcut, HIERARCHY_NO_MIDDLE for a declared edge.
+ * @return 0 if the list can't grow, 1 if not.
+*/
+static int list_lower(EdgeList* list, uint32_t target, int64_t weight, uint32_t middle) {
+    for (uint32_t i = 0; i < list->count; i++) {
+        if (list->edges[i].target == target) {
+            if (weight < list->edges[i].weight) {
+                list->edges[i].weight = weight;
+                list->edges[i].middle = middle;
+            }
+            return 1;
+        }
+    }
+    return list_push(list, target, weight, middle);
+}
+
+/**
+ * Hashes the nodes and edges of a graph, to check that a saved hierarchy still matches it.
+ *
+ * @param view The graph.
+ * @return The FNV-1a hash of the node count and of every edge.
+*/
+uint64_t hierarchy_signature(const GraphView* view) {
+    uint64_t hash = 14695981039346656037ull;
+    hash = (hash ^ view->node_count) * 1099511628211ull;
+    for (uint32_t v = 0; v < view->node_count; v++) {
+        EdgeCursor cursor;
+        ViewEdge edge;
+        view_edges(view, v, &cursor);
+        while (view_next_edge(&cursor, &edge)) {
+            hash = (hash ^ v) * 1099511628211ull;
+            hash = (hash ^ edge.target) * 1099511628211ull;
+            hash = (hash ^ (uint32_t) edge.weight) * 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+/**
+ * Searches the distances from a node without going through the node being contracted,
+ * until every node closer than the limit is settled or the search settled too many nodes.
+ *
+ * @param contraction The contraction.
+ * @param source The source node.
+ * @param avoided The node being contracted.
+ * @param limit The largest distance of interest.
+*/
+static void witness_search(Contraction* contraction, uint32_t source, uint32_t avoided, int64_t limit) {
+    if (++contraction->stamp == 0) {
+        memset(contraction->stamps, 0, contraction->node_count * sizeof(uint32_t));
+        contraction->stamp = 1;
+    }
+    uint32_t stamp = contraction->stamp;
+    IndexedHeap* heap = &contraction->heap;
+    heap_clear(heap);
+    contraction->stamps[source] = stamp;
+    contraction->distances[source] = 0;
+    heap_update(heap, source, 0);
+
+    uint32_t settled = 0;
+    HeapEntry top;
+    while (heap_pop(heap, &top) && top.key <= limit && settled++ < HIERARCHY_WITNESS_LIMIT) {
+        const EdgeList* out = &contraction->out[top.node];
+        for (uint32_t i = 0; i < out->count; i++) {
+            uint32_t next = out->edges[i].target;
+            if (next == avoided || contraction->contracted[next])
+                continue;
+            int64_t distance = top.key + out->edges[i].weight;
+            if (contraction->stamps[next] == stamp && contraction->distances[next] <= distance)
+                continue;
+            contraction->stamps[next] = stamp;
+            contraction->distances[next] = distance;
+            heap_update(heap, next, distance);
+        }
+    }
+}
+
+/**
+ * Contracts a node, or only counts the shortcuts its contraction needs.
+ *
+ * @param contraction The contraction.
+ * @param node The node.
+ * @param simulate 1 to only count the shortcuts, 0 to add them and contract the node.
+ * @return The number of shortcuts.
+*/
+static uint32_t contract(Contraction* contraction, uint32_t node, int simulate) {
+    const EdgeList* in = &contraction->in[node];
+    const EdgeList* out = &contraction->out[node];
+    int64_t longest_out = 0;
+    for (uint32_t j = 0; j < out->count; j++) {
+        if (!contraction->contracted[out->edges[j].target] && out->edges[j].weight > longest_out)
+            longest_out = out->edges[j].weight;
+    }
+
+    uint32_t shortcuts = 0;
+    for (uint32_t i = 0; i < in->count; i++) {
+        uint32_t source = in->edges[i].target;
+        if (contraction->contracted[source])
+            continue;
+        int64_t to_node = in->edges[i].weight;
+        witness_search(contraction, source, node, to_node + longest_out);
+        for (uint32_t j = 0; j < out->count; j++) {
+            uint32_t target = out->edges[j].target;
+            if (target == source || contraction->contracted[target])
+                continue;
+            int64_t through = to_node + out->edges[j].weight;
+            if (contraction->stamps[target] == contraction->stamp && contraction->distances[target] <= through)
+                continue; // A witness path is as short without the node
+            shortcuts++;
+            if (!simulate && (!list_lower(&contraction->out[source], target, through, node)
+                || !list_lower(&contraction->in[target], source, through, node)))
+                contraction->failed = 1;
+        }
+    }
+    return shortcuts;
+}
+
+/**
+ * Returns the contraction priority of a node, the smallest being contracted first.
+ *
+ * @param contraction The contraction.
+ * @param node The node.
+ * @return The edge difference of the node plus its contracted neighbors.
+*/
+static int64_t priority(Contraction* contraction, uint32_t node) {
+    int64_t removed = 0;
+    for (uint32_t i = 0; i < contraction->in[node].count; i++)
+        removed += !contraction->contracted[contraction->in[node].edges[i].target];
+    for (uint32_t i = 0; i < contraction->out[node].count; i++)
+        removed += !contraction->contracted[contraction->out[node].edges[i].target];
+    return (int64_t) contract(contraction, node, 1) - removed + contraction->neighbors[node];
+}
+
+/**
+ * Allocates the query state of a hierarchy whose node count is known.
+ *
+ * @param hierarchy The hierarchy.
+ * @return 0 if memory is exhausted, 1 if not.
+*/
+static int hierarchy_prepare(Hierarchy* hierarchy) {
+    uint32_t n = hierarchy->node_count;
+    int prepared = 1;
+    for (int side = 0; side < 2; side++) {
+        hierarchy->distances[side] = hierarchy_alloc(n, sizeof(int64_t));
+        hierarchy->parents[side] = hierarchy_alloc(n, sizeof(uint32_t));
+        hierarchy->parent_weights[side] = hierarchy_alloc(n, sizeof(int64_t));
+        hierarchy->parent_middles[side] = hierarchy_alloc(n, sizeof(uint32_t));
+        hierarchy->stamps[side] = calloc(n == 0 ? 1 : n, sizeof(uint32_t));
+        heap_init(&hierarchy->heaps[side]);
+        prepared = prepared && hierarchy->distances[side] != NULL && hierarchy->parents[side] != NULL
+            && hierarchy->parent_weights[side] != NULL && hierarchy->parent_middles[side] != NULL
+            && hierarchy->stamps[side] != NULL && heap_reserve(&hierarchy->heaps[side], n);
+    }
+    hierarchy->stamp = 0;
+    hierarchy->meeting = GRAPH_NO_NODE;
+    return prepared;
+}
+
+/**
+ * Releases the contraction of a graph.
+ *
+ * @param contraction The contraction.
+*/
+static void contraction_free(Contraction* contraction) {
+    for (uint32_t v = 0; v < contraction->node_count && contraction->out != NULL; v++)
+        free(contraction->out[v].edges);
+    for (uint32_t v = 0; v < contraction->node_count && contraction->in != NULL; v++)
+        free(contraction->in[v].edges);
+    free(contraction->out);
+    free(contraction->in);
+    free(contraction->contracted);
+    free(contraction->neighbors);
+    free(contraction->stamps);
+    free(contraction->distances);
+    heap_free(&contraction->heap);
+}
+
+/**
+ * Builds the contraction hierarchy of a graph.
+ *
+ * @param hierarchy The hierarchy to fill.
+ * @param view The graph.
+ * @return 0 if the graph has negative weights or if memory is exhausted, failed telling which, 1 if not.
+*/
+int hierarchy_build(Hierarchy* hierarchy, const GraphView* view) {
+    memset(hierarchy, 0, sizeof(Hierarchy));
+    if (view->edge_count > 0 && view->min_weight < 0)
+        return 0;
+    uint32_t n = view->node_count;
+    hierarchy->node_count = n;
+    hierarchy->signature = hierarchy_signature(view);
+
+    Contraction contraction;
+    memset(&contraction, 0, sizeof(Contraction));
+    contraction.node_count = n;
+    contraction.out = calloc(n == 0 ? 1 : n, sizeof(EdgeList));
+    contraction.in = calloc(n == 0 ? 1 : n, sizeof(EdgeList));
+    contraction.contracted = calloc(n == 0 ? 1 : n, sizeof(uint8_t));
+    contraction.neighbors = calloc(n == 0 ? 1 : n, sizeof(uint32_t));
+    contraction.stamps = calloc(n == 0 ? 1 : n, sizeof(uint32_t));
+    contraction.distances = hierarchy_alloc(n, sizeof(int64_t));
+    heap_init(&contraction.heap);
+    IndexedHeap order;
+    heap_init(&order);
+    if (contraction.out == NULL || contraction.in == NULL || contraction.contracted == NULL
+        || contraction.neighbors == NULL || contraction.stamps == NULL || contraction.distances == NULL
+        || !heap_reserve(&contraction.heap, n) || !heap_reserve(&order, n))
+        contraction.failed = 1;
+
+    // The graph is flattened once, instances included, keeping the lightest of parallel edges
+    for (uint32_t v = 0; v < n && !contraction.failed; v++) {
+        EdgeCursor cursor;
+        ViewEdge edge;
+        view_edges(view, v, &cursor);
+        while (view_next_edge(&cursor, &edge)) {
+            if (edge.target == v)
+                continue;
+            if (!list_lower(&contraction.out[v], edge.target, edge.weight, HIERARCHY_NO_MIDDLE)
+                || !list_lower(&contraction.in[edge.target], v, edge.weight, HIERARCHY_NO_MIDDLE))
+                contraction.failed = 1;
+        }
+    }
+
+    for (uint32_t v = 0; v < n && !contraction.failed; v++)
+        heap_update(&order, v, priority(&contraction, v));
+
+    hierarchy->up_first = hierarchy_alloc(n, sizeof(uint32_t));
+    hierarchy->up_count = hierarchy_alloc(n, sizeof(uint32_t));
+    hierarchy->down_first = hierarchy_alloc(n, sizeof(uint32_t));
+    hierarchy->down_count = hierarchy_alloc(n, sizeof(uint32_t));
+    if (hierarchy->up_first == NULL || hierarchy->up_count == NULL || hierarchy->down_first == NULL
+        || hierarchy->down_count == NULL)
+        contraction.failed = 1;
+    HeapEntry top;
+    while (!contraction.failed && heap_pop(&order, &top)) {
+        uint32_t node = top.node;
+        int64_t current = priority(&contraction, node);
+        HeapEntry next;
+        if (heap_top(&order, &next) && current > next.key) { // Lazy update: the node got less attractive
+            heap_update(&order, node, current);
+            continue;
+        }
+
+        // The edges towards the remaining nodes are the edges of the node in the hierarchy
+        hierarchy->up_first[node] = contraction.up.count;
+        hierarchy->down_first[node] = contraction.down.count;
+        const EdgeList* out = &contraction.out[node];
+        const EdgeList* in = &contraction.in[node];
+        for (uint32_t i = 0; i < out->count; i++) {
+            if (!contraction.contracted[out->edges[i].target]) {
+                if (!list_push(&contraction.up, out->edges[i].target, out->edges[i].weight, out->edges[i].middle))
+                    contraction.failed = 1;
+                contraction.neighbors[out->edges[i].target]++;
+            }
+        }
+        for (uint32_t i = 0; i < in->count; i++) {
+            if (!contraction.contracted[in->edges[i].target]) {
+                if (!list_push(&contraction.down, in->edges[i].target, in->edges[i].weight, in->edges[i].middle))
+                    contraction.failed = 1;
+                contraction.neighbors[in->edges[i].target]++;
+            }
+        }
+        hierarchy->up_count[node] = contraction.up.count - hierarchy->up_first[node];
+        hierarchy->down_count[node] = contraction.down.count - hierarchy->down_first[node];
+        hierarchy->shortcut_count += contract(&contraction, node, 0);
+        contraction.contracted[node] = 1;
+    }
+    heap_free(&order);
+
+    hierarchy->up = contraction.up.edges;
+    hierarchy->up_total = contraction.up.count;
+    hierarchy->down = contraction.down.edges;
+    hierarchy->down_total = contraction.down.count;
+    contraction_free(&contraction);
+    if (contraction.failed || !hierarchy_prepare(hierarchy)) {
+        hierarchy_free(hierarchy);
+        hierarchy->failed = 1;
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * Defined type based on a struct holding the header of a hierarchy file, followed by the arrays of the hierarchy.
+*/
+typedef struct {
+    uint32_t magic;        /** HIERARCHY_MAGIC. */
+    uint32_t version;      /** HIERARCHY_VERSION. */
+    uint32_t node_count;   /** Number of nodes. */
+    uint32_t edge_size;    /** Size of a HierarchyEdge, which must match the reader's. */
+    uint64_t signature;    /** Signature of the graph. */
+    uint64_t up_total;     /** Number of upward edges. */
+    uint64_t down_total;   /** Number of downward edges. */
+    uint64_t shortcut_count; /** Number of shortcuts. */
+} HierarchyHeader;
+
+/**
+ * Saves a hierarchy, so that the next runs on the same graph skip the preprocessing.
+ *
+ * @param hierarchy The hierarchy.
+ * @param path The path of the hierarchy file.
+ * @return 0 if the file can't be written, 1 if not.
+*/
+int hierarchy_save(const Hierarchy* hierarchy, const char* path) {
+    FILE* file = fopen(path, "wb");
+    if (file == NULL)
+        return 0;
+    HierarchyHeader header = { HIERARCHY_MAGIC, HIERARCHY_VERSION, hierarchy->node_count, sizeof(HierarchyEdge),
+        hierarchy->signature, hierarchy->up_total, hierarchy->down_total, hierarchy->shortcut_count };
+    size_t n = hierarchy->node_count;
+    int written = fwrite(&header, sizeof(header), 1, file) == 1
+        && fwrite(hierarchy->up_first, sizeof(uint32_t), n, file) == n
+        && fwrite(hierarchy->up_count, sizeof(uint32_t), n, file) == n
+        && fwrite(hierarchy->down_first, sizeof(uint32_t), n, file) == n
+        && fwrite(hierarchy->down_count, sizeof(uint32_t), n, file) == n
+        && fwrite(hierarchy->up, sizeof(HierarchyEdge), hierarchy->up_total, file) == hierarchy->up_total
+        && fwrite(hierarchy->down, sizeof(HierarchyEdge), hierarchy->down_total, file) == hierarchy->down_total;
+    return fclose(file) == 0 && written;
+}
+
+/**
+ * Loads a saved hierarchy if it was built for the same graph.
+ *
+ * @param hierarchy The hierarchy to fill.
+ * @param path The path of the hierarchy file.
+ * @param view The graph.
+ * @return 0 if the file is missing, unreadable or built for another graph, or if memory is exhausted,
+ * 1 if the hierarchy was loaded.
+*/
+int hierarchy_load(Hierarchy* hierarchy, const char* path, const GraphView* view) {
+    memset(hierarchy, 0, sizeof(Hierarchy));
+    FILE* file = fopen(path, "rb");
+    if (file == NULL)
+        return 0;
+    HierarchyHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != HIERARCHY_MAGIC
+        || header.version != HIERARCHY_VERSION || header.edge_size != sizeof(HierarchyEdge)
+        || header.node_count != view->node_count || header.signature != hierarchy_signature(view)) {
+        fclose(file);
+        return 0;
+    }
+    size_t n = header.node_count;
+    hierarchy->node_count = header.node_count;
+    hierarchy->signature = header.signature;
+    hierarchy->up_total = header.up_total;
+    hierarchy->down_total = header.down_total;
+    hierarchy->shortcut_count = header.shortcut_count;
+    hierarchy->up_first = hierarchy_alloc(n, sizeof(uint32_t));
+    hierarchy->up_count = hierarchy_alloc(n, sizeof(uint32_t));
+    hierarchy->down_first = hierarchy_alloc(n, sizeof(uint32_t));
+    hierarchy->down_count = hierarchy_alloc(n, sizeof(uint32_t));
+    hierarchy->up = hierarchy_alloc(header.up_total, sizeof(HierarchyEdge));
+    hierarchy->down = hierarchy_alloc(header.down_total, sizeof(HierarchyEdge));
+    int read = hierarchy->up_first != NULL && hierarchy->up_count != NULL && hierarchy->down_first != NULL
+        && hierarchy->down_count != NULL && hierarchy->up != NULL && hierarchy->down != NULL
+        && fread(hierarchy->up_first, sizeof(uint32_t), n, file) == n
+        && fread(hierarchy->up_count, sizeof(uint32_t), n, file) == n
+        && fread(hierarchy->down_first, sizeof(uint32_t), n, file) == n
+        && fread(hierarchy->down_count, sizeof(uint32_t), n, file) == n
+        && fread(hierarchy->up, sizeof(HierarchyEdge), header.up_total, file) == header.up_total
+        && fread(hierarchy->down, sizeof(HierarchyEdge), header.down_total, file) == header.down_total;
+    fclose(file);
+    if (!read || !hierarchy_prepare(hierarchy)) {
+        hierarchy_free(hierarchy);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * Releases a hierarchy.
+ *
+ * @param hierarchy The hierarchy.
+*/
+void hierarchy_free(Hierarchy* hierarchy) {
+    free(hierarchy->up_first);
+    free(hierarchy->up_count);
+    free(hierarchy->up);
+    free(hierarchy->down_first);
+    free(hierarchy->down_count);
+    free(hierarchy->down);
+    for (int side = 0; side < 2; side++) {
+        free(hierarchy->distances[side]);
+        free(hierarchy->parents[side]);
+        free(hierarchy->parent_weights[side]);
+        free(hierarchy->parent_middles[side]);
+        free(hierarchy->stamps[side]);
+        heap_free(&hierarchy->heaps[side]);
+    }
+    free(hierarchy->path);
+    memset(hierarchy, 0, sizeof(Hierarchy));
+}
+
+/**
+ * Computes the distance between two nodes, searching upward from the source along the upward edges
+ * and from the target along the downward ones. A side stops once its next node is farther than the
+ * best distance through a node reached by both.
+ *
+ * @param hierarchy The hierarchy.
+ * @param source The source node id.
+ * @param target The target node id.
+ * @return The distance, INT64_MAX if there is no path.
+*/
+int64_t hierarchy_query(Hierarchy* hierarchy, uint32_t source, uint32_t target) {
+    if (++hierarchy->stamp == 0) {
+        memset(hierarchy->stamps[0], 0, hierarchy->node_count * sizeof(uint32_t));
+        memset(hierarchy->stamps[1], 0, hierarchy->node_count * sizeof(uint32_t));
+        hierarchy->stamp = 1;
+    }
+    uint32_t stamp = hierarchy->stamp;
+    uint32_t starts[2] = { source, target };
+    for (int side = 0; side < 2; side++) {
+        heap_clear(&hierarchy->heaps[side]);
+        hierarchy->stamps[side][starts[side]] = stamp;
+        hierarchy->distances[side][starts[side]] = 0;
+        hierarchy->parents[side][starts[side]] = GRAPH_NO_NODE;
+        heap_update(&hierarchy->heaps[side], starts[side], 0);
+    }
+    hierarchy->meeting = GRAPH_NO_NODE;
+    hierarchy->settled_count = 0;
+    int64_t best = INT64_MAX;
+
+    HeapEntry tops[2];
+    for (;;) {
+        int active[2];
+        for (int side = 0; side < 2; side++)
+            active[side] = heap_top(&hierarchy->heaps[side], &tops[side]) && tops[side].key < best;
+        if (!active[0] && !active[1])
+            break;
+        int side = !active[0] || (active[1] && tops[1].key < tops[0].key);
+        int other = !side;
+        HeapEntry top;
+        heap_pop(&hierarchy->heaps[side], &top);
+        hierarchy->settled_count++;
+        uint32_t node = top.node;
+        if (hierarchy->stamps[other][node] == stamp && top.key + hierarchy->distances[other][node] < best) {
+            best = top.key + hierarchy->distances[other][node];
+            hierarchy->meeting = node;
+        }
+
+        const HierarchyEdge* edges = side == 0 ? &hierarchy->up[hierarchy->up_first[node]] : &hierarchy->down[hierarchy->down_first[node]];
+        uint32_t count = side == 0 ? hierarchy->up_count[node] : hierarchy->down_count[node];
+        for (uint32_t i = 0; i < count; i++) {
+            uint32_t next = edges[i].target;
+            int64_t distance = top.key + edges[i].weight;
+            if (hierarchy->stamps[side][next] == stamp && hierarchy->distances[side][next] <= distance)
+                continue;
+            hierarchy->stamps[side][next] = stamp;
+            hierarchy->distances[side][next] = distance;
+            hierarchy->parents[side][next] = node;
+            hierarchy->parent_weights[side][next] = edges[i].weight;
+            hierarchy->parent_middles[side][next] = edges[i].middle;
+            heap_update(&hierarchy->heaps[side], next, distance);
+        }
+    }
+    return best;
+}
+
+/**
+ * Appends a node to the unpacked path, unless the path can't grow, which fails the hierarchy.
+ *
+ * @param hierarchy The hierarchy.
+ * @param length The length of the path, increased.
+ * @param node The node id.
+*/
+static void path_append(Hierarchy* hierarchy, uint32_t* length, uint32_t node) {
+    if (*length == hierarchy->path_capacity) {
+        uint32_t capacity = hierarchy->path_capacity == 0 ? 64 : hierarchy->path_capacity * 2;
+        uint32_t* path = realloc(hierarchy->path, capacity * sizeof(uint32_t));
+        if (path == NULL) {
+            hierarchy->failed = 1;
+            return;
+        }
+        hierarchy->path = path;
+        hierarchy->path_capacity = capacity;
+    }
+    hierarchy->path[(*length)++] = node;
+}
+
+/**
+ * Appends the nodes an edge of the hierarchy stands for, its source excepted. A shortcut u -> w
+ * made by contracting m is the downward edge u -> m of m followed by the upward edge m -> w of m,
+ * each of which can be a shortcut again.
+ *
+ * @param hierarchy The hierarchy.
+ * @param length The length of the path, increased.
+ * @param source The source of the edge.
+ * @param target The target of the edge.
+ * @param weight The weight of the edge.
+ * @param middle The middle node of the edge.
+*/
+static void unpack(Hierarchy* hierarchy, uint32_t* length, uint32_t source, uint32_t target, int64_t weight, uint32_t middle) {
+    while (middle != HIERARCHY_NO_MIDDLE) {
+        const HierarchyEdge* first = NULL;
+        const HierarchyEdge* second = NULL;
+        const HierarchyEdge* down = &hierarchy->down[hierarchy->down_first[middle]];
+        const HierarchyEdge* up = &hierarchy->up[hierarchy->up_first[middle]];
+        for (uint32_t i = 0; i < hierarchy->down_count[middle] && first == NULL; i++) {
+            if (down[i].target == source)
+                first = &down[i];
+        }
+        for (uint32_t i = 0; i < hierarchy->up_count[middle] && second == NULL; i++) {
+            if (up[i].target == target)
+                second = &up[i];
+        }
+        if (first == NULL || second == NULL || first->weight + second->weight != weight)
+            break; // Can't happen with a hierarchy built by hierarchy_build()
+        unpack(hierarchy, length, source, middle, first->weight, first->middle);
+        source = middle;
+        weight = second->weight;
+        middle = second->middle;
+    }
+    path_append(hierarchy, length, target);
+}
+
+/**
+ * Unpacks the shortest path found by the last query.
+ *
+ * @param hierarchy The hierarchy, whose path array receives the nodes.
+ * @param source The source of the last query.
+ * @param target The target of the last query, which was reached.
+ * @return The number of nodes of the path, which misses some of them if the hierarchy failed.
+*/
+uint32_t hierarchy_path(Hierarchy* hierarchy, uint32_t source, uint32_t target) {
+    uint32_t length = 0;
+    path_append(hierarchy, &length, source);
+    if (hierarchy->meeting == GRAPH_NO_NODE || source == target)
+        return length;
+
+    // The upward side is walked back from the meeting node, then unpacked from the source
+    uint32_t meeting = hierarchy->meeting;
+    uint32_t chain = 0;
+    for (uint32_t node = meeting; node != source; node = hierarchy->parents[0][node])
+        chain++;
+    uint32_t* nodes = hierarchy_alloc(chain + 1, sizeof(uint32_t));
+    if (nodes == NULL) {
+        hierarchy->failed = 1;
+        return length;
+    }
+    uint32_t i = chain;
+    for (uint32_t node = meeting; ; node = hierarchy->parents[0][node]) {
+        nodes[i] = node;
+        if (i-- == 0)
+            break;
+    }
+    for (uint32_t j = 1; j <= chain; j++)
+        unpack(hierarchy, &length, nodes[j - 1], nodes[j], hierarchy->parent_weights[0][nodes[j]], hierarchy->parent_middles[0][nodes[j]]);
+    free(nodes);
+
+    // The downward side leads from the meeting node to the target
+    for (uint32_t node = meeting; node != target; node = hierarchy->parents[1][node])
+        unpack(hierarchy, &length, node, hierarchy->parents[1][node], hierarchy->parent_weights[1][node], hierarchy->parent_middles[1][node]);
+    return length;
+}
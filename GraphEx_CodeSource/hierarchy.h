@@ -0,0 +1,70 @@
+/**
+ * @file
+ * @brief Contraction hierarchy header file.
+*/
+
+#ifndef HIERARCHY_H_
+#define HIERARCHY_H_
+
+#include <stdint.h>
+#include "heap.h"
+#include "view.h"
+
+#define HIERARCHY_MAGIC 0x48435847u /** First bytes of a hierarchy file, "GXCH". */
+#define HIERARCHY_VERSION 1 /** Version of the hierarchy file format. */
+#define HIERARCHY_NO_MIDDLE UINT32_MAX /** Middle node of an edge that is not a shortcut. */
+#define HIERARCHY_EXTENSION ".ch" /** Appended to the source path to name its hierarchy file. */
+#define HIERARCHY_WITNESS_LIMIT 256 /** Nodes a witness search settles before giving up and keeping the shortcut. */
+
+/**
+ * Defined type based on a struct holding an edge of a contraction hierarchy, between a node and a
+ * node contracted after it.
+*/
+typedef struct {
+    int64_t weight;  /** Weight of the edge, the sum of the edges it stands for if it is a shortcut. */
+    uint32_t target; /** The other node of the edge. */
+    uint32_t middle; /** Node whose contraction added the shortcut, HIERARCHY_NO_MIDDLE for a declared edge. */
+} HierarchyEdge;
+
+/**
+ * Defined type based on a struct holding a contraction hierarchy of a graph, with the state of its queries.
+ * Nodes are contracted one by one, shortcuts keeping the distances between the remaining nodes.
+ * A shortest path then climbs from the source and from the target towards nodes contracted later,
+ * so each query only settles a few nodes.
+*/
+typedef struct {
+    uint32_t node_count;    /** Number of nodes of the graph. */
+    uint64_t signature;     /** Hash of the nodes and edges of the graph the hierarchy was built for. */
+    uint32_t* up_first;     /** First upward edge of each node in up. */
+    uint32_t* up_count;     /** Number of upward edges of each node. */
+    HierarchyEdge* up;      /** Edges from a node to a node contracted after it. */
+    uint32_t* down_first;   /** First downward edge of each node in down. */
+    uint32_t* down_count;   /** Number of downward edges of each node. */
+    HierarchyEdge* down;    /** Edges to a node from a node contracted after it, targeting that other node. */
+    uint64_t up_total;      /** Number of upward edges. */
+    uint64_t down_total;    /** Number of downward edges. */
+    uint64_t shortcut_count;/** Number of shortcuts among the edges. */
+
+    int64_t* distances[2];  /** Distance of each node on the upward and downward sides of a query. */
+    uint32_t* parents[2];   /** Node each node was reached from on each side. */
+    int64_t* parent_weights[2]; /** Weight of the edge each node was reached by. */
+    uint32_t* parent_middles[2]; /** Middle node of the edge each node was reached by. */
+    uint32_t* stamps[2];    /** Query in which each node was reached on each side. */
+    uint32_t stamp;         /** Stamp of the current query. */
+    IndexedHeap heaps[2];   /** Queues of each side. */
+    uint32_t meeting;       /** Node where the sides of the last query met, GRAPH_NO_NODE if they didn't. */
+    uint64_t settled_count; /** Nodes settled by the last query. */
+    uint32_t* path;         /** Nodes of the last path unpacked by hierarchy_path(). */
+    uint32_t path_capacity; /** Capacity of path. */
+    int failed;             /** 1 once memory was exhausted by hierarchy_build() or hierarchy_path(). */
+} Hierarchy;
+
+uint64_t hierarchy_signature(const GraphView* view);
+int hierarchy_build(Hierarchy* hierarchy, const GraphView* view);
+int hierarchy_load(Hierarchy* hierarchy, const char* path, const GraphView* view);
+int hierarchy_save(const Hierarchy* hierarchy, const char* path);
+void hierarchy_free(Hierarchy* hierarchy);
+int64_t hierarchy_query(Hierarchy* hierarchy, uint32_t source, uint32_t target);
+uint32_t hierarchy_path(Hierarchy* hierarchy, uint32_t source, uint32_t target);
+
+#endif
@@ -0,0 +1,727 @@
+/**
+ * @file
+ * @brief Compiled graph image source file.
+ *
+ * Saves a linked program as an image holding its name table, the CSR arrays of its graphs, its views
+ * with their subgraph instances and overlay edges, its syntax tree and its %operations lowered to
+ * bytecode. Every array is written as it is in memory, 8 bytes aligned, so that a mapped image is
+ * used in place: loading it only allocates the headers of the graphs and views and the instance
+ * tables, whose template pointers are rebuilt, whatever the number of nodes and edges.
+ * The incoming edges and node colors are built at run time on the heap, as for a source.
+ *
+ * Loading an image takes the same time whatever its size: only its header and its tables of graphs,
+ * views and instances are covered by the checksum checked by default, along with the bounds of every
+ * array and the node ranges of the instances. When asked, the checksum of the whole image is checked
+ * too, and the arrays that index each other are checked as they are loaded: the offsets of the CSR
+ * arrays, the node ids of the edges, the degrees of the undirected graphs and of the overlays.
+ * The syntax tree and the bytecode are only covered by that checksum.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "image.h"
+
+#define IMAGE_ALIGNMENT 8 /** Alignment of every array of an image. */
+#define IMAGE_HASH_BASIS 14695981039346656037ull /** Checksum of no bytes, the 64 bits FNV offset basis. */
+#define IMAGE_HASH_PRIME 1099511628211ull /** Multiplier of the checksum, the 64 bits FNV prime. */
+
+/**
+ * Defined type based on a struct holding a name map of an image.
+*/
+typedef struct {
+    uint32_t count;  /** Number of names in the map. */
+    uint32_t mask;   /** Number of slots minus one. */
+    uint64_t keys;   /** Offset of the keys of the slots. */
+    uint64_t values; /** Offset of the values of the slots. */
+} ImageMap;
+
+/**
+ * Defined type based on a struct holding a graph of an image, every array being given by its offset,
+ * 0 for a NULL array.
+*/
+typedef struct {
+    int32_t name;        /** Interned name of the graph block, -1 for the main block. */
+    int32_t directed;    /** 1 for a directed graph, 0 for an undirected one. */
+    uint32_t node_count; /** Number of nodes. */
+    uint32_t edge_count; /** Number of stored edges. */
+    int32_t min_weight;  /** Smallest edge weight. */
+    int32_t max_weight;  /** Largest edge weight. */
+    uint64_t offsets;    /** First edge of each node, node_count + 1 entries. */
+    uint64_t targets;    /** Target node of each edge. */
+    uint64_t weights;    /** Weight of each edge. */
+    uint64_t capacities; /** Capacity of each edge, 0 if the block declares none. */
+    uint64_t lines;      /** %declare line of each edge. */
+    uint64_t names;      /** Interned name of each node. */
+    ImageMap nodes;      /** Node id of each interned name. */
+} ImageGraph;
+
+/**
+ * Defined type based on a struct holding the view of a graph of an image, its instances being
+ * a range of the instance table.
+*/
+typedef struct {
+    uint32_t node_count;     /** Number of nodes, instances included. */
+    int32_t min_weight;      /** Smallest edge weight, instances included. */
+    int32_t max_weight;      /** Largest edge weight, instances included. */
+    int32_t capacitated;     /** 1 if an edge, instances included, declares a capacity. */
+    uint64_t edge_count;     /** Number of stored edges, instances included. */
+    uint32_t instance_first; /** First instance of the view in the instance table. */
+    uint32_t instance_count; /** Number of instances. */
+    uint32_t overlay_count;  /** Number of overlay edges. */
+    uint32_t padding;        /** Keeps the offsets aligned. */
+    uint64_t overlay;        /** Edges towards the instances, sorted by source. */
+    uint64_t reverse_overlay;/** Overlay edges turned around, sorted by their new source. */
+    ImageMap instance_names; /** Index of each instance by interned name. */
+} ImageView;
+
+/**
+ * Defined type based on a struct holding one %subgraph instance of an image.
+*/
+typedef struct {
+    int32_t name;    /** Interned name of the instance. */
+    uint32_t shape;  /** Index of the view of its template. */
+    uint32_t offset; /** Node id of the first node of the instance in the enclosing view. */
+} ImageInstance;
+
+/**
+ * Defined type based on a struct holding the header of an image, at its start.
+*/
+typedef struct {
+    uint32_t magic;            /** IMAGE_MAGIC. */
+    uint32_t version;          /** IMAGE_VERSION. */
+    uint32_t node_size;        /** Size of an AstNode, which must match the reader's. */
+    uint32_t instruction_size; /** Size of an Instruction, which must match the reader's. */
+    uint32_t overlay_size;     /** Size of an OverlayEdge, which must match the reader's. */
+    uint32_t graph_count;      /** Number of graphs, the main block being last. */
+    uint64_t length;           /** Size of the image in bytes. */
+    uint64_t checksum;         /** Checksum of the image, see image_checksum(). */
+    uint64_t directory;        /** Checksum of the header and of the tables of graphs, views and instances. */
+    uint64_t runnable;         /** Bit i set if operation i had a handler when the operations were lowered. */
+    uint32_t name_count;       /** Number of interned names. */
+    uint32_t name_mask;        /** Number of slots of the name table minus one. */
+    uint32_t chars_size;       /** Number of bytes of the names. */
+    uint32_t ast_count;        /** Number of syntax tree nodes. */
+    uint64_t name_chars;       /** NUL-terminated names stored back to back. */
+    uint64_t name_offsets;     /** Offset in name_chars of each name. */
+    uint64_t name_hashes;      /** Hash of each name. */
+    uint64_t name_slots;       /** Open addressing table of the names. */
+    uint64_t ast_nodes;        /** Syntax tree nodes. */
+    uint32_t ast_root;         /** Index of the AST_PROGRAM node. */
+    uint32_t code_count;       /** Number of instructions. */
+    uint64_t code;             /** Instructions of the %operations block. */
+    uint32_t register_count;   /** Number of registers the instructions use. */
+    uint32_t instance_total;   /** Number of instances of every view. */
+    ImageMap blocks;           /** Index of the graph of each named block. */
+    uint64_t graphs;           /** ImageGraph of each graph. */
+    uint64_t views;            /** ImageView of each graph. */
+    uint64_t instances;        /** ImageInstance table of every view. */
+} ImageHeader;
+
+/**
+ * Defined type based on a struct holding an image being written.
+*/
+typedef struct {
+    FILE* file;        /** The image file. */
+    uint64_t position; /** Bytes written so far. */
+    int failed;        /** 1 once a write fails. */
+    int hashing;       /** 1 once the header is written, the bytes after it being hashed. */
+    uint64_t checksum; /** Checksum of the words hashed so far. */
+    unsigned char word[8]; /** Bytes written after the last hashed word. */
+    uint32_t word_size;/** Number of bytes in word. */
+} ImageWriter;
+
+/**
+ * Adds a word to the checksum of an image, an FNV-1a hash taking 8 bytes at a time.
+ *
+ * @param checksum The checksum of the words before.
+ * @param word The word.
+ * @return The checksum.
+*/
+static inline uint64_t hash_word(uint64_t checksum, uint64_t word) {
+    return (checksum ^ word) * IMAGE_HASH_PRIME;
+}
+
+/**
+ * Adds the header of an image to a checksum, its own checksums being 0.
+ *
+ * @param checksum The checksum of the bytes hashed before the header.
+ * @param header The header.
+ * @return The checksum.
+*/
+static uint64_t hash_header(uint64_t checksum, const ImageHeader* header) {
+    ImageHeader copy = *header;
+    uint64_t word;
+    copy.checksum = 0;
+    copy.directory = 0;
+    for (size_t position = 0; position < sizeof(copy); position += sizeof(word)) {
+        memcpy(&word, (const char*) &copy + position, sizeof(word));
+        checksum = hash_word(checksum, word);
+    }
+    return checksum;
+}
+
+/**
+ * Adds bytes to a checksum, the last word being padded with zeros.
+ *
+ * @param checksum The checksum of the bytes before.
+ * @param data The bytes.
+ * @param size The number of bytes.
+ * @return The checksum.
+*/
+static uint64_t hash_array(uint64_t checksum, const void* data, uint64_t size) {
+    const char* bytes = data;
+    uint64_t word;
+    uint64_t position = 0;
+    for (; position + sizeof(word) <= size; position += sizeof(word)) {
+        memcpy(&word, bytes + position, sizeof(word));
+        checksum = hash_word(checksum, word);
+    }
+    if (position < size) {
+        word = 0;
+        memcpy(&word, bytes + position, (size_t) (size - position));
+        checksum = hash_word(checksum, word);
+    }
+    return checksum;
+}
+
+/**
+ * Computes the checksum of an image: the bytes after its header, then its header.
+ *
+ * @param data The first byte of the image.
+ * @param length The size of the image in bytes, at least the size of its header.
+ * @param header The header of the image.
+ * @return The checksum.
+*/
+static uint64_t image_checksum(const char* data, uint64_t length, const ImageHeader* header) {
+    uint64_t checksum = hash_array(IMAGE_HASH_BASIS, data + sizeof(ImageHeader), length - sizeof(ImageHeader));
+    return hash_header(checksum, header);
+}
+
+/**
+ * Computes the checksum of the directory of an image: its tables of graphs, views and instances,
+ * then its header. It only depends on the number of graphs and instances, not on their sizes.
+ *
+ * @param header The header of the image.
+ * @param graphs The ImageGraph of each graph.
+ * @param views The ImageView of each graph.
+ * @param instances The ImageInstance table of every view.
+ * @return The checksum.
+*/
+static uint64_t directory_checksum(const ImageHeader* header, const ImageGraph* graphs, const ImageView* views,
+        const ImageInstance* instances) {
+    uint64_t checksum = hash_array(IMAGE_HASH_BASIS, graphs, (uint64_t) header->graph_count * sizeof(ImageGraph));
+    checksum = hash_array(checksum, views, (uint64_t) header->graph_count * sizeof(ImageView));
+    checksum = hash_array(checksum, instances, (uint64_t) header->instance_total * sizeof(ImageInstance));
+    return hash_header(checksum, header);
+}
+
+/**
+ * Adds the bytes written to an image to its checksum, as image_checksum() reads them back.
+ *
+ * @param writer The image writer.
+ * @param data The bytes.
+ * @param size The number of bytes.
+*/
+static void hash_bytes(ImageWriter* writer, const unsigned char* data, size_t size) {
+    if (!writer->hashing)
+        return;
+    for (size_t i = 0; i < size; i++) {
+        writer->word[writer->word_size++] = data[i];
+        if (writer->word_size == sizeof(writer->word)) {
+            uint64_t word;
+            memcpy(&word, writer->word, sizeof(word));
+            writer->checksum = hash_word(writer->checksum, word);
+            writer->word_size = 0;
+        }
+    }
+}
+
+/**
+ * Writes an array to an image, after the padding that aligns it.
+ *
+ * @param writer The image writer.
+ * @param data The array, NULL for none.
+ * @param size The size of an element.
+ * @param count The number of elements.
+ * @return The offset of the array in the image, 0 for a NULL array.
+*/
+static uint64_t write_array(ImageWriter* writer, const void* data, size_t size, size_t count) {
+    if (data == NULL)
+        return 0;
+    static const char zeros[IMAGE_ALIGNMENT] = {0};
+    size_t padding = (size_t) (-writer->position & (IMAGE_ALIGNMENT - 1));
+    if (padding > 0 && fwrite(zeros, 1, padding, writer->file) != padding)
+        writer->failed = 1;
+    hash_bytes(writer, (const unsigned char*) zeros, padding);
+    writer->position += padding;
+    uint64_t offset = writer->position;
+    if (count > 0 && fwrite(data, size, count, writer->file) != count)
+        writer->failed = 1;
+    hash_bytes(writer, data, size * count);
+    writer->position += (uint64_t) size * count;
+    return offset;
+}
+
+/**
+ * Writes the slots of a name map to an image.
+ *
+ * @param writer The image writer.
+ * @param map The name map.
+ * @return The name map of the image.
+*/
+static ImageMap write_map(ImageWriter* writer, const NameMap* map) {
+    ImageMap image = { map->count, map->mask, 0, 0 };
+    image.keys = write_array(writer, map->keys, sizeof(uint32_t), (size_t) map->mask + 1);
+    image.values = write_array(writer, map->values, sizeof(uint32_t), (size_t) map->mask + 1);
+    return image;
+}
+
+/**
+ * Checks if a source is a compiled graph image rather than a GraphEx text.
+ *
+ * @param source The source.
+ * @return 1 if it starts with IMAGE_MAGIC, 0 if not.
+*/
+int image_detect(const Source* source) {
+    uint32_t magic;
+    if (source->length < sizeof(ImageHeader))
+        return 0;
+    memcpy(&magic, source->data, sizeof(magic));
+    return magic == IMAGE_MAGIC;
+}
+
+/**
+ * Saves a linked program and its lowered operations as an image.
+ *
+ * @param program The linked program.
+ * @param code The operations of the program lowered to bytecode.
+ * @param runnable 1 for each operation that has a handler, indexed by OperationKind.
+ * @param path The path of the image file.
+ * @return 0 if the file can't be written, 1 if not.
+*/
+int image_save(const Program* program, const Bytecode* code, const uint8_t* runnable, const char* path) {
+    ImageWriter writer = { fopen(path, "wb"), 0, 0, 0, IMAGE_HASH_BASIS, {0}, 0 };
+    if (writer.file == NULL)
+        return 0;
+    uint32_t n = program->graph_count;
+    ImageHeader header = {0};
+    ImageGraph* graphs = calloc(n == 0 ? 1 : n, sizeof(ImageGraph));
+    ImageView* views = calloc(n == 0 ? 1 : n, sizeof(ImageView));
+    if (graphs == NULL || views == NULL) {
+        free(graphs);
+        free(views);
+        fclose(writer.file);
+        return 0;
+    }
+    write_array(&writer, &header, sizeof(header), 1); // Written again once every offset is known
+    writer.hashing = 1;
+
+    const InternTable* names = program->names;
+    header.name_count = names->count;
+    header.name_mask = names->slot_mask;
+    header.chars_size = names->chars_size;
+    header.name_chars = write_array(&writer, names->chars == NULL ? "" : names->chars, 1, names->chars_size);
+    header.name_offsets = write_array(&writer, names->offsets == NULL ? (void*) &header : names->offsets, sizeof(uint32_t), names->count);
+    header.name_hashes = write_array(&writer, names->hashes == NULL ? (void*) &header : names->hashes, sizeof(uint32_t), names->count);
+    header.name_slots = write_array(&writer, names->slots, sizeof(uint32_t), (size_t) names->slot_mask + 1);
+    header.ast_count = program->ast.count;
+    header.ast_root = program->ast.root;
+    header.ast_nodes = write_array(&writer, program->ast.nodes, sizeof(AstNode), program->ast.count);
+    header.code_count = code->count;
+    header.register_count = code->register_count;
+    header.code = write_array(&writer, code->code, sizeof(Instruction), code->count);
+    header.blocks = write_map(&writer, &program->blocks);
+
+    for (uint32_t i = 0; i < n; i++) {
+        const Graph* graph = program->graphs[i];
+        ImageGraph* image = &graphs[i];
+        image->name = graph->name;
+        image->directed = graph->directed;
+        image->node_count = graph->node_count;
+        image->edge_count = graph->edge_count;
+        image->min_weight = graph->min_weight;
+        image->max_weight = graph->max_weight;
+        image->offsets = write_array(&writer, graph->offsets, sizeof(uint32_t), (size_t) graph->node_count + 1);
+        image->targets = write_array(&writer, graph->targets, sizeof(uint32_t), graph->edge_count);
+        image->weights = write_array(&writer, graph->weights, sizeof(int32_t), graph->edge_count);
+        image->capacities = write_array(&writer, graph->capacities, sizeof(int32_t), graph->edge_count);
+        image->lines = write_array(&writer, graph->lines, sizeof(uint32_t), graph->edge_count);
+        image->names = write_array(&writer, graph->names, sizeof(uint32_t), graph->node_count);
+        image->nodes = write_map(&writer, &graph->nodes);
+
+        const GraphView* view = &program->views[i];
+        ImageView* image_view = &views[i];
+        image_view->node_count = view->node_count;
+        image_view->min_weight = view->min_weight;
+        image_view->max_weight = view->max_weight;
+        image_view->capacitated = view->capacitated;
+        image_view->edge_count = view->edge_count;
+        image_view->instance_first = header.instance_total;
+        image_view->instance_count = view->instance_count;
+        image_view->overlay_count = view->overlay_count;
+        image_view->overlay = write_array(&writer, view->overlay, sizeof(OverlayEdge), view->overlay_count);
+        image_view->reverse_overlay = write_array(&writer, view->reverse_overlay, sizeof(OverlayEdge), view->overlay_count);
+        image_view->instance_names = write_map(&writer, &view->instance_names);
+        header.instance_total += view->instance_count;
+    }
+
+    // Templates are given by the index of their view, turned back into a pointer when loading
+    ImageInstance* instances = calloc(header.instance_total == 0 ? 1 : header.instance_total, sizeof(ImageInstance));
+    if (instances == NULL)
+        writer.failed = 1;
+    for (uint32_t i = 0, k = 0; instances != NULL && i < n; i++) {
+        for (uint32_t j = 0; j < program->views[i].instance_count; j++, k++) {
+            const Instance* instance = &program->views[i].instances[j];
+            instances[k].name = instance->name;
+            instances[k].shape = (uint32_t) (instance->shape - program->views);
+            instances[k].offset = instance->offset;
+        }
+    }
+    header.graphs = write_array(&writer, graphs, sizeof(ImageGraph), n);
+    header.views = write_array(&writer, views, sizeof(ImageView), n);
+    header.instances = write_array(&writer, instances == NULL ? (void*) graphs : instances, sizeof(ImageInstance), header.instance_total);
+
+    header.magic = IMAGE_MAGIC;
+    header.version = IMAGE_VERSION;
+    header.node_size = sizeof(AstNode);
+    header.instruction_size = sizeof(Instruction);
+    header.overlay_size = sizeof(OverlayEdge);
+    header.graph_count = n;
+    header.length = writer.position;
+    if (writer.word_size > 0) { // The last word is padded with zeros
+        static const unsigned char zeros[8] = {0};
+        hash_bytes(&writer, zeros, sizeof(writer.word) - writer.word_size);
+    }
+    for (int i = 0; i < OPERATION_COUNT; i++)
+        header.runnable |= (uint64_t) (runnable[i] != 0) << i;
+    header.checksum = hash_header(writer.checksum, &header);
+    if (instances != NULL)
+        header.directory = directory_checksum(&header, graphs, views, instances);
+    free(instances);
+    free(views);
+    free(graphs);
+    if (fseek(writer.file, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(header), 1, writer.file) != 1)
+        writer.failed = 1;
+    return fclose(writer.file) == 0 && !writer.failed;
+}
+
+/**
+ * Defined type based on a struct holding an image being loaded.
+*/
+typedef struct {
+    const char* data; /** First byte of the image. */
+    uint64_t length;  /** Size of the image in bytes. */
+    int failed;       /** 1 once an array lies outside of the image, or memory is exhausted. */
+    int exhausted;    /** 1 once memory is exhausted, the image being maybe valid. */
+} ImageReader;
+
+/**
+ * Finds an array in an image, checking that it lies inside of it.
+ *
+ * @param reader The image reader.
+ * @param offset The offset of the array, 0 for a NULL array.
+ * @param size The size of an element.
+ * @param count The number of elements.
+ * @return The array, NULL for a NULL array or if it lies outside of the image, failed being set then.
+*/
+static void* read_array(ImageReader* reader, uint64_t offset, size_t size, uint64_t count) {
+    if (offset == 0)
+        return NULL;
+    if (offset % IMAGE_ALIGNMENT != 0 || offset > reader->length || count > (reader->length - offset) / size) {
+        reader->failed = 1;
+        return NULL;
+    }
+    return (void*) (reader->data + offset); // The image is never written, only its headers are copied
+}
+
+/**
+ * Finds the slots of a name map in an image.
+ *
+ * @param reader The image reader.
+ * @param image The name map of the image.
+ * @param map Receives the name map, whose slots stay in the image.
+*/
+static void read_map(ImageReader* reader, const ImageMap* image, NameMap* map) {
+    map->count = image->count;
+    map->mask = image->mask;
+    map->keys = read_array(reader, image->keys, sizeof(uint32_t), (uint64_t) image->mask + 1);
+    map->values = read_array(reader, image->values, sizeof(uint32_t), (uint64_t) image->mask + 1);
+    if (map->keys == NULL || map->values == NULL || (image->mask & (image->mask + 1)) != 0)
+        reader->failed = 1;
+}
+
+/**
+ * Checks that the offsets of a CSR array start at 0, never decrease and end at the number of edges.
+ *
+ * @param offsets The offsets, node_count + 1 entries.
+ * @param node_count The number of nodes.
+ * @param edge_count The number of edges.
+ * @return 1 if the offsets are valid, 0 if not.
+*/
+static int check_offsets(const uint32_t* offsets, uint32_t node_count, uint32_t edge_count) {
+    if (offsets[0] != 0 || offsets[node_count] != edge_count)
+        return 0;
+    for (uint32_t v = 0; v < node_count; v++) {
+        if (offsets[v] > offsets[v + 1])
+            return 0;
+    }
+    return 1;
+}
+
+/**
+ * Checks that every id of an array is below a bound.
+ *
+ * @param ids The ids.
+ * @param count The number of ids.
+ * @param bound The bound.
+ * @return 1 if every id is below the bound, 0 if not.
+*/
+static int check_ids(const uint32_t* ids, uint64_t count, uint32_t bound) {
+    for (uint64_t i = 0; i < count; i++) {
+        if (ids[i] >= bound)
+            return 0;
+    }
+    return 1;
+}
+
+/**
+ * Checks that every node of an undirected graph is the target of as many edges as it is the source
+ * of, as each edge is stored from both of its ends: the incoming edges of a node are read from its
+ * outgoing ones.
+ *
+ * @param graph The undirected graph, whose offsets and targets are checked.
+ * @param reader The reader of the image, exhausted if memory is.
+ * @return 1 if the degrees match, 0 if not or if memory is exhausted.
+*/
+static int check_undirected(const Graph* graph, ImageReader* reader) {
+    uint32_t* degrees = calloc((size_t) graph->node_count + 1, sizeof(uint32_t));
+    if (degrees == NULL) {
+        reader->exhausted = 1;
+        return 0;
+    }
+    for (uint32_t e = 0; e < graph->edge_count; e++)
+        degrees[graph->targets[e]]++;
+    int valid = 1;
+    for (uint32_t v = 0; v < graph->node_count && valid; v++)
+        valid = degrees[v] == graph->offsets[v + 1] - graph->offsets[v];
+    free(degrees);
+    return valid;
+}
+
+/**
+ * Checks that both ends of the overlay edges of a view are nodes of the view.
+ *
+ * @param overlay The overlay edges.
+ * @param count The number of overlay edges.
+ * @param node_count The number of nodes of the view.
+ * @return 1 if every edge is valid, 0 if not.
+*/
+static int check_overlay(const OverlayEdge* overlay, uint32_t count, uint32_t node_count) {
+    for (uint32_t i = 0; i < count; i++) {
+        if (overlay[i].source >= node_count || overlay[i].target >= node_count)
+            return 0;
+    }
+    return 1;
+}
+
+/**
+ * Checks that the turned around overlay of a view leaves each node as many times as the overlay
+ * enters it, and the other way round, the searches reading the incoming edges of a node from it.
+ *
+ * @param view The view, whose overlay edges are checked.
+ * @param reader The reader of the image, exhausted if memory is.
+ * @return 1 if the degrees match, 0 if not or if memory is exhausted.
+*/
+static int check_reverse(const GraphView* view, ImageReader* reader) {
+    int64_t* degrees = calloc((size_t) view->node_count + 1, sizeof(int64_t));
+    if (degrees == NULL) {
+        reader->exhausted = 1;
+        return 0;
+    }
+    for (uint32_t i = 0; i < view->overlay_count; i++) { // Entering counts 1, leaving counts 2^32
+        degrees[view->overlay[i].target]++;
+        degrees[view->overlay[i].source] += (int64_t) 1 << 32;
+        degrees[view->reverse_overlay[i].source]--;
+        degrees[view->reverse_overlay[i].target] -= (int64_t) 1 << 32;
+    }
+    int valid = 1;
+    for (uint32_t v = 0; v < view->node_count && valid; v++)
+        valid = degrees[v] == 0;
+    free(degrees);
+    return valid;
+}
+
+/**
+ * Loads a program and its lowered operations from an image, without copying its arrays: the program
+ * reads them from the source, which must stay open until image_free() is called.
+ *
+ * @param program The program, released or never initialized, which is filled.
+ * @param names The name table of the program, released or never initialized, which is filled.
+ * @param code Receives the lowered operations.
+ * @param source The source holding the image.
+ * @param runnable 1 for each operation that has a handler, indexed by OperationKind.
+ * @param verify 1 to check the checksum of the whole image and the arrays indexing each other, which reads
+ * it all, 0 to only check its header and its tables.
+ * @return 0 if the image was saved by another version of the compiler, is truncated or is corrupted,
+ * IMAGE_OUT_OF_MEMORY if memory is exhausted, 1 if not. The program can be released by image_free() in any case.
+*/
+int image_load(Program* program, InternTable* names, Bytecode* code, const Source* source, const uint8_t* runnable,
+        int verify) {
+    ImageReader reader = { source->data, source->length, 0, 0 };
+    ImageHeader header;
+    memcpy(&header, source->data, sizeof(header));
+    uint64_t handlers = 0;
+    for (int i = 0; i < OPERATION_COUNT; i++)
+        handlers |= (uint64_t) (runnable[i] != 0) << i;
+    if (header.magic != IMAGE_MAGIC || header.version != IMAGE_VERSION || header.node_size != sizeof(AstNode)
+        || header.instruction_size != sizeof(Instruction) || header.overlay_size != sizeof(OverlayEdge)
+        || header.length != source->length || header.runnable != handlers || header.graph_count == 0)
+        return 0;
+    const ImageGraph* graphs = read_array(&reader, header.graphs, sizeof(ImageGraph), header.graph_count);
+    const ImageView* views = read_array(&reader, header.views, sizeof(ImageView), header.graph_count);
+    const ImageInstance* instances = read_array(&reader, header.instances, sizeof(ImageInstance), header.instance_total);
+    if (graphs == NULL || views == NULL || instances == NULL
+        || directory_checksum(&header, graphs, views, instances) != header.directory
+        || (verify && image_checksum(source->data, header.length, &header) != header.checksum))
+        return 0;
+
+    memset(program, 0, sizeof(Program));
+    memset(names, 0, sizeof(InternTable));
+    names->count = names->cap = header.name_count;
+    names->chars_size = names->chars_cap = header.chars_size;
+    names->slot_mask = header.name_mask;
+    names->chars = read_array(&reader, header.name_chars, 1, header.chars_size);
+    names->offsets = read_array(&reader, header.name_offsets, sizeof(uint32_t), header.name_count);
+    names->hashes = read_array(&reader, header.name_hashes, sizeof(uint32_t), header.name_count);
+    names->slots = read_array(&reader, header.name_slots, sizeof(uint32_t), (uint64_t) header.name_mask + 1);
+    program->names = names;
+    program->ast.nodes = read_array(&reader, header.ast_nodes, sizeof(AstNode), header.ast_count);
+    program->ast.count = program->ast.capacity = header.ast_count;
+    program->ast.root = header.ast_root;
+    memset(code, 0, sizeof(Bytecode));
+    code->code = read_array(&reader, header.code, sizeof(Instruction), header.code_count);
+    code->count = code->capacity = header.code_count;
+    code->register_count = header.register_count;
+    read_map(&reader, &header.blocks, &program->blocks);
+    if (reader.failed || names->chars == NULL || names->slots == NULL || code->code == NULL || program->ast.nodes == NULL
+        || header.ast_root >= header.ast_count || names->offsets == NULL
+        || (verify && !check_ids(names->offsets, header.name_count, header.chars_size))
+        || (header.chars_size > 0 && names->chars[header.chars_size - 1] != '\0'))
+        return 0;
+
+    // Only the headers are allocated, every array staying in the image
+    uint32_t n = header.graph_count;
+    program->graphs = calloc(n, sizeof(Graph*));
+    program->views = calloc(n, sizeof(GraphView));
+    if (program->graphs == NULL || program->views == NULL)
+        return IMAGE_OUT_OF_MEMORY;
+    program->graph_count = program->graph_capacity = n;
+    for (uint32_t i = 0; i < n; i++) {
+        const ImageGraph* image = &graphs[i];
+        Graph* graph = calloc(1, sizeof(Graph));
+        if (graph == NULL)
+            return IMAGE_OUT_OF_MEMORY;
+        program->graphs[i] = graph;
+        graph->name = image->name;
+        graph->directed = image->directed;
+        graph->node_count = image->node_count;
+        graph->edge_count = image->edge_count;
+        graph->min_weight = image->min_weight;
+        graph->max_weight = image->max_weight;
+        graph->offsets = read_array(&reader, image->offsets, sizeof(uint32_t), (uint64_t) image->node_count + 1);
+        graph->targets = read_array(&reader, image->targets, sizeof(uint32_t), image->edge_count);
+        graph->weights = read_array(&reader, image->weights, sizeof(int32_t), image->edge_count);
+        graph->capacities = read_array(&reader, image->capacities, sizeof(int32_t), image->edge_count);
+        graph->lines = read_array(&reader, image->lines, sizeof(uint32_t), image->edge_count);
+        graph->names = read_array(&reader, image->names, sizeof(uint32_t), image->node_count);
+        read_map(&reader, &image->nodes, &graph->nodes);
+        if (graph->offsets == NULL || graph->targets == NULL || graph->weights == NULL || graph->lines == NULL
+            || graph->names == NULL)
+            reader.failed = 1;
+        else if (verify && (!check_offsets(graph->offsets, graph->node_count, graph->edge_count)
+            || !check_ids(graph->targets, graph->edge_count, graph->node_count)
+            || !check_ids(graph->names, graph->node_count, header.name_count)
+            || (!graph->directed && !check_undirected(graph, &reader))))
+            reader.failed = 1;
+
+        const ImageView* image_view = &views[i];
+        GraphView* view = &program->views[i];
+        view->graph = graph;
+        view->node_count = image_view->node_count;
+        view->edge_count = image_view->edge_count;
+        view->min_weight = image_view->min_weight;
+        view->max_weight = image_view->max_weight;
+        view->capacitated = image_view->capacitated;
+        view->overlay_count = view->overlay_capacity = image_view->overlay_count;
+        view->overlay = read_array(&reader, image_view->overlay, sizeof(OverlayEdge), image_view->overlay_count);
+        view->reverse_overlay = read_array(&reader, image_view->reverse_overlay, sizeof(OverlayEdge), image_view->overlay_count);
+        read_map(&reader, &image_view->instance_names, &view->instance_names);
+        if ((view->overlay_count > 0 && (view->overlay == NULL || view->reverse_overlay == NULL))
+            || view->node_count < graph->node_count)
+            reader.failed = 1;
+        else if (verify && (!check_overlay(view->overlay, view->overlay_count, view->node_count)
+            || !check_overlay(view->reverse_overlay, view->overlay_count, view->node_count)
+            || (view->overlay_count > 0 && !check_reverse(view, &reader))))
+            reader.failed = 1;
+        if (reader.failed || image_view->instance_first > header.instance_total
+            || image_view->instance_count > header.instance_total - image_view->instance_first) {
+            reader.failed = 1;
+            continue;
+        }
+        view->instance_count = view->instance_capacity = image_view->instance_count;
+        view->instances = malloc(view->instance_count == 0 ? 1 : view->instance_count * sizeof(Instance));
+        if (view->instances == NULL)
+            return IMAGE_OUT_OF_MEMORY;
+        uint64_t next = graph->node_count; // The instances follow the nodes of the block back to back
+        for (uint32_t j = 0; j < view->instance_count; j++) {
+            const ImageInstance* instance = &instances[image_view->instance_first + j];
+            if (instance->shape >= i) { // A template is always declared before its instances
+                reader.failed = 1;
+                break;
+            }
+            view->instances[j].name = instance->name;
+            view->instances[j].shape = &program->views[instance->shape];
+            view->instances[j].offset = instance->offset;
+            if (instance->offset != next)
+                reader.failed = 1;
+            next = instance->offset + (uint64_t) program->views[instance->shape].node_count;
+        }
+        if (next != view->node_count)
+            reader.failed = 1;
+    }
+    if (reader.exhausted)
+        return IMAGE_OUT_OF_MEMORY;
+    return !reader.failed;
+}
+
+/**
+ * Releases a program loaded from an image, and what was built on the heap while it ran.
+ * The arrays read from the image are left to the source.
+ *
+ * @param program The program.
+ * @param names The name table of the program.
+ * @param code The lowered operations.
+*/
+void image_free(Program* program, InternTable* names, Bytecode* code) {
+    for (uint32_t i = 0; program->graphs != NULL && i < program->graph_count; i++) {
+        Graph* graph = program->graphs[i];
+        if (graph == NULL)
+            continue;
+        free(graph->reverse_offsets);
+        free(graph->reverse_targets);
+        free(graph->reverse_weights);
+        free(graph->reverse_lines);
+        free(graph->reverse_capacities);
+        free(graph);
+    }
+    for (uint32_t i = 0; program->views != NULL && i < program->graph_count; i++) {
+        free(program->views[i].instances);
+        free(program->views[i].colors);
+    }
+    free(program->graphs);
+    free(program->views);
+    memset(program, 0, sizeof(Program));
+    memset(names, 0, sizeof(InternTable));
+    memset(code, 0, sizeof(Bytecode));
+}
@@ -0,0 +1,25 @@
+/**
+ * @file
+ * @brief Compiled graph image header file.
+*/
+
+#ifndef IMAGE_H_
+#define IMAGE_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include "source.h"
+#include "intern.h"
+#include "program.h"
+#include "bytecode.h"
+
+#define IMAGE_MAGIC 0x42585847u /** First bytes of a compiled graph image, "GXXB". */
+#define IMAGE_VERSION 3 /** Version of the compiled graph image format. */
+#define IMAGE_OUT_OF_MEMORY (-1) /** Returned by image_load() when memory is exhausted. */
+
+int image_detect(const Source* source);
+int image_save(const Program* program, const Bytecode* code, const uint8_t* runnable, const char* path);
+int image_load(Program* program, InternTable* names, Bytecode* code, const Source* source, const uint8_t* runnable, int verify);
+void image_free(Program* program, InternTable* names, Bytecode* code);
+
+#endif
@@ -0,0 +1,180 @@
+/**
+ * @file
+ * @brief Interned names source file.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "intern.h"
+
+#define INTERN_INITIAL_SLOTS 1024 /** Initial number of slots, must be a power of two. */
+
+
+/**
+ * Computes the FNV-1a hash of the lowercased text.
+ *
+ * @param text The text to hash.
+ * @param length The length of the text.
+ * @return The hash of the text.
+*/
+static uint32_t intern_hash(const char* text, int length) {
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < length; i++) {
+        hash ^= (unsigned char) tolower((unsigned char) text[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * Checks if the stored name of the given id is equal to the text, ignoring the case of the text.
+ *
+ * @param table The name table.
+ * @param id The id of the stored name.
+ * @param text The text to compare.
+ * @param length The length of the text.
+ * @return 1 if both names are equal, 0 if not.
+*/
+static int intern_equals(const InternTable* table, uint32_t id, const char* text, int length) {
+    const char* name = table->chars + table->offsets[id];
+    for (int i = 0; i < length; i++) {
+        if (name[i] != tolower((unsigned char) text[i]))
+            return 0;
+    }
+    return name[length] == '\0';
+}
+
+/**
+ * Doubles the number of slots and re-inserts every stored id.
+ *
+ * @param table The name table, failed if memory is exhausted.
+*/
+static void intern_grow_slots(InternTable* table) {
+    uint32_t slot_count = (table->slot_mask + 1) * 2;
+    uint32_t* slots = calloc(slot_count, sizeof(uint32_t));
+    if (slots == NULL) {
+        table->failed = 1;
+        return;
+    }
+    for (uint32_t id = 0; id < table->count; id++) {
+        uint32_t slot = table->hashes[id] & (slot_count - 1);
+        while (slots[slot] != 0)
+            slot = (slot + 1) & (slot_count - 1);
+        slots[slot] = id + 1;
+    }
+    free(table->slots);
+    table->slots = slots;
+    table->slot_mask = slot_count - 1;
+}
+
+/**
+ * Initializes an empty name table.
+ *
+ * @param table The name table, failed if memory is exhausted.
+*/
+void intern_init(InternTable* table) {
+    memset(table, 0, sizeof(InternTable));
+    table->slots = calloc(INTERN_INITIAL_SLOTS, sizeof(uint32_t));
+    table->failed = table->slots == NULL;
+    table->slot_mask = INTERN_INITIAL_SLOTS - 1;
+}
+
+/**
+ * Releases the memory held by a name table.
+ *
+ * @param table The name table.
+*/
+void intern_free(InternTable* table) {
+    free(table->chars);
+    free(table->offsets);
+    free(table->hashes);
+    free(table->slots);
+    memset(table, 0, sizeof(InternTable));
+}
+
+/**
+ * Returns the id of the given name, storing it first if it was never met.
+ * Names are case insensitive, like every GraphEx word.
+ *
+ * @param table The name table, failed if memory is exhausted.
+ * @param text The name, which doesn't need to be NUL-terminated.
+ * @param length The length of the name.
+ * @return The id of the name, 0 once the table failed.
+*/
+uint32_t intern(InternTable* table, const char* text, int length) {
+    if (table->failed)
+        return 0;
+    uint32_t hash = intern_hash(text, length);
+    uint32_t slot = hash & table->slot_mask;
+    while (table->slots[slot] != 0) {
+        uint32_t id = table->slots[slot] - 1;
+        if (table->hashes[id] == hash && intern_equals(table, id, text, length))
+            return id;
+        slot = (slot + 1) & table->slot_mask;
+    }
+
+    // Store the lowercased name
+    if (table->count == table->cap) {
+        uint32_t cap = table->cap == 0 ? 256 : table->cap * 2;
+        uint32_t* offsets = realloc(table->offsets, cap * sizeof(uint32_t));
+        if (offsets != NULL)
+            table->offsets = offsets;
+        uint32_t* hashes = realloc(table->hashes, cap * sizeof(uint32_t));
+        if (hashes != NULL)
+            table->hashes = hashes;
+        if (offsets == NULL || hashes == NULL) {
+            table->failed = 1;
+            return 0;
+        }
+        table->cap = cap;
+    }
+    while (table->chars_size + (uint32_t) length + 1 > table->chars_cap) {
+        uint32_t chars_cap = table->chars_cap == 0 ? 4096 : table->chars_cap * 2;
+        char* chars = realloc(table->chars, chars_cap);
+        if (chars == NULL) {
+            table->failed = 1;
+            return 0;
+        }
+        table->chars = chars;
+        table->chars_cap = chars_cap;
+    }
+    uint32_t id = table->count++;
+    table->offsets[id] = table->chars_size;
+    table->hashes[id] = hash;
+    for (int i = 0; i < length; i++)
+        table->chars[table->chars_size++] = tolower((unsigned char) text[i]);
+    table->chars[table->chars_size++] = '\0';
+    table->slots[slot] = id + 1;
+
+    // Keep the table at most half full
+    if (table->count * 2 > table->slot_mask + 1)
+        intern_grow_slots(table);
+    return id;
+}
+
+/**
+ * Returns the lowercased text of an interned name.
+ *
+ * @param table The name table.
+ * @param id The id of the name.
+ * @return The NUL-terminated name.
+*/
+const char* intern_text(const InternTable* table, uint32_t id) {
+    return table->chars + table->offsets[id];
+}
+
+/**
+ * Interns every name of another table, in the order of their ids, so that merging the tables of the
+ * parts of a source in source order gives each name the id a scan of the whole source would give.
+ *
+ * @param table The name table, failed if memory is exhausted.
+ * @param part The table whose names are added.
+ * @param ids Receives the id in table of each name of part, part->count entries.
+*/
+void intern_merge(InternTable* table, const InternTable* part, uint32_t* ids) {
+    for (uint32_t id = 0; id < part->count; id++) {
+        uint32_t end = id + 1 < part->count ? part->offsets[id + 1] : part->chars_size;
+        ids[id] = intern(table, intern_text(part, id), (int) (end - part->offsets[id] - 1));
+    }
+}
@@ -0,0 +1,34 @@
+/**
+ * @file
+ * @brief Interned names header file.
+*/
+
+#ifndef INTERN_H_
+#define INTERN_H_
+
+#include <stdint.h>
+
+/**
+ * Defined type based on a struct holding every distinct name met in a program.
+ * Each name is stored once, lowercased, and identified by a dense integer id.
+*/
+typedef struct {
+    char* chars;         /** NUL-terminated names stored back to back. */
+    uint32_t chars_size; /** Number of bytes used in chars. */
+    uint32_t chars_cap;  /** Capacity of chars in bytes. */
+    uint32_t* offsets;   /** Offset in chars of each name, indexed by id. */
+    uint32_t* hashes;    /** Hash of each name, indexed by id. */
+    uint32_t count;      /** Number of interned names. */
+    uint32_t cap;        /** Capacity of offsets and hashes. */
+    uint32_t* slots;     /** Open addressing table holding id + 1, 0 for an empty slot. */
+    uint32_t slot_mask;  /** Number of slots minus one, the slot count being a power of two. */
+    int failed;          /** 1 once memory is exhausted, every name met since then getting id 0. */
+} InternTable;
+
+void intern_init(InternTable* table);
+void intern_free(InternTable* table);
+uint32_t intern(InternTable* table, const char* text, int length);
+const char* intern_text(const InternTable* table, uint32_t id);
+void intern_merge(InternTable* table, const InternTable* part, uint32_t* ids);
+
+#endif
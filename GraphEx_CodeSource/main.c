@@ -1,30 +1,200 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include "scanner.h"
-#include "parser.h"
+#include <string.h>
+#include <time.h>
+#include "graphex.h"
+
+#define OUTPUT_BUFFER_SIZE (1 << 20) /** Size of the stdio buffers used for the results and when tracing or dumping tokens. */
+
+/**
+ * Prints how to call the compiler.
+*/
+void print_usage() {
+    printf("Use: gx [--trace-tokens] [--dump-tokens <tsvpath>] [--stats] [--check] [--ch] [--threads <count>] [--unordered] [--color-budget <ms>] [--flow-scaling] [--emit-c <cpath>] [--verify-image] <filepath>\n");
+    printf("     gx [--stats] [--threads <count>] --compile-graph <filepath> -o <gxbpath>\n");
+    printf("     gx [--stats] [--threads <count>] <filepath | @listpath>...\n");
+}
 
 int main(int argc, char **args) {
-    if (argc != 2) {
-        if (argc < 2)
-            printf("Error: No target file specified for the compiler\n");
-        printf("Use: gx <filepath>\n");
+    const char* path = NULL;
+    Batch batch;
+    int lists = 0;
+    const char* dump_path = NULL;
+    const char* emit_path = NULL;
+    const char* image_path = NULL;
+    int compile_graph = 0;
+    int verify_image = 0;
+    int trace = 0;
+    int hierarchy = 0;
+    int check = 0;
+    ExecOptions options = {0};
+    options.color_budget = COLORING_DEFAULT_BUDGET;
+    batch_init(&batch);
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(args[i], "--trace-tokens") == 0)
+            trace = 1;
+        else if (strcmp(args[i], "--stats") == 0)
+            options.stats = 1;
+        else if (strcmp(args[i], "--ch") == 0)
+            hierarchy = 1;
+        else if (strcmp(args[i], "--check") == 0)
+            check = 1;
+        else if (strcmp(args[i], "--verify-image") == 0)
+            verify_image = 1;
+        else if (strcmp(args[i], "--compile-graph") == 0)
+            compile_graph = 1;
+        else if (strcmp(args[i], "-o") == 0 && i + 1 < argc)
+            image_path = args[++i];
+        else if (strcmp(args[i], "--unordered") == 0)
+            options.unordered = 1;
+        else if (strcmp(args[i], "--flow-scaling") == 0)
+            options.flow_scaling = 1;
+        else if (strcmp(args[i], "--threads") == 0 && i + 1 < argc)
+            options.threads = (uint32_t) strtoul(args[++i], NULL, 10);
+        else if (strcmp(args[i], "--color-budget") == 0 && i + 1 < argc)
+            options.color_budget = (uint32_t) strtoul(args[++i], NULL, 10);
+        else if (strcmp(args[i], "--dump-tokens") == 0 && i + 1 < argc)
+            dump_path = args[++i];
+        else if (strcmp(args[i], "--emit-c") == 0 && i + 1 < argc)
+            emit_path = args[++i];
+        else if (args[i][0] == '-' && args[i][1] == '-') {
+            printf("Error: unknown option \"%s\"\n", args[i]);
+            print_usage();
+            batch_free(&batch);
+            return EXIT_FAILURE;
+        }
+        else if (args[i][0] == '@') { // A list file gives one path per line
+            if (!batch_add_list(&batch, args[i] + 1)) {
+                if (batch.exhausted)
+                    printf("Error: out of memory while reading list file at path \"%s\"\n", args[i] + 1);
+                else
+                    printf("Error: failed to read list file at path \"%s\"\n", args[i] + 1);
+                batch_free(&batch);
+                return EXIT_FAILURE;
+            }
+            lists++;
+        }
+        else if (!batch_add(&batch, args[i])) {
+            printf("Error: out of memory while reading the arguments\n");
+            batch_free(&batch);
+            return EXIT_FAILURE;
+        }
+    }
+    if (batch.count == 0) {
+        printf("Error: No target file specified for the compiler\n");
+        print_usage();
+        batch_free(&batch);
+        return EXIT_FAILURE;
+    }
+    if (compile_graph && image_path == NULL) {
+        printf("Error: --compile-graph needs the path of the image to write with -o\n");
+        print_usage();
+        batch_free(&batch);
         return EXIT_FAILURE;
     }
 
-    PROGRAM_File = fopen(args[1], "r");
+    // Many files are only compiled, on a pool of workers, and their diagnostics printed in input order
+    if (batch.count > 1 || lists > 0) {
+        if (trace || dump_path != NULL || emit_path != NULL || hierarchy || check || compile_graph) {
+            printf("Error: --trace-tokens, --dump-tokens, --emit-c, --ch, --check and --compile-graph need a single target file\n");
+            print_usage();
+            batch_free(&batch);
+            return EXIT_FAILURE;
+        }
+        setvbuf(stdout, NULL, _IOFBF, OUTPUT_BUFFER_SIZE);
+        uint32_t failed = batch_run(&batch, options.threads, options.stats, stdout);
+        batch_free(&batch);
+        return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    path = batch.paths[0];
+    batch_free(&batch);
 
-    if (PROGRAM_File == NULL) {
-        printf("Error: failed to find target source file at path \"%s\"\n", args[1]);
+    // Maps the whole file in memory when possible, reads it in large chunks otherwise
+    GxContext context;
+    gx_init(&context);
+    if (!gx_open(&context, path)) {
+        printf("Error: failed to find target source file at path \"%s\"\n", path);
+        gx_free(&context);
         return EXIT_FAILURE;
     }
-    
-    CURRENT_CHAR = 'a';
-    CURRENT_ROW = 1;
-    CURRENT_COLUMN = 1;
-    
-    parse_program(); // Lexical and syntaxic analysis of the given file
 
-    fclose(PROGRAM_File);
+    // Results and tokens, only traced on demand, go through large fully buffered streams
+    setvbuf(stdout, NULL, _IOFBF, OUTPUT_BUFFER_SIZE);
+    if (trace)
+        context.trace = stdout;
+    if (dump_path != NULL) {
+        context.dump = fopen(dump_path, "w");
+        if (context.dump == NULL) {
+            printf("Error: failed to open token dump file at path \"%s\"\n", dump_path);
+            gx_free(&context);
+            return EXIT_FAILURE;
+        }
+        setvbuf(context.dump, NULL, _IOFBF, OUTPUT_BUFFER_SIZE);
+        fputs("type\tline\tcolumn\tvalue\ttext\n", context.dump);
+    }
+
+    // Only the syntax is checked, one block at a time, whatever the size of the source
+    if (check) {
+        int valid = gx_check(&context);
+        if (options.stats)
+            printf("[stats] check: %llu blocks\n", (unsigned long long) context.blocks);
+        if (context.dump != NULL)
+            fclose(context.dump);
+        gx_free(&context);
+        return valid ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // The contraction hierarchy of the main graph is kept next to the source file
+    char* hierarchy_path = NULL;
+    if (hierarchy) {
+        size_t length = strlen(path);
+        hierarchy_path = malloc(length + sizeof(HIERARCHY_EXTENSION));
+        if (hierarchy_path == NULL) {
+            printf("Error: out of memory while scanning \"%s\"\n", path);
+            if (context.dump != NULL)
+                fclose(context.dump);
+            gx_free(&context);
+            return EXIT_FAILURE;
+        }
+        memcpy(hierarchy_path, path, length);
+        memcpy(hierarchy_path + length, HIERARCHY_EXTENSION, sizeof(HIERARCHY_EXTENSION));
+        options.hierarchy_path = hierarchy_path;
+    }
+
+    // Lexical analysis of the whole file, then syntaxic analysis of its tokens and linking
+    context.threads = options.threads;
+    context.verify = verify_image;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int valid = gx_compile(&context);
+    if (options.stats) {
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        double time = (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) / 1e6;
+        if (context.image)
+            printf("[stats] compile: image, %.3f ms\n", time);
+        else
+            printf("[stats] compile: %u part%s, %.3f ms\n", context.parts, context.parts == 1 ? "" : "s", time);
+    }
+    if (valid && compile_graph) { // The linked program and its lowered operations are saved instead of run
+        uint8_t runnable[OPERATION_COUNT];
+        Bytecode code;
+        exec_runnable(runnable);
+        valid = bytecode_compile(&code, &context.program, runnable);
+        if (valid && !(valid = image_save(&context.program, &code, runnable, image_path)))
+            printf("Error: failed to write graph image at path \"%s\"\n", image_path);
+        bytecode_free(&code);
+    }
+    else if (valid) { // Either runs the operations or compiles them to a C program that runs them
+        if (context.image)
+            options.code = &context.code;
+        valid = emit_path != NULL ? codegen_write(&context.program, &options, emit_path) : exec_program(&context.program, &options);
+    }
+    free(hierarchy_path);
+
+    if (context.dump != NULL)
+        fclose(context.dump);
+    gx_free(&context);
 
-    return EXIT_SUCCESS;
+    return valid ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -5,425 +5,689 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "scanner.h"
+#include "parser.h"
+#include "graph.h"
 
-int parse_subgraph();
-int parse_declare();
-void parse_main();
-void parse_graph();
+/**
+ * Defined type based on a struct holding where a syntax tree node starts.
+*/
+typedef struct {
+    uint32_t mark;  /** Top of the syntax tree stack before the children of the node. */
+    uint32_t token; /** Index of the first token of the node. */
+} NodeStart;
+
+int parse_subgraph(Parser* parser);
+int parse_declare(Parser* parser);
+int parse_main(Parser* parser);
+int parse_graph(Parser* parser);
 
 /**
  * Constant char* array for mapping the token type to the corresponding error name.
 */
 const char* const token_error_map[] = {
-    "", "", "(", ")", "=", "<>", ">", "<", "<=", ">=", "{", "}", "main", "%type", "%declare", "%subgraph", "%operations",
-    "directed or token undirected", "->", ",", ";", "color", "if", "traverse", "operation", "=>", "dfs or token bfs", ":", "EOF"
+#define TOKEN(type, name) name,
+#include "tokens.def"
+#undef TOKEN
 };
 
+/**
+ * Returns the type of the token k positions after the current one.
+ * Looking past the end of the program always gives the final EOF_TOKEN.
+ * 
+ * @param parser The parser.
+ * @param k The distance to the current token, 0 being the current token.
+ * @return The type of the token.
+*/
+TokenType peek(Parser* parser, uint32_t k) {
+    uint32_t i = parser->position + k;
+    if (i >= parser->tokens->count)
+        i = parser->tokens->count - 1;
+    return (TokenType) parser->tokens->types[i];
+}
+
+/**
+ * Moves to the next token, staying on the final EOF_TOKEN once it is reached.
+ *
+ * @param parser The parser.
+*/
+void advance(Parser* parser) {
+    if (parser->position + 1 < parser->tokens->count)
+        parser->position++;
+}
+
+/**
+ * Gathers the data of the current token, for error messages.
+ * 
+ * @param parser The parser.
+ * @return The current token.
+*/
+TokenData current_data(Parser* parser) {
+    TokenData token;
+    uint32_t i = parser->position;
+    token.type = (TokenType) parser->tokens->types[i];
+    token.text = token.type == EOF_TOKEN ? "eof" : parser->text + parser->tokens->offsets[i];
+    token.length = token.type == EOF_TOKEN ? 3 : (int) parser->tokens->lengths[i];
+    token.value = parser->tokens->values[i];
+    token.start_ln = (int) parser->tokens->lines[i];
+    token.start_col = (int) parser->tokens->columns[i];
+    return token;
+}
+
+/**
+ * Returns the value of the current token.
+ * 
+ * @param parser The parser.
+ * @return The interned name of an identifier, the value of a number or the kind of a keyword.
+*/
+int32_t current_value(Parser* parser) {
+    return parser->tokens->values[parser->position];
+}
+
+/**
+ * Starts a syntax tree node on the current token.
+ * 
+ * @param parser The parser.
+ * @return The start of the node, to give to end_node(parser) once its children are parsed.
+*/
+NodeStart begin_node(Parser* parser) {
+    NodeStart start = { ast_mark(parser->ast), parser->position };
+    return start;
+}
+
+/**
+ * Ends a syntax tree node, adopting every node pushed since it was started as its children.
+ * 
+ * @param parser The parser.
+ * @param start The start of the node.
+ * @param kind The AstKind of the node.
+ * @param sub The operation, search method or comparison of the node.
+ * @param value The name, number or color of the node.
+*/
+void end_node(Parser* parser, NodeStart start, AstKind kind, int sub, int32_t value) {
+    AstNode node = {0};
+    node.kind = (uint8_t) kind;
+    node.sub = (uint8_t) sub;
+    node.value = value;
+    node.line = parser->tokens->lines[start.token];
+    node.column = parser->tokens->columns[start.token];
+    ast_reduce(parser->ast, start.mark, node);
+}
+
+/**
+ * Pushes a syntax tree node without children for the current token.
+ * 
+ * @param parser The parser.
+ * @param kind The AstKind of the node.
+ * @param value The name, number or color of the node.
+*/
+void push_leaf(Parser* parser, AstKind kind, int32_t value) {
+    end_node(parser, begin_node(parser), kind, 0, value);
+}
+
+/**
+ * Prints a syntax error describing what was expected instead of the current token.
+ * 
+ * @param parser The parser.
+ * @param expected The description of what was expected.
+*/
+void expected_error(Parser* parser, const char* expected) {
+    TokenData token = current_data(parser);
+    fprintf(parser->messages, "Syntax Error: expected %s but got %.*s at line %d, char %d\n",
+        expected, token.length, token.text, token.start_ln, token.start_col);
+}
+
 /**
  * Prints the syntax error corresponding to the expected type with the error line and column mention.
  * 
+ * @param parser The parser.
  * @param expected_token The expected token type that was failed to match.
 */
-void syntax_error(const TokenType expected_token) { 
+void syntax_error(Parser* parser, const TokenType expected_token) { 
     const char *expected = NULL;
-    if (expected_token == ID_TOKEN)
-        expected = "identifier";
-    else if (expected_token == NUM_TOKEN)
-        expected = "number";
-    else if ((int) expected_token < TOKEN_COUNT)
+    if ((int) expected_token < TOKEN_COUNT)
         expected = token_error_map[expected_token];
-    const char *received = NULL;
-    if (current_token != NULL) {
-        if (current_token->type == ID_TOKEN)
-            received = "identifier";
-        else if (current_token->type == NUM_TOKEN)
-            received = "number";
-        else
-            received = current_token->token;
-    }
-    printf("Syntax Error: expected token %s but got %s at line %d, char %d\n",
-        expected, received, current_token->start_ln, current_token->start_col);
+    TokenData token = current_data(parser);
+    const char *received = token.text;
+    int received_length = token.length;
+    if (token.type == ID_TOKEN)
+        received = "identifier";
+    else if (token.type == NUM_TOKEN)
+        received = "number";
+    if (received != token.text)
+        received_length = (int) strlen(received);
+    fprintf(parser->messages, "Syntax Error: expected token %s but got %.*s at line %d, char %d\n",
+        expected, received_length, received, token.start_ln, token.start_col);
 }
 
 
 /**
  * Prints the syntax error corresponding to the expected type with the error line and column mention.
  * 
+ * @param parser The parser.
  * @param expected_token The expected token type that was failed to match.
  * @return 1 if the current token type matchs the expected type, 0 if not.
 */
-int match(const TokenType type_to_match) {
-    if (current_token != NULL && current_token->type == type_to_match)
+int match(Parser* parser, const TokenType type_to_match) {
+    if (peek(parser, 0) == type_to_match)
+        return 1;
+    return 0;
+}
+
+/**
+ * Checks if the syntax tree could hold every node parsed so far, printing an error if memory is exhausted.
+ *
+ * @param parser The parser.
+ * @return 1 if the tree is complete, 0 if memory is exhausted.
+*/
+int tree_complete(Parser* parser) {
+    if (!parser->ast->failed)
         return 1;
+    fprintf(parser->messages, "Error: out of memory while building the syntax tree\n");
     return 0;
 }
 
+/**
+ * Checks if the current token starts a call of stop(). The word is not reserved, so that a node can be
+ * named stop: it only names the operation when it is called as an instruction of a lambda body.
+ * 
+ * @param parser The parser.
+ * @return 1 if the current token is the identifier stop followed by an opening parenthesis in a lambda body, 0 if not.
+*/
+int is_stop_call(Parser* parser) {
+    uint32_t i = parser->position;
+    return parser->lambdas > 0 && match(parser, ID_TOKEN) && peek(parser, 1) == OP_TOKEN
+        && isWord(parser->text + parser->tokens->offsets[i], (int) parser->tokens->lengths[i], "stop");
+}
+
 /**
  * Checks if the current token is a valid instruction.
  * 
+ * @param parser The parser.
  * @return 1 if valid instruction, 0 if not.
 */
-int is_instruction() {
-    return match(OPERATION_TOKEN) || match(LOOP_TOKEN) || match(IF_TOKEN);
+int is_instruction(Parser* parser) {
+    return match(parser, OPERATION_TOKEN) || match(parser, LOOP_TOKEN) || match(parser, IF_TOKEN) || is_stop_call(parser);
 }
 
 /**
  * Checks if the current token is a valid operation parameter.
  * 
+ * @param parser The parser.
  * @return 1 if valid operation parameter, 0 if not.
 */
-int is_operation_param() {
-    return match(OPERATION_TOKEN) || match(ID_TOKEN) || match(COLOR_TOKEN);
+int is_operation_param(Parser* parser) {
+    return match(parser, OPERATION_TOKEN) || match(parser, ID_TOKEN) || match(parser, COLOR_TOKEN) || match(parser, NUM_TOKEN);
 }
 
 /**
  * Checks if the current token is a valid condition expression.
  * 
+ * @param parser The parser.
  * @return 1 if valid condition expression, 0 if not.
 */
-int is_expression() {
-    return match(NUM_TOKEN) || match(OPERATION_TOKEN);
+int is_expression(Parser* parser) {
+    return match(parser, NUM_TOKEN) || match(parser, OPERATION_TOKEN);
 }
 
 /**
  * Checks if the current token is a valid comparison operator.
  * 
+ * @param parser The parser.
  * @return 1 if valid comparison operator, 0 if not.
 */
-int is_compare_op() {
-    return match(EQ_TOKEN) || match(NEQ_TOKEN) || match(GT_TOKEN) || match(LT_TOKEN)
-        || match(BEQ_TOKEN) || match(LEQ_TOKEN);
+int is_compare_op(Parser* parser) {
+    return match(parser, EQ_TOKEN) || match(parser, NEQ_TOKEN) || match(parser, GT_TOKEN) || match(parser, LT_TOKEN)
+        || match(parser, BEQ_TOKEN) || match(parser, LEQ_TOKEN);
 }
 
 /**
- * Parses the next token and calls parse_graph() or parse_main() correspondingly.
- * If the parsed token is neither an identifier nor a main token, an error is printed and the parser halts.
+ * Parses the top-level blocks one after the other, with parse_graph(parser) or parse_main(parser), the main block being last.
+ * If a block starts with neither an identifier nor a main token, an error is printed and the parser halts.
+ * When the program is streamed, the tokens of each block are scanned just before it is parsed, and the
+ * block is given to the consumer then released, so that any number of blocks fits in memory.
+ * 
+ * @param parser The parser.
+ * @return 0 if a syntax error is found or memory is exhausted, 1 if not.
 */
-void parse_program() {
-    next_token();
-    if (!match(EOF_TOKEN)) {
-        if (match(ID_TOKEN))
-            parse_graph();
-        else if (match(MAIN_TOKEN))
-            parse_main();
+int parse_program(Parser* parser) {
+    while (1) {
+        if (parser->scanner != NULL) {
+            if (!scan_block(parser->scanner, parser->tokens)) {
+                if (!parser->scanner->failed)
+                    fprintf(parser->messages, "Error: out of memory while scanning a block\n");
+                return 0;
+            }
+            parser->position = 0;
+        }
+        if (match(parser, EOF_TOKEN))
+            return 1;
+        int last = match(parser, MAIN_TOKEN);
+        uint32_t mark = ast_mark(parser->ast);
+        uint32_t count = parser->ast->count;
+        if (match(parser, ID_TOKEN)) {
+            if (!parse_graph(parser))
+                return 0;
+        }
+        else if (last) {
+            if (!parse_main(parser))
+                return 0;
+        }
         else {
-            printf("Syntax Error: expected an identifier or keyword main but got %s at line %d, char %d",
-                current_token->token, current_token->start_ln, current_token->start_col);
-            return;
+            expected_error(parser, "an identifier or keyword main");
+            return 0;
+        }
+        if (!tree_complete(parser))
+            return 0;
+        if (parser->consumer != NULL) {
+            const Ast* ast = parser->ast;
+            if (!parser->consumer->block(parser->consumer->data, ast, &ast->stack[ast->depth - 1]))
+                return 0;
+            ast_truncate(parser->ast, mark, count);
         }
+        if (last)
+            return 1;
     }
 }
 
 /**
- * Parses the graph type (%type) delcaration and calls the parse_subgraph() function.
+ * Parses the graph type (%type) delcaration and calls the parse_subgraph(parser) function.
  * 
- * @return 0 if a syntax error is found, else returns parse_subgraph() value.
+ * @param parser The parser.
+ * @return 0 if a syntax error is found, else returns parse_subgraph(parser) value.
 */
-int parse_graph_type() {
-    if (!match(PTYPE_TOKEN)) {
-        syntax_error(PTYPE_TOKEN);
+int parse_graph_type(Parser* parser) {
+    NodeStart start = begin_node(parser);
+    if (!match(parser, PTYPE_TOKEN)) {
+        syntax_error(parser, PTYPE_TOKEN);
         return 0;
     }
-    next_token();
-    if (!match(OB_TOKEN)) {
-        syntax_error(OB_TOKEN);
+    advance(parser);
+    if (!match(parser, OB_TOKEN)) {
+        syntax_error(parser, OB_TOKEN);
         return 0;
     }
-    next_token();
-    if (!match(GTYPE_TOKEN)) {
-        syntax_error(GTYPE_TOKEN);
+    advance(parser);
+    if (!match(parser, GTYPE_TOKEN)) {
+        syntax_error(parser, GTYPE_TOKEN);
         return 0;
     }
-    next_token();
-    if (!match(CB_TOKEN)) {
-        syntax_error(CB_TOKEN);
+    int32_t directed = current_value(parser);
+    parser->directed = directed;
+    advance(parser);
+    if (!match(parser, CB_TOKEN)) {
+        syntax_error(parser, CB_TOKEN);
         return 0;
     }
-    next_token();
-    return parse_subgraph();
+    end_node(parser, start, AST_TYPE, 0, directed);
+    advance(parser);
+    return parse_subgraph(parser);
 }
 
 /**
- * Parses subgraphs declarations if next token matches %subgraph. Calls parse_declare() at the end.
+ * Parses subgraphs declarations if next token matches %subgraph. Calls parse_declare(parser) at the end.
  * 
- * @return 0 if a syntax error is found, else returns parse_declare() value.
+ * @param parser The parser.
+ * @return 0 if a syntax error is found, else returns parse_declare(parser) value.
 */
-int parse_subgraph() {
-    if (match(PSUBGRAPH_TOKEN)) { // Subgraph instances are optional
-        next_token();
-        if (!match(ID_TOKEN)) {
-            syntax_error(ID_TOKEN);
+int parse_subgraph(Parser* parser) {
+    if (match(parser, PSUBGRAPH_TOKEN)) { // Subgraph instances are optional
+        NodeStart subgraph = begin_node(parser);
+        advance(parser);
+        if (!match(parser, ID_TOKEN)) {
+            syntax_error(parser, ID_TOKEN);
             return 0;
         }
-        while (match(ID_TOKEN)) {
-            next_token();
-            if (!match(COLON_TOKEN)) {
-                syntax_error(COLON_TOKEN);
+        while (match(parser, ID_TOKEN)) {
+            NodeStart instances = begin_node(parser);
+            int32_t template_name = current_value(parser);
+            advance(parser);
+            if (!match(parser, COLON_TOKEN)) {
+                syntax_error(parser, COLON_TOKEN);
                 return 0;
             }
-            next_token();
-            if (!match(ID_TOKEN)) {
-                syntax_error(ID_TOKEN);
+            advance(parser);
+            if (!match(parser, ID_TOKEN)) {
+                syntax_error(parser, ID_TOKEN);
                 return 0;
             }
-            next_token();
-            while (match(COMMA_TOKEN)) {
-                next_token();
-                if (!match(ID_TOKEN)) {
-                    syntax_error(ID_TOKEN);
+            push_leaf(parser, AST_ID, current_value(parser));
+            advance(parser);
+            while (match(parser, COMMA_TOKEN)) {
+                advance(parser);
+                if (!match(parser, ID_TOKEN)) {
+                    syntax_error(parser, ID_TOKEN);
                     return 0;
                 }
-                next_token();
+                push_leaf(parser, AST_ID, current_value(parser));
+                advance(parser);
             }
-            if (!match(SEMICOLON_TOKEN)) {
-                syntax_error(SEMICOLON_TOKEN);
+            if (!match(parser, SEMICOLON_TOKEN)) {
+                syntax_error(parser, SEMICOLON_TOKEN);
                 return 0;
             }
-            next_token();
+            end_node(parser, instances, AST_INSTANCES, 0, template_name);
+            advance(parser);
         }
+        end_node(parser, subgraph, AST_SUBGRAPH, 0, 0);
     }
-    return parse_declare();
+    return parse_declare(parser);
 }
 
 /**
- * Parses nodes & edges declarations.
+ * Parses nodes & edges declarations, streaming them to the DeclareSink.
+ * In a chain such as a -> b -> c, each edge leaves the target of the previous one.
  * 
- * @return 0 if a syntax error is found, 1 if not.
+ * @param parser The parser.
+ * @return 0 if a syntax error is found or the sink can't build the graph, 1 if not.
 */
-int parse_declare() {
-    if (!match(PDECLARE_TOKEN)) {
-        syntax_error(PDECLARE_TOKEN);
+int parse_declare(Parser* parser) {
+    NodeStart declare = begin_node(parser);
+    if (!match(parser, PDECLARE_TOKEN)) {
+        syntax_error(parser, PDECLARE_TOKEN);
         return 0;
     }
-    next_token();
-    if (!match(ID_TOKEN)) {
-        syntax_error(ID_TOKEN);
+    if (parser->sink != NULL)
+        parser->sink->begin(parser->sink->data, parser->block, parser->directed);
+    advance(parser);
+    if (!match(parser, ID_TOKEN)) {
+        syntax_error(parser, ID_TOKEN);
         return 0;
     }
-    while (match(ID_TOKEN)) {
-        next_token();
-        while (match(EDGE_TOKEN)) {
+    while (match(parser, ID_TOKEN)) {
+        int32_t source = current_value(parser);
+        if (parser->sink != NULL)
+            parser->sink->node(parser->sink->data, source);
+        advance(parser);
+        while (match(parser, EDGE_TOKEN)) {
             int is_subgraph = 0;
-            next_token();
-            if (!match(ID_TOKEN)) {
-                syntax_error(ID_TOKEN);
+            int32_t instance_node = AST_NO_NAME;
+            int32_t weight = GRAPH_DEFAULT_WEIGHT;
+            int32_t capacity = GRAPH_NO_CAPACITY;
+            advance(parser);
+            if (!match(parser, ID_TOKEN)) {
+                syntax_error(parser, ID_TOKEN);
                 return 0;
             }
-            next_token();
-            if (match(OP_TOKEN)) { // Subgraph call
-                next_token();
-                if (match(ID_TOKEN)) // Optional node parameter
-                    next_token();
-                if (!match(CP_TOKEN)) {
-                    syntax_error(CP_TOKEN);
+            int32_t target = current_value(parser);
+            uint32_t line = parser->tokens->lines[parser->position];
+            advance(parser);
+            if (match(parser, OP_TOKEN)) { // Subgraph call
+                advance(parser);
+                if (match(parser, ID_TOKEN)) { // Optional node parameter
+                    instance_node = current_value(parser);
+                    advance(parser);
+                }
+                if (!match(parser, CP_TOKEN)) {
+                    syntax_error(parser, CP_TOKEN);
                     return 0;
                 }
                 is_subgraph = 1;
-                next_token();
+                advance(parser);
             }
-            if (match(COMMA_TOKEN)) { // Optional weight
-                next_token();
-                if (!match(NUM_TOKEN)) {
-                    syntax_error(NUM_TOKEN);
+            if (match(parser, COMMA_TOKEN)) { // Optional weight
+                advance(parser);
+                if (!match(parser, NUM_TOKEN)) {
+                    syntax_error(parser, NUM_TOKEN);
                     return 0;
                 }
-                next_token();
+                weight = current_value(parser);
+                advance(parser);
+            }
+            if (match(parser, COLON_TOKEN)) { // Optional capacity
+                advance(parser);
+                if (!match(parser, NUM_TOKEN) || current_value(parser) < 0) {
+                    expected_error(parser, "a non-negative capacity");
+                    return 0;
+                }
+                capacity = current_value(parser);
+                advance(parser);
+            }
+            if (parser->sink != NULL) {
+                if (is_subgraph)
+                    parser->sink->attach(parser->sink->data, source, target, instance_node, weight, capacity, line);
+                else
+                    parser->sink->edge(parser->sink->data, source, target, weight, capacity, line);
             }
             if (is_subgraph) // Can't consider the whole subgraph as a root to another graph/node
                 break;
+            source = target;
         }
-        if (!match(SEMICOLON_TOKEN)) {
-            syntax_error(SEMICOLON_TOKEN);
+        if (!match(parser, SEMICOLON_TOKEN)) {
+            syntax_error(parser, SEMICOLON_TOKEN);
             return 0;
         }
-        next_token();
+        advance(parser);
     }
+    int32_t graph = parser->sink != NULL ? parser->sink->end(parser->sink->data) : -1;
+    if (parser->sink != NULL && graph < 0) // The sink printed why
+        return 0;
+    end_node(parser, declare, AST_DECLARE, 0, graph);
     return 1;
 }
 
+/**
+ * Adds the current token as a leaf parameter of an operation call: a node, a color or a number.
+ *
+ * @param parser The parser.
+*/
+void push_param_leaf(Parser* parser) {
+    if (match(parser, ID_TOKEN))
+        push_leaf(parser, AST_ID, current_value(parser));
+    else if (match(parser, COLOR_TOKEN))
+        push_leaf(parser, AST_COLOR, current_value(parser));
+    else
+        push_leaf(parser, AST_NUM, current_value(parser));
+}
+
 /**
  * Parses a single operation call, stoping at the closing parenthesis token.
  * Recursively calls itself if one of the operation parameters is also an operation.
  * 
+ * @param parser The parser.
  * @return 0 if a syntax error is found, 1 if not.
 */
-int parse_operation_call() {
-    if (!match(OPERATION_TOKEN)) {
-        syntax_error(OPERATION_TOKEN);
-        return 0;
+int parse_operation_call(Parser* parser) {
+    NodeStart call = begin_node(parser);
+    int operation = OP_STOP;
+    if (!is_stop_call(parser)) {
+        if (!match(parser, OPERATION_TOKEN)) {
+            syntax_error(parser, OPERATION_TOKEN);
+            return 0;
+        }
+        operation = current_value(parser);
     }
-    next_token();
-    if (!match(OP_TOKEN)) {
-        syntax_error(OP_TOKEN);
+    advance(parser);
+    if (!match(parser, OP_TOKEN)) {
+        syntax_error(parser, OP_TOKEN);
         return 0;
     }
-    next_token();
-    if (is_operation_param()) {
-        if (match(OPERATION_TOKEN)) { // Recursively call operation as a parameter of an another
-            if (!parse_operation_call())
+    advance(parser);
+    if (is_operation_param(parser)) {
+        if (match(parser, OPERATION_TOKEN)) { // Recursively call operation as a parameter of an another
+            if (!parse_operation_call(parser))
                 return 0;
         }
-        next_token();
-        while (match(COMMA_TOKEN)) {
-            next_token();
-            if (!is_operation_param()) {
-                printf("Syntax Error: expected operation parameter but got %s at line %d, chat%d\n",
-                    current_token->token, current_token->start_ln, current_token->start_col);
+        else
+            push_param_leaf(parser);
+        advance(parser);
+        while (match(parser, COMMA_TOKEN)) {
+            advance(parser);
+            if (!is_operation_param(parser)) {
+                expected_error(parser, "operation parameter");
                 return 0;
             }
-            if (match(OPERATION_TOKEN)) {
-                if (!parse_operation_call())
+            if (match(parser, OPERATION_TOKEN)) {
+                if (!parse_operation_call(parser))
                     return 0;
             }
-            next_token();
+            else
+                push_param_leaf(parser);
+            advance(parser);
         }
     }
-    if (!match(CP_TOKEN)) {
-        syntax_error(CP_TOKEN);
+    if (!match(parser, CP_TOKEN)) {
+        syntax_error(parser, CP_TOKEN);
         return 0;
     }
+    end_node(parser, call, AST_CALL, operation, 0);
     return 1;
 }
 
 /**
  * Parses successive valid instructions (operation call, if clause or traverse clause).
  * 
+ * @param parser The parser.
  * @return 0 if a syntax error is found, 1 if not.
 */
-int operations_routine() {
-    while (is_instruction()) {
-        if (match(OPERATION_TOKEN)) {
-            if (!parse_operation_call())
+int operations_routine(Parser* parser) {
+    while (is_instruction(parser)) {
+        if (match(parser, OPERATION_TOKEN) || is_stop_call(parser)) {
+            if (!parse_operation_call(parser))
                 return 0;
-            next_token();
-            if (!match(SEMICOLON_TOKEN)) {
-                syntax_error(SEMICOLON_TOKEN);
+            advance(parser);
+            if (!match(parser, SEMICOLON_TOKEN)) {
+                syntax_error(parser, SEMICOLON_TOKEN);
                 return 0;
             }
         }
-        else if (match(LOOP_TOKEN)) {
-            next_token();
-            if (!match(OP_TOKEN)) {
-                syntax_error(OP_TOKEN);
+        else if (match(parser, LOOP_TOKEN)) {
+            NodeStart traverse = begin_node(parser);
+            int32_t graph = AST_NO_NAME;
+            advance(parser);
+            if (!match(parser, OP_TOKEN)) {
+                syntax_error(parser, OP_TOKEN);
                 return 0;
             }
-            next_token();
-            if (match(ID_TOKEN)) { // Optionally select what graph to traverse. If left out, main graph is traversed.
-                next_token();
-                if (!match(COMMA_TOKEN)) {
-                    syntax_error(COMMA_TOKEN);
-                    return 0;
-                }
-                next_token();
+            advance(parser);
+            if (match(parser, ID_TOKEN) && peek(parser, 1) == COMMA_TOKEN) { // Optionally select what graph to traverse. If left out, main graph is traversed.
+                graph = current_value(parser);
+                advance(parser);
+                advance(parser);
             }
-            if (!match(GSEARCH_TOKEN)) {
-                syntax_error(GSEARCH_TOKEN);
+            if (!match(parser, GSEARCH_TOKEN)) {
+                syntax_error(parser, GSEARCH_TOKEN);
                 return 0;
             }
-            next_token();
-            if (!match(COMMA_TOKEN)) {
-                syntax_error(COMMA_TOKEN);
+            int search = current_value(parser);
+            advance(parser);
+            if (!match(parser, COMMA_TOKEN)) {
+                syntax_error(parser, COMMA_TOKEN);
                 return 0;
             }
-            next_token();
-            if (!match(OP_TOKEN)) {
-                syntax_error(OP_TOKEN);
+            advance(parser);
+            if (!match(parser, OP_TOKEN)) {
+                syntax_error(parser, OP_TOKEN);
                 return 0;
             }
+            NodeStart lambda = begin_node(parser);
             for (int i = 0; i < 3; i++) {
-                next_token();
-                if (!match(ID_TOKEN)) {
-                    syntax_error(ID_TOKEN);
+                advance(parser);
+                if (!match(parser, ID_TOKEN)) {
+                    syntax_error(parser, ID_TOKEN);
                     return 0;
                 }
-                next_token();
-                if (i < 2 && !match(COMMA_TOKEN)) {
-                    syntax_error(COMMA_TOKEN);
+                push_leaf(parser, AST_ID, current_value(parser));
+                advance(parser);
+                if (i < 2 && !match(parser, COMMA_TOKEN)) {
+                    syntax_error(parser, COMMA_TOKEN);
                     return 0;
                 }
             }
-            if (!match(CP_TOKEN)) {
-                syntax_error(CP_TOKEN);
+            if (!match(parser, CP_TOKEN)) {
+                syntax_error(parser, CP_TOKEN);
                 return 0;
             }
-            next_token();
-            if (!match(ARROW_TOKEN)) {
-                syntax_error(ARROW_TOKEN);
+            advance(parser);
+            if (!match(parser, ARROW_TOKEN)) {
+                syntax_error(parser, ARROW_TOKEN);
                 return 0;
             }
-            next_token();
-            if (!match(OB_TOKEN)) {
-                syntax_error(OB_TOKEN);
+            advance(parser);
+            if (!match(parser, OB_TOKEN)) {
+                syntax_error(parser, OB_TOKEN);
                 return 0;
             }
-            next_token();
-            if (!operations_routine())
+            advance(parser);
+            parser->lambdas++;
+            if (!operations_routine(parser))
                 return 0;
-            if (!match(CB_TOKEN)) {
-                syntax_error(CB_TOKEN);
+            parser->lambdas--;
+            if (!match(parser, CB_TOKEN)) {
+                syntax_error(parser, CB_TOKEN);
                 return 0;
             }
-            next_token();
-            if (!match(CP_TOKEN)) {
-                syntax_error(CP_TOKEN);
+            end_node(parser, lambda, AST_LAMBDA, 0, 0);
+            advance(parser);
+            if (!match(parser, CP_TOKEN)) {
+                syntax_error(parser, CP_TOKEN);
                 return 0;
             }
-            next_token();
-            if (!match(SEMICOLON_TOKEN)) {
-                syntax_error(SEMICOLON_TOKEN);
+            advance(parser);
+            if (!match(parser, SEMICOLON_TOKEN)) {
+                syntax_error(parser, SEMICOLON_TOKEN);
                 return 0;
             }
+            end_node(parser, traverse, AST_TRAVERSE, search, graph);
         }
         else { // an IF_TOKEN is read
-            next_token();
-            if (!match(OP_TOKEN)) {
-                syntax_error(OP_TOKEN);
+            NodeStart if_clause = begin_node(parser);
+            advance(parser);
+            if (!match(parser, OP_TOKEN)) {
+                syntax_error(parser, OP_TOKEN);
                 return 0;
             }
-            next_token();
-            if (!is_expression()) { // expression == either a number or an operation call
-                printf("Syntax Error: expected an expression but got %s at line %d, char %d\n",
-                    current_token->token, current_token->start_ln, current_token->start_col);
+            advance(parser);
+            NodeStart condition = begin_node(parser);
+            int compare = 0;
+            if (!is_expression(parser)) { // expression == either a number or an operation call
+                expected_error(parser, "an expression");
                 return 0;
             }
-            if (match(OPERATION_TOKEN)) {
-                if (!parse_operation_call())
+            if (match(parser, OPERATION_TOKEN)) {
+                if (!parse_operation_call(parser))
                     return 0;
             }
-            next_token();
-            if (is_compare_op()) {
-                next_token();
-                if (!is_expression()) {
-                    printf("Syntax Error: expected an expression but got %s at line %d, char %d\n",
-                        current_token->token, current_token->start_ln, current_token->start_col);
+            else
+                push_leaf(parser, AST_NUM, current_value(parser));
+            advance(parser);
+            if (is_compare_op(parser)) {
+                compare = peek(parser, 0);
+                advance(parser);
+                if (!is_expression(parser)) {
+                    expected_error(parser, "an expression");
                     return 0;
                 }
-                if (match(OPERATION_TOKEN)) {
-                    if (!parse_operation_call())
+                if (match(parser, OPERATION_TOKEN)) {
+                    if (!parse_operation_call(parser))
                         return 0;
                 }
-                next_token();
+                else
+                    push_leaf(parser, AST_NUM, current_value(parser));
+                advance(parser);
             }
-            if (!match(CP_TOKEN)) {
-                syntax_error(CP_TOKEN);
+            end_node(parser, condition, AST_CONDITION, compare, 0);
+            if (!match(parser, CP_TOKEN)) {
+                syntax_error(parser, CP_TOKEN);
                 return 0;
             }
-            next_token();
-            if (!match(OB_TOKEN)) {
-                syntax_error(OB_TOKEN);
+            advance(parser);
+            if (!match(parser, OB_TOKEN)) {
+                syntax_error(parser, OB_TOKEN);
                 return 0;
             }
-            next_token();
-            if (!operations_routine()) {
+            advance(parser);
+            if (!operations_routine(parser)) {
                 return 0;
             }
-            if (!match(CB_TOKEN)) {
-                syntax_error(CB_TOKEN);
+            if (!match(parser, CB_TOKEN)) {
+                syntax_error(parser, CB_TOKEN);
                 return 0;
             }
+            end_node(parser, if_clause, AST_IF, 0, 0);
         }
-        next_token();
+        advance(parser);
     }
     return 1;
 }
@@ -431,70 +695,177 @@ int operations_routine() {
 /**
  * Parses an operations block.
  * 
+ * @param parser The parser.
  * @return 0 if a syntax error is found, 1 if not.
 */
-int parse_operations() {
-    if (!match(POPERATIONS_TOKEN)) {
-        syntax_error(POPERATIONS_TOKEN);
+int parse_operations(Parser* parser) {
+    NodeStart operations = begin_node(parser);
+    if (!match(parser, POPERATIONS_TOKEN)) {
+        syntax_error(parser, POPERATIONS_TOKEN);
         return 0;
     }
-    next_token();
-    if (!is_instruction()) { // At least one instruction should be written (Predefined operation, if clause or traverse clause)
-        printf("Syntax Error: expected an operation or instruction but got %s at line %d, char %d",
-            current_token->token, current_token->start_ln, current_token->start_col);
+    advance(parser);
+    if (!is_instruction(parser)) { // At least one instruction should be written (Predefined operation, if clause or traverse clause)
+        expected_error(parser, "an operation or instruction");
         return 0;
     }
-    return operations_routine();
+    if (!operations_routine(parser))
+        return 0;
+    end_node(parser, operations, AST_OPERATIONS, 0, 0);
+    return 1;
 }
 
 /**
- * Parses a graph declaration. Calls parse_program() at the end.
+ * Parses a graph declaration.
+ * 
+ * @param parser The parser.
+ * @return 0 if a syntax error is found, 1 if not.
 */
-void parse_graph() {
-    if (!match(ID_TOKEN)) {
-        syntax_error(ID_TOKEN);
-        return;
+int parse_graph(Parser* parser) {
+    NodeStart graph = begin_node(parser);
+    if (!match(parser, ID_TOKEN)) {
+        syntax_error(parser, ID_TOKEN);
+        return 0;
     }
-    next_token();
-    if (!match(OB_TOKEN)) {
-        syntax_error(OB_TOKEN);
-        return;
+    int32_t name = current_value(parser);
+    parser->block = name;
+    advance(parser);
+    if (!match(parser, OB_TOKEN)) {
+        syntax_error(parser, OB_TOKEN);
+        return 0;
     }
-    next_token();
-    if (!parse_graph_type()) // Already calls parse_subgraph and parse_delcare, and points on the next token
-        return;
-    if (!match(CB_TOKEN)) {
-        syntax_error(CB_TOKEN);
-        return;
+    advance(parser);
+    if (!parse_graph_type(parser)) // Already calls parse_subgraph and parse_delcare, and points on the next token
+        return 0;
+    if (!match(parser, CB_TOKEN)) {
+        syntax_error(parser, CB_TOKEN);
+        return 0;
     }
-    parse_program();
+    end_node(parser, graph, AST_GRAPH, 0, name);
+    advance(parser);
+    return 1;
 }
 
 /**
- * Parses a main block. Calls parse_operations() to parse the operations block.
+ * Parses a main block. Calls parse_operations(parser) to parse the operations block.
+ * 
+ * @param parser The parser.
+ * @return 0 if a syntax error is found, 1 if not.
 */
-void parse_main() {
-    if (!match(MAIN_TOKEN)) {
-        syntax_error(MAIN_TOKEN);
-        return;
+int parse_main(Parser* parser) {
+    NodeStart main_block = begin_node(parser);
+    if (!match(parser, MAIN_TOKEN)) {
+        syntax_error(parser, MAIN_TOKEN);
+        return 0;
     }
-    next_token();
-    if (!match(OB_TOKEN)) {
-        syntax_error(OB_TOKEN);
-        return;
+    parser->block = -1;
+    advance(parser);
+    if (!match(parser, OB_TOKEN)) {
+        syntax_error(parser, OB_TOKEN);
+        return 0;
     }
-    next_token();
-    if (!parse_graph_type())
-        return;
-    if (!parse_operations())
-        return;
-    if (!match(CB_TOKEN)) {
-        syntax_error(CB_TOKEN);
-        return;
+    advance(parser);
+    if (!parse_graph_type(parser))
+        return 0;
+    if (!parse_operations(parser))
+        return 0;
+    if (!match(parser, CB_TOKEN)) {
+        syntax_error(parser, CB_TOKEN);
+        return 0;
     }
-    next_token();
-    if (!match(EOF_TOKEN)) {
-        syntax_error(EOF_TOKEN);
-        return;
+    end_node(parser, main_block, AST_MAIN, 0, 0);
+    advance(parser);
+    if (!match(parser, EOF_TOKEN)) {
+        syntax_error(parser, EOF_TOKEN);
+        return 0;
     }
+    return 1;
+}
+
+/**
+ * Parses a whole program from its token buffer and builds its syntax tree.
+ * 
+ * @param source The source text of the tokens.
+ * @param tokens The tokens of the program, ending with an EOF_TOKEN.
+ * @param ast An empty syntax tree, whose root is the AST_PROGRAM node if the program is valid.
+ * @param sink Receives the nodes and edges of each %declare block, NULL to only validate them.
+ * @param messages Where syntax errors, and running out of memory, are printed.
+ * @return 0 if a syntax error is found or memory is exhausted, 1 if not.
+*/
+int parse_tokens(const Source* source, TokenBuffer* tokens, Ast* ast, DeclareSink* sink, FILE* messages) {
+    Parser state = {0};
+    Parser* parser = &state;
+    parser->text = source->data;
+    parser->tokens = tokens;
+    parser->ast = ast;
+    parser->sink = sink;
+    parser->messages = messages;
+    NodeStart program = begin_node(parser);
+    if (!parse_program(parser))
+        return 0;
+    end_node(parser, program, AST_PROGRAM, 0, 0);
+    ast_finish(ast);
+    return tree_complete(parser);
+}
+
+/**
+ * Parses a part of a program made of whole blocks, leaving each block on the stack of its syntax tree
+ * so that the parts can be appended to one tree with ast_append(), then ended by parse_join().
+ *
+ * @param source The source text of the tokens, whose offsets start at the beginning of the text.
+ * @param tokens The tokens of the part, ending with an EOF_TOKEN.
+ * @param ast An empty syntax tree.
+ * @param sink Receives the nodes and edges of each %declare block, NULL to only validate them.
+ * @param messages Where syntax errors, and running out of memory, are printed.
+ * @return 0 if a syntax error is found or memory is exhausted, 1 if not.
+*/
+int parse_part(const Source* source, TokenBuffer* tokens, Ast* ast, DeclareSink* sink, FILE* messages) {
+    Parser state = {0};
+    state.text = source->data;
+    state.tokens = tokens;
+    state.ast = ast;
+    state.sink = sink;
+    state.messages = messages;
+    return parse_program(&state);
+}
+
+/**
+ * Ends the syntax tree of a program whose parts were parsed by parse_part(), every block being on its stack.
+ *
+ * @param ast The syntax tree, whose root is the AST_PROGRAM node once joined.
+ * @param line The line of the first token of the program.
+ * @param column The column of the first token of the program.
+*/
+void parse_join(Ast* ast, uint32_t line, uint32_t column) {
+    AstNode program = {0};
+    program.kind = AST_PROGRAM;
+    program.line = line;
+    program.column = column;
+    ast_reduce(ast, 0, program);
+    ast_finish(ast);
+}
+
+/**
+ * Parses a program one top-level block at a time, scanning the tokens of each block just before it is parsed.
+ * Each block is given to the consumer then released, so that memory is bounded by the largest block
+ * rather than by the whole program. Lexical and syntax errors are found in source order.
+ * 
+ * @param scanner The scanner of the source, at its start.
+ * @param tokens An empty token buffer, holding one block at a time.
+ * @param ast An empty syntax tree, holding one block at a time.
+ * @param sink Receives the nodes and edges of each %declare block, NULL to only validate them.
+ * @param consumer Receives each block once it is parsed.
+ * @param messages Where syntax errors, and running out of memory, are printed.
+ * @return 0 if a lexical or syntax error is found, if memory is exhausted or if the consumer stops the parse, 1 if not.
+*/
+int parse_stream(Scanner* scanner, TokenBuffer* tokens, Ast* ast, DeclareSink* sink, BlockSink* consumer, FILE* messages) {
+    Parser state = {0};
+    state.text = scanner->source->data;
+    state.tokens = tokens;
+    state.ast = ast;
+    state.sink = sink;
+    state.messages = messages;
+    state.scanner = scanner;
+    state.consumer = consumer;
+    return parse_program(&state);
 }
@@ -6,8 +6,54 @@
 #ifndef PARSER_H_
 #define PARSER_H_
 
-extern const char* const keywords[];
+#include <stdio.h>
+#include "scanner.h"
+#include "ast.h"
 
-void parse_program();
+/**
+ * Defined type based on a struct of callbacks receiving the content of each %declare block while it is parsed,
+ * so that graphs are built without storing their edges in the syntax tree.
+*/
+typedef struct {
+    void* data; /** Passed to every callback. */
+    void (*begin)(void* data, int32_t graph, int directed);
+    void (*node)(void* data, int32_t name);
+    void (*edge)(void* data, int32_t source, int32_t target, int32_t weight, int32_t capacity, uint32_t line);
+    void (*attach)(void* data, int32_t source, int32_t instance, int32_t node, int32_t weight, int32_t capacity, uint32_t line);
+    int32_t (*end)(void* data); /** Returns the index of the graph, or -1 to stop the parse once it printed why. */
+} DeclareSink;
+
+/**
+ * Defined type based on a struct holding the callback receiving each top-level block as soon as it is parsed,
+ * when a program is streamed one block at a time. The nodes of the block are released once it returns.
+*/
+typedef struct {
+    void* data; /** Passed to the callback. */
+    int (*block)(void* data, const Ast* ast, const AstNode* block); /** Returns 0 to stop the parse. */
+} BlockSink;
+
+/**
+ * Defined type based on a struct holding the state of the parse of a token buffer, so that several
+ * programs can be parsed at once, each by its own parser.
+*/
+typedef struct {
+    const char* text;    /** Source text of the tokens. */
+    TokenBuffer* tokens; /** Tokens of the program being parsed. */
+    uint32_t position;   /** Index of the current token in tokens. */
+    Ast* ast;            /** Syntax tree being built. */
+    DeclareSink* sink;   /** Receives the %declare blocks, NULL when the program is only validated. */
+    int32_t block;       /** Interned name of the block being parsed, -1 for the main block. */
+    int directed;        /** Graph type of the block being parsed. */
+    FILE* messages;      /** Where syntax errors are printed. */
+    Scanner* scanner;    /** Scans the tokens of each block when the program is streamed, NULL when they are all scanned. */
+    BlockSink* consumer; /** Receives each block when the program is streamed, NULL when the whole tree is kept. */
+    uint32_t lambdas;    /** Number of lambda bodies the current token is in. */
+} Parser;
+
+int parse_program(Parser* parser);
+int parse_tokens(const Source* source, TokenBuffer* tokens, Ast* ast, DeclareSink* sink, FILE* messages);
+int parse_part(const Source* source, TokenBuffer* tokens, Ast* ast, DeclareSink* sink, FILE* messages);
+void parse_join(Ast* ast, uint32_t line, uint32_t column);
+int parse_stream(Scanner* scanner, TokenBuffer* tokens, Ast* ast, DeclareSink* sink, BlockSink* consumer, FILE* messages);
 
 #endif
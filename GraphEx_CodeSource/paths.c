@@ -0,0 +1,701 @@
+/**
+ * @file
+ * @brief Shortest paths source file.
+ *
+ * Dijkstra's algorithm over a GraphView, with its A* and bidirectional variants. The weights of
+ * the view decide the queue: a radix heap when they are small non-negative integers, an indexed
+ * 4-ary heap with decrease-key otherwise. Single pair queries search from both ends at once and
+ * stop as soon as the two searches can't find anything shorter than the best meeting node.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "paths.h"
+
+/**
+ * Initializes a search side without any memory.
+ *
+ * @param side The side.
+*/
+static void side_init(SearchSide* side) {
+    memset(side, 0, sizeof(SearchSide));
+    heap_init(&side->heap);
+    radix_init(&side->radix);
+}
+
+/**
+ * Releases a search side.
+ *
+ * @param side The side.
+*/
+static void side_free(SearchSide* side) {
+    free(side->distances);
+    free(side->parents);
+    free(side->stamps);
+    free(side->settled);
+    heap_free(&side->heap);
+    radix_free(&side->radix);
+    side_init(side);
+}
+
+/**
+ * Grows the arrays of a search side if the graph is larger than every graph it searched before.
+ *
+ * @param side The side.
+ * @param node_count The number of nodes of the graph.
+ * @return 0 if memory is exhausted, the side holding no array, 1 if not.
+*/
+static int side_reserve(SearchSide* side, uint32_t node_count) {
+    if (node_count <= side->capacity)
+        return 1;
+    free(side->distances);
+    free(side->parents);
+    free(side->stamps);
+    free(side->settled);
+    side->distances = malloc(node_count * sizeof(int64_t));
+    side->parents = malloc(node_count * sizeof(uint32_t));
+    side->stamps = calloc(node_count, sizeof(uint32_t));
+    side->settled = calloc(node_count, sizeof(uint32_t));
+    side->capacity = node_count;
+    if (side->distances == NULL || side->parents == NULL || side->stamps == NULL || side->settled == NULL) {
+        side_free(side);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * Queues a node at a new distance.
+ *
+ * @param side The side.
+ * @param stamp The stamp of the current search.
+ * @param node The node id.
+ * @param distance The distance of the node from the start of the side.
+ * @param parent The node it is reached from.
+ * @param key The queue key of the node, its distance plus the heuristic bound if any.
+*/
+static void side_reach(SearchSide* side, uint32_t stamp, uint32_t node, int64_t distance, uint32_t parent, int64_t key) {
+    side->stamps[node] = stamp;
+    side->distances[node] = distance;
+    side->parents[node] = parent;
+    if (side->use_radix)
+        radix_push(&side->radix, node, key);
+    else
+        heap_update(&side->heap, node, key);
+}
+
+/**
+ * Starts a side from a node, with an empty queue.
+ *
+ * @param side The side.
+ * @param view The graph.
+ * @param stamp The stamp of the current search.
+ * @param start The first node of the side.
+ * @param key The queue key of that node.
+ * @return 0 if memory is exhausted, 1 if not.
+*/
+static int side_start(SearchSide* side, const GraphView* view, uint32_t stamp, uint32_t start, int64_t key) {
+    side->use_radix = view->max_weight <= PATH_RADIX_MAX_WEIGHT;
+    if (side->use_radix)
+        radix_clear(&side->radix);
+    else {
+        heap_clear(&side->heap);
+        if (!heap_reserve(&side->heap, view->node_count))
+            return 0;
+    }
+    side_reach(side, stamp, start, 0, GRAPH_NO_NODE, key);
+    return 1;
+}
+
+/**
+ * Gives the queued node with the smallest key, dropping the stale radix entries of settled nodes.
+ *
+ * @param side The side.
+ * @param stamp The stamp of the current search.
+ * @param top Receives the node and its key.
+ * @return 0 if the queue is empty, 1 if not.
+*/
+static int side_top(SearchSide* side, uint32_t stamp, HeapEntry* top) {
+    if (!side->use_radix)
+        return heap_top(&side->heap, top);
+    while (radix_top(&side->radix, top)) {
+        if (side->settled[top->node] != stamp)
+            return 1;
+        radix_pop(&side->radix, top);
+    }
+    return 0;
+}
+
+/**
+ * Removes the node given by side_top() and marks it settled.
+ *
+ * @param side The side.
+ * @param stamp The stamp of the current search.
+*/
+static void side_settle(SearchSide* side, uint32_t stamp) {
+    HeapEntry top;
+    if (side->use_radix)
+        radix_pop(&side->radix, &top);
+    else
+        heap_pop(&side->heap, &top);
+    side->settled[top.node] = stamp;
+}
+
+/**
+ * Releases the state of the Bellman-Ford searches.
+ *
+ * @param edges The state.
+*/
+static void edges_free(EdgeArrays* edges) {
+    free(edges->parent_edges);
+    free(edges->pending);
+    free(edges->queue);
+    free(edges->walks);
+    memset(edges, 0, sizeof(EdgeArrays));
+}
+
+/**
+ * Initializes a path engine without any search.
+ *
+ * @param engine The engine.
+*/
+void paths_init(PathEngine* engine) {
+    memset(engine, 0, sizeof(PathEngine));
+    side_init(&engine->forward);
+    side_init(&engine->backward);
+    engine->meeting = GRAPH_NO_NODE;
+}
+
+/**
+ * Releases a path engine.
+ *
+ * @param engine The engine.
+*/
+void paths_free(PathEngine* engine) {
+    side_free(&engine->forward);
+    side_free(&engine->backward);
+    free(engine->path);
+    free(engine->landmarks.from);
+    free(engine->landmarks.to);
+    edges_free(&engine->edges);
+    paths_init(engine);
+}
+
+/**
+ * Starts a new search.
+ *
+ * @param engine The engine.
+ * @param node_count The number of nodes of the graph.
+ * @param bidirectional 1 if the backward side is used, 0 if not.
+ * @return 0 if memory is exhausted, the engine being failed, 1 if not.
+*/
+static int paths_begin(PathEngine* engine, uint32_t node_count, int bidirectional) {
+    if (!side_reserve(&engine->forward, node_count) || (bidirectional && !side_reserve(&engine->backward, node_count))) {
+        engine->failed = 1;
+        return 0;
+    }
+    if (++engine->stamp == 0) { // Every stamp was used, the old ones must be forgotten
+        memset(engine->forward.stamps, 0, engine->forward.capacity * sizeof(uint32_t));
+        memset(engine->forward.settled, 0, engine->forward.capacity * sizeof(uint32_t));
+        memset(engine->backward.stamps, 0, engine->backward.capacity * sizeof(uint32_t));
+        memset(engine->backward.settled, 0, engine->backward.capacity * sizeof(uint32_t));
+        engine->stamp = 1;
+    }
+    engine->bidirectional = bidirectional;
+    engine->meeting = GRAPH_NO_NODE;
+    engine->cost = PATH_INFINITY;
+    engine->settled_count = 0;
+    return 1;
+}
+
+/**
+ * Searches the shortest paths from a source on the forward side, following the outgoing edges,
+ * or the incoming ones to get the distances towards the source.
+ *
+ * @param engine The engine.
+ * @param view The graph.
+ * @param source The source node id.
+ * @param target The node id at which the search stops once it is settled, GRAPH_NO_NODE to reach every node.
+ * @param heuristic The A* lower bounds towards the target, NULL for a plain Dijkstra search.
+ * @param data The data given to the heuristic.
+ * @param reverse 1 to follow the incoming edges, 0 for the outgoing ones.
+*/
+static void search(PathEngine* engine, const GraphView* view, uint32_t source, uint32_t target, Heuristic heuristic,
+    void* data, int reverse) {
+    if (!paths_begin(engine, view->node_count, 0))
+        return;
+    SearchSide* side = &engine->forward;
+    uint32_t stamp = engine->stamp;
+    if (!side_start(side, view, stamp, source, heuristic != NULL ? heuristic(data, source) : 0)) {
+        engine->failed = 1;
+        return;
+    }
+
+    HeapEntry top;
+    while (side_top(side, stamp, &top)) {
+        side_settle(side, stamp);
+        engine->settled_count++;
+        uint32_t node = top.node;
+        if (node == target)
+            break;
+
+        int64_t reached = side->distances[node];
+        EdgeCursor cursor;
+        ViewEdge edge;
+        if (reverse)
+            view_edges_in(view, node, &cursor);
+        else
+            view_edges(view, node, &cursor);
+        while (view_next_edge(&cursor, &edge)) {
+            int64_t distance = reached + edge.weight;
+            uint32_t next = edge.target;
+            if (side->stamps[next] == stamp && side->distances[next] <= distance)
+                continue;
+            int64_t bound = heuristic != NULL ? heuristic(data, next) : 0;
+            if (bound == PATH_INFINITY) // The target can't be reached from there
+                continue;
+            side_reach(side, stamp, next, distance, node, distance + bound);
+        }
+    }
+    if (side->radix.failed)
+        engine->failed = 1;
+}
+
+/**
+ * Computes the shortest paths from a source with Dijkstra's algorithm. Distances are then read with
+ * paths_distance(), and paths with paths_rebuild(), until the next search.
+ *
+ * @param engine The engine.
+ * @param view The graph.
+ * @param source The source node id.
+ * @param target The node id at which the search stops once it is settled, GRAPH_NO_NODE to reach every node.
+ * @return 0 if the graph has a negative weight, 1 if not.
+*/
+int paths_dijkstra(PathEngine* engine, const GraphView* view, uint32_t source, uint32_t target) {
+    return paths_astar(engine, view, source, target, NULL, NULL);
+}
+
+/**
+ * Computes the shortest path between two nodes with A*, which settles the nodes by distance
+ * from the source plus a lower bound of their distance to the target.
+ *
+ * @param engine The engine.
+ * @param view The graph.
+ * @param source The source node id.
+ * @param target The target node id, GRAPH_NO_NODE to reach every node.
+ * @param heuristic The consistent lower bounds towards the target, NULL for a plain Dijkstra search.
+ * @param data The data given to the heuristic.
+ * @return 0 if the graph has a negative weight, 1 if not.
+*/
+int paths_astar(PathEngine* engine, const GraphView* view, uint32_t source, uint32_t target, Heuristic heuristic, void* data) {
+    if (view->edge_count > 0 && view->min_weight < 0)
+        return 0;
+    search(engine, view, source, target, heuristic, data, 0);
+    return 1;
+}
+
+/**
+ * Computes the shortest path between two nodes by searching forward from the source and backward
+ * from the target, alternating on the side whose next node is closer. The search stops once the
+ * two closest queued nodes are together farther than the best path through a node reached by both.
+ * The graphs of the view must have been reversed with graph_reverse().
+ *
+ * @param engine The engine.
+ * @param view The graph.
+ * @param source The source node id.
+ * @param target The target node id.
+ * @return 0 if the graph has a negative weight, 1 if not.
+*/
+int paths_bidirectional(PathEngine* engine, const GraphView* view, uint32_t source, uint32_t target) {
+    if (view->edge_count > 0 && view->min_weight < 0)
+        return 0;
+    if (!paths_begin(engine, view->node_count, 1))
+        return 1;
+    uint32_t stamp = engine->stamp;
+    SearchSide* forward = &engine->forward;
+    SearchSide* backward = &engine->backward;
+    if (!side_start(forward, view, stamp, source, 0) || !side_start(backward, view, stamp, target, 0)) {
+        engine->failed = 1;
+        return 1;
+    }
+    if (source == target) {
+        engine->cost = 0;
+        engine->meeting = source;
+    }
+
+    HeapEntry forward_top, backward_top;
+    while (side_top(forward, stamp, &forward_top) && side_top(backward, stamp, &backward_top)) {
+        if (engine->cost != PATH_INFINITY && forward_top.key + backward_top.key >= engine->cost)
+            break;
+        int is_forward = forward_top.key <= backward_top.key;
+        SearchSide* side = is_forward ? forward : backward;
+        SearchSide* other = is_forward ? backward : forward;
+        uint32_t node = is_forward ? forward_top.node : backward_top.node;
+        side_settle(side, stamp);
+        engine->settled_count++;
+
+        int64_t reached = side->distances[node];
+        EdgeCursor cursor;
+        ViewEdge edge;
+        if (is_forward)
+            view_edges(view, node, &cursor);
+        else
+            view_edges_in(view, node, &cursor);
+        while (view_next_edge(&cursor, &edge)) {
+            int64_t distance = reached + edge.weight;
+            uint32_t next = edge.target;
+            if (side->stamps[next] == stamp && side->distances[next] <= distance)
+                continue;
+            side_reach(side, stamp, next, distance, node, distance);
+            if (other->stamps[next] == stamp && distance + other->distances[next] < engine->cost) {
+                engine->cost = distance + other->distances[next];
+                engine->meeting = next;
+            }
+        }
+    }
+    if (forward->radix.failed || backward->radix.failed)
+        engine->failed = 1;
+    return 1;
+}
+
+/**
+ * Appends a node to the rebuilt path, unless the path can't grow, which fails the engine.
+ *
+ * @param engine The engine.
+ * @param length The length of the path, increased.
+ * @param node The node id.
+*/
+static void path_append(PathEngine* engine, uint32_t* length, uint32_t node) {
+    if (*length == engine->path_capacity) {
+        uint32_t capacity = engine->path_capacity == 0 ? 64 : engine->path_capacity * 2;
+        uint32_t* path = realloc(engine->path, capacity * sizeof(uint32_t));
+        if (path == NULL) {
+            engine->failed = 1;
+            return;
+        }
+        engine->path = path;
+        engine->path_capacity = capacity;
+    }
+    engine->path[(*length)++] = node;
+}
+
+/**
+ * Makes room for the nodes of a graph in the state of the Bellman-Ford searches. Its edges are walked
+ * through the view, so the instances of a template are never copied.
+ *
+ * @param edges The state.
+ * @param view The graph.
+ * @return 0 if memory is exhausted, the state holding no array, 1 if not.
+*/
+static int edges_prepare(EdgeArrays* edges, const GraphView* view) {
+    uint32_t n = view->node_count;
+    if (n <= edges->capacity && edges->parent_edges != NULL) {
+        edges->view = view;
+        return 1;
+    }
+    free(edges->parent_edges);
+    free(edges->pending);
+    free(edges->queue);
+    free(edges->walks);
+    edges->parent_edges = malloc(n * sizeof(uint64_t) + 1);
+    edges->pending = calloc((size_t) n + 1, sizeof(uint8_t));
+    edges->queue = malloc(n * sizeof(uint32_t) + 1);
+    edges->walks = calloc((size_t) n + 1, sizeof(uint32_t));
+    if (edges->parent_edges == NULL || edges->pending == NULL || edges->queue == NULL || edges->walks == NULL) {
+        edges_free(edges);
+        return 0;
+    }
+    edges->view = view;
+    edges->capacity = n;
+    return 1;
+}
+
+/**
+ * Relaxes the outgoing edges of a node, marking pending the nodes whose distance decreased.
+ *
+ * @param engine The engine.
+ * @param node The node id.
+ * @param queued 1 to also append the newly pending nodes to the queue, 0 not to.
+ * @param tail The tail of the queue, moved by the appended nodes.
+ * @return The number of newly pending nodes.
+*/
+static uint32_t relax(PathEngine* engine, uint32_t node, int queued, uint32_t* tail) {
+    EdgeArrays* edges = &engine->edges;
+    SearchSide* side = &engine->forward;
+    uint32_t stamp = engine->stamp;
+    uint32_t n = edges->view->node_count;
+    int64_t reached = side->distances[node];
+    uint32_t added = 0;
+    EdgeCursor cursor;
+    ViewEdge edge;
+    view_edges(edges->view, node, &cursor);
+    for (uint64_t e = 0; view_next_edge(&cursor, &edge); e++) {
+        uint32_t next = edge.target;
+        int64_t distance = reached + edge.weight;
+        if (side->stamps[next] == stamp && side->distances[next] <= distance)
+            continue;
+        side->stamps[next] = stamp;
+        side->distances[next] = distance;
+        side->parents[next] = node;
+        edges->parent_edges[next] = e;
+        if (!edges->pending[next]) {
+            edges->pending[next] = 1;
+            added++;
+            if (queued) {
+                edges->queue[*tail] = next;
+                *tail = *tail + 1 == n ? 0 : *tail + 1;
+            }
+        }
+    }
+    engine->settled_count++;
+    return added;
+}
+
+/**
+ * Looks for a cycle among the parents of the reached nodes, which can only be a negative cycle,
+ * and copies its nodes in the path of the engine.
+ *
+ * @param engine The engine.
+ * @return 1 if a cycle was found, 0 if not.
+*/
+static int find_negative_cycle(PathEngine* engine) {
+    EdgeArrays* edges = &engine->edges;
+    SearchSide* side = &engine->forward;
+    uint32_t n = edges->view->node_count;
+    memset(edges->walks, 0, n * sizeof(uint32_t));
+    for (uint32_t start = 0; start < n; start++) {
+        if (side->stamps[start] != engine->stamp || edges->walks[start] != 0)
+            continue;
+        uint32_t node = start;
+        while (node != GRAPH_NO_NODE && edges->walks[node] == 0) {
+            edges->walks[node] = start + 1;
+            node = side->parents[node];
+        }
+        if (node == GRAPH_NO_NODE || edges->walks[node] != start + 1)
+            continue; // The walk ended at the source or on an earlier walk
+
+        // The parents lead backward around the cycle, which is stored forward and closed by its first node
+        uint32_t length = 0;
+        uint32_t at = node;
+        engine->cycle_cost = 0;
+        engine->cycle_line = UINT32_MAX;
+        do {
+            path_append(engine, &length, at);
+            ViewEdge edge;
+            view_edge_at(edges->view, side->parents[at], edges->parent_edges[at], &edge);
+            engine->cycle_cost += edge.weight;
+            if (edge.line < engine->cycle_line)
+                engine->cycle_line = edge.line;
+            at = side->parents[at];
+        } while (at != node);
+        path_append(engine, &length, node);
+        for (uint32_t i = 0; i < length / 2; i++) {
+            uint32_t swapped = engine->path[i];
+            engine->path[i] = engine->path[length - 1 - i];
+            engine->path[length - 1 - i] = swapped;
+        }
+        engine->cycle_length = length;
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * Computes the shortest paths from a source with the Bellman-Ford algorithm, which allows negative
+ * weights. Each pass relaxes the pending nodes, those whose distance decreased since their edges
+ * were last relaxed, and the search stops as soon as no node is pending. While many nodes are pending
+ * a pass sweeps them in node order; once they are few, they are taken from
+ * a FIFO queue instead (SPFA). Distances and paths are then read as after paths_dijkstra().
+ *
+ * @param engine The engine.
+ * @param view The graph.
+ * @param source The source node id.
+ * @return 0 if a negative cycle is reachable from the source, its nodes being in path, 1 if not.
+*/
+int paths_bellman(PathEngine* engine, const GraphView* view, uint32_t source) {
+    if (!edges_prepare(&engine->edges, view)) {
+        engine->failed = 1;
+        return 1;
+    }
+    if (!paths_begin(engine, view->node_count, 0))
+        return 1;
+    EdgeArrays* edges = &engine->edges;
+    SearchSide* side = &engine->forward;
+    uint32_t n = view->node_count;
+    side->stamps[source] = engine->stamp;
+    side->distances[source] = 0;
+    side->parents[source] = GRAPH_NO_NODE;
+    memset(edges->pending, 0, n * sizeof(uint8_t));
+    edges->pending[source] = 1;
+    engine->cycle_length = 0;
+
+    uint32_t pending = 1;
+    uint32_t head = 0, tail = 0;
+    int queued = 0;
+    for (uint32_t pass = 1; pending > 0; pass++) {
+        // A path without cycle has less than n edges, so the pass n can only be needed by a negative cycle
+        if (pass > n && (pass - 1) % n == 0 && find_negative_cycle(engine)) {
+            memset(edges->pending, 0, n * sizeof(uint8_t));
+            return 0;
+        }
+
+        int sweep = pending > n / PATH_SWEEP_RATIO;
+        if (sweep) {
+            queued = 0;
+            for (uint32_t node = 0; node < n; node++) {
+                if (!edges->pending[node])
+                    continue;
+                edges->pending[node] = 0;
+                pending--;
+                pending += relax(engine, node, 0, &tail);
+            }
+            continue;
+        }
+        if (!queued) { // Few nodes are left pending, they are queued from now on
+            head = tail = 0;
+            for (uint32_t node = 0; node < n; node++) {
+                if (edges->pending[node]) {
+                    edges->queue[tail] = node;
+                    tail = tail + 1 == n ? 0 : tail + 1;
+                }
+            }
+            queued = 1;
+        }
+        for (uint32_t count = pending; count > 0; count--) {
+            uint32_t node = edges->queue[head];
+            head = head + 1 == n ? 0 : head + 1;
+            edges->pending[node] = 0;
+            pending--;
+            pending += relax(engine, node, 1, &tail);
+        }
+    }
+    return 1;
+}
+
+/**
+ * Chooses the landmarks of a graph if they were not chosen yet, and sets the target of the
+ * lower bounds given by paths_landmark_bound(). Each landmark is the node farthest from the
+ * landmarks chosen before it, an unreachable node counting as the farthest.
+ * The graphs of the view must have been reversed with graph_reverse().
+ *
+ * @param engine The engine.
+ * @param view The graph.
+ * @param target The target node id of the next A* search.
+ * @return 0 if the graph has a negative weight or if memory is exhausted, failed telling which, 1 if not.
+*/
+int paths_landmarks(PathEngine* engine, const GraphView* view, uint32_t target) {
+    Landmarks* landmarks = &engine->landmarks;
+    landmarks->target = target;
+    if (landmarks->view == view)
+        return 1;
+    if (view->edge_count > 0 && view->min_weight < 0)
+        return 0;
+
+    free(landmarks->from);
+    free(landmarks->to);
+    uint32_t n = view->node_count;
+    uint32_t count = n < PATH_LANDMARKS ? n : PATH_LANDMARKS;
+    landmarks->count = count;
+    landmarks->from = malloc((size_t) n * count * sizeof(int64_t) + 1);
+    landmarks->to = malloc((size_t) n * count * sizeof(int64_t) + 1);
+    landmarks->view = NULL;
+    if (landmarks->from == NULL || landmarks->to == NULL) {
+        engine->failed = 1;
+        return 0;
+    }
+
+    uint32_t landmark = 0;
+    for (uint32_t l = 0; l < count; l++) {
+        search(engine, view, landmark, GRAPH_NO_NODE, NULL, NULL, 0);
+        if (engine->failed)
+            return 0;
+        for (uint32_t v = 0; v < n; v++)
+            landmarks->from[(size_t) v * count + l] = paths_distance(engine, v);
+        search(engine, view, landmark, GRAPH_NO_NODE, NULL, NULL, 1);
+        if (engine->failed)
+            return 0;
+        for (uint32_t v = 0; v < n; v++)
+            landmarks->to[(size_t) v * count + l] = paths_distance(engine, v);
+
+        int64_t farthest = -1;
+        for (uint32_t v = 0; v < n; v++) {
+            int64_t nearest = PATH_INFINITY;
+            for (uint32_t k = 0; k <= l; k++) {
+                if (landmarks->from[(size_t) v * count + k] < nearest)
+                    nearest = landmarks->from[(size_t) v * count + k];
+            }
+            if (nearest > farthest) {
+                farthest = nearest;
+                landmark = v;
+            }
+        }
+    }
+    landmarks->view = view;
+    return 1;
+}
+
+/**
+ * Heuristic giving the landmark lower bound of the distance from a node to the target set by
+ * paths_landmarks(): by the triangle inequality, d(v, t) >= d(L, t) - d(L, v) and d(v, t) >= d(v, L) - d(t, L).
+ *
+ * @param data The Landmarks.
+ * @param node The node id.
+ * @return The largest bound given by a landmark, PATH_INFINITY if the target is proven unreachable.
+*/
+int64_t paths_landmark_bound(void* data, uint32_t node) {
+    const Landmarks* landmarks = data;
+    const int64_t* from_node = &landmarks->from[(size_t) node * landmarks->count];
+    const int64_t* from_target = &landmarks->from[(size_t) landmarks->target * landmarks->count];
+    const int64_t* to_node = &landmarks->to[(size_t) node * landmarks->count];
+    const int64_t* to_target = &landmarks->to[(size_t) landmarks->target * landmarks->count];
+    int64_t bound = 0;
+    for (uint32_t l = 0; l < landmarks->count; l++) {
+        if (from_node[l] != PATH_INFINITY) {
+            if (from_target[l] == PATH_INFINITY) // L reaches the node but not the target
+                return PATH_INFINITY;
+            if (from_target[l] - from_node[l] > bound)
+                bound = from_target[l] - from_node[l];
+        }
+        if (to_node[l] != PATH_INFINITY && to_target[l] != PATH_INFINITY && to_node[l] - to_target[l] > bound)
+            bound = to_node[l] - to_target[l];
+    }
+    return bound;
+}
+
+/**
+ * Returns the cost of the shortest path from the source of the last search to a node.
+ *
+ * @param engine The engine.
+ * @param target The node id, the target of the last search if it was bidirectional.
+ * @return The cost, PATH_INFINITY if there is no path.
+*/
+int64_t paths_cost(const PathEngine* engine, uint32_t target) {
+    if (engine->bidirectional)
+        return engine->cost;
+    return paths_distance(engine, target);
+}
+
+/**
+ * Rebuilds the shortest path found by the last search, from its source to a reached node.
+ *
+ * @param engine The engine, whose path array receives the nodes.
+ * @param target The last node of the path, the target of the last search if it was bidirectional.
+ * @return The number of nodes of the path.
+*/
+uint32_t paths_rebuild(PathEngine* engine, uint32_t target) {
+    int bidirectional = engine->bidirectional;
+    uint32_t last = bidirectional ? engine->meeting : target;
+    uint32_t length = 0;
+    for (uint32_t node = last; node != GRAPH_NO_NODE; node = engine->forward.parents[node])
+        path_append(engine, &length, node);
+    for (uint32_t i = 0; i < length / 2; i++) {
+        uint32_t node = engine->path[i];
+        engine->path[i] = engine->path[length - 1 - i];
+        engine->path[length - 1 - i] = node;
+    }
+    if (bidirectional) { // The backward side leads from the meeting node to the target
+        for (uint32_t node = engine->backward.parents[last]; node != GRAPH_NO_NODE; node = engine->backward.parents[node])
+            path_append(engine, &length, node);
+    }
+    return length;
+}
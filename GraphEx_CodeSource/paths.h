@@ -0,0 +1,113 @@
+/**
+ * @file
+ * @brief Shortest paths header file.
+*/
+
+#ifndef PATHS_H_
+#define PATHS_H_
+
+#include <stdint.h>
+#include "heap.h"
+#include "view.h"
+
+#define PATH_INFINITY INT64_MAX /** Distance of a node that was not reached. */
+#define PATH_RADIX_MAX_WEIGHT (1 << 20) /** Largest weight for which the radix heap is used. */
+#define PATH_LANDMARKS 8 /** Number of landmarks giving the A* lower bounds of a graph. */
+#define PATH_SWEEP_RATIO 16 /** Bellman-Ford sweeps the nodes in order while more than 1 / ratio of them are pending. */
+
+/**
+ * Function pointer type of an A* heuristic.
+ *
+ * @param data The data given with the heuristic.
+ * @param node The node id.
+ * @return A lower bound of the distance from the node to the target, which must be consistent.
+*/
+typedef int64_t (*Heuristic)(void* data, uint32_t node);
+
+/**
+ * Defined type based on a struct holding one direction of a search: from the source along the
+ * outgoing edges, or from the target along the incoming edges.
+*/
+typedef struct {
+    uint32_t capacity;      /** Number of nodes the arrays can hold. */
+    int64_t* distances;     /** Distance of each node from the start of the side. */
+    uint32_t* parents;      /** Node each node was reached from, GRAPH_NO_NODE for the start of the side. */
+    uint32_t* stamps;       /** Search in which each node was reached. */
+    uint32_t* settled;      /** Search in which each node was settled. */
+    int use_radix;          /** 1 when the side queues nodes in radix, 0 when it uses heap. */
+    IndexedHeap heap;       /** Queue used with large weights. */
+    RadixHeap radix;        /** Queue used with small non-negative weights. */
+} SearchSide;
+
+/**
+ * Defined type based on a struct holding the distances between a few landmarks and every node of a graph,
+ * from which the triangle inequality gives lower bounds of any distance (ALT).
+*/
+typedef struct {
+    const GraphView* view; /** Graph of the landmarks, NULL until they are computed. */
+    uint32_t count;        /** Number of landmarks. */
+    int64_t* from;         /** Distance from each landmark to each node, count entries per node. */
+    int64_t* to;           /** Distance from each node to each landmark, count entries per node. */
+    uint32_t target;       /** Target of the current A* search. */
+} Landmarks;
+
+/**
+ * Defined type based on a struct holding the state of the Bellman-Ford searches on a graph,
+ * whose edges are walked through its view.
+*/
+typedef struct {
+    const GraphView* view;  /** Graph of the current search. */
+    uint32_t capacity;      /** Number of nodes the arrays below can hold. */
+    uint64_t* parent_edges; /** Position of the edge each node was last reached by among the edges of its parent. */
+    uint8_t* pending;       /** 1 for each node whose edges must be relaxed again. */
+    uint32_t* queue;        /** Circular queue of the pending nodes, used when they are few. */
+    uint32_t* walks;        /** Walk in which each node was visited when looking for a cycle of parents. */
+} EdgeArrays;
+
+/**
+ * Defined type based on a struct holding the state of the shortest path searches of a program.
+ * Its arrays are allocated for the largest graph searched so far and reused by every search:
+ * a node only holds a distance when its stamp is the stamp of the current search, so starting
+ * a search costs nothing, whatever the size of the graph.
+*/
+typedef struct {
+    SearchSide forward;      /** Side running from the source. */
+    SearchSide backward;     /** Side running from the target, for bidirectional searches. */
+    uint32_t stamp;          /** Stamp of the current search. */
+    int bidirectional;       /** 1 if the current search is bidirectional, 0 if not. */
+    uint32_t meeting;        /** Node where the sides of a bidirectional search met, GRAPH_NO_NODE otherwise. */
+    int64_t cost;            /** Distance found by a bidirectional search. */
+    uint64_t settled_count;  /** Nodes settled by the current search, on both sides. */
+    uint32_t* path;          /** Nodes of the last path rebuilt by paths_rebuild(). */
+    uint32_t path_capacity;  /** Capacity of path. */
+    Landmarks landmarks;     /** Landmarks of the last graph searched with A*. */
+    EdgeArrays edges;        /** Edges of the last graph searched with Bellman-Ford. */
+    uint32_t cycle_length;   /** Nodes of the negative cycle found by Bellman-Ford, copied in path. */
+    int64_t cycle_cost;      /** Cost of that cycle. */
+    uint32_t cycle_line;     /** First line where an edge of that cycle was declared. */
+    int failed;              /** 1 once memory was exhausted, the results of the searches being wrong from then on. */
+} PathEngine;
+
+void paths_init(PathEngine* engine);
+void paths_free(PathEngine* engine);
+int paths_dijkstra(PathEngine* engine, const GraphView* view, uint32_t source, uint32_t target);
+int paths_astar(PathEngine* engine, const GraphView* view, uint32_t source, uint32_t target, Heuristic heuristic, void* data);
+int paths_bidirectional(PathEngine* engine, const GraphView* view, uint32_t source, uint32_t target);
+int paths_bellman(PathEngine* engine, const GraphView* view, uint32_t source);
+int paths_landmarks(PathEngine* engine, const GraphView* view, uint32_t target);
+int64_t paths_landmark_bound(void* data, uint32_t node);
+int64_t paths_cost(const PathEngine* engine, uint32_t target);
+uint32_t paths_rebuild(PathEngine* engine, uint32_t target);
+
+/**
+ * Returns the distance of a node from the source of the last search.
+ *
+ * @param engine The engine.
+ * @param node The node id.
+ * @return The distance, PATH_INFINITY if the node was not reached.
+*/
+static inline int64_t paths_distance(const PathEngine* engine, uint32_t node) {
+    return engine->forward.stamps[node] == engine->stamp ? engine->forward.distances[node] : PATH_INFINITY;
+}
+
+#endif
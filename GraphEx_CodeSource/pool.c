@@ -0,0 +1,140 @@
+/**
+ * @file
+ * @brief Thread pool source file.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "pool.h"
+
+/**
+ * Defined type based on a struct holding what a thread of a pool needs to start.
+*/
+typedef struct {
+    ThreadPool* pool; /** The pool. */
+    uint32_t worker;  /** Index of the worker. */
+} PoolThread;
+
+/**
+ * Returns the number of workers to use when none is asked for.
+ *
+ * @return The number of online processors, 1 if it is unknown.
+*/
+uint32_t pool_default_size() {
+#ifdef _SC_NPROCESSORS_ONLN
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    if (count > 0)
+        return (uint32_t) count;
+#endif
+    return 1;
+}
+
+/**
+ * Runs the tasks given to a pool until it is freed.
+ *
+ * @param argument The PoolThread of the thread, released here.
+ * @return NULL.
+*/
+static void* pool_thread(void* argument) {
+    PoolThread start = *(PoolThread*) argument;
+    free(argument);
+    ThreadPool* pool = start.pool;
+    uint64_t seen = 0;
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (pool->generation == seen && !pool->stopping)
+            pthread_cond_wait(&pool->start, &pool->lock);
+        if (pool->stopping)
+            break;
+        seen = pool->generation;
+        PoolTask task = pool->task;
+        void* data = pool->data;
+        pthread_mutex_unlock(&pool->lock);
+        task(data, start.worker);
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->running == 0)
+            pthread_cond_signal(&pool->done);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+/**
+ * Initializes a pool and starts its threads. A pool of one worker runs its tasks on the calling thread only.
+ * When a thread can't be started, for lack of memory or otherwise, the pool keeps the workers started so far.
+ *
+ * @param pool The pool, whose count is the number of workers actually started.
+ * @param count The number of workers, 0 for pool_default_size().
+*/
+void pool_init(ThreadPool* pool, uint32_t count) {
+    memset(pool, 0, sizeof(ThreadPool));
+    pool->count = count == 0 ? pool_default_size() : count;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->start, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    if (pool->count == 1)
+        return;
+    pool->threads = malloc((pool->count - 1) * sizeof(pthread_t));
+    if (pool->threads == NULL) {
+        pool->count = 1;
+        return;
+    }
+    for (uint32_t i = 1; i < pool->count; i++) {
+        PoolThread* start = malloc(sizeof(PoolThread));
+        if (start != NULL) {
+            start->pool = pool;
+            start->worker = i;
+        }
+        if (start == NULL || pthread_create(&pool->threads[i - 1], NULL, pool_thread, start) != 0) {
+            free(start);
+            pool->count = i;
+            break;
+        }
+    }
+}
+
+/**
+ * Stops the threads of a pool and releases it.
+ *
+ * @param pool The pool.
+*/
+void pool_free(ThreadPool* pool) {
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = 1;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+    for (uint32_t i = 1; i < pool->count; i++)
+        pthread_join(pool->threads[i - 1], NULL);
+    free(pool->threads);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->start);
+    pthread_cond_destroy(&pool->done);
+    memset(pool, 0, sizeof(ThreadPool));
+}
+
+/**
+ * Runs a task on every worker of a pool and waits until they all finished it.
+ *
+ * @param pool The pool.
+ * @param task The task.
+ * @param data The data given to the task.
+*/
+void pool_run(ThreadPool* pool, PoolTask task, void* data) {
+    if (pool->count == 1) {
+        task(data, 0);
+        return;
+    }
+    pthread_mutex_lock(&pool->lock);
+    pool->task = task;
+    pool->data = data;
+    pool->running = pool->count - 1;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+    task(data, 0);
+    pthread_mutex_lock(&pool->lock);
+    while (pool->running > 0)
+        pthread_cond_wait(&pool->done, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+}
@@ -0,0 +1,42 @@
+/**
+ * @file
+ * @brief Thread pool header file.
+*/
+
+#ifndef POOL_H_
+#define POOL_H_
+
+#include <stdint.h>
+#include <pthread.h>
+
+/**
+ * Function pointer type of a task run by every worker of a pool at once.
+ *
+ * @param data The data given with the task.
+ * @param worker The index of the worker, 0 being the thread that called pool_run().
+*/
+typedef void (*PoolTask)(void* data, uint32_t worker);
+
+/**
+ * Defined type based on a struct holding threads that wait for tasks, so that each parallel step
+ * of an algorithm doesn't pay for creating threads. The thread calling pool_run() is worker 0.
+*/
+typedef struct {
+    uint32_t count;          /** Number of workers, the calling thread included. */
+    pthread_t* threads;      /** The count - 1 other threads. */
+    pthread_mutex_t lock;    /** Protects every field below. */
+    pthread_cond_t start;    /** Signaled when a task is given. */
+    pthread_cond_t done;     /** Signaled when the last thread finishes the task. */
+    uint64_t generation;     /** Number of tasks given so far. */
+    uint32_t running;        /** Threads still running the current task. */
+    int stopping;            /** 1 once the threads must exit. */
+    PoolTask task;           /** Current task. */
+    void* data;              /** Data of the current task. */
+} ThreadPool;
+
+uint32_t pool_default_size();
+void pool_init(ThreadPool* pool, uint32_t count);
+void pool_free(ThreadPool* pool);
+void pool_run(ThreadPool* pool, PoolTask task, void* data);
+
+#endif
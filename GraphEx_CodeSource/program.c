@@ -0,0 +1,366 @@
+/**
+ * @file
+ * @brief Program model source file.
+ *
+ * Receives the %declare blocks from the parser through a DeclareSink and keeps the resulting graphs,
+ * then links each block to the templates of its %subgraph instances.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "program.h"
+
+/**
+ * Initializes an empty program.
+ *
+ * @param program The program.
+ * @param names The names of the identifiers met in the program, filled while it is scanned.
+*/
+void program_init(Program* program, const InternTable* names) {
+    memset(program, 0, sizeof(Program));
+    program->names = names;
+    program->messages = stdout;
+    ast_init(&program->ast);
+    name_map_init(&program->blocks);
+}
+
+/**
+ * Releases everything held by a program.
+ *
+ * @param program The program.
+*/
+void program_free(Program* program) {
+    ast_free(&program->ast);
+    if (program->views != NULL) {
+        for (uint32_t i = 0; i < program->graph_count; i++)
+            view_free(&program->views[i]);
+        free(program->views);
+    }
+    name_map_free(&program->blocks);
+    for (uint32_t i = 0; i < program->graph_count; i++)
+        graph_free(program->graphs[i]);
+    free(program->graphs);
+    free(program->attachments);
+    builder_free(&program->builder);
+    memset(program, 0, sizeof(Program));
+}
+
+/**
+ * Starts the graph of a %declare block.
+ *
+ * @param data The program.
+ * @param graph The interned name of the graph block, -1 for the main block.
+ * @param directed 1 for a directed graph, 0 for an undirected one.
+*/
+static void sink_begin(void* data, int32_t graph, int directed) {
+    Program* program = data;
+    builder_init(&program->builder, graph, directed);
+}
+
+/**
+ * Declares a node.
+ *
+ * @param data The program.
+ * @param name The interned name of the node.
+*/
+static void sink_node(void* data, int32_t name) {
+    Program* program = data;
+    builder_node(&program->builder, (uint32_t) name);
+}
+
+/**
+ * Declares an edge between two nodes of the graph.
+ *
+ * @param data The program.
+ * @param source The interned name of the source node.
+ * @param target The interned name of the target node.
+ * @param weight The weight of the edge.
+ * @param capacity The capacity of the edge, GRAPH_NO_CAPACITY without one.
+ * @param line The %declare line of the edge.
+*/
+static void sink_edge(void* data, int32_t source, int32_t target, int32_t weight, int32_t capacity, uint32_t line) {
+    Program* program = data;
+    uint32_t from = builder_node(&program->builder, (uint32_t) source);
+    uint32_t to = builder_node(&program->builder, (uint32_t) target);
+    builder_edge(&program->builder, from, to, weight, capacity, line);
+}
+
+/**
+ * Declares an edge towards a node of a subgraph instance.
+ *
+ * @param data The program.
+ * @param source The interned name of the source node.
+ * @param instance The interned name of the instance.
+ * @param node The interned name of the node in the instance, AST_NO_NAME for its first node.
+ * @param weight The weight of the edge.
+ * @param capacity The capacity of the edge, GRAPH_NO_CAPACITY without one.
+ * @param line The %declare line of the edge.
+*/
+static void sink_attach(void* data, int32_t source, int32_t instance, int32_t node, int32_t weight, int32_t capacity, uint32_t line) {
+    Program* program = data;
+    uint32_t from = builder_node(&program->builder, (uint32_t) source);
+    if (program->builder.error != NULL)
+        return;
+    if (program->attachment_count == program->attachment_capacity) {
+        uint32_t grown = program->attachment_capacity == 0 ? 16 : program->attachment_capacity * 2;
+        Attachment* attachments = realloc(program->attachments, grown * sizeof(Attachment));
+        if (attachments == NULL) {
+            program->builder.error = "out of memory while declaring subgraph edges";
+            return;
+        }
+        program->attachments = attachments;
+        program->attachment_capacity = grown;
+    }
+    Attachment* attachment = &program->attachments[program->attachment_count++];
+    attachment->graph = program->graph_count;
+    attachment->source = from;
+    attachment->instance = instance;
+    attachment->node = node;
+    attachment->weight = weight;
+    attachment->capacity = capacity;
+    attachment->line = line;
+}
+
+/**
+ * Finishes the graph of a %declare block and stores it in the program.
+ *
+ * @param data The program.
+ * @return The index of the graph in the program, -1 if it can't be built, the error being printed.
+*/
+static int32_t sink_end(void* data) {
+    Program* program = data;
+    if (program->graph_count == program->graph_capacity && program->builder.error == NULL) {
+        uint32_t grown = program->graph_capacity == 0 ? 8 : program->graph_capacity * 2;
+        Graph** graphs = realloc(program->graphs, grown * sizeof(Graph*));
+        if (graphs == NULL)
+            program->builder.error = "out of memory while declaring graphs";
+        else {
+            program->graphs = graphs;
+            program->graph_capacity = grown;
+        }
+    }
+    Graph* graph = builder_finish(&program->builder);
+    if (graph == NULL) {
+        fprintf(program->messages, "Error: %s\n", program->builder.error);
+        return -1;
+    }
+    program->graphs[program->graph_count] = graph;
+    return (int32_t) program->graph_count++;
+}
+
+/**
+ * Returns the DeclareSink that streams the %declare blocks of a parsed program into its graphs.
+ *
+ * @param program The program.
+ * @return The sink to give to the parser.
+*/
+DeclareSink program_sink(Program* program) {
+    DeclareSink sink = { program, sink_begin, sink_node, sink_edge, sink_attach, sink_end };
+    return sink;
+}
+
+/**
+ * Moves the graphs, attachments and syntax tree of a part of a program parsed apart to the end of
+ * a program, the graph indices of the part being shifted after the graphs already there.
+ *
+ * @param program The program, whose blocks are on the stack of its syntax tree.
+ * @param part The program of the part, left without graphs.
+ * @return 1 if the part was appended, 0 if memory is exhausted, the part keeping what wasn't moved yet.
+*/
+int program_append(Program* program, Program* part) {
+    uint32_t offset = program->graph_count;
+    if (program->graph_count + part->graph_count > program->graph_capacity) {
+        uint32_t grown = program->graph_count + part->graph_count;
+        Graph** graphs = realloc(program->graphs, grown * sizeof(Graph*));
+        if (graphs == NULL)
+            return 0;
+        program->graphs = graphs;
+        program->graph_capacity = grown;
+    }
+    if (program->attachment_count + part->attachment_count > program->attachment_capacity) {
+        uint32_t grown = program->attachment_count + part->attachment_count;
+        Attachment* attachments = realloc(program->attachments, grown * sizeof(Attachment));
+        if (attachments == NULL)
+            return 0;
+        program->attachments = attachments;
+        program->attachment_capacity = grown;
+    }
+    memcpy(program->graphs + offset, part->graphs, part->graph_count * sizeof(Graph*));
+    program->graph_count += part->graph_count;
+    part->graph_count = 0;
+
+    for (uint32_t i = 0; i < part->attachment_count; i++) {
+        Attachment* attachment = &program->attachments[program->attachment_count++];
+        *attachment = part->attachments[i];
+        attachment->graph += offset;
+    }
+
+    Ast* ast = &program->ast;
+    for (uint32_t i = ast_append(ast, &part->ast); i < ast->count; i++) {
+        if (ast->nodes[i].kind == AST_DECLARE && ast->nodes[i].value >= 0)
+            ast->nodes[i].value += (int32_t) offset;
+    }
+    return !ast->failed;
+}
+
+/**
+ * Prints that a program can't be linked for lack of memory.
+ *
+ * @param program The program.
+ * @return 0, for the caller to return.
+*/
+static int link_out_of_memory(Program* program) {
+    fprintf(program->messages, "Error: out of memory while instantiating subgraphs\n");
+    return 0;
+}
+
+/**
+ * Finds the child of a block node with the given kind.
+ *
+ * @param ast The syntax tree.
+ * @param block The AST_GRAPH or AST_MAIN node.
+ * @param kind The AstKind of the child.
+ * @return The child, NULL if the block has none.
+*/
+static const AstNode* block_child(const Ast* ast, const AstNode* block, AstKind kind) {
+    for (uint32_t i = 0; i < block->count; i++) {
+        if (ast_child(ast, block, i)->kind == kind)
+            return ast_child(ast, block, i);
+    }
+    return NULL;
+}
+
+/**
+ * Creates the view of a block and its %subgraph instances, which must use blocks declared before it.
+ *
+ * @param program The program.
+ * @param block The AST_GRAPH or AST_MAIN node.
+ * @return 0 if an instance can't be created or memory is exhausted, 1 if not.
+*/
+static int link_block(Program* program, const AstNode* block) {
+    const Ast* ast = &program->ast;
+    uint32_t index = (uint32_t) block_child(ast, block, AST_DECLARE)->value;
+    GraphView* view = &program->views[index];
+
+    const AstNode* subgraph = block_child(ast, block, AST_SUBGRAPH);
+    for (uint32_t i = 0; subgraph != NULL && i < subgraph->count; i++) {
+        const AstNode* instances = ast_child(ast, subgraph, i);
+        uint32_t shape = name_map_get(&program->blocks, (uint32_t) instances->value);
+        if (shape == GRAPH_NO_NODE) {
+            fprintf(program->messages, "Semantic Error: graph %s must be declared before its instances at line %u\n",
+                intern_text(program->names, (uint32_t) instances->value), instances->line);
+            return 0;
+        }
+        for (uint32_t j = 0; j < instances->count; j++) {
+            const AstNode* instance = ast_child(ast, instances, j);
+            if (name_map_get(&view->instance_names, (uint32_t) instance->value) != GRAPH_NO_NODE) {
+                fprintf(program->messages, "Semantic Error: instance %s is declared twice at line %u\n",
+                    intern_text(program->names, (uint32_t) instance->value), instance->line);
+                return 0;
+            }
+            if ((uint64_t) view->node_count + program->views[shape].node_count >= GRAPH_NO_NODE) {
+                fprintf(program->messages, "Semantic Error: too many nodes in the instances of line %u\n", instance->line);
+                return 0;
+            }
+            if (!view_add_instance(view, instance->value, &program->views[shape]))
+                return link_out_of_memory(program);
+        }
+    }
+
+    if (block->kind == AST_GRAPH) {
+        if (name_map_get(&program->blocks, (uint32_t) block->value) != GRAPH_NO_NODE) {
+            fprintf(program->messages, "Semantic Error: graph %s is declared twice at line %u\n",
+                intern_text(program->names, (uint32_t) block->value), block->line);
+            return 0;
+        }
+        if (!name_map_put(&program->blocks, (uint32_t) block->value, index))
+            return link_out_of_memory(program);
+    }
+    return 1;
+}
+
+/**
+ * Turns an attachment into overlay edges between a node of a block and a node of one of its instances,
+ * in both directions when the block is undirected.
+ *
+ * @param program The program.
+ * @param attachment The attachment.
+ * @return 0 if the instance or its node doesn't exist or memory is exhausted, 1 if not.
+*/
+static int link_attachment(Program* program, const Attachment* attachment) {
+    GraphView* view = &program->views[attachment->graph];
+    uint32_t i = name_map_get(&view->instance_names, (uint32_t) attachment->instance);
+    if (i == GRAPH_NO_NODE) {
+        fprintf(program->messages, "Semantic Error: unknown subgraph instance %s at line %u\n",
+            intern_text(program->names, (uint32_t) attachment->instance), attachment->line);
+        return 0;
+    }
+    const Instance* instance = &view->instances[i];
+    uint32_t node = 0; // An instance called without a node is entered by the first node of its template
+    if (attachment->node != AST_NO_NAME)
+        node = view_find(instance->shape, (uint32_t) attachment->node);
+    if (node == GRAPH_NO_NODE || node >= instance->shape->graph->node_count) {
+        fprintf(program->messages, "Semantic Error: instance %s has no node %s at line %u\n",
+            intern_text(program->names, (uint32_t) attachment->instance),
+            attachment->node == AST_NO_NAME ? "to enter" : intern_text(program->names, (uint32_t) attachment->node),
+            attachment->line);
+        return 0;
+    }
+    uint32_t target = instance->offset + node;
+    if (!view_add_edge(view, attachment->source, target, attachment->weight, attachment->capacity, attachment->line)
+        || (!view->graph->directed
+        && !view_add_edge(view, target, attachment->source, attachment->weight, attachment->capacity, attachment->line)))
+        return link_out_of_memory(program);
+    return 1;
+}
+
+/**
+ * Links every block of a parsed program to the templates of its instances, without copying them.
+ *
+ * @param program The program, whose syntax tree is complete.
+ * @return 0 if a semantic error is found or memory is exhausted, 1 if not.
+*/
+int program_link(Program* program) {
+    const Ast* ast = &program->ast;
+    const AstNode* root = ast_node(ast, ast->root);
+    program->views = calloc(program->graph_count == 0 ? 1 : program->graph_count, sizeof(GraphView));
+    if (program->views == NULL)
+        return link_out_of_memory(program);
+    int initialized = 1;
+    for (uint32_t i = 0; i < program->graph_count; i++) // Every view can be released, even if linking stops early
+        initialized &= view_init(&program->views[i], program->graphs[i]);
+    if (!initialized)
+        return link_out_of_memory(program);
+
+    // Attachments are stored in block order, a block being complete before the next one uses it
+    uint32_t next = 0;
+    for (uint32_t i = 0; i < root->count; i++) {
+        const AstNode* block = ast_child(ast, root, i);
+        if (!link_block(program, block))
+            return 0;
+        uint32_t index = (uint32_t) block_child(ast, block, AST_DECLARE)->value;
+        for (; next < program->attachment_count && program->attachments[next].graph == index; next++) {
+            if (!link_attachment(program, &program->attachments[next]))
+                return 0;
+        }
+        if (!view_finish(&program->views[index]))
+            return link_out_of_memory(program);
+    }
+    return 1;
+}
+
+/**
+ * Builds the incoming edges of every directed graph of a program, for the searches running backward.
+ * Nothing is done for the graphs that were already reversed.
+ *
+ * @param program The linked program.
+ * @return 1 if every graph is reversed, 0 if memory is exhausted.
+*/
+int program_reverse(Program* program) {
+    for (uint32_t i = 0; i < program->graph_count; i++) {
+        if (!graph_reverse(program->graphs[i]))
+            return 0;
+    }
+    return 1;
+}
@@ -0,0 +1,54 @@
+/**
+ * @file
+ * @brief Program model header file.
+*/
+
+#ifndef PROGRAM_H_
+#define PROGRAM_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include "ast.h"
+#include "graph.h"
+#include "parser.h"
+#include "view.h"
+
+/**
+ * Defined type based on a struct holding an edge whose target is a node of a subgraph instance.
+*/
+typedef struct {
+    uint32_t graph;    /** Index of the graph declaring the edge. */
+    uint32_t source;   /** Source node id in that graph. */
+    int32_t instance;  /** Interned name of the instance. */
+    int32_t node;      /** Interned name of the target node in the instance, AST_NO_NAME for its first node. */
+    int32_t weight;    /** Weight of the edge. */
+    int32_t capacity;  /** Capacity of the edge, GRAPH_NO_CAPACITY without one. */
+    uint32_t line;     /** %declare line of the edge. */
+} Attachment;
+
+/**
+ * Defined type based on a struct holding everything known about a parsed program.
+*/
+typedef struct {
+    Ast ast;                  /** Syntax tree of the program. */
+    Graph** graphs;           /** Graph of each block, in declaration order, the main block being last. */
+    uint32_t graph_count;     /** Number of graphs. */
+    uint32_t graph_capacity;  /** Capacity of graphs. */
+    Attachment* attachments;  /** Edges towards subgraph instances, in declaration order. */
+    uint32_t attachment_count;    /** Number of attachments. */
+    uint32_t attachment_capacity; /** Capacity of attachments. */
+    GraphBuilder builder;     /** Builder of the %declare block being parsed. */
+    GraphView* views;         /** View of each graph with its instances, filled by program_link(). */
+    NameMap blocks;           /** Index of the graph of each named block. */
+    const InternTable* names; /** Names of the identifiers met in the program. */
+    FILE* messages;           /** Where semantic and runtime errors are printed, stdout unless changed. */
+} Program;
+
+void program_init(Program* program, const InternTable* names);
+void program_free(Program* program);
+DeclareSink program_sink(Program* program);
+int program_append(Program* program, Program* part);
+int program_link(Program* program);
+int program_reverse(Program* program);
+
+#endif
@@ -7,243 +7,282 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h> 
+#include <limits.h>
+#include <stdint.h>
 #include "scanner.h"
+#include "keywords.h"
 
 /**
  * Constant char* array for mapping the token type to its string.
 */
 const char* const token_map[] = {
-    "ID_TOKEN", "NUM_TOKEN", "OP_TOKEN", "CP_TOKEN", "EQ_TOKEN", "NEQ_TOKEN", "GT_TOKEN", "LT_TOKEN", "LEQ_TOKEN", "BEQ_TOKEN",
-    "OB_TOKEN", "CB_TOKEN", "MAIN_TOKEN", "PTYPE_TOKEN", "PDECLARE_TOKEN", "PSUBGRAPH_TOKEN", "POPERATIONS_TOKEN", "GTYPE_TOKEN",
-    "EDGE_TOKEN", "COMMA_TOKEN", "SEMICOLON_TOKEN", "COLOR_TOKEN", "IF_TOKEN", "LOOP_TOKEN", "OPERATION_TOKEN", "ARROW_TOKEN",
-    "GSEARCH_TOKEN", "COLON_TOKEN", "EOF_TOKEN"
+#define TOKEN(type, name) #type,
+#include "tokens.def"
+#undef TOKEN
 };
 
 /**
- * Decides the next token type and calls the appropriate function.
+ * Initializes a scanner at the start of a source.
+ *
+ * @param scanner The scanner.
+ * @param source The source text to scan.
+ * @param names The table interning the names of the identifiers.
+*/
+void scanner_init(Scanner* scanner, Source* source, InternTable* names) {
+    memset(scanner, 0, sizeof(Scanner));
+    scanner->source = source;
+    scanner->names = names;
+    scanner->row = 1;
+    scanner->column = 1;
+    scanner->messages = stdout;
+}
+
+/**
+ * Consumes the next character of the source and updates the row and column of the scanner accordingly.
+ * 
+ * @param scanner The scanner.
+ * @return The consumed character, or EOF at the end of the source.
 */
-void next_token() {
-    // clear the content of the current_token
-    if (current_token != NULL) {
-        free(current_token->token);
-        free(current_token);
+int readChar(Scanner* scanner) {
+    int car = source_get(scanner->source);
+    if (car == '\n') {
+        scanner->row++;
+        scanner->column = 1;
     }
+    else if (car == '\t')
+        scanner->column = source_tab_stop(scanner->column);
+    else if (car != EOF)
+        scanner->column++;
+    return car;
+}
 
-    // re-allocate the space for current_token
-    current_token = malloc(sizeof(TokenData));
+/**
+ * Points the current token text on the source characters read since the token start.
+ * 
+ * @param scanner The scanner.
+ * @param start The first character of the token in the source buffer.
+*/
+void storeToken(Scanner* scanner, const char* start) {
+    scanner->token.text = start;
+    scanner->token.length = (int) (scanner->source->cursor - start);
+}
 
-    int has_space = 0;
+/**
+ * Checks if the given token text is equal to a lowercase word, ignoring the case of the text.
+ * 
+ * @param text The token text, not NUL-terminated.
+ * @param length The length of the token text.
+ * @param word The lowercase word to compare with.
+ * @return 1 if they are equal, 0 if not.
+*/
+int isWord(const char* text, int length, const char* word) {
+    int i;
+    for (i = 0; i < length; i++) {
+        if (tolower((unsigned char) text[i]) != word[i])
+            return 0;
+    }
+    return word[i] == '\0';
+}
+
+/**
+ * Decides the next token type and calls the appropriate function.
+ *
+ * @param scanner The scanner.
+*/
+void next_token(Scanner* scanner) {
+    // skip the spaces before the token
+    while (isSpace(source_peek(scanner->source)))
+        readChar(scanner);
+
+    scanner->token.start_ln = scanner->row;
+    scanner->token.start_col = scanner->column;
+    scanner->token.value = 0;
 
     // read the next token
-    if ((CURRENT_CHAR = getc(PROGRAM_File)) != EOF) {
-        CURRENT_CHAR = tolower(CURRENT_CHAR); // GraphEx is case insensitive
-        CURRENT_COLUMN++;
-        while (isSpace() == 1) {
-            CURRENT_CHAR = getc(PROGRAM_File);
-            has_space = 1;
-        }
-        if (CURRENT_CHAR == EOF)
-        {
-            current_token->token = "EOF";
-            current_token->type = EOF_TOKEN;
-        }
-        else if (isalpha(CURRENT_CHAR) != 0)
-            {
-                readWord();
-            }else
-            {
-                if (isdigit(CURRENT_CHAR) != 0)
-                {
-                    readNum();
-                }else
-                {
-                    if(CURRENT_CHAR == '%'){
-                        readTag();
-                    }
-                    else
-                    {
-                        if (CURRENT_CHAR == '#'){
-                            readColor();
-                        }
-                        else 
-                            if(isSpace() == 0){ // if CURRENT_CHAR is not a space
-                                readSpecialChar();
-                            }
-                    } 
-                }  
-            }
+    scanner->current_char = readChar(scanner);
+    if (scanner->current_char == EOF) {
+        scanner->token.text = "eof";
+        scanner->token.length = 3;
+        scanner->token.type = EOF_TOKEN;
     }
-
-    if (CURRENT_CHAR == EOF) {
-        current_token->token = "eof";
-        current_token->type = EOF_TOKEN;
-        current_token->start_ln = CURRENT_ROW;
-        if (!has_space)
-            CURRENT_COLUMN++;
-        current_token->start_col = CURRENT_COLUMN;
+    else {
+        scanner->current_char = tolower(scanner->current_char); // GraphEx is case insensitive
+        if (isalpha(scanner->current_char) != 0)
+            readWord(scanner);
+        else if (isdigit(scanner->current_char) != 0 || (scanner->current_char == '-' && isdigit(source_peek(scanner->source))))
+            readNum(scanner);
+        else if (scanner->current_char == '%')
+            readTag(scanner);
+        else if (scanner->current_char == '#')
+            readColor(scanner);
+        else
+            readSpecialChar(scanner);
     }
 
-    printf("%s | %s\n", current_token->token, token_map[(int) (current_token->type)]);
+    if (scanner->trace != NULL || scanner->dump != NULL)
+        traceToken(scanner);
     return;
 }
 
 /**
- * Reads the next word token in the file and stores its data in the current_token variable.
+ * Writes the decimal form of a number to a file without going through printf.
+ * 
+ * @param number The number to write.
+ * @param file The file to write to.
 */
-void readWord() {
+void writeNumber(int number, FILE* file) {
+    char digits[12];
+    int i = sizeof(digits);
+    unsigned int value = number < 0 ? 0u - (unsigned int) number : (unsigned int) number;
+    do {
+        digits[--i] = '0' + value % 10;
+        value /= 10;
+    } while (value != 0);
+    if (number < 0)
+        digits[--i] = '-';
+    fwrite(digits + i, 1, sizeof(digits) - i, file);
+}
 
-    int col = CURRENT_COLUMN;
-    int line = CURRENT_ROW;
+/**
+ * Writes the current token to the token trace ("text | TYPE") and to the token dump
+ * (tab separated type, line, column, value and text), whichever are enabled.
+ *
+ * @param scanner The scanner.
+*/
+void traceToken(Scanner* scanner) {
+    const char* type = token_map[(int) (scanner->token.type)];
+    if (scanner->trace != NULL) {
+        fwrite(scanner->token.text, 1, scanner->token.length, scanner->trace);
+        fputs(" | ", scanner->trace);
+        fputs(type, scanner->trace);
+        putc('\n', scanner->trace);
+    }
+    if (scanner->dump != NULL) {
+        fputs(type, scanner->dump);
+        putc('\t', scanner->dump);
+        writeNumber(scanner->token.start_ln, scanner->dump);
+        putc('\t', scanner->dump);
+        writeNumber(scanner->token.start_col, scanner->dump);
+        putc('\t', scanner->dump);
+        writeNumber(scanner->token.value, scanner->dump);
+        putc('\t', scanner->dump);
+        fwrite(scanner->token.text, 1, scanner->token.length, scanner->dump);
+        putc('\n', scanner->dump);
+    }
+}
+
+/**
+ * Reads the next word token in the file and stores its data in the current token of the scanner.
+ * Identifiers are interned so that equal names share the same id.
+ *
+ * @param scanner The scanner.
+*/
+void readWord(Scanner* scanner) {
+    const char* start = scanner->source->cursor - 1;
 
-    char token[25];
-    token[0] = tolower(CURRENT_CHAR);
-    
-    int i = 1;
-    char car;
     // read the word
-    while ((car = fgetc(PROGRAM_File)) != EOF) {
-        if (isalpha(car) || isdigit(car)) {
-            car = tolower(car);
-            CURRENT_COLUMN++;
-            token[i]= car;
-            CURRENT_CHAR = car;
-            i++;
-        }
-        else {
-            // Point on the last char of the word
-            fseek(PROGRAM_File, -1L, SEEK_CUR);
-            break;
-        }
-    }
-    token[i]='\0';    
+    while (isalnum(source_peek(scanner->source)))
+        scanner->current_char = tolower(readChar(scanner));
 
     // Store the token
-    current_token->token = malloc(strlen(token) + 1);
-    strcpy(current_token->token, token);
+    storeToken(scanner, start);
 
     // Verify if the token is a keyword or just an ID
-    current_token->type = isKeyword(token);
-    current_token->start_ln = line;
-    current_token->start_col= col;
+    scanner->token.type = isKeyword(scanner, scanner->token.text, scanner->token.length);
+    if (scanner->token.type == ID_TOKEN)
+        scanner->token.value = intern(scanner->names, scanner->token.text, scanner->token.length);
 
     return;
 }
 
 /**
- * Checks if the given token is a keyword or an identifier.
+ * Looks the given token up in the perfect hash table generated from keywords.def.
+ * 
+ * @param token The token that has been read.
+ * @param length The length of the token.
+ * @param value Receives the value of the reserved word if it is found.
+ * @return The token type of the reserved word, -1 if the token is not reserved.
+*/
+int findKeyword(const char* token, int length, int* value) {
+    if (length > KEYWORD_MAX_LENGTH)
+        return -1;
+    uint32_t hash = KEYWORD_SEED;
+    for (int i = 0; i < length; i++) {
+        hash ^= (unsigned char) tolower((unsigned char) token[i]);
+        hash *= 16777619u;
+    }
+    const Keyword* keyword = &keyword_table[hash & (KEYWORD_SLOTS - 1)];
+    if (keyword->length != length || !isWord(token, length, keyword->word))
+        return -1;
+    *value = keyword->value;
+    return keyword->type;
+}
+
+/**
+ * Checks if the given token is a keyword or an identifier, storing the keyword value in the current token.
  * 
+ * @param scanner The scanner.
  * @param token The token that has been read.
+ * @param length The length of the token.
  * @return The corresponding token type value.
 */
-int isKeyword(char *token) {
-    if(strcmp(token, "main") == 0) return MAIN_TOKEN;
-    if(strcmp(token, "directed") == 0) return GTYPE_TOKEN;
-    if(strcmp(token, "undirected") == 0) return GTYPE_TOKEN;
-    if(strcmp(token, "if") == 0) return IF_TOKEN;
-    if(strcmp(token, "traverse") == 0) return LOOP_TOKEN;
-    if(strcmp(token, "dfs") == 0) return GSEARCH_TOKEN;
-    if(strcmp(token, "bfs") == 0) return GSEARCH_TOKEN;
-    if(strcmp(token, "printall") == 0) return OPERATION_TOKEN;
-    if(strcmp(token, "printnodes") == 0) return OPERATION_TOKEN;
-    if(strcmp(token, "getchemin") == 0) return OPERATION_TOKEN;
-    if(strcmp(token, "getweight") == 0) return OPERATION_TOKEN;
-    if(strcmp(token, "getnode") == 0) return OPERATION_TOKEN;
-    if(strcmp(token, "exists") == 0) return OPERATION_TOKEN;
-    if(strcmp(token, "mincost") == 0) return OPERATION_TOKEN;
-    if(strcmp(token, "nombrechromatique") == 0) return OPERATION_TOKEN;
-    if(strcmp(token, "colorier") == 0) return OPERATION_TOKEN;
-    if(strcmp(token, "colorergraph") == 0) return OPERATION_TOKEN;
-    if(strcmp(token, "plot") == 0) return OPERATION_TOKEN;
-    if(strcmp(token, "dijkstra") == 0) return OPERATION_TOKEN;
-    if(strcmp(token, "bellman") == 0) return OPERATION_TOKEN;
-    if(strcmp(token, "dijkstrageneralise") == 0) return OPERATION_TOKEN;
-    if(strcmp(token, "kruskal") == 0) return OPERATION_TOKEN;
-    if(strcmp(token, "prime") == 0) return OPERATION_TOKEN;
-
-    return ID_TOKEN;
+int isKeyword(Scanner* scanner, const char* token, int length) {
+    int type = findKeyword(token, length, &scanner->token.value);
+    return type == -1 ? ID_TOKEN : type;
 } 
 
 /**
- * Reads the next number token in the file and stores its data in the current_token variable.
+ * Reads the next number token in the file, signed by a leading '-', and stores its data in the current token of the scanner.
+ *
+ * @param scanner The scanner.
 */
-void readNum() {
-
-    int col = CURRENT_COLUMN;
-    int line = CURRENT_ROW;
-
-    char token[20]; // zone to put the number 
-    token[0] = CURRENT_CHAR;
+void readNum(Scanner* scanner) {
+    const char* start = scanner->source->cursor - 1;
+    int negative = scanner->current_char == '-';
+    if (negative)
+        scanner->current_char = readChar(scanner);
+    long long value = scanner->current_char - '0';
     
-    char car;
-    int i = 1;
-
     //read the number
-    while ((car = fgetc(PROGRAM_File)) != EOF) {
-        if (isdigit(car)) {
-            CURRENT_COLUMN++;
-            token[i]= car;
-            CURRENT_CHAR = car;
-            i++;
-        }
-        else {
-            fseek(PROGRAM_File, -1L, SEEK_CUR);
-            break;
-        }
+    while (isdigit(source_peek(scanner->source))) {
+        scanner->current_char = readChar(scanner);
+        if (value <= INT_MAX)
+            value = value * 10 + (scanner->current_char - '0');
     }
-    token[i]='\0';
 
     // store the value and the type of the current token
-    current_token->token = malloc(strlen(token) + 1);
-    strcpy(current_token->token, token);
-
-    current_token->type = NUM_TOKEN;
-    current_token->start_ln = line;
-    current_token->start_col = col;
+    storeToken(scanner, start);
+    scanner->token.type = NUM_TOKEN;
+
+    if (negative)
+        value = -value;
+    if (value > INT_MAX || value < INT_MIN) {
+        scanner->token.type = -1;
+        generateError(scanner);
+    }
+    scanner->token.value = (int) value;
 
     return;
 }
 
 /**
- * Reads the next tag token (%...) in the file and stores its data in the current_token variable.
+ * Reads the next tag token (%...) in the file and stores its data in the current token of the scanner.
+ *
+ * @param scanner The scanner.
 */
-void readTag() {
-
-    int col = CURRENT_COLUMN;
-    int line = CURRENT_ROW;
-
-    char token[25];
-    token[0] = CURRENT_CHAR;
+void readTag(Scanner* scanner) {
+    const char* start = scanner->source->cursor - 1;
     
-    int i = 1;
-    char car;
-
     // read the word
-    while ((car = fgetc(PROGRAM_File)) != EOF) {
-        if (isalpha(car) || isdigit(car)) {
-            car = tolower(car);
-            CURRENT_COLUMN++;
-            token[i]= car;
-            CURRENT_CHAR = car;
-            i++;
-        }
-        else {
-            fseek(PROGRAM_File, -1L, SEEK_CUR);
-            break;
-        }
-    }
-    token[i]='\0';
+    while (isalnum(source_peek(scanner->source)))
+        scanner->current_char = tolower(readChar(scanner));
 
     // Stock the token
-    current_token->token = malloc(strlen(token) + 1);
-    strcpy(current_token->token, token);
+    storeToken(scanner, start);
+    scanner->token.type = isTag(scanner, scanner->token.text, scanner->token.length);
 
-    current_token->type = isTag(token);
-
-    current_token->start_ln = line;
-    current_token->start_col = col;
-
-    if ((int) (current_token->type) == -1) {
-        generateError();
+    if ((int) (scanner->token.type) == -1) {
+        generateError(scanner);
     }
 
     return;
@@ -252,263 +291,314 @@ void readTag() {
 /**
  * Checks if the given token is a valid tag token.
  * 
+ * @param scanner The scanner.
  * @param token The token that has been read.
+ * @param length The length of the token.
  * @return The corresponding token type if the token is a valid tag, -1 if not.
 */
-int isTag(char* token) {
-    if(strcmp(token, "%type") == 0) return PTYPE_TOKEN;
-    if(strcmp(token, "\%declare") == 0) return PDECLARE_TOKEN;
-    if(strcmp(token, "\%subgraph") == 0) return PSUBGRAPH_TOKEN;
-    if(strcmp(token, "\%operations") == 0) return POPERATIONS_TOKEN;
-
-    return -1;
+int isTag(Scanner* scanner, const char* token, int length) {
+    return findKeyword(token, length, &scanner->token.value);
 }
 
 /**
- * Reads the next color token in the file and stores its data in the current_token variable.
+ * Reads the next color token in the file and stores its data in the current token of the scanner.
+ *
+ * @param scanner The scanner.
 */
-void readColor() {
-
-    int col = CURRENT_COLUMN;
-    int line = CURRENT_ROW;
-
-    char token[25];
-    token[0] = CURRENT_CHAR;
+void readColor(Scanner* scanner) {
+    const char* start = scanner->source->cursor - 1;
     
-    int i = 1;
-    char car;
-
     // read the word
-    while ((car = fgetc(PROGRAM_File)) != EOF) {
-        if (isalpha(car) || isdigit(car)) {
-            car = tolower(car);
-            CURRENT_COLUMN++;
-            token[i]= car;
-            CURRENT_CHAR = car;
-            i++;
-        }
-        else {
-            fseek(PROGRAM_File, -1L, SEEK_CUR);
-            break;
-        }
-    }
-    token[i]='\0';
+    while (isalnum(source_peek(scanner->source)))
+        scanner->current_char = tolower(readChar(scanner));
 
     // Stock the token
-    current_token->token = malloc(strlen(token) + 1);
-    strcpy(current_token->token, token);
+    storeToken(scanner, start);
 
-    int iscoleur = isColor(token);
-    current_token->type = iscoleur ;
-
-    current_token->start_ln = line;
-    current_token->start_col= col;
+    int iscoleur = isColor(scanner, scanner->token.text, scanner->token.length);
+    scanner->token.type = iscoleur ;
 
     if (iscoleur == -1)
     {
-        generateError();
+        generateError(scanner);
     }
 
     return;
 }
 
 /**
- * Checks if the given token is a valid color token.
+ * Checks if the given token is a valid color token, storing its ColorKind in the current token.
  * 
+ * @param scanner The scanner.
  * @param token The token that has been read.
+ * @param length The length of the token.
  * @return The corresponding token type if the token is a color tag, -1 if not.
 */
-int isColor(char* token) {
-    if (strcmp(token, "#red") == 0) return COLOR_TOKEN;
-    if (strcmp(token, "#blue") == 0) return COLOR_TOKEN;
-    if (strcmp(token, "#green") == 0) return COLOR_TOKEN;
-    if (strcmp(token, "#yellow") == 0) return COLOR_TOKEN;
-    if (strcmp(token, "#black") == 0) return COLOR_TOKEN;
-    if (strcmp(token, "#pink") == 0) return COLOR_TOKEN;
-    if (strcmp(token, "#purple") == 0) return COLOR_TOKEN;
-    if (strcmp(token, "#orange") == 0) return COLOR_TOKEN;
-    if (strcmp(token, "#white") == 0) return COLOR_TOKEN;
-    if (strcmp(token, "#gray") == 0) return COLOR_TOKEN;
-
-    return -1;
+int isColor(Scanner* scanner, const char* token, int length) {
+    return findKeyword(token, length, &scanner->token.value);
 }
 
 /**
- * Checks if the current character is a space and increments CURRENT_COLUMN and CURRENT_ROW accordingly.
+ * Checks if the given character is a space character.
  * 
- * @return 1 if the current character is a space character, 0 if not.
+ * @param car The character to check.
+ * @return 1 if the character is a space character, 0 if not.
 */
-int isSpace() {
-    if(CURRENT_CHAR == ' ') {CURRENT_COLUMN++; return 1;}
-    if(CURRENT_CHAR == '\t') {CURRENT_COLUMN += 8; return 1;}
-    if(CURRENT_CHAR == '\n'){
-        CURRENT_COLUMN = 1;
-        CURRENT_ROW++;
-        return 1; 
-    } 
-    return 0;
+int isSpace(int car) {
+    return car == ' ' || car == '\t' || car == '\n' || car == '\r';
 }
 
 /**
- * Reads the next special character and stores the data in the current_token variable.
+ * Reads the next special character and stores the data in the current token of the scanner.
+ *
+ * @param scanner The scanner.
 */
-void readSpecialChar() {
-    int col = CURRENT_COLUMN;
-    int line = CURRENT_ROW;
-    if(CURRENT_CHAR == ';'){
-        current_token->token = ";";
-        current_token->type = SEMICOLON_TOKEN;
-        current_token->start_ln = line;
-        current_token->start_col= col;
+void readSpecialChar(Scanner* scanner) {
+    const char* start = scanner->source->cursor - 1;
+
+    if(scanner->current_char == ';'){
+        storeToken(scanner, start);
+        scanner->token.type = SEMICOLON_TOKEN;
         return;
     }
-    if(CURRENT_CHAR == ',') {
-        current_token->token = ",";
-        current_token->type = COMMA_TOKEN;
-        current_token->start_ln = line;
-        current_token->start_col= col;
+    if(scanner->current_char == ',') {
+        storeToken(scanner, start);
+        scanner->token.type = COMMA_TOKEN;
         return;
     } 
-    if(CURRENT_CHAR == '{'){
-        current_token->token = "{";
-        current_token->type = OB_TOKEN;
-        current_token->start_ln = line;
-        current_token->start_col= col;
+    if(scanner->current_char == '{'){
+        storeToken(scanner, start);
+        scanner->token.type = OB_TOKEN;
         return;
     }
-    if(CURRENT_CHAR == '}'){
-        current_token->token = "}";
-        current_token->type = CB_TOKEN;
-        current_token->start_ln = line;
-        current_token->start_col= col;
+    if(scanner->current_char == '}'){
+        storeToken(scanner, start);
+        scanner->token.type = CB_TOKEN;
         return;
     }
-    if(CURRENT_CHAR == '('){
-        current_token->token = "(";
-        current_token->type = OP_TOKEN;
-        current_token->start_ln = line;
-        current_token->start_col= col;
+    if(scanner->current_char == '('){
+        storeToken(scanner, start);
+        scanner->token.type = OP_TOKEN;
         return;
     } 
-    if(CURRENT_CHAR == ')'){
-        current_token->token = ")";
-        current_token->type = CP_TOKEN;
-        current_token->start_ln = line;
-        current_token->start_col= col;
+    if(scanner->current_char == ')'){
+        storeToken(scanner, start);
+        scanner->token.type = CP_TOKEN;
         return;
     }
-    if(CURRENT_CHAR == ':'){
-        current_token->token = ":";
-        current_token->type = COLON_TOKEN;
-        current_token->start_ln = line;
-        current_token->start_col= col;
+    if(scanner->current_char == ':'){
+        storeToken(scanner, start);
+        scanner->token.type = COLON_TOKEN;
         return;
     } 
-    if(CURRENT_CHAR == '=') {
-        char car;
-        car = fgetc(PROGRAM_File);
-        if (car == '>') {
-            CURRENT_COLUMN++;
-            CURRENT_CHAR = car;
-            current_token->token = "=>";
-            current_token->type = ARROW_TOKEN;
-            current_token->start_ln = line;
-            current_token->start_col= col;
+    if(scanner->current_char == '=') {
+        if (source_peek(scanner->source) == '>') {
+            scanner->current_char = readChar(scanner);
+            storeToken(scanner, start);
+            scanner->token.type = ARROW_TOKEN;
         }
         else {
-            fseek(PROGRAM_File, -1L, SEEK_CUR);
-            current_token->token = "=";
-            current_token->type = EQ_TOKEN;
-            current_token->start_ln = line;
-            current_token->start_col= col;
+            storeToken(scanner, start);
+            scanner->token.type = EQ_TOKEN;
         }
-
         return;
     } 
-    if (CURRENT_CHAR == '<')
+    if (scanner->current_char == '<')
     {
-        char car;
-        car = fgetc(PROGRAM_File);
+        int car = source_peek(scanner->source);
         if (car == '>') {
-            CURRENT_COLUMN++;
-            CURRENT_CHAR = car;
-            current_token->token = "<>";
-            current_token->type = NEQ_TOKEN;
-            current_token->start_ln = line;
-            current_token->start_col= col;
+            scanner->current_char = readChar(scanner);
+            storeToken(scanner, start);
+            scanner->token.type = NEQ_TOKEN;
         }
-        if (car == '=') {
-            CURRENT_COLUMN++;
-            CURRENT_CHAR = car;
-            current_token->token = "<=";
-            current_token->type = LEQ_TOKEN;
-            current_token->start_ln = line;
-            current_token->start_col= col;
+        else if (car == '=') {
+            scanner->current_char = readChar(scanner);
+            storeToken(scanner, start);
+            scanner->token.type = LEQ_TOKEN;
         }
         else {
-            fseek(PROGRAM_File, -1L, SEEK_CUR);
-            current_token->token = "<";
-            current_token->type = LT_TOKEN;
-            current_token->start_ln = line;
-            current_token->start_col= col;
+            storeToken(scanner, start);
+            scanner->token.type = LT_TOKEN;
         }
-
         return;
     }
-    if (CURRENT_CHAR == '>')
+    if (scanner->current_char == '>')
     {
-        char car;
-        car = fgetc(PROGRAM_File);
-        if (car == '=') {
-            CURRENT_COLUMN++;
-            CURRENT_CHAR = car;
-            current_token->token = ">=";
-            current_token->type = BEQ_TOKEN;
-            current_token->start_ln = line;
-            current_token->start_col= col;
-            return;
+        if (source_peek(scanner->source) == '=') {
+            scanner->current_char = readChar(scanner);
+            storeToken(scanner, start);
+            scanner->token.type = BEQ_TOKEN;
         }
         else {
-            fseek(PROGRAM_File, -1L, SEEK_CUR);
-            current_token->token = ">";
-            current_token->type = GT_TOKEN;
-            current_token->start_ln = line;
-            current_token->start_col= col;
+            storeToken(scanner, start);
+            scanner->token.type = GT_TOKEN;
         }
-        
         return;
     }
-    if(CURRENT_CHAR == '-'){
-        char car;
-        car = fgetc(PROGRAM_File);
-        if(car == '>'){
-            CURRENT_COLUMN++;
-            CURRENT_CHAR = car;
-            current_token->token = "->";
-            current_token->type = EDGE_TOKEN;
-            current_token->start_ln = line;
-            current_token->start_col= col;
-            return;
-        } 
+    if(scanner->current_char == '-' && source_peek(scanner->source) == '>'){
+        scanner->current_char = readChar(scanner);
+        storeToken(scanner, start);
+        scanner->token.type = EDGE_TOKEN;
+        return;
     }
     
-    char token[3];
-    token[0]= CURRENT_CHAR;
-    token[1]='\0';
-
-    strcpy(current_token->token, token);
-    current_token->type = -1;
-    current_token->start_ln = line;
-    current_token->start_col= col;
+    storeToken(scanner, start);
+    scanner->token.type = -1;
 
-    generateError();
+    generateError(scanner);
     return;
 }
 
 /**
- * Prints the lexical error with the error line and column mention.
+ * Prints the lexical error with the error line and column mention, and stops the scan.
+ *
+ * @param scanner The scanner.
+*/
+void generateError(Scanner* scanner) {
+    fprintf(scanner->messages, "Lexical Error : invalid token %.*s at line %d, char %d\n", scanner->token.length, scanner->token.text, scanner->token.start_ln, scanner->token.start_col);
+    scanner->failed = 1;
+}
+
+
+/**
+ * Grows every array of a token buffer to the given capacity.
+ * 
+ * @param tokens The token buffer.
+ * @param capacity The new capacity.
+ * @return 1 if the arrays were grown, 0 if memory is exhausted.
+*/
+static int growTokens(TokenBuffer* tokens, uint32_t capacity) {
+    uint8_t* types = realloc(tokens->types, capacity * sizeof(uint8_t));
+    if (types != NULL) tokens->types = types;
+    uint32_t* offsets = realloc(tokens->offsets, capacity * sizeof(uint32_t));
+    if (offsets != NULL) tokens->offsets = offsets;
+    uint32_t* lengths = realloc(tokens->lengths, capacity * sizeof(uint32_t));
+    if (lengths != NULL) tokens->lengths = lengths;
+    int32_t* values = realloc(tokens->values, capacity * sizeof(int32_t));
+    if (values != NULL) tokens->values = values;
+    uint32_t* lines = realloc(tokens->lines, capacity * sizeof(uint32_t));
+    if (lines != NULL) tokens->lines = lines;
+    uint32_t* columns = realloc(tokens->columns, capacity * sizeof(uint32_t));
+    if (columns != NULL) tokens->columns = columns;
+    if (types == NULL || offsets == NULL || lengths == NULL || values == NULL || lines == NULL || columns == NULL)
+        return 0;
+    tokens->capacity = capacity;
+    return 1;
+}
+
+/**
+ * Rejects a source whose token offsets would not fit in 32 bits, before anything is scanned.
+ *
+ * @param scanner The scanner.
+ * @return 1 if the source can be scanned, 0 if it is too large, failed being set.
+*/
+static int checkLength(Scanner* scanner) {
+    if (scanner->source->length <= SCANNER_MAX_LENGTH)
+        return 1;
+    fprintf(scanner->messages, "Error: the source is larger than 4 GiB, the largest source that can be scanned\n");
+    scanner->failed = 1;
+    return 0;
+}
+
+/**
+ * Scans the next token and appends it to a token buffer.
+ *
+ * @param scanner The scanner.
+ * @param tokens The token buffer.
+ * @return 1 if the token was scanned, 0 if a lexical error is found, failed being set, or if memory is exhausted.
+*/
+static int appendToken(Scanner* scanner, TokenBuffer* tokens) {
+    next_token(scanner);
+    if (scanner->failed || scanner->names->failed) // Names stored once memory is exhausted all get id 0
+        return 0;
+    if (tokens->count == tokens->capacity && (tokens->capacity == UINT32_MAX || !growTokens(tokens, tokens->capacity == 0 ? 256
+        : tokens->capacity > UINT32_MAX / 2 ? UINT32_MAX : tokens->capacity * 2)))
+        return 0;
+    uint32_t i = tokens->count++;
+    tokens->types[i] = (uint8_t) scanner->token.type;
+    tokens->offsets[i] = scanner->token.type == EOF_TOKEN ? (uint32_t) (scanner->source->end - scanner->source->data)
+        : (uint32_t) (scanner->token.text - scanner->source->data);
+    tokens->lengths[i] = scanner->token.type == EOF_TOKEN ? 0 : (uint32_t) scanner->token.length;
+    tokens->values[i] = scanner->token.value;
+    tokens->lines[i] = (uint32_t) scanner->token.start_ln;
+    tokens->columns[i] = (uint32_t) scanner->token.start_col;
+    return 1;
+}
+
+/**
+ * Scans the whole source in one pass and stores every token in the given buffer.
+ * The buffer ends with the EOF_TOKEN, so a parser walking it never needs to scan again.
+ * Only the characters from the cursor to the end of the source are scanned, token offsets being
+ * taken from the start of its text, so that a part of a source can be scanned on its own.
+ * 
+ * @param scanner The scanner.
+ * @param tokens An empty token buffer.
+ * @return 1 if the source was scanned, 0 if a lexical error is found or the source is larger than SCANNER_MAX_LENGTH,
+ * failed being set, or if memory is exhausted.
+*/
+int scan_all(Scanner* scanner, TokenBuffer* tokens) {
+    // A guess of a token every few dozen characters, the buffer doubling from there as it fills up
+    size_t guess = (size_t) (scanner->source->end - scanner->source->cursor) / 32 + 16;
+    if (!checkLength(scanner) || !growTokens(tokens, guess < SCANNER_FIRST_TOKENS ? (uint32_t) guess : SCANNER_FIRST_TOKENS))
+        return 0;
+    do {
+        if (!appendToken(scanner, tokens))
+            return 0;
+    } while (tokens->types[tokens->count - 1] != EOF_TOKEN);
+    return 1;
+}
+
+/**
+ * Scans the next top-level block of the source, for a parser reading it one block at a time.
+ * The last token of the buffer, which starts the block, is kept as its first token, then the tokens
+ * are scanned up to the one following the brace that closes the block, or up to the EOF_TOKEN.
+ * The buffer thus only ever holds one block and the token after it.
+ * 
+ * @param scanner The scanner.
+ * @param tokens The token buffer, empty before the first block.
+ * @return 1 if the block was scanned, 0 if a lexical error is found or the source is larger than SCANNER_MAX_LENGTH,
+ * failed being set, or if memory is exhausted.
+*/
+int scan_block(Scanner* scanner, TokenBuffer* tokens) {
+    if (tokens->count == 0) {
+        if (!checkLength(scanner) || !appendToken(scanner, tokens))
+            return 0;
+    }
+    else {
+        uint32_t last = tokens->count - 1;
+        tokens->types[0] = tokens->types[last];
+        tokens->offsets[0] = tokens->offsets[last];
+        tokens->lengths[0] = tokens->lengths[last];
+        tokens->values[0] = tokens->values[last];
+        tokens->lines[0] = tokens->lines[last];
+        tokens->columns[0] = tokens->columns[last];
+        tokens->count = 1;
+    }
+    int depth = 0, closed = 0;
+    while (1) {
+        TokenType type = (TokenType) tokens->types[tokens->count - 1];
+        if (type == EOF_TOKEN || closed)
+            return 1;
+        if (type == OB_TOKEN)
+            depth++;
+        else if (type == CB_TOKEN && --depth <= 0) // The token after the block is scanned too
+            closed = 1;
+        if (!appendToken(scanner, tokens))
+            return 0;
+    }
+}
+
+/**
+ * Releases the arrays of a token buffer.
+ * 
+ * @param tokens The token buffer.
 */
-void generateError() {
-    printf("Lexical Error : invalid token %s at line %d, char %d\n", current_token->token, current_token->start_ln, current_token->start_col);
-    exit(0);
+void free_tokens(TokenBuffer* tokens) {
+    free(tokens->types);
+    free(tokens->offsets);
+    free(tokens->lengths);
+    free(tokens->values);
+    free(tokens->lines);
+    free(tokens->columns);
+    memset(tokens, 0, sizeof(TokenBuffer));
 }
@@ -6,46 +6,128 @@
 #ifndef SCANNER_H_
 #define SCANNER_H_ 
 
-#define TOKEN_COUNT 29
+#include <stdint.h>
+#include "source.h"
+#include "intern.h"
+
+#define SCANNER_MAX_LENGTH UINT32_MAX /** Largest source that can be scanned, token offsets being 32-bit. */
+#define SCANNER_FIRST_TOKENS (1 << 16) /** Most tokens a buffer is first given room for, before it grows. */
 
 /**
  * Enumeration of the different tokens that constitute the GraphEx grammar.
 */
 typedef enum {
-    ID_TOKEN, NUM_TOKEN, OP_TOKEN, CP_TOKEN, EQ_TOKEN, NEQ_TOKEN, 
-    GT_TOKEN, LT_TOKEN, LEQ_TOKEN, BEQ_TOKEN, OB_TOKEN, CB_TOKEN, MAIN_TOKEN, 
-    PTYPE_TOKEN, PDECLARE_TOKEN, PSUBGRAPH_TOKEN, POPERATIONS_TOKEN, GTYPE_TOKEN, 
-    EDGE_TOKEN, COMMA_TOKEN, SEMICOLON_TOKEN, COLOR_TOKEN, IF_TOKEN, LOOP_TOKEN,
-    OPERATION_TOKEN, ARROW_TOKEN, GSEARCH_TOKEN, COLON_TOKEN, EOF_TOKEN
+#define TOKEN(type, name) type,
+#include "tokens.def"
+#undef TOKEN
 } TokenType;
 
+#define TOKEN_COUNT ((int) EOF_TOKEN + 1)
+
+/**
+ * Enumeration of the graph search methods, value of a GSEARCH_TOKEN.
+*/
+typedef enum {
+    SEARCH_DFS, SEARCH_BFS
+} SearchKind;
+
+#define KEYWORD(word, type, value)
+#define TAG(word, type)
+#define COLOR(word, kind)
+
+/**
+ * Enumeration of the predefined operations, value of an OPERATION_TOKEN.
+*/
+typedef enum {
+#define OPERATION(word, kind) kind,
+#include "keywords.def"
+#undef OPERATION
+    OPERATION_COUNT
+} OperationKind;
+
+#undef COLOR
+#define OPERATION(word, kind)
+
+/**
+ * Enumeration of the palette colors, value of a COLOR_TOKEN.
+*/
+typedef enum {
+#define COLOR(word, kind) kind,
+#include "keywords.def"
+#undef COLOR
+    COLOR_COUNT
+} ColorKind;
+
+#undef KEYWORD
+#undef TAG
+#undef OPERATION
+
 /**
  * Defined type based on a struct holding various informations on a token.
+ * The token text is not copied: it points in the source buffer and is not NUL-terminated.
 */
 typedef struct {
-    char* token;
+    const char* text; /** First character of the token in the source buffer. */
+    int length;       /** Number of characters of the token. */
     TokenType type;
+    int value;        /** Interned name id of an identifier, value of a number, kind of a keyword. */
     int start_ln;
     int start_col;
 } TokenData;
 
-TokenData* current_token; /** Pointer on the current token. */
-
-FILE *PROGRAM_File; /** Pointer on the current file. */
-char CURRENT_CHAR; /** Current character in the buffer. */
-int CURRENT_ROW; /** Keeps count of the current line in the file. */
-int CURRENT_COLUMN; /** Keeps count of the character in the current line. */
-
-void next_token();
-void readWord();
-int isKeyword(char*);
-void readNum();
-void readTag();
-int isTag(char*);
-void readColor();
-int isColor(char*);
-int isSpace();
-void readSpecialChar();
-void generateError();
+/**
+ * Defined type based on a struct holding every token of a source, as one contiguous array per field.
+ * Token texts are given by their offset in the source buffer.
+*/
+typedef struct {
+    uint8_t* types;    /** TokenType of each token. */
+    uint32_t* offsets; /** Offset of the first character of each token in the source buffer. */
+    uint32_t* lengths; /** Number of characters of each token. */
+    int32_t* values;   /** Value of each token, as in TokenData. */
+    uint32_t* lines;   /** Start line of each token. */
+    uint32_t* columns; /** Start column of each token. */
+    uint32_t count;    /** Number of tokens, the last one being an EOF_TOKEN. */
+    uint32_t capacity; /** Capacity of each array. */
+} TokenBuffer;
+
+/**
+ * Defined type based on a struct holding the state of the scan of a source, so that several sources
+ * can be scanned at once, each by its own scanner.
+*/
+typedef struct {
+    Source* source;       /** The source text being scanned. */
+    InternTable* names;   /** Names of the identifiers met in the program. */
+    TokenData token;      /** The current token. */
+    int current_char;     /** Current character in the buffer. */
+    int row;              /** Line of the next character to be read. */
+    int column;           /** Column of the next character to be read. */
+    int failed;           /** 1 once a lexical error is found. */
+    FILE* messages;       /** Where lexical errors are printed. */
+    FILE* trace;          /** Where each token is traced as "text | TYPE", NULL when tracing is off. */
+    FILE* dump;           /** Where the token stream is dumped as tab separated values, NULL when off. */
+} Scanner;
+
+void scanner_init(Scanner*, Source*, InternTable*);
+int readChar(Scanner*);
+void storeToken(Scanner*, const char*);
+int isWord(const char*, int, const char*);
+void next_token(Scanner*);
+void writeNumber(int, FILE*);
+void traceToken(Scanner*);
+void readWord(Scanner*);
+int findKeyword(const char*, int, int*);
+int isKeyword(Scanner*, const char*, int);
+void readNum(Scanner*);
+void readTag(Scanner*);
+int isTag(Scanner*, const char*, int);
+void readColor(Scanner*);
+int isColor(Scanner*, const char*, int);
+int isSpace(int);
+void readSpecialChar(Scanner*);
+void generateError(Scanner*);
+
+int scan_all(Scanner*, TokenBuffer*);
+int scan_block(Scanner*, TokenBuffer*);
+void free_tokens(TokenBuffer*);
 
 #endif
\ No newline at end of file
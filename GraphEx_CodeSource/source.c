@@ -0,0 +1,140 @@
+/**
+ * @file
+ * @brief Source reader source file.
+ *
+ * The whole program text is made available as one contiguous buffer so the scanner can walk it
+ * with a cursor and a one character peek instead of going through stdio and seeking back.
+ * Regular files are memory-mapped where the platform allows it, anything else is read in large chunks.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "source.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#define SOURCE_CHUNK_SIZE (1 << 20) /** Size of the blocks read when the file can't be mapped. */
+
+/**
+ * Sets the source data and places the cursor on its first character.
+ *
+ * @param source The source to initialize.
+ * @param data The source text.
+ * @param length The size of the source text.
+ * @param mapped 1 if data is a memory mapping, 0 if it is a heap buffer.
+*/
+static void source_set(Source* source, const char* data, size_t length, int mapped) {
+    source->data = data;
+    source->cursor = data;
+    source->end = data + length;
+    source->length = length;
+    source->mapped = mapped;
+}
+
+#ifndef _WIN32
+/**
+ * Tries to memory-map the file at the given path.
+ *
+ * @param source The source to fill.
+ * @param path The path of the file.
+ * @return 1 if the file was mapped, 0 if the caller should fall back to reading it.
+*/
+static int source_map(Source* source, const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return 0;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+        close(fd);
+        return 0;
+    }
+    void* data = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return 0;
+    madvise(data, (size_t) st.st_size, MADV_SEQUENTIAL);
+    source_set(source, data, (size_t) st.st_size, 1);
+    return 1;
+}
+#endif
+
+/**
+ * Reads the whole file at the given path in large chunks into a heap buffer.
+ *
+ * @param source The source to fill.
+ * @param path The path of the file.
+ * @return 1 if the file was read, 0 if it could not be opened or read.
+*/
+static int source_read(Source* source, const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL)
+        return 0;
+
+    size_t capacity = SOURCE_CHUNK_SIZE;
+    size_t length = 0;
+    char* data = malloc(capacity);
+    if (data == NULL) {
+        fclose(file);
+        return 0;
+    }
+    size_t count;
+    while ((count = fread(data + length, 1, capacity - length, file)) > 0) {
+        length += count;
+        if (length == capacity) {
+            char* grown = realloc(data, capacity * 2);
+            if (grown == NULL) {
+                free(data);
+                fclose(file);
+                return 0;
+            }
+            data = grown;
+            capacity *= 2;
+        }
+    }
+    int failed = ferror(file);
+    fclose(file);
+    if (failed) {
+        free(data);
+        return 0;
+    }
+    source_set(source, data, length, 0);
+    return 1;
+}
+
+/**
+ * Loads the file at the given path as a source, memory-mapping it when possible.
+ *
+ * @param source The source to fill.
+ * @param path The path of the file.
+ * @return 1 if the source is ready to be scanned, 0 if the file could not be loaded.
+*/
+int source_open(Source* source, const char* path) {
+#ifndef _WIN32
+    if (source_map(source, path))
+        return 1;
+#endif
+    return source_read(source, path);
+}
+
+/**
+ * Releases the memory held by a source.
+ *
+ * @param source The source to close.
+*/
+void source_close(Source* source) {
+    if (source->data != NULL) {
+#ifndef _WIN32
+        if (source->mapped)
+            munmap((void*) source->data, source->length);
+        else
+#endif
+            free((void*) source->data);
+    }
+    source_set(source, NULL, 0, 0);
+}
@@ -0,0 +1,58 @@
+/**
+ * @file
+ * @brief Source reader header file.
+*/
+
+#ifndef SOURCE_H_
+#define SOURCE_H_
+
+#include <stdio.h>
+#include <stddef.h>
+
+#define SOURCE_TAB_WIDTH 8 /** Columns between two tab stops. */
+
+/**
+ * Defined type based on a struct holding a whole source file in memory and a read cursor on it.
+*/
+typedef struct {
+    const char* data;   /** First character of the source text. */
+    const char* cursor; /** Next character to be read. */
+    const char* end;    /** One past the last character of the source text. */
+    size_t length;      /** Size of the source text in bytes. */
+    int mapped;         /** 1 if data is a memory mapping of the file, 0 if it is a heap buffer. */
+} Source;
+
+int source_open(Source* source, const char* path);
+void source_close(Source* source);
+
+/**
+ * Returns the next character of the source without consuming it.
+ *
+ * @param source The source to read from.
+ * @return The next character as an unsigned char, or EOF at the end of the source.
+*/
+static inline int source_peek(const Source* source) {
+    return source->cursor < source->end ? (unsigned char) *source->cursor : EOF;
+}
+
+/**
+ * Gives the column a tab moves to, the next tab stop.
+ *
+ * @param column The column of the tab, starting at 1.
+ * @return The column of the character after the tab.
+*/
+static inline int source_tab_stop(int column) {
+    return (column - 1) / SOURCE_TAB_WIDTH * SOURCE_TAB_WIDTH + SOURCE_TAB_WIDTH + 1;
+}
+
+/**
+ * Consumes and returns the next character of the source.
+ *
+ * @param source The source to read from.
+ * @return The consumed character as an unsigned char, or EOF at the end of the source.
+*/
+static inline int source_get(Source* source) {
+    return source->cursor < source->end ? (unsigned char) *source->cursor++ : EOF;
+}
+
+#endif
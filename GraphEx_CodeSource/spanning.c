@@ -0,0 +1,342 @@
+/**
+ * @file
+ * @brief Minimum spanning forest source file.
+ *
+ * Kruskal sorts the edges by weight with a radix sort run by a thread pool, then joins the trees of a
+ * disjoint-set forest until every node but one per component is joined. Prim grows each tree from
+ * its first node with the indexed heap of Dijkstra, following the edges in both directions.
+ *
+ * Unlike the searches of paths.c, both work on a flat copy of the graph rather than through its view.
+ * Kruskal keeps a source and a sort key per edge anyway, so the copy only adds to the constant of its
+ * O(edges) memory, and the forest names its edges by their position in the copy. A graph instancing
+ * a template many times is expanded in full, which is the price of sorting all of its edges.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "spanning.h"
+
+/**
+ * Allocates an array.
+ *
+ * @param count The number of elements.
+ * @param size The size of an element.
+ * @return The array, NULL if memory is exhausted.
+*/
+static void* spanning_alloc(size_t count, size_t size) {
+    return malloc(count * size + 1);
+}
+
+/**
+ * Initializes a forest without any graph.
+ *
+ * @param spanning The forest.
+ * @param pool The workers of the radix sort, which may be started later.
+*/
+void spanning_init(Spanning* spanning, ThreadPool* pool) {
+    memset(spanning, 0, sizeof(Spanning));
+    spanning->pool = pool;
+    flat_init(&spanning->flat);
+    heap_init(&spanning->heap);
+}
+
+/**
+ * Releases a forest.
+ *
+ * @param spanning The forest.
+*/
+void spanning_free(Spanning* spanning) {
+    free(spanning->parents);
+    free(spanning->ranks);
+    free(spanning->keys);
+    free(spanning->reaching);
+    free(spanning->in_tree);
+    free(spanning->edges);
+    free(spanning->sources);
+    free(spanning->candidates);
+    free(spanning->scratch);
+    free(spanning->counts);
+    heap_free(&spanning->heap);
+    flat_free(&spanning->flat);
+    memset(spanning, 0, sizeof(Spanning));
+}
+
+/**
+ * Releases a forest when memory is exhausted, keeping its workers for the next one.
+ *
+ * @param spanning The forest.
+ * @return 0.
+*/
+static int spanning_out_of_memory(Spanning* spanning) {
+    ThreadPool* pool = spanning->pool;
+    spanning_free(spanning);
+    spanning->pool = pool;
+    return 0;
+}
+
+/**
+ * Flattens a graph and makes room for its nodes and edges.
+ *
+ * @param spanning The forest.
+ * @param view The graph.
+ * @return 0 if memory is exhausted, the forest being released, 1 if not.
+*/
+static int spanning_begin(Spanning* spanning, const GraphView* view) {
+    FlatGraph* flat = &spanning->flat;
+    if (!flat_build(flat, view))
+        return spanning_out_of_memory(spanning);
+    uint32_t n = flat->node_count;
+    uint64_t m = flat->edge_count;
+    if (n > spanning->capacity || spanning->parents == NULL) {
+        free(spanning->parents);
+        free(spanning->ranks);
+        free(spanning->keys);
+        free(spanning->reaching);
+        free(spanning->in_tree);
+        free(spanning->edges);
+        spanning->parents = spanning_alloc(n, sizeof(uint32_t));
+        spanning->ranks = spanning_alloc(n, sizeof(uint8_t));
+        spanning->keys = spanning_alloc(n, sizeof(int64_t));
+        spanning->reaching = spanning_alloc(n, sizeof(uint64_t));
+        spanning->in_tree = spanning_alloc(n, sizeof(uint8_t));
+        spanning->edges = spanning_alloc(n, sizeof(uint64_t));
+        spanning->capacity = n;
+    }
+    if (m > spanning->edge_capacity || spanning->sources == NULL) {
+        free(spanning->sources);
+        free(spanning->candidates);
+        free(spanning->scratch);
+        spanning->sources = spanning_alloc(m, sizeof(uint32_t));
+        spanning->candidates = spanning_alloc(m, sizeof(uint64_t));
+        spanning->scratch = spanning_alloc(m, sizeof(uint64_t));
+        spanning->edge_capacity = m;
+    }
+    if (spanning->parents == NULL || spanning->ranks == NULL || spanning->keys == NULL || spanning->reaching == NULL
+        || spanning->in_tree == NULL || spanning->edges == NULL || spanning->sources == NULL
+        || spanning->candidates == NULL || spanning->scratch == NULL)
+        return spanning_out_of_memory(spanning);
+    spanning->edge_count = 0;
+    spanning->cost = 0;
+    spanning->passes = 0;
+    spanning->examined = 0;
+    return 1;
+}
+
+/**
+ * Gives the range of the candidates that a worker handles.
+ *
+ * @param spanning The forest.
+ * @param worker The index of the worker.
+ * @param begin Receives the first index of the range.
+ * @param end Receives the index after the range.
+*/
+static void worker_range(const Spanning* spanning, uint32_t worker, uint64_t* begin, uint64_t* end) {
+    uint32_t workers = spanning->pool->count;
+    *begin = spanning->candidate_count / workers * worker + (worker == 0 ? 0 : spanning->candidate_count % workers);
+    *end = *begin + spanning->candidate_count / workers + (worker == 0 ? spanning->candidate_count % workers : 0);
+}
+
+/**
+ * Gives the digit of an edge sorted by the current radix pass.
+ *
+ * @param spanning The forest.
+ * @param edge The position of the edge.
+ * @return The digit.
+*/
+static inline uint32_t edge_digit(const Spanning* spanning, uint64_t edge) {
+    uint64_t key = (uint64_t) (spanning->flat.weights[edge] - spanning->min_weight);
+    return (uint32_t) (key >> spanning->shift) & (SPANNING_RADIX_BUCKETS - 1);
+}
+
+/**
+ * Radix pass task counting the digits of the candidates of the worker.
+*/
+static void task_count(void* data, uint32_t worker) {
+    Spanning* spanning = data;
+    uint64_t* counts = &spanning->counts[(size_t) worker * SPANNING_RADIX_BUCKETS];
+    uint64_t begin, end;
+    worker_range(spanning, worker, &begin, &end);
+    memset(counts, 0, SPANNING_RADIX_BUCKETS * sizeof(uint64_t));
+    for (uint64_t i = begin; i < end; i++)
+        counts[edge_digit(spanning, spanning->candidates[i])]++;
+}
+
+/**
+ * Radix pass task moving the candidates of the worker to the first free slot of their bucket.
+ * Each worker owns a range of every bucket, after the ranges of the workers before it, which
+ * keeps the sort stable.
+*/
+static void task_scatter(void* data, uint32_t worker) {
+    Spanning* spanning = data;
+    uint64_t* next = &spanning->counts[(size_t) worker * SPANNING_RADIX_BUCKETS];
+    uint64_t begin, end;
+    worker_range(spanning, worker, &begin, &end);
+    for (uint64_t i = begin; i < end; i++) {
+        uint64_t edge = spanning->candidates[i];
+        spanning->scratch[next[edge_digit(spanning, edge)]++] = edge;
+    }
+}
+
+/**
+ * Sorts the candidates by weight, edges of the same weight keeping their order. Only the bits
+ * of the weights that differ from the smallest weight are sorted.
+ *
+ * @param spanning The forest.
+ * @param view The graph, giving the range of the weights.
+ * @return 0 if memory is exhausted, the forest being released, 1 if not.
+*/
+static int sort_candidates(Spanning* spanning, const GraphView* view) {
+    uint32_t workers = spanning->pool->count;
+    if (spanning->counts == NULL)
+        spanning->counts = spanning_alloc((size_t) workers * SPANNING_RADIX_BUCKETS, sizeof(uint64_t));
+    if (spanning->counts == NULL)
+        return spanning_out_of_memory(spanning);
+    uint64_t range = (uint64_t) ((int64_t) view->max_weight - view->min_weight);
+    spanning->min_weight = view->min_weight;
+    for (spanning->shift = 0; spanning->shift < 32 && (range >> spanning->shift) != 0; spanning->shift += SPANNING_RADIX_BITS) {
+        pool_run(spanning->pool, task_count, spanning);
+        uint64_t total = 0;
+        for (uint32_t digit = 0; digit < SPANNING_RADIX_BUCKETS; digit++) {
+            for (uint32_t w = 0; w < workers; w++) {
+                uint64_t* count = &spanning->counts[(size_t) w * SPANNING_RADIX_BUCKETS + digit];
+                uint64_t size = *count;
+                *count = total;
+                total += size;
+            }
+        }
+        pool_run(spanning->pool, task_scatter, spanning);
+        uint64_t* sorted = spanning->scratch;
+        spanning->scratch = spanning->candidates;
+        spanning->candidates = sorted;
+        spanning->passes++;
+    }
+    return 1;
+}
+
+/**
+ * Finds the root of the tree of a node, halving the path on the way.
+ *
+ * @param parents The disjoint-set forest.
+ * @param node The node id.
+ * @return The root.
+*/
+static inline uint32_t find_root(uint32_t* parents, uint32_t node) {
+    while (parents[node] != node) {
+        parents[node] = parents[parents[node]];
+        node = parents[node];
+    }
+    return node;
+}
+
+/**
+ * Builds a minimum spanning forest with Kruskal: the edges are taken by increasing weight, an edge being
+ * kept when it joins two trees. The search ends once a forest of a connected graph would be complete.
+ *
+ * @param spanning The forest.
+ * @param view The graph.
+ * @return 0 if memory is exhausted, the forest being released, 1 if not.
+*/
+int spanning_kruskal(Spanning* spanning, const GraphView* view) {
+    if (!spanning_begin(spanning, view))
+        return 0;
+    const FlatGraph* flat = &spanning->flat;
+    uint32_t n = flat->node_count;
+    uint64_t count = 0;
+    for (uint32_t u = 0; u < n; u++) {
+        spanning->parents[u] = u;
+        spanning->ranks[u] = 0;
+        for (uint64_t e = flat->first[u]; e < flat->first[u + 1]; e++) {
+            spanning->sources[e] = u;
+            if (flat->targets[e] != u) // A loop never joins two trees
+                spanning->candidates[count++] = e;
+        }
+    }
+    spanning->candidate_count = count;
+    if (!sort_candidates(spanning, view))
+        return 0;
+
+    for (uint64_t i = 0; i < count && spanning->edge_count + 1 < n; i++) {
+        uint64_t e = spanning->candidates[i];
+        uint32_t a = find_root(spanning->parents, spanning->sources[e]);
+        uint32_t b = find_root(spanning->parents, flat->targets[e]);
+        spanning->examined++;
+        if (a == b)
+            continue;
+        if (spanning->ranks[a] < spanning->ranks[b]) { // The lower tree goes under the higher one
+            uint32_t swap = a;
+            a = b;
+            b = swap;
+        }
+        spanning->parents[b] = a;
+        if (spanning->ranks[a] == spanning->ranks[b])
+            spanning->ranks[a]++;
+        spanning->edges[spanning->edge_count++] = e;
+        spanning->cost += flat->weights[e];
+    }
+    return 1;
+}
+
+/**
+ * Offers Prim a lighter edge towards a node that is not in the forest yet.
+ *
+ * @param spanning The forest.
+ * @param node The node id.
+ * @param edge The position of the edge.
+ * @param weight The weight of the edge.
+*/
+static inline void offer_edge(Spanning* spanning, uint32_t node, uint64_t edge, int64_t weight) {
+    spanning->examined++;
+    if (spanning->in_tree[node] || weight >= spanning->keys[node])
+        return;
+    spanning->keys[node] = weight;
+    spanning->reaching[node] = edge;
+    heap_update(&spanning->heap, node, weight);
+}
+
+/**
+ * Builds a minimum spanning forest with Prim: each tree grows from its first node, always by the
+ * lightest edge between the tree and a node outside of it.
+ *
+ * @param spanning The forest.
+ * @param view The graph.
+ * @return 0 if memory is exhausted, the forest being released, 1 if not.
+*/
+int spanning_prim(Spanning* spanning, const GraphView* view) {
+    FlatGraph* flat = &spanning->flat;
+    if (!spanning_begin(spanning, view))
+        return 0;
+    if (!flat_incoming(flat))
+        return spanning_out_of_memory(spanning);
+    uint32_t n = flat->node_count;
+    for (uint32_t v = 0; v < n; v++) {
+        spanning->keys[v] = INT64_MAX;
+        spanning->reaching[v] = SPANNING_NO_EDGE;
+        spanning->in_tree[v] = 0;
+    }
+    heap_clear(&spanning->heap);
+    if (!heap_reserve(&spanning->heap, n))
+        return spanning_out_of_memory(spanning);
+
+    for (uint32_t root = 0; root < n; root++) {
+        if (spanning->in_tree[root])
+            continue;
+        heap_update(&spanning->heap, root, 0);
+        HeapEntry entry;
+        while (heap_pop(&spanning->heap, &entry)) {
+            uint32_t u = entry.node;
+            spanning->in_tree[u] = 1;
+            if (spanning->reaching[u] != SPANNING_NO_EDGE) {
+                spanning->edges[spanning->edge_count++] = spanning->reaching[u];
+                spanning->cost += spanning->keys[u];
+            }
+            for (uint64_t e = flat->first[u]; e < flat->first[u + 1]; e++)
+                offer_edge(spanning, flat->targets[e], e, flat->weights[e]);
+            for (uint64_t i = flat->in_first[u]; i < flat->in_first[u + 1]; i++) {
+                uint32_t source = flat->sources[i];
+                uint64_t e = flat->first[source] + flat->positions[i];
+                offer_edge(spanning, source, e, flat->weights[e]);
+            }
+        }
+    }
+    return 1;
+}
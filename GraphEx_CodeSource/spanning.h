@@ -0,0 +1,54 @@
+/**
+ * @file
+ * @brief Minimum spanning forest header file.
+*/
+
+#ifndef SPANNING_H_
+#define SPANNING_H_
+
+#include <stdint.h>
+#include "heap.h"
+#include "pool.h"
+#include "flat.h"
+
+#define SPANNING_RADIX_BITS 8 /** Bits of the weights sorted by each pass of the radix sort of Kruskal. */
+#define SPANNING_RADIX_BUCKETS (1 << SPANNING_RADIX_BITS) /** Buckets of each pass of the radix sort. */
+#define SPANNING_NO_EDGE UINT64_MAX /** Edge of a node that is not reached by Prim yet, or that is a root. */
+
+/**
+ * Defined type based on a struct holding a minimum spanning forest of a graph and the state of the
+ * algorithms building it. The direction of the edges is ignored: each connected component gets a tree.
+ * The forest is a list of positions among the flattened outgoing edges, which name the edges of the
+ * graph without copying them.
+*/
+typedef struct {
+    ThreadPool* pool;        /** Workers of the radix sort. */
+    FlatGraph flat;          /** Outgoing and incoming edges of the graph. */
+    uint32_t capacity;       /** Number of nodes the node arrays can hold. */
+    uint32_t* parents;       /** Disjoint-set forest of Kruskal: parent of each node, the node itself for a root. */
+    uint8_t* ranks;          /** Upper bound of the height of the tree of each root. */
+    int64_t* keys;           /** Weight of the lightest edge reaching each node from the tree of Prim. */
+    uint64_t* reaching;      /** That edge, SPANNING_NO_EDGE if there is none. */
+    uint8_t* in_tree;        /** 1 for each node Prim added to the forest. */
+    IndexedHeap heap;        /** Queue of Prim, the indexed heap of Dijkstra. */
+    uint64_t edge_capacity;  /** Number of edges the edge arrays can hold. */
+    uint32_t* sources;       /** Source of each outgoing edge. */
+    uint64_t* candidates;    /** Edges Kruskal considers, sorted by weight. */
+    uint64_t* scratch;       /** Other buffer of the radix sort. */
+    uint64_t candidate_count;/** Number of candidates. */
+    uint64_t* counts;        /** Bucket sizes of each worker during a radix pass, then their first slot. */
+    uint32_t shift;          /** Bit of the weights sorted by the current radix pass. */
+    int32_t min_weight;      /** Smallest weight, subtracted to sort unsigned keys. */
+    uint64_t* edges;         /** Edges of the last forest, in the order they were added. */
+    uint32_t edge_count;     /** Number of edges of the forest. */
+    int64_t cost;            /** Sum of their weights. */
+    uint32_t passes;         /** Radix passes of the last Kruskal. */
+    uint64_t examined;       /** Edges examined by the last algorithm. */
+} Spanning;
+
+void spanning_init(Spanning* spanning, ThreadPool* pool);
+void spanning_free(Spanning* spanning);
+int spanning_kruskal(Spanning* spanning, const GraphView* view);
+int spanning_prim(Spanning* spanning, const GraphView* view);
+
+#endif
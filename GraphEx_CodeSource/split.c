@@ -0,0 +1,67 @@
+/**
+ * @file
+ * @brief Source splitting source file.
+ *
+ * Cuts a source between its top-level blocks with a single pass that only balances braces: GraphEx
+ * has neither strings nor comments, so every brace of the text opens or closes a block. Each part
+ * can then be scanned and parsed on its own, starting at the line and column the scanner would have.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "split.h"
+
+/**
+ * Splits a source into parts of about the same size, each made of whole top-level blocks.
+ *
+ * @param source The source.
+ * @param count The number of parts wanted.
+ * @param parts Receives the parts, to release with free(), NULL if the source isn't split.
+ * @return The number of parts, 0 if the source has less than two blocks or unbalanced braces.
+*/
+uint32_t split_source(const Source* source, uint32_t count, SourcePart** parts) {
+    *parts = NULL;
+    const char* text = source->data;
+    size_t length = source->length;
+    if (count < 2 || length > UINT32_MAX)
+        return 0;
+    size_t target = length / count;
+    SourcePart* split = malloc(((size_t) count + 1) * sizeof(SourcePart));
+    if (split == NULL)
+        return 0;
+
+    uint32_t n = 0, line = 1, column = 1;
+    long depth = 0;
+    split[0].start = 0;
+    split[0].line = 1;
+    split[0].column = 1;
+    for (size_t i = 0; i < length; i++) {
+        char car = text[i];
+        if (car == '\n') {
+            line++;
+            column = 1;
+            continue;
+        }
+        column = car == '\t' ? (uint32_t) source_tab_stop((int) column) : column + 1; // Same columns as readChar()
+        if (car == '{')
+            depth++;
+        else if (car == '}') {
+            if (--depth < 0)
+                break;
+            if (depth == 0 && i + 1 - split[n].start >= target && n + 1 < count) { // A block ends here
+                split[n].end = (uint32_t) (i + 1);
+                n++;
+                split[n].start = (uint32_t) (i + 1);
+                split[n].line = line;
+                split[n].column = column;
+            }
+        }
+    }
+    split[n].end = (uint32_t) length;
+    if (depth != 0 || n == 0) {
+        free(split);
+        return 0;
+    }
+    *parts = split;
+    return n + 1;
+}
@@ -0,0 +1,28 @@
+/**
+ * @file
+ * @brief Source splitting header file.
+*/
+
+#ifndef SPLIT_H_
+#define SPLIT_H_
+
+#include <stdint.h>
+#include "source.h"
+
+#define SPLIT_MIN_LENGTH (1 << 18) /** Sources shorter than this are compiled in one pass. */
+#define SPLIT_PARTS_PER_WORKER 4 /** Parts given to each worker, so that blocks of uneven sizes balance out. */
+
+/**
+ * Defined type based on a struct holding a part of a source made of whole top-level blocks,
+ * with the position its first character has in the source.
+*/
+typedef struct {
+    uint32_t start;  /** Offset of the first character of the part in the source. */
+    uint32_t end;    /** Offset one past the last character of the part. */
+    uint32_t line;   /** Line of the first character of the part. */
+    uint32_t column; /** Column of the first character of the part. */
+} SourcePart;
+
+uint32_t split_source(const Source* source, uint32_t count, SourcePart** parts);
+
+#endif
@@ -0,0 +1,17 @@
+# A batch succeeds only if every file compiles, and prints the diagnostics of each file in input order
+# whatever worker compiled it; a list file naming a missing file fails the batch.
+mkdir -p "$WORK/batch"
+run "$GX" --threads 2 "$TESTS/flow.gx" "$TESTS/paths.gx" > "$WORK/batch/ok.out"
+expect "batch: all compiled" grep -q "^exit 0$" "$WORK/batch/ok.out"
+(cd "$TESTS" && run "$GX" --threads 2 flow.gx syntax_error.gx paths.gx syntax_error.gx) > "$WORK/batch/failing.out"
+{
+    printf 'syntax_error.gx:\n'
+    sed -n 1p "$TESTS/syntax_error.out"
+    printf 'syntax_error.gx:\n'
+    sed -n 1p "$TESTS/syntax_error.out"
+    printf '4 files compiled, 2 failed\nexit 1\n'
+} > "$WORK/batch/failing.expected"
+check "batch: one failing" "$WORK/batch/failing.expected" "$WORK/batch/failing.out"
+printf '%s\n\n%s\n' "$TESTS/flow.gx" "$WORK/batch/missing.gx" > "$WORK/batch/list.txt"
+run "$GX" "@$WORK/batch/list.txt" > "$WORK/batch/list.out"
+expect "batch: missing file" grep -q "^exit 1$" "$WORK/batch/list.out"
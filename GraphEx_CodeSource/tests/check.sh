@@ -0,0 +1,16 @@
+# --check streams a source of many blocks one block at a time, counting them, and reports a syntax error
+# in one of its last blocks as a compile does.
+mkdir -p "$WORK/check"
+awk 'BEGIN {
+    for (g = 0; g < 5000; g++)
+        printf "g%d { %%type { undirected } %%declare\na -> b, %d; b -> c, 1;\n}\n", g, g + 1;
+    print "main { %type { directed } %declare\na -> b, 1;\n%operations\ndijkstra(a);\n}";
+}' > "$WORK/check/blocks.gx"
+run "$GX" --check --stats "$WORK/check/blocks.gx" > "$WORK/check/blocks.out"
+printf '[stats] check: 5001 blocks\nexit 0\n' > "$WORK/check/blocks.expected"
+check "check: blocks counted" "$WORK/check/blocks.expected" "$WORK/check/blocks.out"
+sed '14000s/ -> / -> -> /' "$WORK/check/blocks.gx" > "$WORK/check/error.gx"
+run "$GX" --check "$WORK/check/error.gx" > "$WORK/check/error.out"
+run "$GX" --threads 1 "$WORK/check/error.gx" > "$WORK/check/error.expected"
+expect "check: late error found" grep -q "^Syntax Error: .* at line 14000," "$WORK/check/error.out"
+check "check: late error" "$WORK/check/error.expected" "$WORK/check/error.out"
@@ -0,0 +1,22 @@
+# Components above the limit of the exact search: a chain of 3000 triangles gets its chromatic number
+# from a clique, while an odd cycle of 5001 nodes only gets bounds.
+mkdir -p "$WORK/coloring"
+awk 'BEGIN {
+    print "main { %type { undirected } %declare";
+    for (i = 0; i < 3000; i++)
+        printf "t%d -> u%d; u%d -> t%d; t%d -> t%d;\n", i, i, i, i + 1, i, i + 1;
+    print "%operations\nnombrechromatique();\n}";
+}' > "$WORK/coloring/triangles.gx"
+"$GX" "$WORK/coloring/triangles.gx" > "$WORK/coloring/triangles.txt"
+echo "nombrechromatique(): 3" > "$WORK/coloring/triangles.expected"
+check "chromatic number of a large component" "$WORK/coloring/triangles.expected" "$WORK/coloring/triangles.txt"
+
+awk 'BEGIN {
+    print "main { %type { undirected } %declare";
+    for (i = 0; i < 5000; i++)
+        printf "c%d -> c%d;\n", i, i + 1;
+    print "c5000 -> c0;\n%operations\nnombrechromatique();\n}";
+}' > "$WORK/coloring/cycle.gx"
+"$GX" "$WORK/coloring/cycle.gx" > "$WORK/coloring/cycle.txt"
+echo "nombrechromatique(): at most 3, at least 2 (component too large to search)" > "$WORK/coloring/cycle.expected"
+check "bounds of a large component" "$WORK/coloring/cycle.expected" "$WORK/coloring/cycle.txt"
@@ -0,0 +1,25 @@
+# The speculative coloring on 4 threads, whose colors depend on the timing of the workers, must still
+# give different colors to the ends of every edge of a random graph.
+mkdir -p "$WORK/speculative"
+awk 'BEGIN {
+    srand(19);
+    print "main { %type { undirected } %declare";
+    for (i = 0; i < 60000; i++)
+        printf "n%d -> n%d;\n", int(rand() * 20000), int(rand() * 20000);
+    print "%operations\ncolorergraph(1);\n}";
+}' > "$WORK/speculative/random.gx"
+"$GX" --threads 4 "$WORK/speculative/random.gx" > "$WORK/speculative/random.txt"
+proper() {
+    awk 'FNR == NR {
+        if ($0 ~ /^    /)
+            color[$1] = $2 $3;
+        next;
+    }
+    / -> / {
+        sub(/;$/, "", $3);
+        if ($1 != $3 && color[$1] == color[$3])
+            bad++;
+    }
+    END { exit bad > 0 || length(color) == 0 }' "$WORK/speculative/random.txt" "$WORK/speculative/random.gx"
+}
+expect "speculative coloring on 4 threads is proper" proper
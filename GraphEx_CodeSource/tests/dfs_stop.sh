@@ -0,0 +1,11 @@
+# traverse(dfs) walks a chain far deeper than the C stack allows for a recursive search, and a stop() in an if
+# of its lambda ends it on the edge that meets the condition.
+awk 'BEGIN {
+    printf "main { %%type { directed } %%declare\n"
+    for (i = 0; i < 300000; i++)
+        printf "n%d -> n%d, %d;\n", i, i + 1, i == 250000 ? 9 : 1
+    printf "%%operations\ntraverse(dfs, (u, v, w) => { if (mincost(u, v) > 5) { mincost(u, v); stop(); } });\n}\n"
+}' > "$WORK/chain.gx"
+run "$GX" --threads 1 "$WORK/chain.gx" > "$WORK/chain.out"
+printf 'mincost(u, v): 9\nexit 0\n' > "$WORK/chain.expected"
+check "dfs: deep chain stopped" "$WORK/chain.expected" "$WORK/chain.out"
@@ -0,0 +1,16 @@
+# The C program that --emit-c writes for each tests/<name>.gx prints what the executor prints and exits the
+# same way, when a C compiler is there; a program that can't be compiled gets the same errors.
+if command -v "$CC" > /dev/null 2>&1; then
+    mkdir -p "$WORK/emit_c/library"
+    LIBRARY=$(sed -n 's/^#define CODEGEN_LIBRARY "\([^"]*\)".*/\1/p' "$TESTS/../codegen.h")
+    (cd "$WORK/emit_c/library" && for library in $LIBRARY; do $CC -c -O2 -pthread -I"$TESTS/.." "$TESTS/../$library" || exit 1; done)
+    for source in "$TESTS"/*.gx; do
+        name=$(basename "$source" .gx)
+        run "$GX" "$source" --emit-c "$WORK/emit_c/$name.c" > "$WORK/emit_c/$name.out"
+        if [ -f "$WORK/emit_c/$name.c" ]; then
+            $CC -O2 -pthread -I"$TESTS/.." "$WORK/emit_c/$name.c" "$WORK"/emit_c/library/*.o -o "$WORK/emit_c/$name"
+            run "$WORK/emit_c/$name" > "$WORK/emit_c/$name.out"
+        fi
+        check "emit-c: $name" "$TESTS/$name.out" "$WORK/emit_c/$name.out"
+    done
+fi
@@ -0,0 +1,14 @@
+# The first --ch run builds and saves the contraction hierarchy next to the source, the second one loads it,
+# both finding the paths a run without it finds; a graph with negative weights gets none.
+cp "$TESTS/paths.gx" "$WORK/ch.gx"
+run "$GX" --stats --ch "$WORK/ch.gx" > "$WORK/ch1.out"
+run "$GX" --stats --ch "$WORK/ch.gx" > "$WORK/ch2.out"
+expect "ch: hierarchy saved" grep -q "contraction hierarchy built and saved" "$WORK/ch1.out"
+expect "ch: hierarchy reused" grep -q "contraction hierarchy loaded from" "$WORK/ch2.out"
+grep -v "^\[stats\]" "$WORK/ch1.out" > "$WORK/ch1.txt"
+grep -v "^\[stats\]" "$WORK/ch2.out" > "$WORK/ch2.txt"
+check "ch: first run" "$TESTS/paths.out" "$WORK/ch1.txt"
+check "ch: second run" "$TESTS/paths.out" "$WORK/ch2.txt"
+printf 'main { %%type { directed } %%declare\na -> b, 2; b -> c, -1;\n%%operations\ngetchemin(a, c);\n}\n' > "$WORK/ch_negative.gx"
+run "$GX" --stats --ch "$WORK/ch_negative.gx" > "$WORK/ch_negative.out"
+expect "ch: none with negative weights" grep -q "no contraction hierarchy: the graph has negative weights" "$WORK/ch_negative.out"
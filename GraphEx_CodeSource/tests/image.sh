@@ -0,0 +1,18 @@
+# A compiled graph image runs the operations of its source, whether every array is verified or only its
+# tables; a truncated image is rejected, and a damaged byte is found by --verify-image.
+mkdir -p "$WORK/image"
+for name in flow paths; do
+    run "$GX" --compile-graph "$TESTS/$name.gx" -o "$WORK/image/$name.gxb" > "$WORK/image/$name.compile.out"
+    expect "image: $name compiled" grep -q "^exit 0$" "$WORK/image/$name.compile.out"
+    run "$GX" --threads 1 "$WORK/image/$name.gxb" > "$WORK/image/$name.out"
+    check "image: $name round-trip" "$TESTS/$name.out" "$WORK/image/$name.out"
+    run "$GX" --threads 1 --verify-image "$WORK/image/$name.gxb" > "$WORK/image/$name.verified.out"
+    check "image: $name verified round-trip" "$TESTS/$name.out" "$WORK/image/$name.verified.out"
+done
+head -c 100 "$WORK/image/paths.gxb" > "$WORK/image/truncated.gxb"
+run "$GX" "$WORK/image/truncated.gxb" > "$WORK/image/truncated.out"
+expect "image: truncated image rejected" grep -q "^exit 1$" "$WORK/image/truncated.out"
+cp "$WORK/image/paths.gxb" "$WORK/image/damaged.gxb"
+printf '\377' | dd of="$WORK/image/damaged.gxb" bs=1 seek=200 conv=notrunc 2> /dev/null
+run "$GX" --verify-image "$WORK/image/damaged.gxb" > "$WORK/image/damaged.out"
+expect "image: damaged image rejected" grep -q "is corrupted" "$WORK/image/damaged.out"
@@ -0,0 +1,59 @@
+#!/bin/sh
+# Runs the tests of the compiler: make check, or sh tests/run.sh <gx> from the source directory.
+#
+# Each tests/<name>.gx is run with one thread and what it prints, followed by its exit status, is compared
+# with tests/<name>.out. Each other tests/<name>.sh is then sourced, checking a feature whose results
+# can't be written once, with the helpers and variables below.
+
+GX=${1:-./gx}
+GX=$(cd "$(dirname "$GX")" && pwd)/$(basename "$GX")
+CC=${CC:-gcc}
+TESTS=$(cd "$(dirname "$0")" && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+passed=0
+failed=0
+
+# Prints what a command prints followed by its exit status.
+run() {
+    "$@"
+    echo "exit $?"
+}
+
+# Compares an output with the expected one, arguments: name, expected file, output file.
+check() {
+    if cmp -s "$2" "$3"; then
+        passed=$((passed + 1))
+    else
+        failed=$((failed + 1))
+        echo "FAIL: $1"
+        diff "$2" "$3" | head -20
+    fi
+}
+
+# Checks a condition, arguments: name, then the command testing it.
+expect() {
+    condition=$1
+    shift
+    if "$@"; then
+        passed=$((passed + 1))
+    else
+        failed=$((failed + 1))
+        echo "FAIL: $condition"
+    fi
+}
+
+for source in "$TESTS"/*.gx; do
+    name=$(basename "$source" .gx)
+    run "$GX" --threads 1 "$source" > "$WORK/$name.out"
+    check "$name" "$TESTS/$name.out" "$WORK/$name.out"
+done
+
+for scenario in "$TESTS"/*.sh; do
+    if [ "$(basename "$scenario")" != run.sh ]; then
+        . "$scenario"
+    fi
+done
+
+echo "$passed passed, $failed failed"
+[ "$failed" -eq 0 ]
@@ -0,0 +1,15 @@
+# On a larger graph, Kruskal sorts its edges on several workers into the forest one worker finds,
+# whose cost Prim finds too.
+awk 'BEGIN {
+    srand(17)
+    printf "main { %%type { undirected } %%declare\n"
+    for (i = 0; i < 40000; i++)
+        printf "n%d -> n%d, %d;\n", int(rand() * 5000), int(rand() * 5000), int(rand() * 2000) - 100
+    printf "%%operations\nkruskal();\nprime();\n}\n"
+}' > "$WORK/forest.gx"
+run "$GX" --threads 1 "$WORK/forest.gx" > "$WORK/forest1.out"
+run "$GX" --threads 4 "$WORK/forest.gx" > "$WORK/forest4.out"
+check "spanning: same forest on 4 workers" "$WORK/forest1.out" "$WORK/forest4.out"
+grep "^kruskal()" "$WORK/forest1.out" | sed 's/^kruskal()//' > "$WORK/forest_kruskal.txt"
+grep "^prime()" "$WORK/forest1.out" | sed 's/^prime()//' > "$WORK/forest_prim.txt"
+check "spanning: same cost for kruskal and prime" "$WORK/forest_kruskal.txt" "$WORK/forest_prim.txt"
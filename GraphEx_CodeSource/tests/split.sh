@@ -0,0 +1,25 @@
+# A source large enough to be split between its blocks is compiled in parts on 4 threads, giving the results
+# of a single pass, and a syntax error in one of its last blocks gives the error a single pass reports.
+mkdir -p "$WORK/split"
+awk 'BEGIN {
+    srand(23);
+    for (g = 0; g < 100; g++) {
+        printf "g%d { %%type { directed } %%declare\n", g;
+        for (i = 0; i < 200; i++)
+            printf "n%d -> n%d, %d;\n", i, int(rand() * 200), 1 + int(rand() * 50);
+        print "}";
+    }
+    print "main { %type { directed } %declare";
+    for (i = 0; i < 2000; i++)
+        printf "n%d -> n%d, %d; n%d -> n%d, %d;\n", i, i + 1, 50, i, int(rand() * 2000), 1 + int(rand() * 50);
+    print "%operations\ngetchemin(n0, n1999);\ndijkstra(n7);\n}";
+}' > "$WORK/split/large.gx"
+run "$GX" --threads 1 "$WORK/split/large.gx" > "$WORK/split/single.out"
+run "$GX" --threads 4 --stats "$WORK/split/large.gx" > "$WORK/split/parts.out"
+expect "split: compiled in parts" grep -q "^\[stats\] compile: [0-9]* parts," "$WORK/split/parts.out"
+grep -v "^\[stats\]" "$WORK/split/parts.out" > "$WORK/split/parts.results"
+check "split: same results" "$WORK/split/single.out" "$WORK/split/parts.results"
+sed '16200s/ -> / -> -> /' "$WORK/split/large.gx" > "$WORK/split/error.gx"
+run "$GX" --threads 1 "$WORK/split/error.gx" > "$WORK/split/error_single.out"
+run "$GX" --threads 4 "$WORK/split/error.gx" > "$WORK/split/error_parts.out"
+check "split: same syntax error" "$WORK/split/error_single.out" "$WORK/split/error_parts.out"
@@ -0,0 +1,414 @@
+/**
+ * @file
+ * @brief Graph view source file.
+ *
+ * A graph block instantiated by %subgraph is never copied: every instance points to the one view
+ * of its template and only owns a range of node ids. The enclosing view adds the edges between its
+ * own nodes and its instances in a small sorted overlay, and walking the edges of a node descends
+ * through the instances holding it, shifting the ids of the shared arrays on the way.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "view.h"
+
+/**
+ * Initializes the view of a graph block without instances.
+ *
+ * @param view The view, which can be released even if memory is exhausted.
+ * @param graph The graph declared by the block.
+ * @return 1 if the view was initialized, 0 if memory is exhausted.
+*/
+int view_init(GraphView* view, const Graph* graph) {
+    memset(view, 0, sizeof(GraphView));
+    view->graph = graph;
+    view->node_count = graph->node_count;
+    view->edge_count = graph->edge_count;
+    view->min_weight = graph->min_weight;
+    view->max_weight = graph->max_weight;
+    view->capacitated = graph->capacities != NULL;
+    return name_map_init(&view->instance_names);
+}
+
+/**
+ * Releases what a view owns, the shared graphs and template views excepted.
+ *
+ * @param view The view.
+*/
+void view_free(GraphView* view) {
+    free(view->instances);
+    free(view->overlay);
+    free(view->reverse_overlay);
+    free(view->colors);
+    name_map_free(&view->instance_names);
+    memset(view, 0, sizeof(GraphView));
+}
+
+/**
+ * Widens the weight range of a view with the weights of new edges.
+ *
+ * @param view The view.
+ * @param min_weight The smallest weight of the new edges.
+ * @param max_weight The largest weight of the new edges.
+ * @param edge_count The number of new edges, nothing being done without any.
+*/
+static void view_extend_weights(GraphView* view, int32_t min_weight, int32_t max_weight, uint64_t edge_count) {
+    if (edge_count == 0)
+        return;
+    if (view->edge_count == 0 || min_weight < view->min_weight)
+        view->min_weight = min_weight;
+    if (view->edge_count == 0 || max_weight > view->max_weight)
+        view->max_weight = max_weight;
+}
+
+/**
+ * Adds an instance of a template, taking the next node ids of the view, which must have enough of them left:
+ * the node count of the view and the template must stay below GRAPH_NO_NODE.
+ *
+ * @param view The view, left as it was if memory is exhausted.
+ * @param name The interned name of the instance.
+ * @param shape The view of the template.
+ * @return 1 if the instance was added, 0 if memory is exhausted.
+*/
+int view_add_instance(GraphView* view, int32_t name, const GraphView* shape) {
+    if (view->instance_count == view->instance_capacity) {
+        uint32_t capacity = view->instance_capacity == 0 ? 4 : view->instance_capacity * 2;
+        Instance* instances = realloc(view->instances, capacity * sizeof(Instance));
+        if (instances == NULL)
+            return 0;
+        view->instances = instances;
+        view->instance_capacity = capacity;
+    }
+    if (!name_map_put(&view->instance_names, (uint32_t) name, view->instance_count))
+        return 0;
+    Instance* instance = &view->instances[view->instance_count++];
+    instance->name = name;
+    instance->shape = shape;
+    instance->offset = view->node_count;
+    view->node_count += shape->node_count;
+    view_extend_weights(view, shape->min_weight, shape->max_weight, shape->edge_count);
+    view->edge_count += shape->edge_count;
+    view->capacitated |= shape->capacitated;
+    return 1;
+}
+
+/**
+ * Adds an edge on top of the shared graphs. The overlay must be sorted by view_finish() before use.
+ *
+ * @param view The view.
+ * @param source The source node id.
+ * @param target The target node id.
+ * @param weight The weight of the edge.
+ * @param capacity The capacity of the edge, GRAPH_NO_CAPACITY without one.
+ * @param line The %declare line of the edge.
+ * @return 1 if the edge was added, 0 if memory is exhausted.
+*/
+int view_add_edge(GraphView* view, uint32_t source, uint32_t target, int32_t weight, int32_t capacity, uint32_t line) {
+    if (view->overlay_count == view->overlay_capacity) {
+        uint32_t grown = view->overlay_capacity == 0 ? 16 : view->overlay_capacity * 2;
+        OverlayEdge* overlay = realloc(view->overlay, grown * sizeof(OverlayEdge));
+        if (overlay == NULL)
+            return 0;
+        view->overlay = overlay;
+        view->overlay_capacity = grown;
+    }
+    OverlayEdge* edge = &view->overlay[view->overlay_count++];
+    edge->source = source;
+    edge->target = target;
+    edge->weight = weight;
+    edge->capacity = capacity;
+    edge->line = line;
+    view->capacitated |= capacity != GRAPH_NO_CAPACITY;
+    view_extend_weights(view, weight, weight, 1);
+    view->edge_count++;
+    return 1;
+}
+
+/**
+ * Orders two overlay edges by source, then by declaration line and target.
+ *
+ * @param a The first edge.
+ * @param b The second edge.
+ * @return A negative, zero or positive value as a sorts before, with or after b.
+*/
+static int compare_overlay(const void* a, const void* b) {
+    const OverlayEdge* x = a;
+    const OverlayEdge* y = b;
+    if (x->source != y->source)
+        return x->source < y->source ? -1 : 1;
+    if (x->line != y->line)
+        return x->line < y->line ? -1 : 1;
+    return (x->target > y->target) - (x->target < y->target);
+}
+
+/**
+ * Sorts the overlay by source node once every edge was added, and keeps a turned around copy
+ * of it for the incoming edges.
+ *
+ * @param view The view.
+ * @return 1 if the view is finished, 0 if memory is exhausted.
+*/
+int view_finish(GraphView* view) {
+    qsort(view->overlay, view->overlay_count, sizeof(OverlayEdge), compare_overlay);
+    view->reverse_overlay = malloc(view->overlay_count == 0 ? 1 : view->overlay_count * sizeof(OverlayEdge));
+    if (view->reverse_overlay == NULL)
+        return 0;
+    for (uint32_t i = 0; i < view->overlay_count; i++) {
+        view->reverse_overlay[i] = view->overlay[i];
+        view->reverse_overlay[i].source = view->overlay[i].target;
+        view->reverse_overlay[i].target = view->overlay[i].source;
+    }
+    qsort(view->reverse_overlay, view->overlay_count, sizeof(OverlayEdge), compare_overlay);
+    return 1;
+}
+
+/**
+ * Finds the overlay edges leaving a node, or entering it for a reverse cursor.
+ *
+ * @param view The view.
+ * @param node The node id.
+ * @param cursor Receives the range of the edges.
+*/
+static void overlay_range(const GraphView* view, uint32_t node, EdgeCursor* cursor) {
+    const OverlayEdge* overlay = cursor->reverse ? view->reverse_overlay : view->overlay;
+    if (view->overlay_count == 0) { // A block without instances walks its graph alone
+        cursor->next = cursor->end = 0;
+        return;
+    }
+    uint32_t low = 0, high = view->overlay_count;
+    while (low < high) {
+        uint32_t middle = low + (high - low) / 2;
+        if (overlay[middle].source < node)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    cursor->next = low;
+    while (low < view->overlay_count && overlay[low].source == node)
+        low++;
+    cursor->end = low;
+}
+
+/**
+ * Finds the instance holding a node that was not declared by the block itself.
+ *
+ * @param view The view.
+ * @param node The node id, at least view->graph->node_count.
+ * @return The instance.
+*/
+static const Instance* view_instance(const GraphView* view, uint32_t node) {
+    uint32_t low = 0, high = view->instance_count - 1;
+    while (low < high) {
+        uint32_t middle = low + (high - low + 1) / 2;
+        if (view->instances[middle].offset <= node)
+            low = middle;
+        else
+            high = middle - 1;
+    }
+    return &view->instances[low];
+}
+
+/**
+ * Starts walking the edges leaving a node: its overlay edges first, then those of the graph declaring it.
+ *
+ * @param view The view.
+ * @param node The node id.
+ * @param cursor The cursor to initialize.
+*/
+void view_edges(const GraphView* view, uint32_t node, EdgeCursor* cursor) {
+    cursor->view = view;
+    cursor->node = node;
+    cursor->shift = 0;
+    cursor->in_graph = 0;
+    cursor->reverse = 0;
+    overlay_range(view, node, cursor);
+}
+
+/**
+ * Starts walking the edges entering a node, which the graphs of the view must have reversed
+ * with graph_reverse().
+ *
+ * @param view The view.
+ * @param node The node id.
+ * @param cursor The cursor to initialize.
+*/
+void view_edges_in(const GraphView* view, uint32_t node, EdgeCursor* cursor) {
+    cursor->view = view;
+    cursor->node = node;
+    cursor->shift = 0;
+    cursor->in_graph = 0;
+    cursor->reverse = 1;
+    overlay_range(view, node, cursor);
+}
+
+/**
+ * Moves a walk to the next range of edges of its node: the edges of the graph declaring it
+ * once the overlay edges of the block are given, or the overlay edges of the instance holding it.
+ *
+ * @param cursor The cursor, whose current range is exhausted.
+ * @return 1 if the walk moved to another range, 0 if the node has no range left.
+*/
+static int cursor_descend(EdgeCursor* cursor) {
+    if (cursor->in_graph)
+        return 0;
+    const GraphView* view = cursor->view;
+    if (cursor->node < view->graph->node_count) { // Declared by the block itself
+        const uint32_t* offsets = cursor->reverse && view->graph->directed ? view->graph->reverse_offsets : view->graph->offsets;
+        cursor->in_graph = 1;
+        cursor->next = offsets[cursor->node];
+        cursor->end = offsets[cursor->node + 1];
+    }
+    else { // Declared by the template of an instance
+        const Instance* instance = view_instance(view, cursor->node);
+        cursor->node -= instance->offset;
+        cursor->shift += instance->offset;
+        cursor->view = instance->shape;
+        overlay_range(cursor->view, cursor->node, cursor);
+    }
+    return 1;
+}
+
+/**
+ * Gives the next edge of a walk, descending into the instance holding the node when the
+ * edges of a level are exhausted.
+ *
+ * @param cursor The cursor.
+ * @param edge Receives the edge, with a target id of the view the walk started from.
+ * @return 1 if an edge was given, 0 if the node has no edge left.
+*/
+int view_next_edge(EdgeCursor* cursor, ViewEdge* edge) {
+    for (;;) {
+        if (cursor->next < cursor->end) {
+            uint32_t i = cursor->next++;
+            const Graph* graph = cursor->view->graph;
+            if (cursor->in_graph && cursor->reverse && graph->directed) {
+                edge->target = graph->reverse_targets[i] + cursor->shift;
+                edge->weight = graph->reverse_weights[i];
+                edge->capacity = graph->reverse_capacities == NULL ? GRAPH_NO_CAPACITY : graph->reverse_capacities[i];
+                edge->line = graph->reverse_lines[i];
+            }
+            else if (cursor->in_graph) {
+                edge->target = graph->targets[i] + cursor->shift;
+                edge->weight = graph->weights[i];
+                edge->capacity = graph->capacities == NULL ? GRAPH_NO_CAPACITY : graph->capacities[i];
+                edge->line = graph->lines[i];
+            }
+            else {
+                const OverlayEdge* overlay = cursor->reverse ? &cursor->view->reverse_overlay[i] : &cursor->view->overlay[i];
+                edge->target = overlay->target + cursor->shift;
+                edge->weight = overlay->weight;
+                edge->capacity = overlay->capacity;
+                edge->line = overlay->line;
+            }
+            return 1;
+        }
+        if (!cursor_descend(cursor))
+            return 0;
+    }
+}
+
+/**
+ * Returns the number of edges leaving a node, counted by ranges without walking them.
+ *
+ * @param view The view.
+ * @param node The node id.
+ * @return The degree of the node.
+*/
+uint64_t view_degree(const GraphView* view, uint32_t node) {
+    if (view->overlay_count == 0 && node < view->graph->node_count)
+        return view->graph->offsets[node + 1] - view->graph->offsets[node];
+    EdgeCursor cursor;
+    uint64_t degree = 0;
+    view_edges(view, node, &cursor);
+    do
+        degree += cursor.end - cursor.next;
+    while (cursor_descend(&cursor));
+    return degree;
+}
+
+/**
+ * Gives an edge leaving a node by its position in the walk of view_edges(), skipping whole ranges.
+ *
+ * @param view The view.
+ * @param node The node id.
+ * @param position The position of the edge, below the degree of the node.
+ * @param edge Receives the edge.
+*/
+void view_edge_at(const GraphView* view, uint32_t node, uint64_t position, ViewEdge* edge) {
+    EdgeCursor cursor;
+    view_edges(view, node, &cursor);
+    while (position >= cursor.end - cursor.next) {
+        position -= cursor.end - cursor.next;
+        cursor_descend(&cursor);
+    }
+    cursor.next += (uint32_t) position;
+    view_next_edge(&cursor, edge);
+}
+
+/**
+ * Returns the instance holding a node.
+ *
+ * @param view The view.
+ * @param node The node id.
+ * @return The instance, NULL if the node is declared by the block itself.
+*/
+const Instance* view_instance_of(const GraphView* view, uint32_t node) {
+    return node < view->graph->node_count ? NULL : view_instance(view, node);
+}
+
+/**
+ * Returns the name of a node, as declared in its graph block.
+ *
+ * @param view The view.
+ * @param node The node id.
+ * @return The interned name of the node.
+*/
+uint32_t view_node_name(const GraphView* view, uint32_t node) {
+    while (node >= view->graph->node_count) {
+        const Instance* instance = view_instance(view, node);
+        node -= instance->offset;
+        view = instance->shape;
+    }
+    return view->graph->names[node];
+}
+
+/**
+ * Returns the node id of a name declared by the block itself.
+ *
+ * @param view The view.
+ * @param name The interned name of the node.
+ * @return The node id, GRAPH_NO_NODE if the block declares no such node.
+*/
+uint32_t view_find(const GraphView* view, uint32_t name) {
+    return graph_node(view->graph, name);
+}
+
+/**
+ * Returns the color of a node.
+ *
+ * @param view The view.
+ * @param node The node id.
+ * @return The ColorKind of the node, VIEW_NO_COLOR if it was never colored.
+*/
+int view_color(const GraphView* view, uint32_t node) {
+    return view->colors == NULL ? VIEW_NO_COLOR : view->colors[node];
+}
+
+/**
+ * Colors a node. The colors belong to the view, so two instances of a template are colored apart.
+ *
+ * @param view The view.
+ * @param node The node id.
+ * @param color The ColorKind of the node.
+ * @return 1 if the node was colored, 0 if memory is exhausted.
+*/
+int view_set_color(GraphView* view, uint32_t node, int color) {
+    if (view->colors == NULL) {
+        view->colors = malloc(view->node_count == 0 ? 1 : view->node_count);
+        if (view->colors == NULL)
+            return 0;
+        memset(view->colors, VIEW_NO_COLOR, view->node_count);
+    }
+    view->colors[node] = (uint8_t) color;
+    return 1;
+}
@@ -0,0 +1,101 @@
+/**
+ * @file
+ * @brief Graph view header file.
+*/
+
+#ifndef VIEW_H_
+#define VIEW_H_
+
+#include <stdint.h>
+#include "graph.h"
+
+#define VIEW_NO_COLOR 0xFF /** Color of a node that was never colored. */
+
+typedef struct GraphView GraphView;
+
+/**
+ * Defined type based on a struct holding one %subgraph instance of a graph block.
+ * The nodes of the instance are the nodes of its template, shifted by the offset.
+*/
+typedef struct {
+    int32_t name;           /** Interned name of the instance. */
+    const GraphView* shape; /** View of the template block, shared by every instance of it. */
+    uint32_t offset;        /** Node id of the first node of the instance in the enclosing view. */
+} Instance;
+
+/**
+ * Defined type based on a struct holding an edge added by a view on top of the shared graphs,
+ * between a node of the block and a node of one of its instances.
+*/
+typedef struct {
+    uint32_t source; /** Source node id in the view. */
+    uint32_t target; /** Target node id in the view. */
+    int32_t weight;  /** Weight of the edge. */
+    int32_t capacity;/** Capacity of the edge, GRAPH_NO_CAPACITY without one. */
+    uint32_t line;   /** %declare line of the edge. */
+} OverlayEdge;
+
+/**
+ * Structure holding a graph block with its %subgraph instances, without copying them.
+ * Node ids 0 to graph->node_count - 1 are the nodes declared by the block itself,
+ * each instance then taking the next shape->node_count ids.
+*/
+struct GraphView {
+    const Graph* graph;       /** Nodes and edges declared by the block itself. */
+    uint32_t node_count;      /** Number of nodes, instances included. */
+    uint64_t edge_count;      /** Number of stored edges, instances included. */
+    int32_t min_weight;       /** Smallest edge weight, instances included. */
+    int32_t max_weight;       /** Largest edge weight, instances included. */
+    int capacitated;          /** 1 if an edge, instances included, declares a capacity. */
+    Instance* instances;      /** Instances, by increasing offset. */
+    uint32_t instance_count;  /** Number of instances. */
+    uint32_t instance_capacity; /** Capacity of instances. */
+    NameMap instance_names;   /** Index of each instance by interned name. */
+    OverlayEdge* overlay;     /** Edges towards the instances, sorted by source. */
+    OverlayEdge* reverse_overlay; /** Overlay edges turned around, sorted by their new source. */
+    uint32_t overlay_count;   /** Number of overlay edges. */
+    uint32_t overlay_capacity;/** Capacity of overlay. */
+    uint8_t* colors;          /** ColorKind of each node, allocated by the first view_set_color(). */
+};
+
+/**
+ * Defined type based on a struct walking the edges leaving a node of a view.
+*/
+typedef struct {
+    const GraphView* view; /** View holding the edges being walked. */
+    uint32_t node;         /** Node id in that view. */
+    uint32_t shift;        /** Offset of that view in the view the walk started from. */
+    uint32_t next;         /** Next edge of the current range. */
+    uint32_t end;          /** End of the current range. */
+    int in_graph;          /** 1 when the range is in view->graph, 0 when it is in view->overlay. */
+    int reverse;           /** 1 when the incoming edges are walked, 0 for the outgoing ones. */
+} EdgeCursor;
+
+/**
+ * Defined type based on a struct holding one edge given by an EdgeCursor.
+*/
+typedef struct {
+    uint32_t target; /** Target node id, or source node id of an incoming edge. */
+    int32_t weight;  /** Weight of the edge. */
+    int32_t capacity;/** Capacity of the edge, GRAPH_NO_CAPACITY without one. */
+    uint32_t line;   /** %declare line of the edge. */
+} ViewEdge;
+
+int view_init(GraphView* view, const Graph* graph);
+void view_free(GraphView* view);
+int view_add_instance(GraphView* view, int32_t name, const GraphView* shape);
+int view_add_edge(GraphView* view, uint32_t source, uint32_t target, int32_t weight, int32_t capacity, uint32_t line);
+int view_finish(GraphView* view);
+
+void view_edges(const GraphView* view, uint32_t node, EdgeCursor* cursor);
+void view_edges_in(const GraphView* view, uint32_t node, EdgeCursor* cursor);
+int view_next_edge(EdgeCursor* cursor, ViewEdge* edge);
+uint64_t view_degree(const GraphView* view, uint32_t node);
+void view_edge_at(const GraphView* view, uint32_t node, uint64_t position, ViewEdge* edge);
+const Instance* view_instance_of(const GraphView* view, uint32_t node);
+uint32_t view_node_name(const GraphView* view, uint32_t node);
+uint32_t view_find(const GraphView* view, uint32_t name);
+int view_color(const GraphView* view, uint32_t node);
+int view_set_color(GraphView* view, uint32_t node, int color);
+
+#endif